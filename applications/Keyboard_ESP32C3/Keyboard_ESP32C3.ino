@@ -9,12 +9,19 @@
  * * 2024-12-24 : Fixed issue https://github.com/Xinyuan-LilyGO/T-Deck/issues/70
  * * 2024-12-25 : Added keyboard backlight control
  * * 2025-06-12 : Add new commands to allow reading raw key states by @kilrah
+ * * 2026-10-18 : Event mode: press/release FIFO, interrupt line and burst reads at 400 kHz
+ * * 2026-10-18 : Timer driven matrix scan with register access, integrating debounce and light sleep
+ * * 2026-10-18 : Empty burst reads no longer keep the C3 awake, short wake for the host
  */
 #include <Arduino.h>
 #include <Wire.h>
 
 #ifdef CONFIG_IDF_TARGET_ESP32C3
 
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include <soc/gpio_reg.h>
+
 #define I2C_DEV_ADDR                        0x55
 #define keyboard_BL_PIN                     9
 #define SDA                                 2
@@ -30,6 +37,48 @@
 #define LILYGO_KB_ALT_B_BRIGHTNESS_CMD      0x02
 #define LILYGO_KB_MODE_RAW_CMD              0x03
 #define LILYGO_KB_MODE_KEY_CMD              0x04
+#define LILYGO_KB_MODE_EVENT_CMD            0x05
+#define LILYGO_KB_SCAN_RATE_CMD             0x06  //Argument: scan rate / 10 Hz
+
+/*
+* The matrix is scanned from a hardware timer. Each column is driven low in
+* turn by enabling its output, the rows are read KB_SETTLE_US later straight
+* from the GPIO input register. Every key has an integrator counting up while
+* it reads pressed and down while it reads released; it changes state only at
+* the ends, KB_DEBOUNCE_MS of steady readings.
+*
+* In event mode, with the interrupt line wired, no key down, an empty FIFO and
+* the backlight off, the C3 light sleeps after KB_IDLE_MS with every column
+* low, until a key pulls a row low or the host pulls SDA low. The transaction
+* that wakes it is missed, the host retries within KB_HOST_WAKE_MS. Burst reads
+* that find the FIFO empty, the host's safety polls, do not count as activity.
+* */
+#define KB_SCAN_HZ                          1000
+#define KB_SCAN_HZ_MIN                      50
+#define KB_SCAN_HZ_MAX                      2000
+#define KB_SETTLE_US                        5
+#define KB_DEBOUNCE_MS                      5
+#define KB_IDLE_MS                          1000
+#define KB_HOST_WAKE_MS                     50    //Awake time after the host woke the C3
+
+/*
+* Event mode: every press and release goes into a FIFO and KB_INT_PIN is pulled
+* low while it holds anything. A read returns KB_BURST_MAGIC, a count byte and
+* up to KB_BURST_EVENTS events of 3 bytes: flags, col * rowCount + row and the
+* character, which is 0 for modifiers. A release repeats the press character.
+* */
+#define KB_INT_PIN                          8     //Open drain to the T-Deck BOARD_KEYBOARD_INT, -1 if not wired
+#define KB_FIFO_DEPTH                       32    //Power of two
+#define KB_BURST_MAGIC                      0xEB
+#define KB_BURST_EVENTS                     16
+#define KB_BURST_NO_INT                     0x20  //Count byte: no interrupt line, the host polls
+#define KB_BURST_MORE                       0x40  //Count byte: events left after this burst
+#define KB_BURST_OVERFLOW                   0x80  //Count byte: events were dropped
+#define KB_EVT_PRESSED                      0x80
+#define KB_MOD_SHIFT                        0x01
+#define KB_MOD_SYM                          0x02
+#define KB_MOD_ALT                          0x04
+#define KB_MOD_MIC                          0x08
 
 uint8_t  rows[] = {0, 3, 19, 12, 18, 6, 7 };
 const int rowCount = sizeof(rows) / sizeof(rows[0]);
@@ -43,6 +92,28 @@ bool changedValue[colCount][rowCount];
 char keyboard[colCount][rowCount];
 char keyboard_symbol[colCount][rowCount];
 bool rawMode = 0;
+uint8_t integrator[colCount][rowCount];
+uint8_t debounceMax;
+bool keysBusy = false;              // A key is down or still bouncing
+uint32_t colMask = 0;
+uint32_t rowMask = 0;
+hw_timer_t *scanTimer = NULL;
+TaskHandle_t scanTask = NULL;
+volatile uint32_t lastActivity = 0;
+bool eventMode = false;
+
+typedef struct {
+    uint8_t flags;
+    uint8_t key;
+    uint8_t ch;
+} kb_event_t;
+
+// Written by loop(), read by onRequest() on the I2C task
+kb_event_t kbFifo[KB_FIFO_DEPTH];
+volatile uint32_t kbFifoHead = 0;
+volatile uint32_t kbFifoTail = 0;
+volatile bool kbFifoOverflow = false;
+char pressedChar[colCount][rowCount];
 
 bool BL_state = false;
 bool comdata_flag = false;
@@ -63,15 +134,23 @@ uint8_t kb_brightness_duty = KB_BRIGHTNESS_BOOT_DUTY;
 uint8_t kb_brightness_setting_duty = KB_BRIGHTNESS_DEFAULT_DUTY;   //Alt+B default duty , is duty is zero , use setting duty
 
 void onRequest();
-void readMatrix();
+bool readMatrix();
+void setScanRate(uint32_t hz);
+void idleSleep();
+void IRAM_ATTR onScanTimer();
 bool keyPressed(int colIndex, int rowIndex);
 bool keyActive(int colIndex, int rowIndex);
 bool isPrintableKey(int colIndex, int rowIndex);
 void printMatrix();
 void set_keyboard_BL(bool state);
+void queueEvents();
+void setIntLine();
+uint8_t currentModifiers();
+char keyCharacter(int colIndex, int rowIndex);
 
 void onReceive(int len)
 {
+    lastActivity = millis();
     // Serial.printf("onReceive[%d]: ", len);
     while (Wire.available()) {
         int cmd = Wire.read();
@@ -103,9 +182,27 @@ void onReceive(int len)
         break;
         case LILYGO_KB_MODE_KEY_CMD: {
             rawMode = false;
+            eventMode = false;
+            setIntLine();
             Serial.println("Switched to key mode");
         }
         break;
+        case LILYGO_KB_MODE_EVENT_CMD: {
+            rawMode = false;
+            kbFifoTail = kbFifoHead;
+            kbFifoOverflow = false;
+            eventMode = true;
+            setIntLine();
+            Serial.println("Switched to event mode");
+        }
+        break;
+        case LILYGO_KB_SCAN_RATE_CMD: {
+            int rate = Wire.read();
+            if (rate > 0) {
+                setScanRate(rate * 10);
+            }
+        }
+        break;
         default:
             break;
         }
@@ -208,7 +305,12 @@ void setup()
     Serial.setDebugOutput(true);
     Wire.onRequest(onRequest);
     Wire.onReceive(onReceive);
-    Wire.begin((uint8_t)I2C_DEV_ADDR, SDA, SCL, 100000UL);
+    Wire.begin((uint8_t)I2C_DEV_ADDR, SDA, SCL, 400000UL);
+
+#if KB_INT_PIN >= 0
+    pinMode(KB_INT_PIN, OUTPUT_OPEN_DRAIN);
+    digitalWrite(KB_INT_PIN, HIGH);
+#endif
 
     Serial.println("Starting keyboard work!");
 
@@ -216,22 +318,41 @@ void setup()
     ledcAttachPin(keyboard_BL_PIN, KB_BRIGHTNESS_CH);
     ledcWrite(KB_BRIGHTNESS_CH, KB_BRIGHTNESS_BOOT_DUTY);
 
-    Serial.println("4");
     for (int x = 0; x < rowCount; x++) {
-        Serial.print(rows[x]); Serial.println(" as input");
-        pinMode(rows[x], INPUT);
+        Serial.print(rows[x]); Serial.println(" as input-pullup");
+        pinMode(rows[x], INPUT_PULLUP);
+        rowMask |= 1UL << rows[x];
     }
 
+    // Columns hold a low output level, readMatrix() only switches the output enable
     for (int x = 0; x < colCount; x++) {
-        Serial.print(cols[x]); Serial.println(" as input-pullup");
-        pinMode(cols[x], INPUT_PULLUP);
+        Serial.print(cols[x]); Serial.println(" as column");
+        pinMode(cols[x], OUTPUT);
+        digitalWrite(cols[x], LOW);
+        colMask |= 1UL << cols[x];
     }
+    REG_WRITE(GPIO_ENABLE_W1TC_REG, colMask);
 
+    scanTask = xTaskGetCurrentTaskHandle();
+    scanTimer = timerBegin(0, getApbFrequency() / 1000000, true);
+    timerAttachInterrupt(scanTimer, onScanTimer, true);
+    setScanRate(KB_SCAN_HZ);
+    timerAlarmEnable(scanTimer);
 }
 
 void loop()
 {
-    readMatrix();
+    // One pass per scan timer tick
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (!readMatrix()) {
+        setIntLine();
+        idleSleep();
+        return;
+    }
+    lastActivity = millis();
+    if (eventMode) {
+        queueEvents();
+    }
     printMatrix();
 
     // key 3,3 is the enter key
@@ -271,8 +392,167 @@ void loop()
     }
 }
 
+// Low while the host has events to read
+void setIntLine()
+{
+#if KB_INT_PIN >= 0
+    digitalWrite(KB_INT_PIN, (eventMode && kbFifoHead != kbFifoTail) ? LOW : HIGH);
+#endif
+}
+
+uint8_t currentModifiers()
+{
+    uint8_t mods = 0;
+    if (keyActive(1, 6) || keyActive(2, 3)) {
+        mods |= KB_MOD_SHIFT;
+    }
+    if (keyActive(0, 2)) {
+        mods |= KB_MOD_SYM;
+    }
+    if (keyActive(0, 4)) {
+        mods |= KB_MOD_ALT;
+    }
+    if (keyActive(0, 6)) {
+        mods |= KB_MOD_MIC;
+    }
+    return mods;
+}
+
+// The character a key press stands for with the modifiers now held, as key mode sends it
+char keyCharacter(int colIndex, int rowIndex)
+{
+    if (colIndex == 3 && rowIndex == 3) {
+        return (char)0x0D;  // Enter
+    }
+    if (colIndex == 4 && rowIndex == 3) {
+        return (char)0x08;  // Backspace
+    }
+    if (keyActive(0, 4)) {
+        if (colIndex == 3 && rowIndex == 4) {
+            return 0;       // Alt+B is the backlight, handled here
+        }
+        if (colIndex == 2 && rowIndex == 5) {
+            return (char)0x0C;
+        }
+    }
+    char ch = keyActive(0, 2) ? keyboard_symbol[colIndex][rowIndex] : keyboard[colIndex][rowIndex];
+    if ((keyActive(1, 6) || keyActive(2, 3)) && ch >= 'a' && ch <= 'z') {
+        ch = (char)(ch - 32);
+    }
+    return ch;
+}
+
+void queueEvents()
+{
+    uint8_t mods = currentModifiers();
+    for (int colIndex = 0; colIndex < colCount; colIndex++) {
+        for (int rowIndex = 0; rowIndex < rowCount; rowIndex++) {
+            if (!changedValue[colIndex][rowIndex]) {
+                continue;
+            }
+            bool pressed = keys[colIndex][rowIndex];
+            char ch;
+            if (pressed) {
+                ch = keyCharacter(colIndex, rowIndex);
+                pressedChar[colIndex][rowIndex] = ch;
+            } else {
+                ch = pressedChar[colIndex][rowIndex];
+                pressedChar[colIndex][rowIndex] = 0;
+            }
+            if (kbFifoHead - kbFifoTail >= KB_FIFO_DEPTH) {
+                kbFifoOverflow = true;
+                continue;
+            }
+            kb_event_t *event = &kbFifo[kbFifoHead & (KB_FIFO_DEPTH - 1)];
+            event->flags = (pressed ? KB_EVT_PRESSED : 0) | mods;
+            event->key = colIndex * rowCount + rowIndex;
+            event->ch = ch;
+            kbFifoHead = kbFifoHead + 1;
+        }
+    }
+    // Also re-asserts the line should a read have emptied the FIFO just before a push
+    setIntLine();
+}
+
+void IRAM_ATTR onScanTimer()
+{
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(scanTask, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void setScanRate(uint32_t hz)
+{
+    hz = constrain(hz, KB_SCAN_HZ_MIN, KB_SCAN_HZ_MAX);
+    debounceMax = max(1UL, (unsigned long)(KB_DEBOUNCE_MS * hz / 1000));
+    timerAlarmWrite(scanTimer, 1000000 / hz, true);
+    Serial.printf("Scan rate %lu Hz, debounce %u scans\n", (unsigned long)hz, debounceMax);
+}
+
+void idleSleep()
+{
+    if (KB_INT_PIN < 0 || !eventMode || BL_state || keysBusy || kbFifoHead != kbFifoTail ||
+            millis() - lastActivity < KB_IDLE_MS) {
+        return;
+    }
+    timerAlarmDisable(scanTimer);
+    Serial.flush();
+
+    // Every column low, so any key pulls its row low
+    REG_WRITE(GPIO_ENABLE_W1TS_REG, colMask);
+    for (int x = 0; x < rowCount; x++) {
+        gpio_wakeup_enable((gpio_num_t)rows[x], GPIO_INTR_LOW_LEVEL);
+    }
+    gpio_wakeup_enable((gpio_num_t)SDA, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+
+    esp_light_sleep_start();
+
+    for (int x = 0; x < rowCount; x++) {
+        gpio_wakeup_disable((gpio_num_t)rows[x]);
+    }
+    gpio_wakeup_disable((gpio_num_t)SDA);
+    // With no row low it was the host; stay up for its retry only
+    bool byKey = (REG_READ(GPIO_IN_REG) & rowMask) != rowMask;
+    REG_WRITE(GPIO_ENABLE_W1TC_REG, colMask);
+
+    lastActivity = byKey ? millis() : millis() - (KB_IDLE_MS - KB_HOST_WAKE_MS);
+    timerAlarmEnable(scanTimer);
+}
+
 void onRequest()
 {
+    if (eventMode && !rawMode) {
+        uint8_t buf[2 + KB_BURST_EVENTS * sizeof(kb_event_t)];
+        uint32_t tail = kbFifoTail;
+        uint32_t count = min(kbFifoHead - tail, (uint32_t)KB_BURST_EVENTS);
+        for (uint32_t i = 0; i < count; i++) {
+            memcpy(buf + 2 + i * sizeof(kb_event_t), &kbFifo[(tail + i) & (KB_FIFO_DEPTH - 1)], sizeof(kb_event_t));
+        }
+        kbFifoTail = tail + count;
+        // The host's empty safety polls must not keep the keyboard awake
+        if (count) {
+            lastActivity = millis();
+        }
+        buf[0] = KB_BURST_MAGIC;
+        buf[1] = count;
+        if (kbFifoHead != kbFifoTail) {
+            buf[1] |= KB_BURST_MORE;
+        }
+        if (KB_INT_PIN < 0) {
+            buf[1] |= KB_BURST_NO_INT;
+        }
+        if (kbFifoOverflow) {
+            buf[1] |= KB_BURST_OVERFLOW;
+            kbFifoOverflow = false;
+        }
+        Wire.write(buf, 2 + count * sizeof(kb_event_t));
+        setIntLine();
+        return;
+    }
+    lastActivity = millis();
     if(rawMode) {
         for(uint8_t col = 0; col < colCount; col++) {
             uint8_t val = 0;
@@ -297,37 +577,44 @@ void onRequest()
     }
 }
 
-void readMatrix()
+// One pass over the matrix, true when a key changed its debounced state
+bool readMatrix()
 {
-    int delayTime = 0;
-    // iterate the columns
+    bool changed = false;
+    keysBusy = false;
     for (int colIndex = 0; colIndex < colCount; colIndex++) {
-        // col: set to output to low
-        uint8_t  curCol = cols[colIndex];
-        pinMode(curCol, OUTPUT);
-        digitalWrite(curCol, LOW);
+        uint32_t colBit = 1UL << cols[colIndex];
+        REG_WRITE(GPIO_ENABLE_W1TS_REG, colBit);
+        delayMicroseconds(KB_SETTLE_US);
+        uint32_t in = REG_READ(GPIO_IN_REG);
+        REG_WRITE(GPIO_ENABLE_W1TC_REG, colBit);
 
-        // row: interate through the rows
         for (int rowIndex = 0; rowIndex < rowCount; rowIndex++) {
-            uint8_t  rowCol = rows[rowIndex];
-            pinMode(rowCol, INPUT_PULLUP);
-            delay(1); // arduino is not fast enought to switch input/output modes so wait 1 ms
-
-            bool buttonPressed = (digitalRead(rowCol) == LOW);
+            bool buttonPressed = !(in & (1UL << rows[rowIndex]));
+            uint8_t &count = integrator[colIndex][rowIndex];
+            if (buttonPressed) {
+                if (count < debounceMax) {
+                    count++;
+                }
+            } else if (count > 0) {
+                count--;
+            }
 
-            keys[colIndex][rowIndex] = buttonPressed;
-            if ((lastValue[colIndex][rowIndex] != buttonPressed)) {
-                changedValue[colIndex][rowIndex] = true;
-            } else {
-                changedValue[colIndex][rowIndex] = false;
+            bool state = keys[colIndex][rowIndex];
+            if (count >= debounceMax) {
+                state = true;
+            } else if (count == 0) {
+                state = false;
             }
+            keysBusy |= count > 0;
 
-            lastValue[colIndex][rowIndex] = buttonPressed;
-            pinMode(rowCol, INPUT);
+            keys[colIndex][rowIndex] = state;
+            changedValue[colIndex][rowIndex] = lastValue[colIndex][rowIndex] != state;
+            changed |= changedValue[colIndex][rowIndex];
+            lastValue[colIndex][rowIndex] = state;
         }
-        // disable the column
-        pinMode(curCol, INPUT);
     }
+    return changed;
 }
 
 bool keyPressed(int colIndex, int rowIndex)
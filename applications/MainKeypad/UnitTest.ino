@@ -37,6 +37,26 @@ LV_IMG_DECLARE(CWS_Logo);
 
 #include "utilities.h"
 #include "config.h"
+#include "event_journal.h"
+#include "node_registry.h"
+#include "supervision.h"
+#include "alarm_pipeline.h"
+#include "ui_performance.h"
+#include "boot_profile.h"
+#include "boot_orchestrator.h"
+#include "gps_task.h"
+#include "ubx.h"
+#include "gps_assist.h"
+#include "map_tiles.h"
+#include "ui_map.h"
+#include "mic_capture.h"
+#include "audio_recorder.h"
+#include "acoustic_events.h"
+#include "mic_array.h"
+#include "clip_cache.h"
+#include "audio_mixer.h"
+#include "keyboard.h"
+#include "input_events.h"
 
 #ifndef BOARD_HAS_PSRAM
 #error "Detected that PSRAM is not turned on. Please set PSRAM to OPI PSRAM in ArduinoIDE"
@@ -52,11 +72,26 @@ String gps_model = "None";
 
 #define MIC_I2S_SAMPLE_RATE         16000
 #define MIC_I2S_PORT                I2S_NUM_1
+#define MIC_I2S_CHANNELS            4       // ES7210 TDM, MIC1..MIC4 in slots 0..3
+#define MIC_PAIR_SPACING_MM         50      // Between the two board microphones, adjust to the enclosure
 #define SPK_I2S_PORT                I2S_NUM_0
+#define SPK_STREAM_HEADROOM         2304    // Frames free before audio.loop(), it decodes one MP3/AAC frame at most
 #define VAD_SAMPLE_RATE_HZ          16000
 #define VAD_FRAME_LENGTH_MS         30
 #define VAD_BUFFER_LENGTH           (VAD_FRAME_LENGTH_MS * VAD_SAMPLE_RATE_HZ / 1000)
 
+#define BOOT_FADE_STEP_MS           30      // Splash backlight fade, 16 steps
+#define BOOT_SPLASH_MIN_MS          500     // Let the fade finish
+#define BOOT_PROBE_TIMEOUT_MS       3000    // Continue without a hung required probe
+
+// Index into boot_probes[]
+enum {
+    BOOT_PROBE_SD = 0,
+    BOOT_PROBE_AUDIO,
+    BOOT_PROBE_WIFI,
+    BOOT_PROBE_GPS,
+};
+
 #if TFT_DC !=  BOARD_TFT_DC || TFT_CS !=  BOARD_TFT_CS || TFT_MOSI !=  BOARD_SPI_MOSI || TFT_SCLK !=  BOARD_SPI_SCK
 #error "Not using the already configured T-Deck file, please remove <Arduino/libraries/TFT_eSPI> and replace with <lib/TFT_eSPI>, please do not click the upgrade library button when opening sketches in ArduinoIDE versions 2.0 and above, otherwise the original configuration file will be replaced !!!"
 #error "Not using the already configured T-Deck file, please remove <Arduino/libraries/TFT_eSPI> and replace with <lib/TFT_eSPI>, please do not click the upgrade library button when opening sketches in ArduinoIDE versions 2.0 and above, otherwise the original configuration file will be replaced !!!"
@@ -127,6 +162,9 @@ Audio           audio;
 size_t          bytes_read;
 uint8_t         status;
 TaskHandle_t    playHandle = NULL;
+static volatile bool playStop = false;  // Asks the play task to finish before sleep
+static int      ttsStream = -1;         // Mixer stream fed by Audio while a file plays
+static int      clickClip = -1;
 TaskHandle_t    radioHandle = NULL;
 
 static lv_obj_t *vad_btn_label;
@@ -135,6 +173,7 @@ static TaskHandle_t vadTaskHandler;
 bool        kbDetected = false;
 bool        touchDetected = false;
 bool        transmissionFlag = true;
+volatile uint32_t rxTimestampUs = 0;    // micros() of the last DIO1 interrupt
 bool        enableInterrupt = true;
 int         transmissionState ;
 bool        hasRadio = false;
@@ -156,11 +195,12 @@ bool is_touch_isolated();
 
 static void setupLvgl();
 static void keypad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data);
-static uint32_t keypad_get_key(void);
 static void touchpad_read( lv_indev_drv_t *indev_driver, lv_indev_data_t *data );
 static void mouse_read(lv_indev_drv_t *indev, lv_indev_data_t *data);
 static void disp_flush( lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p );
 static bool GPS_Recovery();
+static bool GPS_EnablePVT();
+static void GPS_InjectAssist();
 
 
 
@@ -175,6 +215,8 @@ extern void setupUI(void);
 
 bool setupGPS()
 {
+    // Absorbs NMEA bursts between two GPS task wake-ups
+    SerialGPS.setRxBufferSize(GPS_UART_RX_BUFFER);
     SerialGPS.begin(9600, SERIAL_8N1, BOARD_GPS_RX_PIN, BOARD_GPS_TX_PIN);
 
     bool result = false;
@@ -230,6 +272,7 @@ bool setupGPS()
 static void time_available_cb(struct timeval *t)
 {
     Serial.println("Got time adjustment from NTP!");
+    gps_assist_time_synced();
 }
 
 static void wifi_event_cb(WiFiEvent_t event)
@@ -318,6 +361,7 @@ void setFlag(void)
         return;
     }
     // we got a packet, set the flag
+    rxTimestampUs = micros();
     transmissionFlag = true;
 }
 
@@ -464,6 +508,7 @@ bool setupCoder()
 
     ret_val |= es7210_adc_init(&Wire, &cfg);
     ret_val |= es7210_adc_config_i2s(cfg.codec_mode, &cfg.i2s_iface);
+    ret_val |= es7210_adc_set_tdm(true);
     ret_val |= es7210_adc_set_gain(
                    (es7210_input_mics_t)(ES7210_INPUT_MIC1 | ES7210_INPUT_MIC2),
                    (es7210_gain_value_t)GAIN_6DB);
@@ -474,12 +519,28 @@ bool setupCoder()
 
 void taskPlaySong(void *p)
 {
-    while (1) {
-        if ( xSemaphoreTake( xSemaphore, portMAX_DELAY ) == pdTRUE ) {
-            playTTS("hello.mp3");
-            xSemaphoreGive( xSemaphore );
-        }
-        vTaskSuspend(NULL);
+    while (!playStop) {
+        // playTTS() takes the SPI bus only around the card reads
+        playTTS("hello.mp3");
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    playHandle = NULL;
+    vTaskDelete(NULL);
+}
+
+// Let the play task give the bus back and exit on its own; deleting it could
+// leave xSemaphore taken for good
+static void stopPlayTask()
+{
+    playStop = true;
+    if (playHandle) {
+        xTaskNotifyGive(playHandle);
+    }
+    for (int i = 0; i < 100 && playHandle; i++) {
+        delay(10);
+    }
+    if (playHandle) {
+        Serial.println("Play task did not stop");
     }
 }
 
@@ -489,52 +550,33 @@ uint32_t gps_use_second = 0;
 
 void loopGPS()
 {
-    static uint32_t last_gps_time = 0;
-    uint32_t current_time = millis();
-    
-    // Time-slice GPS processing: only run every 50ms to prevent UI blocking
-    if (current_time - last_gps_time < 50) {
+    // The boot probe owns the UART until the module is identified
+    if (!boot_probe_done(BOOT_PROBE_GPS)) {
         return;
     }
-    last_gps_time = current_time;
-    
-    unsigned long start = millis();
-    do {
-        // Process only a limited amount of GPS data per cycle
-        int bytes_processed = 0;
-        while (SerialGPS.available() && bytes_processed < 32) {
-            int c = SerialGPS.read();
-            // Serial.write(c);
-            gps.encode(c);
-            bytes_processed++;
-        }
-        
-        // Yield to LVGL every 5ms during GPS processing
-        if (millis() - start >= 5) {
-            lv_task_handler();
-            break;
-        }
-    } while (millis() - start < 15); // Reduced from 20ms to 15ms
 
     if (gps_update_interval < millis()) {
+        // Parsing runs in the GPS task, this only copies its latest fix
+        gps_fix_t fix;
+        gps_fix_read(&fix);
 
-        bool location = gps.location.isValid();
-        bool datetime = (gps.date.year() > 2000);
-        if (location && datetime && !update_use_second) {
+        bool datetime = (fix.year > 2000);
+        if (fix.location_valid && datetime && !update_use_second) {
             update_use_second = true;
             gps_use_second = (millis() - gps_start_ms) / 1000;
         }
-
-        updateGPS(gps.location.lat(),
-                  gps.location.lng(),
-                  gps.date.year(),
-                  gps.date.month(),
-                  gps.date.day(),
-                  gps.time.hour(),
-                  gps.time.minute(),
-                  gps.time.second(),
-                  gps.speed.value(),
-                  gps.charsProcessed(),
+        gps_assist_poll(&fix, gps_use_second);
+
+        updateGPS(fix.lat,
+                  fix.lng,
+                  fix.year,
+                  fix.month,
+                  fix.day,
+                  fix.hour,
+                  fix.minute,
+                  fix.second,
+                  fix.speed,
+                  fix.chars,
                   gps_use_second);
         gps_update_interval = millis()  + 3000;
     }
@@ -642,9 +684,8 @@ void loopRadio()
                     Serial.println(F(" dB"));
 
 
-                    snprintf(buf, 256, "RX:%s RSSI:%.2f SNR:%.2f\n", recv.c_str(), radio.getRSSI(), radio.getSNR());
-
-                    setLoRaMessage(buf);
+                    // Decoding, journaling and the UI update happen in the alarm pipeline
+                    alarm_pipeline_submit_rx(recv.c_str(), recv.length(), radio.getRSSI(), radio.getSNR(), rxTimestampUs);
 
                 } else if (state ==  RADIOLIB_ERR_CRC_MISMATCH) {
                     // packet was received, but is malformed
@@ -709,11 +750,15 @@ void vadTask(void *params)
 {
     Serial.println("vadTask(void *params)");
 
-    // vTaskSuspend(NULL);
+    int mic = mic_capture_subscribe("vad");
+    if (mic < 0) {
+        Serial.println("VAD: no capture cursor left");
+        vTaskDelete(NULL);
+    }
     while (1) {
-        size_t read_len = 0;
-        if (i2s_read(MIC_I2S_PORT, (char *) vad_buff, vad_buffer_size, &read_len, portMAX_DELAY) == ESP_OK) {
-            // if (watch.readMicrophone((char *) vad_buff, vad_buffer_size, &read_len)) {
+        // Consecutive 30 ms frames from the capture ring, no audio is skipped
+        // between them however long vad_process() takes
+        if (mic_capture_read_channel(mic, 0, vad_buff, VAD_BUFFER_LENGTH, portMAX_DELAY) == VAD_BUFFER_LENGTH) {
             // Feed samples to the VAD process and get the result
 #if  ESP_IDF_VERSION_VAL(4,4,1) == ESP_IDF_VERSION
             vad_state_t vad_state = vad_process(vad_inst, vad_buff);
@@ -722,7 +767,14 @@ void vadTask(void *params)
 #else
 #error "ESP VAD Not support Version > V5.0.0 , please use IDF V4.4.4"
 #endif
+            // Same frames, classified for glass break and impacts; not
+            // while the keypad's own speaker plays into the microphones
+            if (!audio_mixer_active()) {
+                acoustic_events_frame(vad_buff, VAD_BUFFER_LENGTH, vad_state == VAD_SPEECH);
+            }
             if (vad_state == VAD_SPEECH) {
+                // Starts or extends an evidence recording, pre-roll included
+                audio_recorder_trigger();
                 // Serial.print(millis());
                 // Serial.println(" -> Noise detected!!!");
                 updateNoiseLabel(vad_detected_counter++);
@@ -734,7 +786,6 @@ void vadTask(void *params)
                 vad_detected_counter = 0;
             }
         }
-        delay(30);
     }
 }
 
@@ -763,7 +814,7 @@ void setupMicrophoneI2S(i2s_port_t  i2s_ch)
         .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
         .sample_rate = MIC_I2S_SAMPLE_RATE,
         .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-        .channel_format = I2S_CHANNEL_FMT_ALL_LEFT,
+        .channel_format = I2S_CHANNEL_FMT_MULTIPLE,
         .communication_format = I2S_COMM_FORMAT_STAND_I2S,
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
         .dma_buf_count = 8,
@@ -787,6 +838,12 @@ void setupMicrophoneI2S(i2s_port_t  i2s_ch)
     i2s_set_pin(i2s_ch, &pin_config);
     i2s_zero_dma_buffer(i2s_ch);
 
+    // Capture runs from here on, consumers subscribe from their own tasks
+    if (!mic_capture_begin(i2s_ch, MIC_I2S_CHANNELS, true)) {
+        Serial.println("Mic capture failed to start");
+        return;
+    }
+
 #ifdef USE_ESP_VAD
     // Initialize esp-sr vad detected
 #if ESP_IDF_VERSION_VAL(4,4,1) == ESP_IDF_VERSION
@@ -803,8 +860,22 @@ void setupMicrophoneI2S(i2s_port_t  i2s_ch)
             delay(1000);
         }
     }
+    if (!acoustic_events_begin(MIC_I2S_SAMPLE_RATE)) {
+        Serial.println("Acoustic events unavailable");
+    }
     xTaskCreate(vadTask, "vad", 8 * 1024, NULL, 12, &vadTaskHandler);
-#else
+#endif
+
+    // MIC1 and MIC2 on the keypad's horizontal axis, MIC1 to the left
+    static const mic_position_t mic_layout[] = {
+        { -MIC_PAIR_SPACING_MM / 2, 0, 0 },
+        { MIC_PAIR_SPACING_MM / 2, 0, 1 },
+    };
+    if (!mic_array_begin(mic_layout, sizeof(mic_layout) / sizeof(mic_layout[0]), MIC_I2S_SAMPLE_RATE, true)) {
+        Serial.println("Noise direction unavailable");
+    }
+
+#ifndef USE_ESP_VAD
     // xTaskCreate(audioLoopbackTask, "vad", 8 * 1024, NULL, 12, &vadTaskHandler);
 #endif
 
@@ -813,24 +884,102 @@ void setupMicrophoneI2S(i2s_port_t  i2s_ch)
 
 void playTTS(const char *filename)
 {
+    // Cached prompts start within a few ms, without decoding or the SD card
+    if (audio_mixer_play(clip_cache_find(filename), MIXER_GAIN_UNITY, MIXER_PRIO_VOICE, false)) {
+        return;
+    }
+    ttsStream = audio_mixer_stream_open(MIXER_GAIN_UNITY, MIXER_PRIO_VOICE);
+    if (ttsStream < 0) {
+        return;
+    }
+    // Audio decodes with the same global MP3 decoder as the clip loader
+    if (!clip_cache_decoder_take(portMAX_DELAY)) {
+        audio_mixer_stream_close(ttsStream);
+        ttsStream = -1;
+        return;
+    }
     bool findMp3 = false;
-    if (SD.exists("/" + String(filename))) {
-        findMp3 = audio.connecttoFS(SD, filename);
-    } else if (SPIFFS.exists("/" + String(filename))) {
+    bool onSD = false;
+    if (xSemaphoreTake(xSemaphore, portMAX_DELAY) == pdTRUE) {
+        onSD = SD.exists("/" + String(filename));
+        if (onSD) {
+            findMp3 = audio.connecttoFS(SD, filename);
+        }
+        xSemaphoreGive(xSemaphore);
+    }
+    if (!onSD && SPIFFS.exists("/" + String(filename))) {
         findMp3 = audio.connecttoFS(SPIFFS, filename);
     }
     if (findMp3) {
-        while (audio.isRunning()) {
+        uint32_t frames0, writes0, us0;
+        audio.getOutputStats(&frames0, &writes0, &us0);
+        uint32_t start = millis();
+        while (audio.isRunning() && !playStop) {
+            // Stolen by a higher priority voice or stopped: its space stays
+            // 0, stop decoding and let the clip loader have the decoder
+            if (!audio_mixer_stream_attached(ttsStream)) {
+                break;
+            }
+            // With room for what one loop() decodes, the mixer never makes
+            // Audio wait while the bus is taken
+            if (audio_mixer_stream_space(ttsStream) < SPK_STREAM_HEADROOM) {
+                delay(3);
+                continue;
+            }
+            if (onSD && xSemaphoreTake(xSemaphore, portMAX_DELAY) != pdTRUE) {
+                continue;
+            }
             audio.loop();
-            delay(3);
+            if (onSD) {
+                xSemaphoreGive(xSemaphore);
+            }
         }
-    }
+        // Stopped for sleep or detached, closing the file may touch the card
+        if (audio.isRunning() && (!onSD || xSemaphoreTake(xSemaphore, portMAX_DELAY) == pdTRUE)) {
+            audio.stopSong();
+            if (onSD) {
+                xSemaphoreGive(xSemaphore);
+            }
+        }
+        // Output path cost against the length of the audio it produced
+        uint32_t frames, writes, us;
+        audio.getOutputStats(&frames, &writes, &us);
+        frames -= frames0;
+        uint32_t rate = audio.getSampleRate();
+        uint32_t audio_ms = rate ? (uint64_t)frames * 1000 / rate : 0;
+        Serial.printf("TTS %s: %lu frames in %lu ms, %lu i2s_write calls, output %lu us, %lu.%lu%% CPU\n",
+                      filename, (unsigned long)frames, (unsigned long)(millis() - start),
+                      (unsigned long)(writes - writes0), (unsigned long)(us - us0),
+                      (unsigned long)(audio_ms ? (us - us0) / (audio_ms * 10) : 0),
+                      (unsigned long)(audio_ms ? (us - us0) / audio_ms % 10 : 0));
+    }
+    clip_cache_decoder_give();
+    audio_mixer_stream_close(ttsStream);
+    ttsStream = -1;
+}
+
+// Each block Audio decodes goes to the mixer instead of the I2S port
+void audio_process_block(int16_t *buff, uint16_t frames, bool *continueI2S)
+{
+    audio_mixer_stream_write(ttsStream, buff, frames, audio.getSampleRate(), portMAX_DELAY);
+    *continueI2S = false;
 }
 
 void setupAmpI2S(i2s_port_t  i2s_ch)
 {
     audio.setPinout(BOARD_I2S_BCK, BOARD_I2S_WS, BOARD_I2S_DOUT);
     audio.setVolume(21);
+
+    // The mixer takes the port over with a short DMA ring, Audio hands its
+    // blocks to it through audio_process_block()
+    audio.setI2SOutput(false);
+    i2s_pin_config_t pins = {0};
+    pins.mck_io_num = I2S_PIN_NO_CHANGE;
+    pins.bck_io_num = BOARD_I2S_BCK;
+    pins.ws_io_num = BOARD_I2S_WS;
+    pins.data_out_num = BOARD_I2S_DOUT;
+    pins.data_in_num = I2S_PIN_NO_CHANGE;
+    audio_mixer_output(i2s_ch, &pins);
 }
 
 void setTx()
@@ -887,15 +1036,124 @@ void setSenderInterval(uint32_t interval_ms)
 void soundPlay()
 {
     if (playHandle) {
-        vTaskResume(playHandle);
+        xTaskNotifyGive(playHandle);
+    }
+}
+
+static bool probeSD()
+{
+    bool ok = false;
+    // The display keeps flushing the splash on the same bus
+    if (xSemaphoreTake(xSemaphore, portMAX_DELAY) == pdTRUE) {
+        ok = setupSD();
+        xSemaphoreGive(xSemaphore);
+    }
+    if (ok) {
+        journal_begin(SD);
+        // Tiles are read by their own task, a chunk at a time under the SPI mutex
+        if (map_tiles_begin(&SD, xSemaphore, true)) {
+            map_nodes_load(&SD);
+        }
     }
+    return ok;
+}
+
+static bool probeAudio()
+{
+    bool ok = setupCoder();
+    setupAmpI2S(SPK_I2S_PORT);
+    setupMicrophoneI2S(MIC_I2S_PORT);
+    return ok;
+}
+
+static bool probeWiFi()
+{
+    setupWiFi();
+    return true;
+}
+
+static bool probeGPS()
+{
+    gps_protocol_t protocol = GPS_PROTOCOL_NMEA;
+    bool found = setupGPS();
+    if (found) {
+        // Time to first fix is still measured, the L76K is not given aiding
+        gps_assist_start(GPS_ASSIST_MODEL_L76K, protocol);
+    } else {
+        SerialGPS.begin(38400, SERIAL_8N1, BOARD_GPS_RX_PIN, BOARD_GPS_TX_PIN);
+        uint32_t baudrate[] = {38400, 115200, 9600};
+        // Restore factory settings
+        for (int i = 0; i < 3; ++i) {
+            Serial.printf("Use baudrate : %u\n", baudrate[i]);
+            if (GPS_Recovery()) {
+                Serial.println("UBlox-M10Q GNSS init succeeded, using UBlox-M10Q GNSS Module\n");
+                gps_model = "UBlox-M10";
+                found = true;
+                if (GPS_EnablePVT()) {
+                    protocol = GPS_PROTOCOL_UBX;
+                }
+                gps_assist_start(GPS_ASSIST_MODEL_M10, protocol);
+                GPS_InjectAssist();
+                break;
+            }
+            Serial.printf("Update baudrate : %u\n", baudrate[i]);
+            SerialGPS.updateBaudRate(baudrate[i]);
+        }
+    }
+
+    // Record GPS start time
+    gps_start_ms = millis();
+
+    gps_task_set_ubx_hook(gps_assist_ubx_frame);
+    if (!gps_task_begin(&SerialGPS, &gps, protocol)) {
+        Serial.println("GPS task create failed");
+    }
+    return found;
+}
+
+// Independent peripherals brought up in parallel behind the splash screen.
+// The GPS probe can take seconds across baud rates and finishes in the background.
+static const boot_probe_t boot_probes[] = {
+    {"sd",    probeSD,    4 * 1024, true},
+    {"audio", probeAudio, 4 * 1024, true},
+    {"wifi",  probeWiFi,  4 * 1024, true},
+    {"gps",   probeGPS,   4 * 1024, false},
+};
+
+static fs::FS *flashFs = nullptr;       // SPIFFS once mounted
+
+// Users of the SD card and the speaker, once their probes have finished.
+// Runs from setup() or, when a probe was still running after
+// BOOT_PROBE_TIMEOUT_MS, from loop().
+static void startAfterProbes()
+{
+    static bool started = false;
+    if (started || !boot_probes_ready()) {
+        return;
+    }
+    started = true;
+
+    // Clips are looked up on the mounted card first, only on flash without one
+    clip_cache_begin(boot_probe_ok(BOOT_PROBE_SD) ? &SD : NULL, xSemaphore, flashFs, true);
+
+    // Evidence recordings of the first microphone, on the card
+    if (boot_probe_ok(BOOT_PROBE_SD) && boot_probe_ok(BOOT_PROBE_AUDIO)) {
+        audio_recorder_begin(&SD, xSemaphore, MIC_I2S_SAMPLE_RATE, 0, true);
+    }
+
+    xTaskCreate(taskPlaySong, "play", 1024 * 4, NULL, 10, &playHandle);
+    soundPlay();
 }
 
 void setup()
 {
+    uint32_t phase = boot_phase_begin("serial");
     Serial.begin(115200);
 
     Serial.println("T-DECK factory");
+    boot_phase_end(phase, true);
+
+    phase = boot_phase_begin("power+display");
 
     //! The board peripheral power control pin needs to be set to HIGH when using the peripheral
     pinMode(BOARD_POWERON, OUTPUT);
@@ -913,11 +1171,13 @@ void setup()
     pinMode(BOARD_SPI_MISO, INPUT_PULLUP);
     SPI.begin(BOARD_SPI_SCK, BOARD_SPI_MISO, BOARD_SPI_MOSI); //SD
 
-    pinMode(BOARD_BOOT_PIN, INPUT_PULLUP);
-    pinMode(BOARD_TBOX_G02, INPUT_PULLUP);
-    pinMode(BOARD_TBOX_G01, INPUT_PULLUP);
-    pinMode(BOARD_TBOX_G04, INPUT_PULLUP);
-    pinMode(BOARD_TBOX_G03, INPUT_PULLUP);
+    // Trackball pulses and clicks are queued from interrupts, mouse_read() drains them
+    static const uint8_t trackball_pins[4] = {BOARD_TBOX_G02,   // Right
+                                              BOARD_TBOX_G01,   // Up
+                                              BOARD_TBOX_G04,   // Left
+                                              BOARD_TBOX_G03    // Down
+                                             };
+    input_events_begin_trackball(trackball_pins, BOARD_BOOT_PIN);
 
     //Add mutex to allow multitasking access
     xSemaphore = xSemaphoreCreateBinary();
@@ -949,7 +1209,9 @@ void setup()
 
     tft.setRotation( 1 );
     tft.fillScreen(TFT_BLACK);
+    boot_phase_end(phase, true);
 
+    phase = boot_phase_begin("touch+kb");
     Wire.begin(BOARD_I2C_SDA, BOARD_I2C_SCL);
 
     touch.setPins(-1, BOARD_TOUCH_INT);
@@ -966,18 +1228,31 @@ void setup()
         // Set mirror xy
         touch.setMirrorXY(false, true);
 
+        // Reports are read only after the INT edge that announces them,
+        // the level query modes give no edge per report
+        uint8_t irq_mode = touch.getInterruptMode();
+        if (irq_mode > 1) {
+            touch.setInterruptMode(FALLING);
+            irq_mode = 1;
+        }
+        input_events_begin_touch(BOARD_TOUCH_INT, irq_mode == 0 ? RISING : FALLING);
+
     } else {
         Serial.println("Failed to find GT911 - check your wiring!");
     }
 
     kbDetected = checkKb();
+    if (kbDetected) {
+        keyboard_begin(&Wire, BOARD_KEYBOARD_INT);
+    }
+    boot_phase_end(phase, touchDetected && kbDetected);
 
 
     pinMode(BOARD_BL_PIN, OUTPUT);
-    setBrightness(16);
-
+    setBrightness(0);
 
 
+    phase = boot_phase_begin("lvgl+splash");
     setupLvgl();
 
     // Disable scrollbars on the main screen to remove scroll indicators
@@ -1031,31 +1306,65 @@ void setup()
     lv_obj_set_style_text_font(info_label, &lv_font_montserrat_12, LV_PART_MAIN);   // Small font
     lv_obj_set_style_text_align(info_label, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
     lv_obj_align(info_label, LV_ALIGN_TOP_MID, 0, 45);  // Position below developer credit
+    lv_timer_handler();
+    boot_phase_end(phase, true);
+
+    phase = boot_phase_begin("registry");
+    flashFs = SPIFFS.begin() ? &SPIFFS : nullptr;
+    node_registry_begin(flashFs);
+    gps_assist_begin(flashFs);
+    supervision_begin();
+    alarm_pipeline_begin();
+    // Decoded by the clip loader task once it starts, well before an alarm
+    static int siren_clip = clip_cache_add_siren("siren", 650, 1300, 1000, 3000, 12000);
+    static int hello_clip = clip_cache_add("hello.mp3", "/hello.mp3", true);
+    clickClip = clip_cache_add_siren("click", 2000, 2000, 100, 12, 8000);
+    audio_mixer_begin(true);
+    alarm_pipeline_set_sink(ALARM_SINK_SIREN, [](const alarm_event_t *event) {
+        // Lock free, never blocks the dispatch task; the prompt ducks the siren
+        bool queued = audio_mixer_play(siren_clip, MIXER_GAIN_UNITY, MIXER_PRIO_SIREN, false);
+        queued &= audio_mixer_play(hello_clip, MIXER_GAIN_UNITY, MIXER_PRIO_VOICE, false);
+        if (!queued) {
+            soundPlay();
+        }
+    });
+    acoustic_events_set_sink([](const acoustic_event_t *event) {
+        // Telemetry only: the prototypes are scored on synthetic sounds, not
+        // yet on recordings from a panel. Map glass to intrusion and impact
+        // to tamper once recorded sets pass test_acoustic_replay.
+        char text[ALARM_TEXT_MAX];
+        snprintf(text, sizeof(text), "%s %u%%", acoustic_class_name(event->cls), event->confidence);
+        alarm_pipeline_submit_local(ALARM_CLASS_TELEMETRY, ALARM_SRC_ACOUSTIC, text);
+        if (event->cls == ACOUSTIC_GLASS || event->cls == ACOUSTIC_IMPACT) {
+            audio_recorder_trigger();
+        }
+    });
+    boot_phase_end(phase, true);
 
-    // Show logo and info with fade-in effect
-    for (int i = 0; i <= 16; ++i) {
-        setBrightness(i);
-        lv_timer_handler();
-        delay(30);
-    }
-
-    // Keep the splash screen visible for 3 seconds
-    delay(3000);
-
-    // Process any pending LVGL tasks before transitioning
-    lv_task_handler();
-
-    SPIFFS.begin();
-
-    setupSD();
-
-    setupRadio();
-
-    setupCoder();
+    // Re-initializes the SPI bus, must run before the SD probe shares it
+    phase = boot_phase_begin("radio");
+    boot_phase_end(phase, setupRadio());
 
-    setupAmpI2S(SPK_I2S_PORT);
+    boot_probes_start(boot_probes, sizeof(boot_probes) / sizeof(boot_probes[0]));
 
-    setupMicrophoneI2S(MIC_I2S_PORT);
+    // Fade the splash in while the probes run, instead of a fixed 3 s delay
+    phase = boot_phase_begin("splash");
+    uint32_t splash_start = millis();
+    uint32_t splash_elapsed;
+    uint8_t splash_level = 0;
+    do {
+        splash_elapsed = millis() - splash_start;
+        uint8_t level = min<uint32_t>(16, splash_elapsed / BOOT_FADE_STEP_MS);
+        if (level != splash_level) {
+            setBrightness(level);
+            splash_level = level;
+        }
+        lv_timer_handler();
+        delay(5);
+    } while (splash_elapsed < BOOT_SPLASH_MIN_MS ||
+             (!boot_probes_ready() && splash_elapsed < BOOT_PROBE_TIMEOUT_MS));
+    setBrightness(16);
+    boot_phase_end(phase, boot_probes_ready());
 
     // Test screen
 #ifdef ENABLE_TEST_IMG
@@ -1120,27 +1429,6 @@ void setup()
     lv_obj_set_scrollbar_mode(main_count, LV_SCROLLBAR_MODE_OFF);
 #endif
 
-    setupWiFi();
-
-    if (!setupGPS()) {
-        SerialGPS.begin(38400, SERIAL_8N1, BOARD_GPS_RX_PIN, BOARD_GPS_TX_PIN);
-        uint32_t baudrate[] = {38400, 115200, 9600};
-        // Restore factory settings
-        for (int i = 0; i < 3; ++i) {
-            Serial.printf("Use baudrate : %u\n", baudrate[i]);
-            if (GPS_Recovery()) {
-                Serial.println("UBlox-M10Q GNSS init succeeded, using UBlox-M10Q GNSS Module\n");
-                gps_model = "UBlox-M10";
-                break;
-            }
-            Serial.printf("Update baudrate : %u\n", baudrate[i]);
-            SerialGPS.updateBaudRate(baudrate[i]);
-        }
-    }
-
-    // Record GPS start time
-    gps_start_ms = millis();
-
     // Clean up splash screen before showing main UI
     lv_obj_del(logo_img);
     lv_obj_del(info_panel);
@@ -1148,6 +1436,7 @@ void setup()
     // Clear the screen to ensure clean transition
     lv_obj_clean(lv_scr_act());
 
+    phase = boot_phase_begin("ui");
     setupUI();
 
     // Create professional arrow cursor using built-in LVGL symbol
@@ -1166,22 +1455,36 @@ void setup()
         lv_task_handler();
         delay(5);
     }
+    boot_phase_end(phase, true);
 
-    xTaskCreate(taskPlaySong, "play", 1024 * 4, NULL, 10, &playHandle);
-    soundPlay();
+    // Left to loop() when a required probe outlasted the splash
+    startAfterProbes();
+
+    boot_profile_ready();
+    boot_profile_dump();
 }
 
 void loop()
 {
     if (enterSleep) {
 
-        vTaskDelete(playHandle);
-        playHandle = NULL;
+        stopPlayTask();
+        audio_mixer_stop_all();
 
 #ifdef USE_ESP_VAD
         vTaskDelete(vadTaskHandler);
         vadTaskHandler = NULL;
 #endif
+        // Close the recording under way with what has been captured
+        audio_recorder_finish();
+        for (int i = 0; i < 20 && audio_recorder_active(); i++) {
+            delay(REC_POLL_MS);
+        }
+        mic_capture_stop();
+
+        // Commit buffered events before the card loses power
+        journal_end();
+        node_registry_save();
 
         //LilyGo T-Deck control backlight chip has 16 levels of adjustment range
         for (int i = 16; i > 0; --i) {
@@ -1195,6 +1498,7 @@ void loop()
         // gpio_hold_en((gpio_num_t)BOARD_POWERON);
         // gpio_deep_sleep_hold_en();
 
+        input_events_end();
         touch.sleep();        //set touchpad enter sleep mode
         tft.writecommand(0x10);      //set display enter sleep mode
         SPI.end();
@@ -1206,6 +1510,20 @@ void loop()
 
     loopRadio();
     loopGPS();
+    startAfterProbes();
+
+    // Persist changed node registry pages, only dirty 256 byte pages are rewritten
+    static uint32_t last_registry_save = 0;
+    if (millis() - last_registry_save > NODE_REGISTRY_SAVE_INTERVAL_MS) {
+        last_registry_save = millis();
+        node_registry_save();
+#ifdef ALARM_PIPELINE_STATS
+        alarm_pipeline_print_stats();
+#endif
+#ifdef UI_PERF_STATS
+        ui_perf_print_stats();
+#endif
+    }
     
     // Optimize for scroll smoothness: process LVGL more frequently with minimal delay
     lv_task_handler();
@@ -1233,176 +1551,118 @@ static void disp_flush( lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *
     }
 }
 
+/*Will be called by the library to read the trackball. Moves are summed up,
+  a click ends the read so LVGL sees every press and release in order*/
 static void mouse_read(lv_indev_drv_t *indev, lv_indev_data_t *data)
 {
     static int16_t last_x = 160; // Start in center
     static int16_t last_y = 120; // Start in center
-    static uint32_t last_read_time = 0;
-    static bool last_dir[5] = {false, false, false, false, false};
-    static uint32_t last_change_time[5] = {0, 0, 0, 0, 0};
-    
-    bool left_button_down = false;
-    uint32_t current_time = millis();
-    
-    // Debounce timing - reduce from default to make more responsive
-    const uint32_t debounce_delay = 20; // 20ms debounce instead of default
-    
-    // Skip reading if called too frequently to prevent lag
-    if (current_time - last_read_time < 3) { // Reduced from 5ms to 3ms for ultra-responsive scrolling
-        data->point.x = last_x;
-        data->point.y = last_y;
-        data->state = left_button_down ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
-        return;
-    }
-    last_read_time = current_time;
-    
-    const uint8_t dir_pins[5] = {BOARD_TBOX_G02,
-                                 BOARD_TBOX_G01,
-                                 BOARD_TBOX_G04,
-                                 BOARD_TBOX_G03,
-                                 BOARD_BOOT_PIN
-                                };
-    
-    // Increased movement speed for more responsive feel
-    uint8_t pos = 15; // Increased from 10 to 15 for faster movement
-    
-    for (int i = 0; i < 5; i++) {
-        bool dir = digitalRead(dir_pins[i]);
-        
-        // Only process if state changed and debounce time has passed
-        if (dir != last_dir[i] && (current_time - last_change_time[i]) > debounce_delay) {
-            last_dir[i] = dir;
-            last_change_time[i] = current_time;
-            
-            // Only move on button press, not release for cleaner movement
-            if (dir == LOW) { // Button pressed (assuming active low)
-                switch (i) {
-                case 0: // Right
-                    {
-                        int16_t new_x = last_x + pos;
-                        int16_t max_x = lv_disp_get_hor_res(NULL) - 20;
-                        last_x = (new_x < max_x) ? new_x : max_x;
-                    }
-                    break;
-                case 1: // Up
-                    {
-                        int16_t new_y = last_y - pos;
-                        last_y = (new_y > 20) ? new_y : 20;
-                    }
-                    break;
-                case 2: // Left
-                    {
-                        int16_t new_x = last_x - pos;
-                        last_x = (new_x > 20) ? new_x : 20;
-                    }
-                    break;
-                case 3: // Down
-                    {
-                        int16_t new_y = last_y + pos;
-                        int16_t max_y = lv_disp_get_ver_res(NULL) - 20;
-                        last_y = (new_y < max_y) ? new_y : max_y;
-                    }
-                    break;
-                case 4: // Click
-                    left_button_down = true;
-                    break;
-                default:
-                    break;
-                }
-            }
-        } else if (i == 4 && dir == LOW) {
-            // Keep button pressed if still held down
-            left_button_down = true;
+    static bool left_button_down = false;
+    static uint32_t last_pulse_us[4] = {0, 0, 0, 0};
+
+    // Right, up, left, down
+    static const int8_t move_dx[4] = {1, 0, -1, 0};
+    static const int8_t move_dy[4] = {0, -1, 0, 1};
+
+    input_events_sync();
+    input_event_t event;
+    while (input_events_next(INPUT_QUEUE_TRACKBALL, &event)) {
+        if (event.type == INPUT_EV_BUTTON_DOWN || event.type == INPUT_EV_BUTTON_UP) {
+            left_button_down = event.type == INPUT_EV_BUTTON_DOWN;
+            data->continue_reading = input_events_pending(INPUT_QUEUE_TRACKBALL) > 0;
+            break;
+        }
+        uint8_t dir = event.type - INPUT_EV_RIGHT;
+        int16_t step = input_trackball_step(event.at_us - last_pulse_us[dir]);
+        last_pulse_us[dir] = event.at_us;
+
+        // The map page takes the rolls as panning, the cursor stays put
+        if (ui_map_pan(move_dx[dir] * UI_MAP_TRACKBALL_STEP, move_dy[dir] * UI_MAP_TRACKBALL_STEP)) {
+            continue;
         }
+        last_x = constrain(last_x + move_dx[dir] * step, 20, lv_disp_get_hor_res(NULL) - 20);
+        last_y = constrain(last_y + move_dy[dir] * step, 20, lv_disp_get_ver_res(NULL) - 20);
     }
-    
-    // Serial.printf("indev:X:%04d  Y:%04d \n", last_x, last_y);
+
     /*Store the collected data*/
     data->point.x = last_x;
     data->point.y = last_y;
     data->state = left_button_down ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
 }
 
-/*Read the touchpad*/
+/*Read the touchpad, over I2C only when the GT911 has signalled a report*/
 static void touchpad_read( lv_indev_drv_t *indev_driver, lv_indev_data_t *data )
 {
     static int16_t x[5], y[5];
-    static uint32_t last_touch_time = 0;
-    static bool was_pressed = false;
-    uint32_t current_time = millis();
-    
+    static bool pressed = false;
+    static uint32_t last_report_us = 0;
+
+    // Reports that piled up since the last read all give way to the newest
+    bool report = false;
+    input_event_t event;
+    while (input_events_next(INPUT_QUEUE_TOUCH, &event)) {
+        report = true;
+        last_report_us = event.at_us;
+    }
+    if (report) {
+        pressed = touch.getPoint(x, y, 1) > 0;
+    } else if (pressed && micros() - last_report_us > INPUT_TOUCH_HOLD_US) {
+        // The GT911 reports every 10 ms while touched, the lift report was missed
+        pressed = false;
+    }
+
     data->state = LV_INDEV_STATE_REL;
-    
+    data->point.x = x[0];
+    data->point.y = y[0];
+
     // Check if touch input should be isolated during screen transitions
     if (is_touch_isolated()) {
         // During isolation period, only allow touch release
-        if (!touch.isPressed()) {
+        if (!pressed) {
             touch_state_isolated = false; // Reset isolation when touch is released
         }
         return; // Block all touch input during isolation
     }
-    
-    // Optimize touch reading for smoother scrolling
-    if (touch.isPressed()) {
-        uint8_t touched = touch.getPoint(x, y, 1);
-        if (touched > 0) {
-            data->state = LV_INDEV_STATE_PR;
-            data->point.x = x[0];
-            data->point.y = y[0];
-            last_touch_time = current_time;
-            was_pressed = true;
-        }
-    } else {
-        was_pressed = false;
-    }
-    
-    // Add small hysteresis for more stable touch detection during scrolling
-    if (current_time - last_touch_time < 10 && was_pressed) { // 10ms hysteresis
-        // Keep last valid position for smoother scrolling transitions
-        if (data->state == LV_INDEV_STATE_REL) {
-            data->point.x = x[0];
-            data->point.y = y[0];
-        }
+    if (pressed) {
+        data->state = LV_INDEV_STATE_PR;
     }
 }
 
-// Read key value from esp32c3
-static uint32_t keypad_get_key(void)
+/*Will be called by the library to read the keyboard. One event per call,
+  LVGL calls again straight away while more are queued*/
+static void keypad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data)
 {
+    static uint32_t last_key = 0;
     static uint32_t retry = 0;
-    char key_ch = 0;
-    if (retry > 10) {
-        lv_indev_delete(kb_indev);
-        kb_indev = NULL;
-        return 0;
-    }
-    Wire.beginTransmission(0x55);
-    if (Wire.endTransmission() != 0) {
-        Serial.println("Keyboard Failed!");
-        retry++;
-        return 0;
-    }
-    Wire.requestFrom(0x55, 1);
-    while (Wire.available() > 0) {
-        key_ch = Wire.read();
+    if (keyboard_service() < 0) {
+        if (++retry > 10) {
+            Serial.println("Keyboard Failed!");
+            lv_indev_delete(kb_indev);
+            kb_indev = NULL;
+        }
+    } else {
         retry = 0;
     }
-    return key_ch;
-}
 
-/*Will be called by the library to read the mouse*/
-static void keypad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data)
-{
-    static uint32_t last_key = 0;
-    uint32_t act_key ;
-    act_key = keypad_get_key();
-    if (act_key != 0) {
-        data->state = LV_INDEV_STATE_PR;
-        Serial.printf("Key pressed : 0x%x\n", act_key);
-        last_key = act_key;
-    } else {
-        data->state = LV_INDEV_STATE_REL;
+    kb_event_t event;
+    while (keyboard_next(&event)) {
+        // Modifiers come in as events too, LVGL only wants characters
+        if (!event.ch) {
+            continue;
+        }
+        if (event.flags & KB_EVT_PRESSED) {
+            data->state = LV_INDEV_STATE_PR;
+            audio_mixer_play(clickClip, MIXER_GAIN_UNITY / 2, MIXER_PRIO_CLICK, false);
+            Serial.printf("Key pressed : 0x%x\n", event.ch);
+        } else {
+            data->state = LV_INDEV_STATE_REL;
+        }
+        last_key = event.ch;
+        data->key = last_key;
+        data->continue_reading = keyboard_pending() > 0;
+        return;
     }
+    data->state = LV_INDEV_STATE_REL;
     data->key = last_key;
 }
 
@@ -1436,6 +1696,8 @@ static void setupLvgl()
     disp_drv.flush_cb = disp_flush;
     disp_drv.draw_buf = &draw_buf;
     disp_drv.full_refresh = 1;
+    // Render + flush time of every refresh, printed with UI_PERF_STATS
+    disp_drv.monitor_cb = ui_perf_monitor_cb;
     lv_disp_drv_register( &disp_drv );
 
     /*Initialize the  input device driver*/
@@ -1483,63 +1745,19 @@ uint8_t buffer[256];
 
 int getAck(uint8_t *buffer, uint16_t size, uint8_t requestedClass, uint8_t requestedID)
 {
-    uint16_t    ubxFrameCounter = 0;
-    bool        ubxFrame = 0;
+    // Static, the payload buffer is too large for the probe task stack
+    static ubx_parser_t parser;
     uint32_t    startTime = millis();
-    uint16_t    needRead;
 
+    ubx_parser_init(&parser);
     while (millis() - startTime < 800) {
         while (SerialGPS.available()) {
-            int c = SerialGPS.read();
-            switch (ubxFrameCounter) {
-            case 0:
-                if (c == 0xB5) {
-                    ubxFrameCounter++;
-                }
-                break;
-            case 1:
-                if (c == 0x62) {
-                    ubxFrameCounter++;
-                } else {
-                    ubxFrameCounter = 0;
-                }
-                break;
-            case 2:
-                if (c == requestedClass) {
-                    ubxFrameCounter++;
-                } else {
-                    ubxFrameCounter = 0;
-                }
-                break;
-            case 3:
-                if (c == requestedID) {
-                    ubxFrameCounter++;
-                } else {
-                    ubxFrameCounter = 0;
-                }
-                break;
-            case 4:
-                needRead = c;
-                ubxFrameCounter++;
-                break;
-            case 5:
-                needRead |=  (c << 8);
-                ubxFrameCounter++;
-                break;
-            case 6:
-                if (needRead >= size) {
-                    ubxFrameCounter = 0;
-                    break;
-                }
-                if (SerialGPS.readBytes(buffer, needRead) != needRead) {
-                    ubxFrameCounter = 0;
-                } else {
-                    return needRead;
-                }
-                break;
-
-            default:
-                break;
+            if (!ubx_parser_feed(&parser, SerialGPS.read())) {
+                continue;
+            }
+            if (parser.cls == requestedClass && parser.id == requestedID && parser.len < size) {
+                memcpy(buffer, parser.payload, parser.len);
+                return parser.len;
             }
         }
     }
@@ -1576,6 +1794,49 @@ static bool GPS_Recovery()
     return true;
 }
 
+// Switch the M10 to binary NAV-PVT only. The rate follows the baud rate the
+// recovery settled on, 10 Hz of 100 byte frames needs more than 9600 baud.
+static bool GPS_EnablePVT()
+{
+    uint16_t meas_ms = SerialGPS.baudRate() >= UBX_PVT_FAST_MIN_BAUD ? UBX_PVT_FAST_MS : UBX_PVT_SLOW_MS;
+    uint8_t cfg_pvt[64];
+    size_t len = ubx_cfg_pvt_only(cfg_pvt, sizeof(cfg_pvt), meas_ms);
+
+    SerialGPS.write(cfg_pvt, len);
+    if (getAck(buffer, 256, UBX_CLASS_ACK, UBX_ACK_ACK) == 2 &&
+            buffer[0] == UBX_CLASS_CFG && buffer[1] == UBX_CFG_VALSET) {
+        Serial.printf("UBlox-M10 NAV-PVT at %u Hz\n", 1000 / meas_ms);
+        return true;
+    }
+    Serial.println("UBlox-M10 NAV-PVT not acknowledged, keep NMEA");
+    return false;
+}
+
+// Hand the saved position, the clock and the navigation database back to
+// the M10. It has no flow control on its UART, database frames are paced.
+static void GPS_InjectAssist()
+{
+    uint8_t ini[64];
+    size_t len = gps_assist_mga_ini(ini, sizeof(ini), time(NULL));
+    if (len) {
+        SerialGPS.write(ini, len);
+    }
+
+    uint8_t *db = (uint8_t *)ps_malloc(GPS_ASSIST_DB_MAX);
+    if (!db) {
+        return;
+    }
+    size_t db_len = gps_assist_db_load(db, GPS_ASSIST_DB_MAX);
+    for (size_t pos = 0; pos < db_len;) {
+        size_t frame = UBX_FRAME_OVERHEAD + (db[pos + 4] | (db[pos + 5] << 8));
+        SerialGPS.write(db + pos, frame);
+        pos += frame;
+        delay(GPS_ASSIST_DB_PACE_MS);
+    }
+    free(db);
+    Serial.printf("GPS assist: given 0x%02x, %u database bytes\n", gps_assist_given(), (unsigned)db_len);
+}
+
 
 #define LILYGO_KB_BRIGHTNESS_CMD            0x01
 #define LILYGO_KB_ALT_B_BRIGHTNESS_CMD      0x02
@@ -1587,10 +1848,16 @@ void setKeyboardBrightness(uint8_t level)
     if (!kbDetected) {
         return ;
     }
-    Wire.beginTransmission(0x55);
-    Wire.write(LILYGO_KB_BRIGHTNESS_CMD);
-    Wire.write(level);
-    Wire.endTransmission();
+    // An idle keyboard light sleeps and misses the transaction that wakes it
+    for (int retry = 0; retry < 2; retry++) {
+        Wire.beginTransmission(0x55);
+        Wire.write(LILYGO_KB_BRIGHTNESS_CMD);
+        Wire.write(level);
+        if (Wire.endTransmission() == 0) {
+            break;
+        }
+        delay(2);
+    }
 }
 
 // Touch state isolation functions to prevent cross-menu button activation
@@ -0,0 +1,323 @@
+/**
+ * @file      acoustic_events.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "acoustic_events.h"
+#include "dsp_fft.h"
+#include <math.h>
+
+#define ACOUSTIC_BINS           (ACOUSTIC_FFT_SIZE / 2 + 1)
+#define ACOUSTIC_SILENCE_DB     (-100 * 256)
+
+static_assert(ACOUSTIC_FFT_SIZE <= DSP_FFT_SIZE_MAX, "ACOUSTIC_FFT_SIZE above the shared FFT table");
+
+typedef struct {
+    int16_t mean[ACOUSTIC_FEATURES];
+    int16_t spread[ACOUSTIC_FEATURES];              // Typical deviation from the mean
+} acoustic_prototype_t;
+
+// Means from the synthetic set in test_acoustic_events.cpp. Spreads are a
+// little wider than the set's own where real rooms vary more (level,
+// length) and tight where the classes and the sounds to reject differ
+// most (onset, high band share, decay).
+static const acoustic_prototype_t prototypes[ACOUSTIC_CLASS_MAX] = {
+    // level onset centroid high  zcr  decay length speech
+    {{    0,    0,    0,    0,    0,    0,    0,    0 },           // ACOUSTIC_NONE, unused
+     {    1,    1,    1,    1,    1,    1,    1,    1 }},
+    {{  580,  570, 4800,  230,  590,  590,  910,   10 },           // ACOUSTIC_GLASS
+     {  200,  100,  700,   40,   80,  150,  250,   40 }},
+    {{  630,  620,  250,    1,  130,  135,  260,    5 },           // ACOUSTIC_IMPACT
+     {  200,  100,  150,   20,   50,   50,  100,   40 }},
+    {{  520,  300, 1000,    3,  250,  130,  575,  130 },           // ACOUSTIC_VOICE
+     {  200,  120,  300,   30,   60,   80,  350,   40 }},
+};
+
+static const char *const class_names[ACOUSTIC_CLASS_MAX] = { "None", "Glass break", "Impact", "Voice" };
+
+// Open event, summed frame by frame
+typedef struct {
+    bool     open;
+    uint16_t frames;
+    uint8_t  quiet;                                 // Frames in a row under the end level
+    int16_t  peak_db;
+    uint16_t peak_frame;
+    int16_t  decay_frame;                           // -1 until the level falls off the peak
+    int16_t  onset_db;
+    uint32_t zero_crossings;
+    uint32_t samples;
+    uint16_t speech;
+    float    power;
+    float    power_hz;
+    float    power_high;
+    uint32_t at_ms;
+} acoustic_accum_t;
+
+static uint32_t          rate = 16000;
+static float             window[ACOUSTIC_FRAME_MAX];
+static size_t            window_len = 0;
+static float             window_power;              // Sum of the squared window
+static float             fft_buf[2 * ACOUSTIC_FFT_SIZE];
+static uint8_t           bin_segment[ACOUSTIC_BINS]; // Mel segment of the bin, 0xFF outside
+static float             bin_weight[ACOUSTIC_BINS];  // Towards the upper band of the segment
+static float             band_hz[ACOUSTIC_BANDS];
+static float             band_power[ACOUSTIC_BANDS]; // Of the last frame, linear
+
+static acoustic_frame_t  frame;
+static acoustic_accum_t  accum;
+static int16_t           floor_db;
+static int16_t           last_db;
+static bool              floor_set = false;
+static acoustic_sink_t   sink = NULL;
+static acoustic_stats_t  stats;
+
+static float mel(float hz)
+{
+    return 2595.0f * log10f(1.0f + hz / 700.0f);
+}
+
+static float mel_hz(float m)
+{
+    return 700.0f * (powf(10.0f, m / 2595.0f) - 1.0f);
+}
+
+static inline int16_t to_db(float power)
+{
+    if (power <= 1e-10f) {
+        return ACOUSTIC_SILENCE_DB;
+    }
+    float db = 10.0f * log10f(power) * 256.0f;
+    return (int16_t)constrain(lroundf(db), (long)ACOUSTIC_SILENCE_DB, 32767L);
+}
+
+bool acoustic_events_begin(uint32_t sample_rate)
+{
+    if (sample_rate < 8000) {
+        return false;
+    }
+    rate = sample_rate;
+    if (!dsp_fft_init()) {
+        return false;
+    }
+
+    // Triangular bands on ACOUSTIC_BANDS + 2 points even in mel. A bin in
+    // segment s rises into band s and falls out of band s - 1.
+    float lo = mel(ACOUSTIC_BAND_LO_HZ), hi = mel(rate / 2.0f);
+    float points[ACOUSTIC_BANDS + 2];
+    for (int p = 0; p < ACOUSTIC_BANDS + 2; p++) {
+        points[p] = lo + (hi - lo) * p / (ACOUSTIC_BANDS + 1);
+    }
+    for (int b = 0; b < ACOUSTIC_BANDS; b++) {
+        band_hz[b] = mel_hz(points[b + 1]);
+    }
+    for (int k = 0; k < ACOUSTIC_BINS; k++) {
+        float m = mel((float)k * rate / ACOUSTIC_FFT_SIZE);
+        bin_segment[k] = 0xFF;
+        for (int s = 0; s <= ACOUSTIC_BANDS; s++) {
+            if (m >= points[s] && m < points[s + 1]) {
+                bin_segment[k] = s;
+                bin_weight[k] = (m - points[s]) / (points[s + 1] - points[s]);
+                break;
+            }
+        }
+    }
+
+    window_len = 0;
+    floor_set = false;
+    memset(&accum, 0, sizeof(accum));
+    memset(&stats, 0, sizeof(stats));
+    return true;
+}
+
+void acoustic_events_set_sink(acoustic_sink_t cb)
+{
+    sink = cb;
+}
+
+void acoustic_frame_features(const int16_t *samples, size_t count, acoustic_frame_t *out)
+{
+    if (count > ACOUSTIC_FRAME_MAX) {
+        count = ACOUSTIC_FRAME_MAX;
+    }
+    if (count != window_len) {
+        window_power = 0;
+        for (size_t n = 0; n < count; n++) {
+            window[n] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * n / count);
+            window_power += window[n] * window[n];
+        }
+        window_len = count;
+    }
+
+    int64_t square = 0;
+    uint16_t crossings = 0;
+    for (size_t n = 0; n < count; n++) {
+        square += (int32_t)samples[n] * samples[n];
+        crossings += n && (samples[n] < 0) != (samples[n - 1] < 0);
+        fft_buf[2 * n] = samples[n] * window[n];
+        fft_buf[2 * n + 1] = 0.0f;
+    }
+    memset(&fft_buf[2 * count], 0, (ACOUSTIC_FFT_SIZE - count) * 2 * sizeof(float));
+    out->energy_db = to_db(count ? (float)square / count / (32768.0f * 32768.0f) : 0.0f);
+    out->zero_crossings = crossings;
+
+    dsp_fft(fft_buf, ACOUSTIC_FFT_SIZE);
+    memset(band_power, 0, sizeof(band_power));
+    for (int k = 0; k < ACOUSTIC_BINS; k++) {
+        uint8_t s = bin_segment[k];
+        if (s == 0xFF) {
+            continue;
+        }
+        float p = fft_buf[2 * k] * fft_buf[2 * k] + fft_buf[2 * k + 1] * fft_buf[2 * k + 1];
+        if (s < ACOUSTIC_BANDS) {
+            band_power[s] += p * bin_weight[k];
+        }
+        if (s > 0) {
+            band_power[s - 1] += p * (1.0f - bin_weight[k]);
+        }
+    }
+    // Scaled so the bands add up to the frame's mean square (Parseval,
+    // half the spectrum, corrected for the window)
+    float scale = 2.0f / (32768.0f * 32768.0f * ACOUSTIC_FFT_SIZE * (window_power > 0 ? window_power : 1.0f));
+    for (int b = 0; b < ACOUSTIC_BANDS; b++) {
+        band_power[b] *= scale;
+        out->bands[b] = to_db(band_power[b]);
+    }
+}
+
+static int16_t clamp16(int32_t v)
+{
+    return (int16_t)constrain(v, -32768L, 32767L);
+}
+
+acoustic_class_t acoustic_classify(const int16_t *features, uint8_t *confidence)
+{
+    // Squared distance in sixteenths of each feature's spread
+    uint32_t best = UINT32_MAX, second = UINT32_MAX;
+    acoustic_class_t cls = ACOUSTIC_NONE;
+    for (int c = ACOUSTIC_NONE + 1; c < ACOUSTIC_CLASS_MAX; c++) {
+        const acoustic_prototype_t *p = &prototypes[c];
+        uint32_t distance = 0;
+        for (int f = 0; f < ACOUSTIC_FEATURES; f++) {
+            int32_t d = ((int32_t)features[f] - p->mean[f]) * 16 / p->spread[f];
+            d = constrain(d, -1023L, 1023L);
+            distance += d * d;
+        }
+        if (distance < best) {
+            second = best;
+            best = distance;
+            cls = (acoustic_class_t)c;
+        } else if (distance < second) {
+            second = distance;
+        }
+    }
+    if (confidence) {
+        *confidence = second ? (uint8_t)((uint64_t)(second - best) * 100 / second) : 0;
+    }
+    return best / ACOUSTIC_FEATURES <= ACOUSTIC_ACCEPT ? cls : ACOUSTIC_NONE;
+}
+
+static void close_event(uint32_t frame_ms)
+{
+    acoustic_event_t event;
+    int16_t *f = event.features;
+    uint16_t sounding = accum.frames - accum.quiet;
+    uint16_t decayed = accum.decay_frame >= 0 ? accum.decay_frame : sounding;
+    f[ACOUSTIC_F_LEVEL] = clamp16((accum.peak_db - floor_db) >> 4);
+    f[ACOUSTIC_F_ONSET] = clamp16(accum.onset_db >> 4);
+    f[ACOUSTIC_F_CENTROID] = clamp16(accum.power > 0 ? lroundf(accum.power_hz / accum.power) : 0);
+    f[ACOUSTIC_F_HIGH] = clamp16(accum.power > 0 ? lroundf(256.0f * accum.power_high / accum.power) : 0);
+    f[ACOUSTIC_F_ZCR] = clamp16(accum.samples ? (int32_t)((uint64_t)accum.zero_crossings * 1000 / accum.samples) : 0);
+    f[ACOUSTIC_F_DECAY] = clamp16((decayed - accum.peak_frame) * frame_ms);
+    f[ACOUSTIC_F_LENGTH] = clamp16(sounding * frame_ms);
+    f[ACOUSTIC_F_SPEECH] = clamp16(accum.frames ? accum.speech * 256 / accum.frames : 0);
+    event.cls = acoustic_classify(f, &event.confidence);
+    event.at_ms = accum.at_ms;
+    accum.open = false;
+
+    stats.events++;
+    stats.detected[event.cls]++;
+    if (event.cls != ACOUSTIC_NONE && sink) {
+        sink(&event);
+    }
+}
+
+void acoustic_events_frame(const int16_t *samples, size_t count, bool speech)
+{
+    if (!count) {
+        return;
+    }
+    uint32_t start = micros();
+    acoustic_frame_features(samples, count, &frame);
+    int16_t db = frame.energy_db;
+    uint32_t frame_ms = count * 1000 / rate;
+
+    if (!floor_set) {
+        floor_db = last_db = db;
+        floor_set = true;
+    }
+    if (!accum.open) {
+        if (db > floor_db + ACOUSTIC_ONSET_DB * 256 && db > ACOUSTIC_MIN_DB * 256) {
+            memset(&accum, 0, sizeof(accum));
+            accum.open = true;
+            accum.peak_db = ACOUSTIC_SILENCE_DB;
+            accum.decay_frame = -1;
+            accum.at_ms = millis();
+        } else {
+            // Down quickly, up slowly so a long sound does not raise it much
+            int shift = db < floor_db ? 2 : ACOUSTIC_FLOOR_SHIFT;
+            floor_db += (db - floor_db) >> shift;
+        }
+    }
+
+    if (accum.open) {
+        uint16_t n = accum.frames++;
+        if (n < 3 && db - last_db > accum.onset_db) {
+            accum.onset_db = db - last_db;
+        }
+        if (db > accum.peak_db) {
+            accum.peak_db = db;
+            accum.peak_frame = n;
+            accum.decay_frame = -1;
+        } else if (accum.decay_frame < 0 && db < accum.peak_db - ACOUSTIC_DECAY_DB * 256) {
+            accum.decay_frame = n;
+        }
+        accum.zero_crossings += frame.zero_crossings;
+        accum.samples += count;
+        accum.speech += speech;
+        for (int b = 0; b < ACOUSTIC_BANDS; b++) {
+            accum.power += band_power[b];
+            accum.power_hz += band_power[b] * band_hz[b];
+            if (band_hz[b] >= ACOUSTIC_HIGH_HZ) {
+                accum.power_high += band_power[b];
+            }
+        }
+
+        accum.quiet = db < floor_db + ACOUSTIC_END_DB * 256 ? accum.quiet + 1 : 0;
+        if (accum.quiet >= ACOUSTIC_HANG_FRAMES || accum.frames * frame_ms >= ACOUSTIC_EVENT_MS_MAX) {
+            close_event(frame_ms);
+        }
+    }
+    last_db = db;
+
+    uint32_t spent = micros() - start;
+    stats.frames++;
+    stats.frame_us += spent;
+    if (spent > stats.frame_us_max) {
+        stats.frame_us_max = spent;
+    }
+}
+
+void acoustic_get_stats(acoustic_stats_t *out)
+{
+    *out = stats;
+    out->floor_db = floor_db;
+}
+
+const char *acoustic_class_name(uint8_t cls)
+{
+    return cls < ACOUSTIC_CLASS_MAX ? class_names[cls] : "?";
+}
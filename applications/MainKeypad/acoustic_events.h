@@ -0,0 +1,104 @@
+/**
+ * @file      acoustic_events.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Glass break, impact and voice events from the microphone.
+ *
+ * Runs on the 30 ms frames the VAD task already reads, so it costs no
+ * capture cursor of its own. Every frame gets its energy, zero crossing
+ * count and a mel spectrum of ACOUSTIC_BANDS bands from one 512 point FFT
+ * (esp-dsp on the ESP32-S3). Against a slowly tracked noise floor, frames
+ * rising well above it open an event that lasts while the level stays up,
+ * up to ACOUSTIC_EVENT_MS_MAX.
+ *
+ * A closed event is summed up in ACOUSTIC_FEATURES integers (level and
+ * onset, spectral centroid and high band share, zero crossing rate,
+ * decay, length and the share of frames the VAD called speech) and
+ * classified in fixed point: the nearest class prototype by the distance
+ * scaled per feature, with sounds far from every prototype rejected. The
+ * prototypes are plain tables below; the acoustic test replays labelled
+ * WAV files and reports precision and recall to retune them against.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define ACOUSTIC_FFT_SIZE           512             // A 30 ms frame at 16 kHz, zero padded
+#define ACOUSTIC_FRAME_MAX          ACOUSTIC_FFT_SIZE
+#define ACOUSTIC_BANDS              24              // Mel bands, 100 Hz to half the sample rate
+#define ACOUSTIC_BAND_LO_HZ         100
+#define ACOUSTIC_HIGH_HZ            3000            // Bands centred above count as high
+#define ACOUSTIC_ONSET_DB           12              // Over the noise floor to open an event
+#define ACOUSTIC_END_DB             6               // Under it for ACOUSTIC_HANG_FRAMES closes it
+#define ACOUSTIC_HANG_FRAMES        3
+#define ACOUSTIC_MIN_DB             (-60)           // dBFS, quieter is never an event
+#define ACOUSTIC_DECAY_DB           20              // Below the peak, for the decay time
+#define ACOUSTIC_EVENT_MS_MAX       1500
+#define ACOUSTIC_FLOOR_SHIFT        4               // Floor follows quiet frames over ~0.5 s
+#define ACOUSTIC_ACCEPT             (3 * 3 * 64)    // Mean squared distance to a prototype in
+                                                    // (spread / 16)^2 per feature: 1.5 spreads
+
+typedef enum : uint8_t {
+    ACOUSTIC_NONE = 0,
+    ACOUSTIC_GLASS,
+    ACOUSTIC_IMPACT,
+    ACOUSTIC_VOICE,
+    ACOUSTIC_CLASS_MAX,
+} acoustic_class_t;
+
+enum {
+    ACOUSTIC_F_LEVEL = 0,                           // Peak over the noise floor, dB * 16
+    ACOUSTIC_F_ONSET,                               // Largest rise from one frame to the next, dB * 16
+    ACOUSTIC_F_CENTROID,                            // Hz, energy weighted over the event
+    ACOUSTIC_F_HIGH,                                // Share of energy in the high bands, / 256
+    ACOUSTIC_F_ZCR,                                 // Zero crossings per 1000 samples
+    ACOUSTIC_F_DECAY,                               // ms from the peak to ACOUSTIC_DECAY_DB below it
+    ACOUSTIC_F_LENGTH,                              // ms
+    ACOUSTIC_F_SPEECH,                              // Share of frames the VAD called speech, / 256
+    ACOUSTIC_FEATURES,
+};
+
+// One frame, from acoustic_frame_features()
+typedef struct {
+    int16_t  energy_db;                             // dBFS * 256
+    uint16_t zero_crossings;
+    int16_t  bands[ACOUSTIC_BANDS];                 // dBFS * 256 per mel band
+} acoustic_frame_t;
+
+typedef struct {
+    uint8_t  cls;                                   // acoustic_class_t
+    uint8_t  confidence;                            // Percent, from the margin to the next class
+    uint32_t at_ms;                                 // millis() when the event opened
+    int16_t  features[ACOUSTIC_FEATURES];
+} acoustic_event_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t events;                                // Closed, classified or not
+    uint32_t detected[ACOUSTIC_CLASS_MAX];          // [ACOUSTIC_NONE] are the rejected ones
+    uint32_t frame_us;                              // Total, against frames for the CPU share
+    uint32_t frame_us_max;
+    int16_t  floor_db;                              // dBFS * 256
+} acoustic_stats_t;
+
+// Called on the VAD task, must not block
+typedef void (*acoustic_sink_t)(const acoustic_event_t *event);
+
+bool acoustic_events_begin(uint32_t sample_rate);
+void acoustic_events_set_sink(acoustic_sink_t cb);
+
+// Next frame of up to ACOUSTIC_FRAME_MAX samples, `speech` as the VAD
+// found it. Frames are expected back to back; leave out those the keypad's
+// own speaker plays into rather than passing them.
+void acoustic_events_frame(const int16_t *samples, size_t count, bool speech);
+
+void acoustic_get_stats(acoustic_stats_t *stats);
+const char *acoustic_class_name(uint8_t cls);
+
+// Stages, exposed for the unit tests
+void acoustic_frame_features(const int16_t *samples, size_t count, acoustic_frame_t *frame);
+acoustic_class_t acoustic_classify(const int16_t *features, uint8_t *confidence);
@@ -0,0 +1,366 @@
+/**
+ * @file      alarm_pipeline.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "alarm_pipeline.h"
+#include "node_registry.h"
+#include "supervision.h"
+#include "event_journal.h"
+
+#define ALARM_TASK_STACK            (4 * 1024)
+
+typedef struct {
+    uint32_t rx_us;
+    int16_t  rssi_x10;
+    int16_t  snr_x10;
+    uint8_t  len;
+    char     data[ALARM_FRAME_MAX + 1];
+} alarm_frame_t;
+
+// Deeper queues for the classes that may burst, all bounded
+static const uint8_t class_depth[ALARM_CLASS_MAX] = {8, 16, 16, 32};
+
+static QueueHandle_t     ingress_queue = NULL;
+static QueueHandle_t     class_queue[ALARM_CLASS_MAX];
+static QueueHandle_t     ui_queue = NULL;
+static SemaphoreHandle_t pending = NULL;   // One count per event in the class queues
+static TaskHandle_t      decode_handle = NULL;
+static TaskHandle_t      dispatch_handle = NULL;
+
+static alarm_sink_t      sinks[ALARM_SINK_MAX];
+static alarm_pipeline_stats_t stats;       // Counted from the radio, audio, dispatch and LVGL tasks
+
+static const struct {
+    const char *keyword;
+    alarm_class_t cls;
+} class_keywords[] = {
+    {"PANIC",   ALARM_CLASS_PANIC},
+    {"SOS",     ALARM_CLASS_PANIC},
+    {"ALARM",   ALARM_CLASS_INTRUSION},
+    {"OPEN",    ALARM_CLASS_INTRUSION},
+    {"MOTION",  ALARM_CLASS_INTRUSION},
+    {"GLASS",   ALARM_CLASS_INTRUSION},
+    {"TAMPER",  ALARM_CLASS_TAMPER},
+};
+
+alarm_class_t alarm_classify(const char *payload)
+{
+    for (size_t i = 0; i < sizeof(class_keywords) / sizeof(class_keywords[0]); i++) {
+        size_t len = strlen(class_keywords[i].keyword);
+        if (strncmp(payload, class_keywords[i].keyword, len) == 0) {
+            return class_keywords[i].cls;
+        }
+    }
+    return ALARM_CLASS_TELEMETRY;
+}
+
+uint8_t alarm_latency_bucket(uint32_t us)
+{
+    uint8_t bucket = us ? 32 - __builtin_clz(us) : 0;
+    return bucket < ALARM_HIST_BUCKETS ? bucket : ALARM_HIST_BUCKETS - 1;
+}
+
+uint32_t alarm_latency_percentile(const uint32_t *hist, uint8_t percent)
+{
+    uint32_t total = 0;
+    for (int i = 0; i < ALARM_HIST_BUCKETS; i++) {
+        total += hist[i];
+    }
+    if (!total) {
+        return 0;
+    }
+    uint32_t target = (total * percent + 99) / 100, seen = 0;
+    for (int i = 0; i < ALARM_HIST_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen >= target) {
+            // Upper bound of the bucket
+            return i ? (1UL << i) - 1 : 0;
+        }
+    }
+    return UINT32_MAX;
+}
+
+static inline void record_latency(alarm_stage_t stage, const alarm_event_t *event)
+{
+    uint8_t bucket = alarm_latency_bucket(micros() - event->rx_us);
+    __atomic_fetch_add(&stats.latency[stage][event->cls][bucket], 1, __ATOMIC_RELAXED);
+}
+
+// Telemetry never waits. Critical classes wait for space, which stalls the
+// decode stage rather than losing the event.
+static bool post_event(const alarm_event_t *event)
+{
+    QueueHandle_t queue = class_queue[event->cls];
+    if (xQueueSend(queue, event, 0) != pdTRUE) {
+        if (event->cls == ALARM_CLASS_TELEMETRY) {
+            __atomic_fetch_add(&stats.dropped[event->cls], 1, __ATOMIC_RELAXED);
+            return false;
+        }
+        __atomic_fetch_add(&stats.stalled[event->cls], 1, __ATOMIC_RELAXED);
+        xQueueSend(queue, event, portMAX_DELAY);
+    }
+    __atomic_fetch_add(&stats.queued[event->cls], 1, __ATOMIC_RELAXED);
+    xSemaphoreGive(pending);
+    return true;
+}
+
+static void supervision_event(const node_snapshot_t *node, supervision_event_t what)
+{
+    static const char *const reason[] = {"TAMPER?", "LOST", "RESTORED"};
+    alarm_event_t event = {0};
+    event.rx_us = micros();
+    event.node_id = node->node_id;
+    event.cls = what == SUPERVISION_EVT_RESTORED ? ALARM_CLASS_TELEMETRY : ALARM_CLASS_TAMPER;
+    event.source = ALARM_SRC_SUPERVISION;
+    event.zone = node->zone;
+    event.battery = node->battery;
+    event.rssi_x10 = node->rssi_x16 * 10 / NODE_EWMA_SCALE;
+    event.snr_x10 = node->snr_x16 * 10 / NODE_EWMA_SCALE;
+    strncpy(event.text, reason[what], sizeof(event.text) - 1);
+    post_event(&event);
+}
+
+static void decode_frame(const alarm_frame_t *frame)
+{
+    alarm_event_t event = {0};
+    event.rx_us = frame->rx_us;
+    event.rssi_x10 = frame->rssi_x10;
+    event.snr_x10 = frame->snr_x10;
+    event.battery = 0xFF;
+    event.source = ALARM_SRC_RADIO;
+
+    node_frame_t node_frame;
+    const char *payload = frame->data;
+    if (frame->data[0] == '@') {
+        if (!node_frame_parse(frame->data, &node_frame)) {
+            __atomic_fetch_add(&stats.rejected, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        // No keys are provisioned yet, so authentication is limited to
+        // rejecting replayed sequence numbers of known nodes
+        if (!node_registry_seq_fresh(node_frame.node_id, node_frame.seq)) {
+            __atomic_fetch_add(&stats.replayed, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        node_snapshot_t node;
+        int slot = node_registry_update_rx(node_frame.node_id, frame->rssi_x10 / 10.0f, frame->snr_x10 / 10.0f,
+                                           node_frame.seq, node_frame.battery);
+        supervision_node_heard(slot);
+        if (node_registry_snapshot(slot, &node)) {
+            event.zone = node.zone;
+        }
+        event.node_id = node_frame.node_id;
+        event.seq = node_frame.seq;
+        event.battery = node_frame.battery;
+        payload = node_frame.payload;
+    }
+    // Frames without a node header are legacy telemetry
+    event.cls = event.node_id ? alarm_classify(payload) : ALARM_CLASS_TELEMETRY;
+    strncpy(event.text, payload, sizeof(event.text) - 1);
+    post_event(&event);
+}
+
+static void decode_task(void *params)
+{
+    alarm_frame_t frame;
+    while (1) {
+        // Wake at least once per supervision tick
+        if (xQueueReceive(ingress_queue, &frame, pdMS_TO_TICKS(SUPERVISION_TICK_MS)) == pdTRUE) {
+            decode_frame(&frame);
+        }
+        supervision_poll();
+    }
+}
+
+static void dispatch(const alarm_event_t *event)
+{
+    // Supervision journals its own events, local telemetry is not journalled
+    if (event->source != ALARM_SRC_SUPERVISION) {
+        if (event->cls == ALARM_CLASS_TELEMETRY) {
+            if (event->source == ALARM_SRC_RADIO) {
+                journal_log_radio(event->node_id, event->rssi_x10 / 10.0f, event->snr_x10 / 10.0f, event->seq,
+                                  event->battery);
+            }
+        } else {
+            uint8_t payload[12] = {0};
+            payload[0] = event->cls;
+            strncpy((char *)payload + 1, event->text, sizeof(payload) - 1);
+            journal_append(event->cls == ALARM_CLASS_TAMPER ? JOURNAL_EVT_TAMPER : JOURNAL_EVT_ALARM,
+                           event->node_id, event->zone, payload, sizeof(payload));
+        }
+    }
+
+    // Keep the last UI slots free for critical events
+    if (event->cls != ALARM_CLASS_TELEMETRY || uxQueueSpacesAvailable(ui_queue) > ALARM_UI_RESERVE) {
+        if (xQueueSend(ui_queue, event, 0) != pdTRUE) {
+            __atomic_fetch_add(&stats.ui_dropped, 1, __ATOMIC_RELAXED);
+        }
+    } else {
+        __atomic_fetch_add(&stats.ui_dropped, 1, __ATOMIC_RELAXED);
+    }
+
+    if (event->cls != ALARM_CLASS_TELEMETRY && sinks[ALARM_SINK_SIREN]) {
+        sinks[ALARM_SINK_SIREN](event);
+    }
+    if (sinks[ALARM_SINK_UPLINK]) {
+        sinks[ALARM_SINK_UPLINK](event);
+    }
+
+    __atomic_fetch_add(&stats.dispatched[event->cls], 1, __ATOMIC_RELAXED);
+    record_latency(ALARM_STAGE_DISPATCH, event);
+}
+
+static void dispatch_task(void *params)
+{
+    alarm_event_t event;
+    while (1) {
+        xSemaphoreTake(pending, portMAX_DELAY);
+        // Highest priority class first, re-checked for every event
+        for (int cls = 0; cls < ALARM_CLASS_MAX; cls++) {
+            if (xQueueReceive(class_queue[cls], &event, 0) == pdTRUE) {
+                dispatch(&event);
+                break;
+            }
+        }
+    }
+}
+
+bool alarm_pipeline_begin(void)
+{
+    if (decode_handle) {
+        return true;
+    }
+    memset(&stats, 0, sizeof(stats));
+    uint32_t total_depth = 0;
+    ingress_queue = xQueueCreate(ALARM_INGRESS_DEPTH, sizeof(alarm_frame_t));
+    ui_queue = xQueueCreate(ALARM_UI_DEPTH, sizeof(alarm_event_t));
+    for (int cls = 0; cls < ALARM_CLASS_MAX; cls++) {
+        class_queue[cls] = xQueueCreate(class_depth[cls], sizeof(alarm_event_t));
+        total_depth += class_depth[cls];
+        if (!class_queue[cls]) {
+            return false;
+        }
+    }
+    pending = xSemaphoreCreateCounting(total_depth, 0);
+    if (!ingress_queue || !ui_queue || !pending) {
+        return false;
+    }
+
+    supervision_set_handler(supervision_event);
+    xTaskCreate(dispatch_task, "alarm_dispatch", ALARM_TASK_STACK, NULL, ALARM_DISPATCH_PRIORITY, &dispatch_handle);
+    xTaskCreate(decode_task, "alarm_decode", ALARM_TASK_STACK, NULL, ALARM_DECODE_PRIORITY, &decode_handle);
+    return decode_handle && dispatch_handle;
+}
+
+void alarm_pipeline_set_sink(alarm_sink_id_t sink, alarm_sink_t cb)
+{
+    if (sink < ALARM_SINK_MAX) {
+        sinks[sink] = cb;
+    }
+}
+
+bool alarm_pipeline_submit_rx(const char *data, size_t len, float rssi, float snr, uint32_t rx_us)
+{
+    if (!ingress_queue) {
+        return false;
+    }
+    alarm_frame_t frame;
+    frame.rx_us = rx_us;
+    frame.rssi_x10 = (int16_t)(rssi * 10);
+    frame.snr_x10 = (int16_t)(snr * 10);
+    frame.len = min(len, (size_t)ALARM_FRAME_MAX);
+    memcpy(frame.data, data, frame.len);
+    frame.data[frame.len] = '\0';
+
+    __atomic_fetch_add(&stats.submitted, 1, __ATOMIC_RELAXED);
+    // The class as decode_frame() will see it; frames it rejects count as
+    // telemetry here
+    node_frame_t node_frame;
+    bool critical = node_frame_parse(frame.data, &node_frame) &&
+                    alarm_classify(node_frame.payload) != ALARM_CLASS_TELEMETRY;
+    bool queued;
+    if (critical) {
+        queued = xQueueSend(ingress_queue, &frame, pdMS_TO_TICKS(ALARM_INGRESS_WAIT_MS)) == pdTRUE;
+    } else {
+        // Keep the last ingress slots free for critical frames
+        queued = uxQueueSpacesAvailable(ingress_queue) > ALARM_INGRESS_RESERVE &&
+                 xQueueSend(ingress_queue, &frame, 0) == pdTRUE;
+    }
+    if (!queued) {
+        __atomic_fetch_add(&stats.ingress_dropped, 1, __ATOMIC_RELAXED);
+    }
+    return queued;
+}
+
+bool alarm_pipeline_submit_local(alarm_class_t cls, alarm_source_t source, const char *text)
+{
+    if (!pending || cls >= ALARM_CLASS_MAX) {
+        return false;
+    }
+    alarm_event_t event = {0};
+    event.rx_us = micros();
+    event.cls = cls;
+    event.source = source;
+    event.battery = 0xFF;
+    strncpy(event.text, text, sizeof(event.text) - 1);
+
+    // The detectors run on audio tasks, which must not stall behind the
+    // radio side for long. Telemetry never waits, critical classes wait a
+    // bounded time for the dispatcher to make room.
+    if (xQueueSend(class_queue[cls], &event, 0) != pdTRUE) {
+        if (cls == ALARM_CLASS_TELEMETRY) {
+            __atomic_fetch_add(&stats.dropped[cls], 1, __ATOMIC_RELAXED);
+            return false;
+        }
+        __atomic_fetch_add(&stats.stalled[cls], 1, __ATOMIC_RELAXED);
+        if (xQueueSend(class_queue[cls], &event, pdMS_TO_TICKS(ALARM_LOCAL_WAIT_MS)) != pdTRUE) {
+            __atomic_fetch_add(&stats.dropped[cls], 1, __ATOMIC_RELAXED);
+            return false;
+        }
+    }
+    __atomic_fetch_add(&stats.queued[cls], 1, __ATOMIC_RELAXED);
+    xSemaphoreGive(pending);
+    return true;
+}
+
+uint32_t alarm_pipeline_ui_poll(alarm_sink_t cb, uint32_t max)
+{
+    if (!ui_queue) {
+        return 0;
+    }
+    alarm_event_t event;
+    uint32_t handled = 0;
+    while (handled < max && xQueueReceive(ui_queue, &event, 0) == pdTRUE) {
+        cb(&event);
+        record_latency(ALARM_STAGE_UI, &event);
+        handled++;
+    }
+    return handled;
+}
+
+void alarm_pipeline_get_stats(alarm_pipeline_stats_t *out)
+{
+    memcpy(out, &stats, sizeof(stats));
+}
+
+void alarm_pipeline_print_stats(void)
+{
+    static const char *const names[ALARM_CLASS_MAX] = {"panic", "intrusion", "tamper", "telemetry"};
+    Serial.printf("Alarm pipeline: %lu submitted, %lu ingress dropped, %lu rejected, %lu replayed, %lu ui dropped\n",
+                  (unsigned long)stats.submitted, (unsigned long)stats.ingress_dropped,
+                  (unsigned long)stats.rejected, (unsigned long)stats.replayed, (unsigned long)stats.ui_dropped);
+    for (int cls = 0; cls < ALARM_CLASS_MAX; cls++) {
+        Serial.printf("  %-9s queued %lu dropped %lu stalled %lu | dispatch p50 %lu p99 %lu us | ui p50 %lu p99 %lu us\n",
+                      names[cls], (unsigned long)stats.queued[cls], (unsigned long)stats.dropped[cls],
+                      (unsigned long)stats.stalled[cls],
+                      (unsigned long)alarm_latency_percentile(stats.latency[ALARM_STAGE_DISPATCH][cls], 50),
+                      (unsigned long)alarm_latency_percentile(stats.latency[ALARM_STAGE_DISPATCH][cls], 99),
+                      (unsigned long)alarm_latency_percentile(stats.latency[ALARM_STAGE_UI][cls], 50),
+                      (unsigned long)alarm_latency_percentile(stats.latency[ALARM_STAGE_UI][cls], 99));
+    }
+}
@@ -0,0 +1,123 @@
+/**
+ * @file      alarm_pipeline.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Alarm event pipeline from radio reception to the outputs.
+ *
+ *   radio RX --ingress--> decode/classify --class queues--> dispatch --> journal
+ *                              |                                    +--> siren/TTS sink
+ *                        node registry,                             +--> uplink sink
+ *                        supervision                                +--> UI mailbox (LVGL task)
+ *
+ * Every hop is a bounded FreeRTOS queue. The dispatcher always serves the
+ * highest priority class first, so a panic never waits behind telemetry.
+ * Telemetry is dropped when its queue is full; critical classes block the
+ * decode stage instead (backpressure), which in turn fills the ingress queue.
+ * The radio side peeks at the class of each frame so that telemetry cannot
+ * take the last ingress slots from a panic.
+ * Latency from packet reception to dispatch and to the UI is recorded per
+ * class in log2 histograms.
+ *
+ * The decode task is the node registry writer and runs heartbeat supervision.
+ * Events the keypad detects itself, such as the microphone's acoustic
+ * events, skip decoding and go straight to the class queues.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define ALARM_FRAME_MAX             64
+#define ALARM_TEXT_MAX              32
+#define ALARM_INGRESS_DEPTH         32
+#define ALARM_INGRESS_RESERVE       4       // Ingress slots only critical classes may use
+#define ALARM_INGRESS_WAIT_MS       20      // Longest the radio waits for an ingress slot, critical classes only
+#define ALARM_UI_DEPTH              16
+#define ALARM_UI_RESERVE            4       // UI slots only critical classes may use
+#define ALARM_LOCAL_WAIT_MS         20      // Longest a local detector waits for a critical class slot
+#define ALARM_DECODE_PRIORITY       5       // Above LVGL/loop, the stage is short
+#define ALARM_DISPATCH_PRIORITY     4
+#define ALARM_HIST_BUCKETS          24      // Bucket n counts latencies in [2^(n-1), 2^n) us
+
+typedef enum : uint8_t {
+    ALARM_CLASS_PANIC = 0,          // Highest priority first
+    ALARM_CLASS_INTRUSION,
+    ALARM_CLASS_TAMPER,
+    ALARM_CLASS_TELEMETRY,
+    ALARM_CLASS_MAX,
+} alarm_class_t;
+
+typedef enum : uint8_t {
+    ALARM_SRC_RADIO = 0,
+    ALARM_SRC_SUPERVISION,
+    ALARM_SRC_ACOUSTIC,             // The keypad's own microphones
+} alarm_source_t;
+
+typedef enum {
+    ALARM_SINK_SIREN = 0,           // Critical classes only
+    ALARM_SINK_UPLINK,              // Every dispatched event
+    ALARM_SINK_MAX,
+} alarm_sink_id_t;
+
+typedef enum {
+    ALARM_STAGE_DISPATCH = 0,
+    ALARM_STAGE_UI,
+    ALARM_STAGE_MAX,
+} alarm_stage_t;
+
+typedef struct {
+    uint32_t rx_us;                 // micros() at packet reception
+    uint32_t node_id;               // 0 for frames without a node header
+    uint16_t seq;
+    uint8_t  cls;                   // alarm_class_t
+    uint8_t  source;                // alarm_source_t
+    uint8_t  zone;
+    uint8_t  battery;
+    int16_t  rssi_x10;
+    int16_t  snr_x10;
+    char     text[ALARM_TEXT_MAX];  // Frame payload or supervision reason
+} alarm_event_t;
+
+typedef struct {
+    uint32_t submitted;
+    uint32_t ingress_dropped;
+    uint32_t rejected;              // Malformed node frames
+    uint32_t replayed;              // Sequence numbers already heard or behind the window
+    uint32_t queued[ALARM_CLASS_MAX];
+    uint32_t dropped[ALARM_CLASS_MAX];
+    uint32_t stalled[ALARM_CLASS_MAX];      // Posts that had to wait for queue space
+    uint32_t dispatched[ALARM_CLASS_MAX];
+    uint32_t ui_dropped;
+    uint32_t latency[ALARM_STAGE_MAX][ALARM_CLASS_MAX][ALARM_HIST_BUCKETS];
+} alarm_pipeline_stats_t;
+
+// Sinks run on the dispatch task and must not block
+typedef void (*alarm_sink_t)(const alarm_event_t *event);
+
+// Start the decode and dispatch tasks, after node_registry_begin() and supervision_begin()
+bool alarm_pipeline_begin(void);
+void alarm_pipeline_set_sink(alarm_sink_id_t sink, alarm_sink_t cb);
+
+// Radio side: queue a received packet. Telemetry is dropped when only the
+// ALARM_INGRESS_RESERVE slots are left; critical classes take those, and
+// wait up to ALARM_INGRESS_WAIT_MS when even they are full.
+bool alarm_pipeline_submit_rx(const char *data, size_t len, float rssi, float snr, uint32_t rx_us);
+
+// Local detectors: queue an event for dispatch. Telemetry is dropped (and
+// counted) when its class queue is full; critical classes wait up to
+// ALARM_LOCAL_WAIT_MS for space first.
+bool alarm_pipeline_submit_local(alarm_class_t cls, alarm_source_t source, const char *text);
+
+// LVGL side: hand queued events to `cb`, at most `max` per call
+uint32_t alarm_pipeline_ui_poll(alarm_sink_t cb, uint32_t max);
+
+void alarm_pipeline_get_stats(alarm_pipeline_stats_t *stats);
+void alarm_pipeline_print_stats(void);
+
+// Helpers, exposed for the unit tests
+alarm_class_t alarm_classify(const char *payload);
+uint8_t  alarm_latency_bucket(uint32_t us);
+uint32_t alarm_latency_percentile(const uint32_t *hist, uint8_t percent);
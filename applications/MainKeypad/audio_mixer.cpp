@@ -0,0 +1,628 @@
+/**
+ * @file      audio_mixer.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "audio_mixer.h"
+
+#define MIXER_QUEUE_MASK        (MIXER_QUEUE_DEPTH - 1)
+#define MIXER_STREAM_MASK       (MIXER_STREAM_FRAMES - 1)
+#define MIXER_GAIN_MAX          (4 * MIXER_GAIN_UNITY)
+
+static_assert((MIXER_QUEUE_DEPTH & MIXER_QUEUE_MASK) == 0, "MIXER_QUEUE_DEPTH must be a power of two");
+static_assert((MIXER_STREAM_FRAMES & MIXER_STREAM_MASK) == 0, "MIXER_STREAM_FRAMES must be a power of two");
+
+enum {
+    CMD_PLAY = 0,
+    CMD_STREAM,
+    CMD_GAIN,
+    CMD_STOP,
+    CMD_STOP_ALL,
+};
+
+typedef struct {
+    uint8_t  op;
+    int8_t   source;                    // Clip, or stream for CMD_STREAM
+    uint8_t  priority;
+    bool     loop;
+    uint16_t gain;
+    uint32_t at_us;
+} mixer_cmd_t;
+
+// Bounded multi-producer queue after Dmitry Vyukov: a producer claims a
+// cell by moving the tail on, the sequence of the cell tells whether it is
+// free (== position) or filled (== position + 1)
+typedef struct {
+    uint32_t    seq;
+    mixer_cmd_t cmd;
+} mixer_cell_t;
+
+enum {
+    VOICE_FREE = 0,
+    VOICE_PENDING,                      // Clip still loading
+    VOICE_CLIP,
+    VOICE_STREAM,
+};
+
+typedef struct {
+    uint8_t  kind;
+    int8_t   source;
+    uint8_t  priority;
+    bool     loop;
+    bool     stopping;                  // Fades out over this block, then frees
+    bool     started;                   // Has sounded
+    uint16_t gain;
+    uint16_t level;                     // Gain reached at the end of the last block
+    uint32_t pos;                       // Clip frame
+    uint64_t frac;                      // Stream position past its tail, Q32
+    uint32_t seq;                       // Start order, the oldest is taken over first
+    uint32_t at_us;
+} mixer_voice_t;
+
+enum {
+    STREAM_CLOSED = 1,                  // Producer is done
+    STREAM_DETACHED = 2,                // Mixer is done; both and the slot is free
+};
+
+typedef struct {
+    int16_t      *ring;                 // Interleaved stereo
+    uint32_t      head;                 // Frames written, producer only
+    uint32_t      tail;                 // Frames played, mixer only
+    uint32_t      rate;
+    uint8_t       flags;
+    bool          used;
+    TaskHandle_t  writer;               // Waiting for room
+} mixer_stream_t;
+
+static mixer_cell_t         queue[MIXER_QUEUE_DEPTH];
+static uint32_t             queue_tail = 0;
+static uint32_t             queue_head = 0;
+static mixer_voice_t        voices[MIXER_VOICES];
+static uint8_t              busy = 0;           // Voices not free
+static uint32_t             voice_seq = 0;
+static mixer_stream_t       streams[MIXER_STREAMS];
+static uint32_t             block_at_us = 0;    // Oldest request first heard in the last block
+static TaskHandle_t         mixer_handle = NULL;
+static i2s_port_t           out_port;
+static volatile bool        out_ready = false;
+static audio_mixer_stats_t  stats;
+
+static inline int16_t saturate(int32_t v)
+{
+    return v > 32767 ? 32767 : v < -32768 ? -32768 : (int16_t)v;
+}
+
+static bool push(mixer_cmd_t *cmd)
+{
+    cmd->at_us = micros();
+    uint32_t pos = __atomic_load_n(&queue_tail, __ATOMIC_RELAXED);
+    mixer_cell_t *cell;
+    while (1) {
+        cell = &queue[pos & MIXER_QUEUE_MASK];
+        uint32_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            // A failed exchange reloads pos
+            if (__atomic_compare_exchange_n(&queue_tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            __atomic_fetch_add(&stats.queue_full, 1, __ATOMIC_RELAXED);
+            return false;
+        } else {
+            pos = __atomic_load_n(&queue_tail, __ATOMIC_RELAXED);
+        }
+    }
+    cell->cmd = *cmd;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    if (mixer_handle) {
+        xTaskNotifyGive(mixer_handle);
+    }
+    return true;
+}
+
+static bool pop(mixer_cmd_t *cmd)
+{
+    mixer_cell_t *cell = &queue[queue_head & MIXER_QUEUE_MASK];
+    uint32_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+    if ((int32_t)(seq - (queue_head + 1)) < 0) {
+        return false;
+    }
+    *cmd = cell->cmd;
+    __atomic_store_n(&cell->seq, queue_head + MIXER_QUEUE_DEPTH, __ATOMIC_RELEASE);
+    __atomic_store_n(&queue_head, queue_head + 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+static void stream_release(mixer_stream_t *s, uint8_t flag)
+{
+    if ((__atomic_or_fetch(&s->flags, flag, __ATOMIC_ACQ_REL) & (STREAM_CLOSED | STREAM_DETACHED)) ==
+            (STREAM_CLOSED | STREAM_DETACHED)) {
+        __atomic_store_n(&s->used, false, __ATOMIC_RELEASE);
+    }
+}
+
+static void voice_free(mixer_voice_t *v)
+{
+    if (v->kind == VOICE_STREAM) {
+        mixer_stream_t *s = &streams[v->source];
+        stream_release(s, STREAM_DETACHED);
+        // The producer may be waiting for room that will not come
+        TaskHandle_t writer = __atomic_load_n(&s->writer, __ATOMIC_ACQUIRE);
+        if (writer) {
+            xTaskNotifyGive(writer);
+        }
+    }
+    v->kind = VOICE_FREE;
+    __atomic_store_n(&busy, busy - 1, __ATOMIC_RELAXED);
+}
+
+// A free voice, else the lowest priority one not above `priority`, the
+// oldest of those; voices fading out go first
+static mixer_voice_t *voice_alloc(uint8_t priority)
+{
+    mixer_voice_t *v = NULL;
+    for (int i = 0; i < MIXER_VOICES; i++) {
+        if (voices[i].kind == VOICE_FREE) {
+            v = &voices[i];
+            break;
+        }
+    }
+    if (!v) {
+        for (int i = 0; i < MIXER_VOICES; i++) {
+            mixer_voice_t *c = &voices[i];
+            if (c->priority > priority && !c->stopping) {
+                continue;
+            }
+            if (!v || (c->stopping && !v->stopping) ||
+                    (c->stopping == v->stopping &&
+                     (c->priority < v->priority || (c->priority == v->priority && (int32_t)(c->seq - v->seq) < 0)))) {
+                v = c;
+            }
+        }
+        if (!v) {
+            return NULL;
+        }
+        voice_free(v);
+        stats.stolen++;
+    }
+    memset(v, 0, sizeof(*v));
+    v->seq = voice_seq++;
+    __atomic_store_n(&busy, busy + 1, __ATOMIC_RELAXED);
+    return v;
+}
+
+static void serve(const mixer_cmd_t *cmd)
+{
+    stats.commands++;
+    switch (cmd->op) {
+    case CMD_PLAY: {
+        if (clip_cache_failed(cmd->source)) {
+            stats.dropped++;
+            return;
+        }
+        mixer_voice_t *v = NULL;
+        for (int i = 0; i < MIXER_VOICES && !v; i++) {
+            if ((voices[i].kind == VOICE_CLIP || voices[i].kind == VOICE_PENDING) && voices[i].source == cmd->source) {
+                v = &voices[i];
+            }
+        }
+        if (v) {
+            // Again from the start, at the level it had
+            uint16_t level = v->level;
+            uint32_t seq = v->seq;
+            memset(v, 0, sizeof(*v));
+            v->level = level;
+            v->seq = seq;
+        } else if ((v = voice_alloc(cmd->priority)) != NULL) {
+            v->level = cmd->gain;
+        } else {
+            stats.dropped++;
+            return;
+        }
+        v->kind = clip_cache_request(cmd->source) ? VOICE_CLIP : VOICE_PENDING;
+        v->source = cmd->source;
+        v->priority = cmd->priority;
+        v->loop = cmd->loop;
+        v->gain = cmd->gain;
+        v->at_us = cmd->at_us;
+        stats.plays++;
+        break;
+    }
+    case CMD_STREAM: {
+        mixer_voice_t *v = voice_alloc(cmd->priority);
+        if (!v) {
+            stream_release(&streams[cmd->source], STREAM_DETACHED);
+            stats.dropped++;
+            return;
+        }
+        v->kind = VOICE_STREAM;
+        v->source = cmd->source;
+        v->priority = cmd->priority;
+        v->gain = v->level = cmd->gain;
+        v->at_us = cmd->at_us;
+        stats.plays++;
+        break;
+    }
+    case CMD_GAIN:
+    case CMD_STOP:
+    case CMD_STOP_ALL:
+        for (int i = 0; i < MIXER_VOICES; i++) {
+            mixer_voice_t *v = &voices[i];
+            if (v->kind == VOICE_FREE ||
+                    (cmd->op != CMD_STOP_ALL && (v->kind == VOICE_STREAM || v->source != cmd->source))) {
+                continue;
+            }
+            if (cmd->op == CMD_GAIN) {
+                v->gain = cmd->gain;
+            } else if (v->kind == VOICE_PENDING) {
+                voice_free(v);
+            } else {
+                v->stopping = true;
+            }
+        }
+        break;
+    }
+}
+
+static bool mix_clip(mixer_voice_t *v, int32_t *acc, uint32_t frames, int32_t gq, int32_t dg)
+{
+    uint32_t length = 0;
+    const int16_t *pcm = clip_cache_pcm(v->source, &length);
+    uint32_t k = 0;
+    while (k < frames && v->pos < length) {
+        uint32_t n = length - v->pos < frames - k ? length - v->pos : frames - k;
+        const int16_t *src = pcm + v->pos;
+        int32_t *dst = acc + 2 * k;
+        for (uint32_t i = 0; i < n; i++, gq += dg) {
+            int32_t s = (src[i] * (gq >> 16)) >> 8;
+            dst[2 * i] += s;
+            dst[2 * i + 1] += s;
+        }
+        k += n;
+        v->pos += n;
+        if (v->pos >= length && v->loop && !v->stopping) {
+            v->pos = 0;
+        }
+    }
+    return v->pos < length;
+}
+
+// Linear interpolation from the producer's rate; returns false once the
+// stream is closed and played out
+static bool mix_stream(mixer_voice_t *v, int32_t *acc, uint32_t frames, int32_t gq, int32_t dg, uint32_t *mixed)
+{
+    mixer_stream_t *s = &streams[v->source];
+    // Flags first: once closed, head has everything the producer wrote
+    bool closed = __atomic_load_n(&s->flags, __ATOMIC_ACQUIRE) & STREAM_CLOSED;
+    uint32_t head = __atomic_load_n(&s->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = s->tail;
+    uint32_t avail = head - tail;
+    uint64_t step = ((uint64_t)__atomic_load_n(&s->rate, __ATOMIC_RELAXED) << 32) / MIXER_SAMPLE_RATE;
+    uint64_t p = v->frac;
+    uint32_t k = 0;
+    for (; k < frames; k++, p += step, gq += dg) {
+        uint32_t i = p >> 32;
+        if (i + 1 >= avail && !(closed && i < avail)) {
+            break;
+        }
+        const int16_t *a = &s->ring[((tail + i) & MIXER_STREAM_MASK) * 2];
+        const int16_t *b = i + 1 < avail ? &s->ring[((tail + i + 1) & MIXER_STREAM_MASK) * 2] : a;
+        int32_t f = (p >> 16) & 0xFFFF;
+        int32_t g = gq >> 16;
+        acc[2 * k] += ((a[0] + (((b[0] - a[0]) * f) >> 16)) * g) >> 8;
+        acc[2 * k + 1] += ((a[1] + (((b[1] - a[1]) * f) >> 16)) * g) >> 8;
+    }
+    uint32_t used = p >> 32 < avail ? p >> 32 : avail;
+    v->frac = p - ((uint64_t)used << 32);
+    if (used) {
+        __atomic_store_n(&s->tail, tail + used, __ATOMIC_RELEASE);
+        TaskHandle_t writer = __atomic_load_n(&s->writer, __ATOMIC_ACQUIRE);
+        if (writer) {
+            xTaskNotifyGive(writer);
+        }
+    }
+    *mixed = k;
+    if (k < frames) {
+        if (closed) {
+            return false;
+        }
+        if (v->started) {
+            stats.underruns++;
+        }
+    }
+    return true;
+}
+
+uint8_t audio_mixer_mix(int16_t *out, size_t frames, TickType_t wait)
+{
+    static int32_t acc[MIXER_BLOCK_FRAMES * 2];
+    mixer_cmd_t cmd;
+    while (pop(&cmd)) {
+        serve(&cmd);
+    }
+    if (!busy && wait) {
+        ulTaskNotifyTake(pdTRUE, wait);
+        while (pop(&cmd)) {
+            serve(&cmd);
+        }
+    }
+    block_at_us = 0;
+    if (!busy) {
+        return 0;
+    }
+
+    uint32_t t0 = micros();
+    if (frames > MIXER_BLOCK_FRAMES) {
+        frames = MIXER_BLOCK_FRAMES;
+    }
+    int top = -1;
+    for (int i = 0; i < MIXER_VOICES; i++) {
+        mixer_voice_t *v = &voices[i];
+        uint32_t length;
+        if (v->kind == VOICE_PENDING) {
+            if (clip_cache_pcm(v->source, &length)) {
+                v->kind = VOICE_CLIP;
+            } else if (clip_cache_failed(v->source)) {
+                voice_free(v);
+                stats.dropped++;
+            }
+        }
+        if ((v->kind == VOICE_CLIP || v->kind == VOICE_STREAM) && !v->stopping && v->priority > top) {
+            top = v->priority;
+        }
+    }
+
+    memset(acc, 0, frames * 2 * sizeof(int32_t));
+    uint8_t mixed = 0;
+    for (int i = 0; i < MIXER_VOICES; i++) {
+        mixer_voice_t *v = &voices[i];
+        if (v->kind != VOICE_CLIP && v->kind != VOICE_STREAM) {
+            continue;
+        }
+        // From the last level to this block's target over the block
+        int32_t target = v->stopping ? 0 : v->gain * (v->priority < top ? MIXER_DUCK_GAIN : MIXER_GAIN_UNITY) / MIXER_GAIN_UNITY;
+        int32_t gq = v->level << 16;
+        int32_t dg = ((target - v->level) << 16) / (int32_t)frames;
+        uint32_t n = frames;
+        bool more = v->kind == VOICE_CLIP ? mix_clip(v, acc, frames, gq, dg) : mix_stream(v, acc, frames, gq, dg, &n);
+        v->level = target;
+        if (n) {
+            if (!v->started && (!block_at_us || (int32_t)(v->at_us - block_at_us) < 0)) {
+                block_at_us = v->at_us;
+            }
+            v->started = true;
+            mixed++;
+        }
+        if (!more || v->stopping) {
+            voice_free(v);
+        }
+    }
+    if (!mixed) {
+        return 0;
+    }
+    for (size_t k = 0; k < frames * 2; k++) {
+        out[k] = saturate(acc[k]);
+    }
+
+    stats.blocks++;
+    if (mixed > stats.voices_max) {
+        stats.voices_max = mixed;
+    }
+    uint32_t us = micros() - t0;
+    if (us > stats.mix_us_max) {
+        stats.mix_us_max = us;
+    }
+    return mixed;
+}
+
+static void mixer_task(void *params)
+{
+    static int16_t block[MIXER_BLOCK_FRAMES * 2];
+    // Until the port is installed nothing paces the blocks and they would
+    // be mixed and thrown away; requests wait in the queue meanwhile
+    while (!out_ready) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    while (1) {
+        if (!audio_mixer_mix(block, MIXER_BLOCK_FRAMES, portMAX_DELAY)) {
+            if (audio_mixer_active()) {
+                vTaskDelay(1);          // Clips loading or a stream not started yet
+            }
+            continue;
+        }
+        // Blocks while the DMA ring is full, which paces the mixer
+        size_t written = 0;
+        i2s_write(out_port, block, sizeof(block), &written, portMAX_DELAY);
+        if (block_at_us) {
+            uint32_t us = micros() - block_at_us;
+            stats.start_us_last = us;
+            if (us > stats.start_us_max) {
+                stats.start_us_max = us;
+            }
+        }
+    }
+}
+
+bool audio_mixer_begin(bool task)
+{
+    if (mixer_handle) {
+        return true;
+    }
+    for (uint32_t i = 0; i < MIXER_QUEUE_DEPTH; i++) {
+        queue[i].seq = i;
+    }
+    queue_tail = queue_head = 0;
+    memset(voices, 0, sizeof(voices));
+    busy = 0;
+    for (int i = 0; i < MIXER_STREAMS; i++) {
+        streams[i].used = false;
+    }
+
+    if (task && xTaskCreate(mixer_task, "mixer", MIXER_TASK_STACK, NULL, MIXER_TASK_PRIORITY, &mixer_handle) != pdPASS) {
+        mixer_handle = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool audio_mixer_output(i2s_port_t port, const i2s_pin_config_t *pins)
+{
+    i2s_config_t cfg = {};
+    cfg.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX);
+    cfg.sample_rate = MIXER_SAMPLE_RATE;
+    cfg.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    cfg.channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT;
+    cfg.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+    cfg.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1;
+    cfg.dma_buf_count = MIXER_DMA_BUFS;
+    cfg.dma_buf_len = MIXER_BLOCK_FRAMES;
+    cfg.use_apll = false;
+    cfg.tx_desc_auto_clear = true;      // Silence while nothing is written
+    cfg.fixed_mclk = 0;
+
+    // Audio installed its 16 x 512 frame ring in its constructor
+    i2s_driver_uninstall(port);
+    if (i2s_driver_install(port, &cfg, 0, NULL) != ESP_OK || i2s_set_pin(port, pins) != ESP_OK) {
+        Serial.println("Mixer: speaker I2S setup failed");
+        return false;
+    }
+    i2s_zero_dma_buffer(port);
+    out_port = port;
+    out_ready = true;
+    if (mixer_handle) {
+        xTaskNotifyGive(mixer_handle);
+    }
+    return true;
+}
+
+static inline uint16_t clamp_gain(uint16_t gain)
+{
+    return gain > MIXER_GAIN_MAX ? MIXER_GAIN_MAX : gain;
+}
+
+bool audio_mixer_play(int clip, uint16_t gain, uint8_t priority, bool loop)
+{
+    mixer_cmd_t cmd = { CMD_PLAY, (int8_t)clip, priority, loop, clamp_gain(gain), 0 };
+    return clip >= 0 && clip < CLIP_CACHE_MAX && push(&cmd);
+}
+
+bool audio_mixer_set_gain(int clip, uint16_t gain)
+{
+    mixer_cmd_t cmd = { CMD_GAIN, (int8_t)clip, 0, false, clamp_gain(gain), 0 };
+    return clip >= 0 && clip < CLIP_CACHE_MAX && push(&cmd);
+}
+
+bool audio_mixer_stop(int clip)
+{
+    mixer_cmd_t cmd = { CMD_STOP, (int8_t)clip, 0, false, 0, 0 };
+    return clip >= 0 && clip < CLIP_CACHE_MAX && push(&cmd);
+}
+
+bool audio_mixer_stop_all(void)
+{
+    mixer_cmd_t cmd = { CMD_STOP_ALL, -1, 0, false, 0, 0 };
+    return push(&cmd);
+}
+
+bool audio_mixer_active(void)
+{
+    return __atomic_load_n(&busy, __ATOMIC_RELAXED) ||
+           __atomic_load_n(&queue_tail, __ATOMIC_RELAXED) != __atomic_load_n(&queue_head, __ATOMIC_RELAXED);
+}
+
+int audio_mixer_stream_open(uint16_t gain, uint8_t priority)
+{
+    for (int i = 0; i < MIXER_STREAMS; i++) {
+        mixer_stream_t *s = &streams[i];
+        bool expected = false;
+        if (!__atomic_compare_exchange_n(&s->used, &expected, true, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            continue;
+        }
+        if (!s->ring) {
+            s->ring = (int16_t *)ps_malloc(MIXER_STREAM_FRAMES * 2 * sizeof(int16_t));
+        }
+        s->head = s->tail = 0;
+        s->rate = MIXER_SAMPLE_RATE;
+        s->flags = 0;
+        s->writer = NULL;
+        mixer_cmd_t cmd = { CMD_STREAM, (int8_t)i, priority, false, clamp_gain(gain), 0 };
+        if (!s->ring || !push(&cmd)) {
+            __atomic_store_n(&s->used, false, __ATOMIC_RELEASE);
+            return -1;
+        }
+        return i;
+    }
+    return -1;
+}
+
+size_t audio_mixer_stream_space(int stream)
+{
+    if (stream < 0 || stream >= MIXER_STREAMS) {
+        return 0;
+    }
+    mixer_stream_t *s = &streams[stream];
+    if (__atomic_load_n(&s->flags, __ATOMIC_ACQUIRE) & STREAM_DETACHED) {
+        return 0;
+    }
+    return MIXER_STREAM_FRAMES - (s->head - __atomic_load_n(&s->tail, __ATOMIC_ACQUIRE));
+}
+
+bool audio_mixer_stream_attached(int stream)
+{
+    if (stream < 0 || stream >= MIXER_STREAMS) {
+        return false;
+    }
+    return !(__atomic_load_n(&streams[stream].flags, __ATOMIC_ACQUIRE) & STREAM_DETACHED);
+}
+
+size_t audio_mixer_stream_write(int stream, const int16_t *frames, size_t count, uint32_t rate, TickType_t wait)
+{
+    if (stream < 0 || stream >= MIXER_STREAMS || !rate) {
+        return 0;
+    }
+    mixer_stream_t *s = &streams[stream];
+    __atomic_store_n(&s->rate, rate, __ATOMIC_RELAXED);
+    size_t done = 0;
+    while (done < count && !(__atomic_load_n(&s->flags, __ATOMIC_ACQUIRE) & STREAM_DETACHED)) {
+        uint32_t room = MIXER_STREAM_FRAMES - (s->head - __atomic_load_n(&s->tail, __ATOMIC_ACQUIRE));
+        if (!room) {
+            if (!wait) {
+                break;
+            }
+            // Registered before looking again, a wakeup in between is kept
+            __atomic_store_n(&s->writer, xTaskGetCurrentTaskHandle(), __ATOMIC_RELEASE);
+            if (s->head - __atomic_load_n(&s->tail, __ATOMIC_ACQUIRE) == MIXER_STREAM_FRAMES &&
+                    !ulTaskNotifyTake(pdTRUE, wait)) {
+                break;
+            }
+            continue;
+        }
+        uint32_t at = s->head & MIXER_STREAM_MASK;
+        uint32_t n = count - done < room ? count - done : room;
+        if (n > MIXER_STREAM_FRAMES - at) {
+            n = MIXER_STREAM_FRAMES - at;
+        }
+        memcpy(&s->ring[at * 2], &frames[done * 2], n * 2 * sizeof(int16_t));
+        __atomic_store_n(&s->head, s->head + n, __ATOMIC_RELEASE);
+        done += n;
+    }
+    __atomic_store_n(&s->writer, (TaskHandle_t)NULL, __ATOMIC_RELEASE);
+    return done;
+}
+
+void audio_mixer_stream_close(int stream)
+{
+    if (stream >= 0 && stream < MIXER_STREAMS) {
+        stream_release(&streams[stream], STREAM_CLOSED);
+    }
+}
+
+void audio_mixer_get_stats(audio_mixer_stats_t *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file      audio_mixer.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Everything the speaker plays, mixed into one I2S stream.
+ *
+ * The mixer task owns the speaker port with a short DMA ring
+ * (MIXER_DMA_BUFS of MIXER_BLOCK_FRAMES at MIXER_SAMPLE_RATE) and is the
+ * only writer to it. Up to MIXER_VOICES sounds play at once, each either a
+ * clip out of the clip cache or a stream that a producer task fills while
+ * it plays (Audio decoding a file, through audio_process_block()). Voices
+ * are summed in 32 bit and saturated once.
+ *
+ * Each voice has a gain and a priority. While a voice of higher priority
+ * sounds, the lower ones are ducked to MIXER_DUCK_GAIN of their gain, so a
+ * voice prompt stays intelligible over the siren. Gain changes, ducking and
+ * stops ramp over one block instead of stepping.
+ *
+ * Requests go through a lock-free queue: any task can play, stop or change
+ * the gain of a sound without waiting on a mutex, and the mixer picks them
+ * up at the start of the next block. Nothing on the playing path takes the
+ * SPI bus; clips are in PSRAM and stream producers read their files ahead.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <driver/i2s.h>
+#include "clip_cache.h"
+
+#define MIXER_SAMPLE_RATE       CLIP_SAMPLE_RATE
+#define MIXER_VOICES            6
+#define MIXER_BLOCK_FRAMES      128             // 2.9 ms at 44.1 kHz
+#define MIXER_DMA_BUFS          4               // 11.6 ms of output queued at most
+#define MIXER_QUEUE_DEPTH       16              // Power of two
+#define MIXER_STREAMS           2
+#define MIXER_STREAM_FRAMES     4096            // Power of two, stereo frames at the producer's rate
+#define MIXER_GAIN_UNITY        256
+#define MIXER_DUCK_GAIN         64              // -12 dB under a higher priority voice
+#define MIXER_TASK_PRIORITY     12              // Below mic capture, above UI and radio
+#define MIXER_TASK_STACK        (4 * 1024)
+
+enum {
+    MIXER_PRIO_CLICK = 0,                       // Key clicks, ducked under anything else
+    MIXER_PRIO_SIREN,
+    MIXER_PRIO_VOICE,                           // Prompts and files, the siren ducks under them
+};
+
+typedef struct {
+    uint32_t commands;
+    uint32_t queue_full;                        // Requests refused, the queue was full
+    uint32_t plays;
+    uint32_t stolen;                            // Voices taken over by a new sound
+    uint32_t dropped;                           // Failed clip, or every voice of higher priority
+    uint32_t underruns;                         // Blocks a stream producer was late for
+    uint32_t blocks;
+    uint32_t mix_us_max;                        // Mixing one block
+    uint32_t start_us_last;                     // Request to the first block in DMA
+    uint32_t start_us_max;
+    uint8_t  voices_max;                        // Most voices sounding at once
+} audio_mixer_stats_t;
+
+// With `task` the mixer task starts and writes to the output, from the
+// first audio_mixer_output() on; without it blocks are only made by
+// audio_mixer_mix(), as in the unit tests
+bool audio_mixer_begin(bool task);
+
+// Install the speaker port with the mixer's DMA ring at MIXER_SAMPLE_RATE.
+// Audio must be set not to use the port (Audio::setI2SOutput(false)).
+bool audio_mixer_output(i2s_port_t port, const i2s_pin_config_t *pins);
+
+// Any task, never blocks, not from ISRs. Playing a clip that is already
+// playing starts it over. A clip not loaded yet is requested from the clip
+// cache and starts once it is there.
+bool audio_mixer_play(int clip, uint16_t gain, uint8_t priority, bool loop);
+bool audio_mixer_set_gain(int clip, uint16_t gain);
+bool audio_mixer_stop(int clip);
+bool audio_mixer_stop_all(void);
+bool audio_mixer_active(void);
+
+// A stream plays interleaved stereo written while it plays, resampled from
+// the rate it is written at. Returns the stream or -1 when none is free.
+int audio_mixer_stream_open(uint16_t gain, uint8_t priority);
+
+// Frames that can be written now without waiting
+size_t audio_mixer_stream_space(int stream);
+
+// False once the stream was stopped or lost its voice; nothing written
+// after that plays, and its space stays 0
+bool audio_mixer_stream_attached(int stream);
+
+// Waits up to `wait` for room. Returns the frames taken, fewer when it
+// timed out or the stream was stopped or lost its voice.
+size_t audio_mixer_stream_write(int stream, const int16_t *frames, size_t count, uint32_t rate, TickType_t wait);
+
+// What was written plays out, then the stream is free again
+void audio_mixer_stream_close(int stream);
+
+// Serve the queued requests and mix the next `frames` (up to
+// MIXER_BLOCK_FRAMES) of interleaved stereo into `out`. Waits up to `wait`
+// for a request while nothing plays. Returns the voices mixed, 0 when
+// nothing sounds and `out` is left alone.
+uint8_t audio_mixer_mix(int16_t *out, size_t frames, TickType_t wait);
+
+void audio_mixer_get_stats(audio_mixer_stats_t *stats);
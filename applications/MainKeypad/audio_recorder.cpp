@@ -0,0 +1,506 @@
+/**
+ * @file      audio_recorder.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "audio_recorder.h"
+#include "mic_capture.h"
+
+#define REC_NAME_MAX            24
+#define REC_DATA_OFFSET         (REC_HEADER_SIZE - 8)   // "data" chunk header, last in the header sector
+
+static_assert(1 + 2 * (REC_ADPCM_BLOCK - 4) == REC_ADPCM_SAMPLES, "mono IMA ADPCM block layout");
+static_assert(REC_WRITE_BYTES % REC_ADPCM_BLOCK == 0 && REC_HEADER_SIZE % REC_ADPCM_BLOCK == 0,
+              "writes are whole blocks");
+
+static const int16_t adpcm_steps[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+};
+static const int8_t adpcm_index_step[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+static fs::FS                *rec_fs = NULL;
+static SemaphoreHandle_t      rec_bus = NULL;
+static uint32_t               rec_rate = 16000;
+static uint8_t                rec_channel = 0;
+static int                    consumer = -1;
+static TaskHandle_t           rec_handle = NULL;
+static audio_recorder_stats_t stats;
+
+// Written by any task
+static uint32_t               trigger_seq = 0;
+static uint32_t               trigger_at = 0;        // Capture position of the latest trigger
+static bool                   finish_requested = false;
+static bool                   recording = false;
+
+// Recorder task only
+static uint32_t               trigger_seen = 0;
+static uint32_t               file_number = 0;       // Of the next recording
+static char                   rec_path[REC_NAME_MAX] = "";
+static File                   file;
+static uint32_t               start_pos;             // Capture position of the first sample
+static uint32_t               end_pos;
+static uint32_t               next_pos;              // Where the cursor is expected, a jump is lost audio
+static uint32_t               file_samples;
+static uint32_t               file_lost;
+static uint32_t               file_encode_us;
+static uint8_t               *staging = NULL;        // REC_WRITE_BYTES, sent to the card when full
+static size_t                 staged;
+static int16_t                block_samples[REC_ADPCM_SAMPLES];
+static size_t                 block_fill;
+static adpcm_state_t          adpcm;
+
+static inline void adpcm_update(adpcm_state_t *state, uint8_t nibble, int delta)
+{
+    int predictor = state->predictor + (nibble & 8 ? -delta : delta);
+    state->predictor = predictor > 32767 ? 32767 : predictor < -32768 ? -32768 : predictor;
+    int index = state->index + adpcm_index_step[nibble & 7];
+    state->index = index < 0 ? 0 : index > 88 ? 88 : index;
+}
+
+static inline uint8_t adpcm_encode_sample(adpcm_state_t *state, int16_t sample)
+{
+    int step = adpcm_steps[state->index];
+    int diff = sample - state->predictor;
+    uint8_t nibble = 0;
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    // Same sum of step fractions the decoder forms from the nibble
+    int delta = step >> 3;
+    if (diff >= step) {
+        nibble |= 4;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 2;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 1;
+        delta += step;
+    }
+    adpcm_update(state, nibble, delta);
+    return nibble;
+}
+
+static inline int16_t adpcm_decode_sample(adpcm_state_t *state, uint8_t nibble)
+{
+    int step = adpcm_steps[state->index];
+    int delta = step >> 3;
+    if (nibble & 4) {
+        delta += step;
+    }
+    if (nibble & 2) {
+        delta += step >> 1;
+    }
+    if (nibble & 1) {
+        delta += step >> 2;
+    }
+    adpcm_update(state, nibble, delta);
+    return state->predictor;
+}
+
+void adpcm_encode_block(adpcm_state_t *state, const int16_t *samples, uint8_t *block)
+{
+    // The header restarts the predictor on the exact first sample
+    state->predictor = samples[0];
+    block[0] = (uint16_t)samples[0];
+    block[1] = (uint16_t)samples[0] >> 8;
+    block[2] = state->index;
+    block[3] = 0;
+    uint8_t *out = block + 4;
+    for (int i = 1; i < REC_ADPCM_SAMPLES; i += 2) {
+        uint8_t lo = adpcm_encode_sample(state, samples[i]);
+        uint8_t hi = adpcm_encode_sample(state, samples[i + 1]);
+        *out++ = lo | hi << 4;
+    }
+}
+
+void adpcm_decode_block(const uint8_t *block, int16_t *samples)
+{
+    adpcm_state_t state;
+    state.predictor = (int16_t)(block[0] | block[1] << 8);
+    state.index = block[2] > 88 ? 88 : block[2];
+    samples[0] = state.predictor;
+    const uint8_t *in = block + 4;
+    for (int i = 1; i < REC_ADPCM_SAMPLES; i += 2, in++) {
+        samples[i] = adpcm_decode_sample(&state, *in & 0x0f);
+        samples[i + 1] = adpcm_decode_sample(&state, *in >> 4);
+    }
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    put16(p, v);
+    put16(p + 2, v >> 16);
+}
+
+// RIFF, fmt (IMA ADPCM), fact and a JUNK chunk filling the sector up to
+// the "data" chunk header
+static void write_header(uint8_t *hdr, uint32_t samples, uint32_t data_bytes)
+{
+    memset(hdr, 0, REC_HEADER_SIZE);
+    memcpy(hdr, "RIFF", 4);
+    put32(hdr + 4, REC_HEADER_SIZE - 8 + data_bytes);
+    memcpy(hdr + 8, "WAVEfmt ", 8);
+    put32(hdr + 16, 20);
+    put16(hdr + 20, 0x11);
+    put16(hdr + 22, 1);
+    put32(hdr + 24, rec_rate);
+    put32(hdr + 28, (uint64_t)rec_rate * REC_ADPCM_BLOCK / REC_ADPCM_SAMPLES);
+    put16(hdr + 32, REC_ADPCM_BLOCK);
+    put16(hdr + 34, 4);
+    put16(hdr + 36, 2);
+    put16(hdr + 38, REC_ADPCM_SAMPLES);
+    memcpy(hdr + 40, "fact", 4);
+    put32(hdr + 44, 4);
+    put32(hdr + 48, samples);
+    memcpy(hdr + 52, "JUNK", 4);
+    put32(hdr + 56, REC_DATA_OFFSET - 60);
+    memcpy(hdr + REC_DATA_OFFSET, "data", 4);
+    put32(hdr + REC_DATA_OFFSET + 4, data_bytes);
+}
+
+static bool bus_take(void)
+{
+    if (!rec_bus) {
+        return true;
+    }
+    uint32_t start = micros();
+    if (xSemaphoreTake(rec_bus, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+    uint32_t waited = micros() - start;
+    if (waited > stats.bus_wait_us_max) {
+        stats.bus_wait_us_max = waited;
+    }
+    return true;
+}
+
+static void bus_give(void)
+{
+    if (rec_bus) {
+        xSemaphoreGive(rec_bus);
+    }
+}
+
+static bool write_staging(void)
+{
+    if (!staged) {
+        return true;
+    }
+    if (!bus_take()) {
+        return false;
+    }
+    uint32_t start = micros();
+    size_t written = file.write(staging, staged);
+    uint32_t held = micros() - start;
+    bus_give();
+
+    if (held > stats.write_us_max) {
+        stats.write_us_max = held;
+    }
+    stats.writes++;
+    stats.bytes += written;
+    bool ok = written == staged;
+    staged = 0;
+    if (!ok) {
+        stats.errors++;
+    }
+    return ok;
+}
+
+static void end_recording(bool ok)
+{
+    uint32_t blocks = (file_samples + REC_ADPCM_SAMPLES - 1) / REC_ADPCM_SAMPLES;
+    if (ok && block_fill) {
+        // The last block is padded with its last sample, the fact chunk
+        // tells players where the audio ends
+        for (size_t i = block_fill; i < REC_ADPCM_SAMPLES; i++) {
+            block_samples[i] = block_samples[block_fill - 1];
+        }
+        if (staged == REC_WRITE_BYTES) {
+            ok = write_staging();
+        }
+        adpcm_encode_block(&adpcm, block_samples, staging + staged);
+        staged += REC_ADPCM_BLOCK;
+    }
+    if (ok) {
+        ok = write_staging();
+    }
+    staged = 0;
+    block_fill = 0;
+    if (bus_take()) {
+        if (ok) {
+            write_header(staging, file_samples, blocks * REC_ADPCM_BLOCK);
+            file.seek(0);
+            if (file.write(staging, REC_HEADER_SIZE) != REC_HEADER_SIZE) {
+                stats.errors++;
+            }
+        }
+        file.close();
+        bus_give();
+    }
+    __atomic_store_n(&recording, false, __ATOMIC_RELEASE);
+
+    uint32_t ms = (uint64_t)file_samples * 1000 / rec_rate;
+    Serial.printf("Recorder: %s, %lu ms, %lu bytes, %lu ms lost, encoding %lu us per second%s\n",
+                  rec_path, (unsigned long)ms,
+                  (unsigned long)(REC_HEADER_SIZE + blocks * REC_ADPCM_BLOCK),
+                  (unsigned long)((uint64_t)file_lost * 1000 / rec_rate),
+                  (unsigned long)(ms ? (uint64_t)file_encode_us * 1000 / ms : 0),
+                  ok ? "" : ", card error");
+}
+
+static bool start_recording(uint32_t at)
+{
+    char path[REC_NAME_MAX];
+    snprintf(path, sizeof(path), REC_DIR "/rec%05lu.wav", (unsigned long)file_number);
+    if (!bus_take()) {
+        return false;
+    }
+    if (file_number >= REC_FILES_MAX) {
+        char oldest[REC_NAME_MAX];
+        snprintf(oldest, sizeof(oldest), REC_DIR "/rec%05lu.wav", (unsigned long)(file_number - REC_FILES_MAX));
+        rec_fs->remove(oldest);
+    }
+    file = rec_fs->open(path, FILE_WRITE);
+    bus_give();
+    if (!file) {
+        stats.errors++;
+        return false;
+    }
+    file_number++;
+    strlcpy(rec_path, path, sizeof(rec_path));
+
+    // Idle, the cursor is kept about the pre-roll behind; start exactly
+    // that far ahead of the trigger when more is held
+    uint32_t preroll = (uint64_t)rec_rate * REC_PREROLL_MS / 1000;
+    uint32_t cursor = mic_capture_cursor(consumer);
+    if ((int32_t)(at - preroll - cursor) > 0) {
+        mic_capture_advance(consumer, at - preroll - cursor);
+    }
+    start_pos = next_pos = mic_capture_cursor(consumer);
+    file_samples = 0;
+    file_lost = 0;
+    file_encode_us = 0;
+    block_fill = 0;
+    adpcm.predictor = 0;
+    adpcm.index = 0;
+    // Sizes are filled in when the file is closed
+    write_header(staging, 0, 0);
+    staged = REC_HEADER_SIZE;
+    stats.recordings++;
+    __atomic_store_n(&recording, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool audio_recorder_service(void)
+{
+    if (consumer < 0) {
+        return false;
+    }
+
+    uint32_t seq = __atomic_load_n(&trigger_seq, __ATOMIC_ACQUIRE);
+    if (seq != trigger_seen) {
+        trigger_seen = seq;
+        uint32_t at = __atomic_load_n(&trigger_at, __ATOMIC_RELAXED);
+        bool extend = recording;
+        if (extend || start_recording(at)) {
+            uint32_t end = at + (uint64_t)rec_rate * REC_POSTROLL_MS / 1000;
+            uint32_t length_max = (uint64_t)rec_rate * REC_LENGTH_MAX_MS / 1000;
+            if (end - start_pos > length_max) {
+                end = start_pos + length_max;
+            }
+            if (!extend || (int32_t)(end - end_pos) > 0) {
+                end_pos = end;
+            }
+        }
+    }
+    if (__atomic_exchange_n(&finish_requested, false, __ATOMIC_ACQ_REL) && recording) {
+        uint32_t now = mic_capture_position();
+        if ((int32_t)(end_pos - now) > 0) {
+            end_pos = now;
+        }
+    }
+
+    if (!recording) {
+        // Let go of everything older than the pre-roll
+        size_t held = mic_capture_available(consumer);
+        size_t preroll = (uint64_t)rec_rate * REC_PREROLL_MS / 1000;
+        if (held > preroll) {
+            mic_capture_advance(consumer, held - preroll);
+        }
+        return false;
+    }
+
+    uint8_t channels = mic_capture_channels();
+    while (1) {
+        if (staged == REC_WRITE_BYTES && !write_staging()) {
+            end_recording(false);
+            return false;
+        }
+        uint32_t cursor = mic_capture_cursor(consumer);
+        if (cursor != next_pos) {
+            // Overwritten before it was encoded, the recording skips it
+            file_lost += cursor - next_pos;
+            stats.lost_samples += cursor - next_pos;
+            next_pos = cursor;
+        }
+        if ((int32_t)(end_pos - cursor) <= 0) {
+            end_recording(true);
+            return false;
+        }
+        size_t frames;
+        const int16_t *src = mic_capture_peek(consumer, &frames);
+        size_t n = REC_ADPCM_SAMPLES - block_fill;
+        if (n > frames) {
+            n = frames;
+        }
+        if (n > end_pos - cursor) {
+            n = end_pos - cursor;
+        }
+        if (!n) {
+            return true;
+        }
+
+        uint32_t start = micros();
+        src += rec_channel;
+        for (size_t i = 0; i < n; i++, src += channels) {
+            block_samples[block_fill + i] = *src;
+        }
+        if (!mic_capture_advance(consumer, n)) {
+            continue;
+        }
+        next_pos = cursor + n;
+        block_fill += n;
+        file_samples += n;
+        stats.samples += n;
+        if (block_fill == REC_ADPCM_SAMPLES) {
+            adpcm_encode_block(&adpcm, block_samples, staging + staged);
+            staged += REC_ADPCM_BLOCK;
+            block_fill = 0;
+        }
+        uint32_t spent = micros() - start;
+        file_encode_us += spent;
+        stats.encode_us += spent;
+    }
+}
+
+static void recorder_task(void *params)
+{
+    consumer = mic_capture_subscribe("rec");
+    if (consumer < 0) {
+        Serial.println("Recorder: no capture cursor left");
+        rec_handle = NULL;
+        vTaskDelete(NULL);
+    }
+    while (1) {
+        // The ring holds seconds, a pass every REC_POLL_MS keeps well ahead
+        audio_recorder_service();
+        vTaskDelay(pdMS_TO_TICKS(REC_POLL_MS));
+    }
+}
+
+bool audio_recorder_begin(fs::FS *fs, SemaphoreHandle_t bus, uint32_t sample_rate, uint8_t channel, bool task)
+{
+    if (!fs || !sample_rate || channel >= mic_capture_channels()) {
+        return false;
+    }
+    if (!staging) {
+        staging = (uint8_t *)ps_malloc(REC_WRITE_BYTES);
+        if (!staging) {
+            Serial.println("Recorder: no PSRAM for the write buffer");
+            return false;
+        }
+    }
+    rec_fs = fs;
+    rec_bus = bus;
+    rec_rate = sample_rate;
+    rec_channel = channel;
+    memset(&stats, 0, sizeof(stats));
+    trigger_seen = __atomic_load_n(&trigger_seq, __ATOMIC_ACQUIRE);
+
+    // Numbering goes on after the newest recording on the card
+    file_number = 0;
+    if (bus_take()) {
+        if (!fs->exists(REC_DIR)) {
+            fs->mkdir(REC_DIR);
+        }
+        File dir = fs->open(REC_DIR);
+        if (dir && dir.isDirectory()) {
+            for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) {
+                const char *name = strrchr(entry.name(), '/');
+                name = name ? name + 1 : entry.name();
+                if (!strncmp(name, "rec", 3) && isdigit((unsigned char)name[3])) {
+                    uint32_t number = strtoul(name + 3, NULL, 10);
+                    if (number + 1 > file_number) {
+                        file_number = number + 1;
+                    }
+                }
+            }
+        }
+        bus_give();
+    }
+
+    if (!task) {
+        if (consumer < 0) {
+            consumer = mic_capture_subscribe("rec");
+        }
+        return consumer >= 0;
+    }
+    if (!rec_handle &&
+            xTaskCreate(recorder_task, "rec", REC_TASK_STACK, NULL, REC_TASK_PRIORITY, &rec_handle) != pdPASS) {
+        rec_handle = NULL;
+        return false;
+    }
+    return true;
+}
+
+void audio_recorder_trigger(void)
+{
+    __atomic_store_n(&trigger_at, mic_capture_position(), __ATOMIC_RELAXED);
+    __atomic_fetch_add(&trigger_seq, 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&stats.triggers, 1, __ATOMIC_RELAXED);
+}
+
+void audio_recorder_finish(void)
+{
+    __atomic_store_n(&finish_requested, true, __ATOMIC_RELEASE);
+}
+
+bool audio_recorder_active(void)
+{
+    return __atomic_load_n(&recording, __ATOMIC_ACQUIRE);
+}
+
+void audio_recorder_path(char *path, size_t size)
+{
+    strlcpy(path, rec_path, size);
+}
+
+void audio_recorder_get_stats(audio_recorder_stats_t *out)
+{
+    *out = stats;
+}
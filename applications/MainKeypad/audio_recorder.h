@@ -0,0 +1,90 @@
+/**
+ * @file      audio_recorder.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Evidence recordings of what the microphone heard around a trigger.
+ *
+ * The recorder is a consumer of the capture ring (mic_capture.h) that,
+ * while idle, keeps its cursor REC_PREROLL_MS behind the newest frame: the
+ * ring itself is the pre-roll buffer and nothing is copied until something
+ * happens. A trigger (the VAD hearing speech) starts a file with the audio
+ * from before it, and every further trigger moves the end out to
+ * REC_POSTROLL_MS after it, up to REC_LENGTH_MAX_MS per file.
+ *
+ * One microphone channel is compressed to 4 bit IMA ADPCM, a quarter of
+ * the PCM size and a few cycles per sample, and written as a standard
+ * WAV file (format 0x11) any player opens. Each ADPCM block is one 512
+ * byte sector and the header is padded to one, so the low priority
+ * recorder task writes whole sectors REC_WRITE_BYTES at a time, holding
+ * the SPI bus for one write only. The capture ring absorbs a slow card for
+ * up to four seconds before audio is lost, which is counted.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+#define REC_DIR                 "/rec"
+#define REC_PREROLL_MS          3000            // Held in the capture ring, under its 4.1 s
+#define REC_POSTROLL_MS         5000            // After the last trigger
+#define REC_LENGTH_MAX_MS       (2 * 60 * 1000)
+#define REC_FILES_MAX           200             // The oldest is deleted beyond this
+#define REC_ADPCM_BLOCK         512             // Bytes, one sector
+#define REC_ADPCM_SAMPLES       1017            // Per block, one in the header and two per byte after it
+#define REC_HEADER_SIZE         512             // WAV header padded to a sector
+#define REC_WRITE_BYTES         (8 * 1024)      // One SD write, about a second of audio at 16 kHz
+#define REC_POLL_MS             100
+#define REC_TASK_PRIORITY       2               // Below the UI, radio and the other capture consumers
+#define REC_TASK_STACK          (4 * 1024)
+
+typedef struct {
+    int16_t predictor;
+    uint8_t index;                      // Into the step size table
+} adpcm_state_t;
+
+typedef struct {
+    uint32_t triggers;
+    uint32_t recordings;
+    uint32_t samples;                   // Encoded
+    uint32_t lost_samples;              // Overwritten in the ring before they were encoded
+    uint32_t bytes;                     // Written to the card, headers included
+    uint32_t writes;
+    uint32_t errors;                    // Files not opened or short writes
+    uint32_t encode_us;                 // Copying and encoding, against samples for the CPU share
+    uint32_t write_us_max;              // Longest SPI bus hold for one write
+    uint32_t bus_wait_us_max;           // Longest wait for the bus
+} audio_recorder_stats_t;
+
+// IMA ADPCM as in WAV files, exposed for the unit tests. Encodes
+// REC_ADPCM_SAMPLES samples into one REC_ADPCM_BLOCK byte block, the
+// state carries the step size from one block to the next.
+void adpcm_encode_block(adpcm_state_t *state, const int16_t *samples, uint8_t *block);
+void adpcm_decode_block(const uint8_t *block, int16_t *samples);
+
+// Record `channel` of the capture ring, captured at `sample_rate`, into
+// REC_DIR on `fs`, taking `bus` (may be NULL) around every file access.
+// With `task` the recorder task starts; without it the ring is only read by
+// audio_recorder_service(), as in the unit tests.
+bool audio_recorder_begin(fs::FS *fs, SemaphoreHandle_t bus, uint32_t sample_rate, uint8_t channel, bool task);
+
+// Any task, never blocks. Records from REC_PREROLL_MS before now to
+// REC_POSTROLL_MS after, or extends the recording under way.
+void audio_recorder_trigger(void);
+
+// End the recording under way with what has been captured so far, before
+// sleep. The file is closed on the recorder's next pass.
+void audio_recorder_finish(void);
+
+bool audio_recorder_active(void);
+
+// Encode and write what the ring holds. Returns true while recording.
+bool audio_recorder_service(void);
+
+// Path of the recording under way or the last one, empty before the first
+void audio_recorder_path(char *path, size_t size);
+
+void audio_recorder_get_stats(audio_recorder_stats_t *stats);
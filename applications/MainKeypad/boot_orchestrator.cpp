@@ -0,0 +1,75 @@
+/**
+ * @file      boot_orchestrator.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "boot_orchestrator.h"
+#include "boot_profile.h"
+
+static const boot_probe_t *probe_table = NULL;
+static uint32_t required_mask = 0;
+static uint32_t done_mask = 0;
+static uint32_t ok_mask = 0;
+
+static void run_probe(uint8_t index)
+{
+    const boot_probe_t *probe = &probe_table[index];
+
+    uint32_t phase = boot_phase_begin(probe->name);
+    bool ok = probe->probe();
+    boot_phase_end(phase, ok);
+
+    if (ok) {
+        __atomic_fetch_or(&ok_mask, 1UL << index, __ATOMIC_RELAXED);
+    }
+    // Release: the probe's side effects are visible once done is seen
+    __atomic_fetch_or(&done_mask, 1UL << index, __ATOMIC_RELEASE);
+}
+
+static void probe_task(void *params)
+{
+    run_probe((uint8_t)(uintptr_t)params);
+    vTaskDelete(NULL);
+}
+
+void boot_probes_start(const boot_probe_t *probes, uint8_t count)
+{
+    if (count > BOOT_PROBE_MAX) {
+        count = BOOT_PROBE_MAX;
+    }
+    probe_table = probes;
+    required_mask = 0;
+    __atomic_store_n(&done_mask, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ok_mask, 0, __ATOMIC_RELAXED);
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (probes[i].required) {
+            required_mask |= 1UL << i;
+        }
+        if (xTaskCreate(probe_task, probes[i].name, probes[i].stack, (void *)(uintptr_t)i,
+                        BOOT_PROBE_PRIORITY, NULL) != pdPASS) {
+            // No memory for the task, run it inline rather than lose the peripheral
+            Serial.printf("Boot probe %s: no task, running inline\n", probes[i].name);
+            run_probe(i);
+        }
+    }
+}
+
+bool boot_probes_ready(void)
+{
+    return (__atomic_load_n(&done_mask, __ATOMIC_ACQUIRE) & required_mask) == required_mask;
+}
+
+bool boot_probe_done(uint8_t index)
+{
+    return __atomic_load_n(&done_mask, __ATOMIC_ACQUIRE) & (1UL << index);
+}
+
+bool boot_probe_ok(uint8_t index)
+{
+    return boot_probe_done(index) && (__atomic_load_n(&ok_mask, __ATOMIC_RELAXED) & (1UL << index));
+}
@@ -0,0 +1,43 @@
+/**
+ * @file      boot_orchestrator.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Parallel bring-up of independent peripherals.
+ *
+ * Each probe runs once in its own FreeRTOS task while setup() keeps
+ * animating the splash screen, and is timed as a boot_profile phase.
+ * setup() waits until the required probes have finished. The others, like
+ * the GPS probe that can take seconds across baud rates, complete in the
+ * background; check boot_probe_done() before touching their peripheral.
+ *
+ * Probes must not share a bus without its lock: SD takes the SPI mutex,
+ * the codec relies on the Wire driver lock.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define BOOT_PROBE_MAX          8
+#define BOOT_PROBE_PRIORITY     1       // Same as loopTask, the splash keeps running
+
+typedef bool (*boot_probe_fn_t)(void);
+
+typedef struct {
+    const char     *name;
+    boot_probe_fn_t probe;
+    uint32_t        stack;              // Task stack in bytes
+    bool            required;           // setup() waits for it
+} boot_probe_t;
+
+// Spawn one task per probe, `probes` must stay valid until they finish
+void boot_probes_start(const boot_probe_t *probes, uint8_t count);
+
+// All required probes finished
+bool boot_probes_ready(void);
+
+bool boot_probe_done(uint8_t index);
+bool boot_probe_ok(uint8_t index);
@@ -0,0 +1,112 @@
+/**
+ * @file      boot_profile.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "boot_profile.h"
+
+static boot_phase_t ring[BOOT_PROFILE_CAPACITY];
+static uint32_t     next_seq = 0;
+static uint32_t     ready_us = 0;
+
+uint32_t boot_phase_begin(const char *name)
+{
+    uint32_t seq = __atomic_fetch_add(&next_seq, 1, __ATOMIC_RELAXED);
+    boot_phase_t *phase = &ring[seq % BOOT_PROFILE_CAPACITY];
+    phase->name = name;
+    phase->start_us = micros();
+    phase->end_us = 0;
+    phase->ok = false;
+    __atomic_store_n(&phase->seq, seq, __ATOMIC_RELEASE);
+    return seq;
+}
+
+void boot_phase_end(uint32_t seq, bool ok)
+{
+    boot_phase_t *phase = &ring[seq % BOOT_PROFILE_CAPACITY];
+    // Overwritten by a newer phase after the ring wrapped
+    if (__atomic_load_n(&phase->seq, __ATOMIC_ACQUIRE) != seq) {
+        return;
+    }
+    phase->ok = ok;
+    // Never store 0, it means running
+    __atomic_store_n(&phase->end_us, micros() | 1, __ATOMIC_RELEASE);
+}
+
+void boot_profile_ready(void)
+{
+    ready_us = micros();
+}
+
+uint32_t boot_profile_ready_ms(void)
+{
+    return ready_us / 1000;
+}
+
+size_t boot_profile_count(void)
+{
+    uint32_t claimed = __atomic_load_n(&next_seq, __ATOMIC_ACQUIRE);
+    return claimed < BOOT_PROFILE_CAPACITY ? claimed : BOOT_PROFILE_CAPACITY;
+}
+
+bool boot_profile_get(size_t index, boot_phase_t *phase)
+{
+    uint32_t claimed = __atomic_load_n(&next_seq, __ATOMIC_ACQUIRE);
+    size_t count = boot_profile_count();
+    if (index >= count) {
+        return false;
+    }
+    uint32_t seq = claimed - count + index;
+    const boot_phase_t *src = &ring[seq % BOOT_PROFILE_CAPACITY];
+    if (__atomic_load_n(&src->seq, __ATOMIC_ACQUIRE) != seq) {
+        return false;               // Claimed but not written yet
+    }
+    *phase = *src;
+    phase->end_us = __atomic_load_n(&src->end_us, __ATOMIC_ACQUIRE);
+    return true;
+}
+
+size_t boot_profile_format(char *buf, size_t len)
+{
+    size_t used = 0;
+    boot_phase_t phase;
+    if (len) {
+        buf[0] = '\0';
+    }
+    for (size_t i = 0; i < boot_profile_count() && used < len; i++) {
+        if (!boot_profile_get(i, &phase)) {
+            continue;
+        }
+        int n;
+        if (phase.end_us) {
+            n = snprintf(buf + used, len - used, "%5lu %5lu %s%s\n", (unsigned long)(phase.start_us / 1000),
+                         (unsigned long)((phase.end_us - phase.start_us) / 1000), phase.name, phase.ok ? "" : " FAIL");
+        } else {
+            n = snprintf(buf + used, len - used, "%5lu   ... %s\n", (unsigned long)(phase.start_us / 1000), phase.name);
+        }
+        if (n < 0) {
+            break;
+        }
+        used += (size_t)n;
+    }
+    return used < len ? used : (len ? len - 1 : 0);
+}
+
+void boot_profile_dump(void)
+{
+    static char text[BOOT_PROFILE_CAPACITY * 40];
+    boot_profile_format(text, sizeof(text));
+    Serial.printf("Boot profile, operational at %lu ms\n start   dur phase (ms)\n%s",
+                  (unsigned long)boot_profile_ready_ms(), text);
+}
+
+void boot_profile_reset(void)
+{
+    memset(ring, 0, sizeof(ring));
+    __atomic_store_n(&next_seq, 0, __ATOMIC_RELEASE);
+    ready_us = 0;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file      boot_profile.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Boot phase profiler.
+ *
+ * Every phase of setup() and of the parallel boot probes is timestamped into
+ * a fixed ring of records. Slots are claimed with an atomic counter, so
+ * phases may begin and end from any task without locking. The oldest
+ * records are overwritten once the ring wraps. The ring is dumped to the
+ * serial port at the end of setup() and shown on the Settings page.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define BOOT_PROFILE_CAPACITY   32
+
+typedef struct {
+    const char *name;               // String literal, not copied
+    uint32_t    seq;                // Claim order, validates the handle
+    uint32_t    start_us;           // micros() since reset
+    uint32_t    end_us;             // 0 while the phase is running
+    bool        ok;
+} boot_phase_t;
+
+// Start timing a phase, returns the handle for boot_phase_end()
+uint32_t boot_phase_begin(const char *name);
+void boot_phase_end(uint32_t phase, bool ok);
+
+// Mark the keypad operational, normally the end of setup()
+void boot_profile_ready(void);
+uint32_t boot_profile_ready_ms(void);
+
+// Records still in the ring, oldest first
+size_t boot_profile_count(void);
+bool boot_profile_get(size_t index, boot_phase_t *phase);
+
+// One line per phase: start and duration in ms, running phases show "..."
+size_t boot_profile_format(char *buf, size_t len);
+void boot_profile_dump(void);
+
+void boot_profile_reset(void);
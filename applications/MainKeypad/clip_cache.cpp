@@ -0,0 +1,490 @@
+/**
+ * @file      clip_cache.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "clip_cache.h"
+#include <mp3_decoder/mp3_decoder.h>
+
+#define CLIP_MP3_FRAME_SAMPLES  (1152 * 2)      // One MPEG-1 layer III frame, stereo
+#define CLIP_GROW_FRAMES        (64 * 1024)
+#define CLIP_FADE_FRAMES        (CLIP_SAMPLE_RATE / 200)   // 5 ms, the siren starts and ends without a click
+
+typedef struct {
+    char        name[CLIP_NAME_MAX];
+    const char *path;                   // NULL for synthesized clips
+    int16_t    *pcm;                    // Mono at CLIP_SAMPLE_RATE
+    uint32_t    frames;
+    uint32_t    source_rate;
+    bool        preload;
+    bool        requested;              // Queued to the loader task
+    bool        loaded;                 // Released after pcm and frames are set
+    bool        failed;
+} clip_t;
+
+typedef struct {
+    int16_t *pcm;
+    uint32_t frames;
+    uint32_t capacity;
+} pcm_buf_t;
+
+static clip_t              clips[CLIP_CACHE_MAX];
+static uint8_t             clip_count = 0;
+static QueueHandle_t       requests = NULL;
+static TaskHandle_t        loader_handle = NULL;
+static fs::FS             *clip_sd = NULL;
+static fs::FS             *clip_flash = NULL;
+static SemaphoreHandle_t   clip_bus = NULL;
+static SemaphoreHandle_t   decoder_lock = NULL;    // The Helix MP3 globals, shared with Audio
+static clip_cache_stats_t  stats;
+
+static inline bool bus_take(void)
+{
+    return !clip_bus || xSemaphoreTake(clip_bus, portMAX_DELAY) == pdTRUE;
+}
+
+static inline void bus_give(void)
+{
+    if (clip_bus) {
+        xSemaphoreGive(clip_bus);
+    }
+}
+
+static inline bool clip_loaded(const clip_t *c)
+{
+    return __atomic_load_n(&c->loaded, __ATOMIC_ACQUIRE);
+}
+
+static void loader_task(void *params)
+{
+    uint32_t start = millis();
+    for (int i = 0; i < clip_count; i++) {
+        if (clips[i].preload) {
+            clip_cache_load(i);
+        }
+    }
+    Serial.printf("Clip cache: %lu of %lu clips loaded, %lu KB, slowest %lu ms, %lu ms in all\n",
+                  (unsigned long)stats.loaded, (unsigned long)clip_count, (unsigned long)(stats.bytes / 1024),
+                  (unsigned long)stats.load_ms_max, (unsigned long)(millis() - start));
+
+    uint8_t id;
+    while (1) {
+        if (xQueueReceive(requests, &id, portMAX_DELAY) == pdTRUE) {
+            clip_cache_load(id);
+        }
+    }
+}
+
+bool clip_cache_begin(fs::FS *sd, SemaphoreHandle_t bus, fs::FS *flash, bool task)
+{
+    clip_sd = sd;
+    clip_bus = bus;
+    clip_flash = flash;
+    if (!decoder_lock && !(decoder_lock = xSemaphoreCreateMutex())) {
+        return false;
+    }
+    if (!task || loader_handle) {
+        return true;
+    }
+    requests = xQueueCreate(CLIP_CACHE_MAX, sizeof(uint8_t));
+    if (!requests ||
+            xTaskCreate(loader_task, "clips", CLIP_TASK_STACK, NULL, CLIP_TASK_PRIORITY, &loader_handle) != pdPASS) {
+        loader_handle = NULL;
+        return false;
+    }
+    return true;
+}
+
+static clip_t *new_clip(const char *name)
+{
+    if (clip_count >= CLIP_CACHE_MAX || clip_cache_find(name) >= 0) {
+        return NULL;
+    }
+    clip_t *c = &clips[clip_count];
+    memset(c, 0, sizeof(*c));
+    strlcpy(c->name, name, sizeof(c->name));
+    return c;
+}
+
+int clip_cache_add(const char *name, const char *path, bool preload)
+{
+    clip_t *c = new_clip(name);
+    if (!c) {
+        return -1;
+    }
+    c->path = path;
+    c->preload = preload;
+    stats.clips = ++clip_count;
+    return clip_count - 1;
+}
+
+int clip_cache_add_siren(const char *name, uint16_t lo_hz, uint16_t hi_hz, uint16_t period_ms,
+                         uint32_t length_ms, int16_t amplitude)
+{
+    uint32_t frames = (uint64_t)length_ms * CLIP_SAMPLE_RATE / 1000;
+    clip_t *c = new_clip(name);
+    if (!c || !frames || period_ms == 0 || stats.bytes + frames * sizeof(int16_t) > CLIP_CACHE_BYTES_MAX) {
+        return -1;
+    }
+    c->pcm = (int16_t *)ps_malloc(frames * sizeof(int16_t));
+    if (!c->pcm) {
+        return -1;
+    }
+
+    // Triangle sweep lo -> hi -> lo every period, phase kept continuous
+    uint32_t period = (uint32_t)period_ms * CLIP_SAMPLE_RATE / 1000;
+    float phase = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        uint32_t t = i % period;
+        float sweep = t < period / 2 ? (float)t / (period / 2) : (float)(period - t) / (period - period / 2);
+        phase += 2 * (float)PI * (lo_hz + (hi_hz - lo_hz) * sweep) / CLIP_SAMPLE_RATE;
+        if (phase > 2 * (float)PI) {
+            phase -= 2 * (float)PI;
+        }
+        uint32_t edge = i < frames - i ? i : frames - i;
+        float fade = edge < CLIP_FADE_FRAMES ? (float)edge / CLIP_FADE_FRAMES : 1.0f;
+        c->pcm[i] = (int16_t)(amplitude * fade * sinf(phase));
+    }
+    c->frames = frames;
+    c->source_rate = CLIP_SAMPLE_RATE;
+    stats.bytes += frames * sizeof(int16_t);
+    stats.loaded++;
+    __atomic_store_n(&c->loaded, true, __ATOMIC_RELEASE);
+    stats.clips = ++clip_count;
+    return clip_count - 1;
+}
+
+int clip_cache_find(const char *name)
+{
+    for (int i = 0; i < clip_count; i++) {
+        if (strcmp(clips[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Whole file into PSRAM, SD first with the bus taken per chunk, then flash
+static uint8_t *read_file(const char *path, size_t *len)
+{
+    fs::FS *fs = NULL;
+    File file;
+    if (clip_sd && bus_take()) {
+        if (clip_sd->exists(path)) {
+            file = clip_sd->open(path, FILE_READ);
+            fs = clip_sd;
+        }
+        bus_give();
+    }
+    if (!file && clip_flash && clip_flash->exists(path)) {
+        file = clip_flash->open(path, FILE_READ);
+        fs = clip_flash;
+    }
+    if (!file) {
+        return NULL;
+    }
+    bool shared = fs == clip_sd;
+    size_t size = file.size();
+    uint8_t *data = size && size <= CLIP_FILE_MAX ? (uint8_t *)ps_malloc(size) : NULL;
+    for (size_t pos = 0; data && pos < size;) {
+        size_t n = size - pos < CLIP_READ_CHUNK ? size - pos : CLIP_READ_CHUNK;
+        if (shared && !bus_take()) {
+            free(data);
+            data = NULL;
+            break;
+        }
+        bool ok = file.read(data + pos, n) == n;
+        if (shared) {
+            bus_give();
+        }
+        if (!ok) {
+            free(data);
+            data = NULL;
+        }
+        pos += n;
+    }
+    if (!shared || bus_take()) {
+        file.close();
+        if (shared) {
+            bus_give();
+        }
+    }
+    *len = size;
+    return data;
+}
+
+// Append mono frames, stereo is averaged down
+static bool pcm_push(pcm_buf_t *b, const int16_t *in, uint32_t frames, uint8_t channels)
+{
+    if (b->frames + frames > b->capacity) {
+        uint32_t capacity = b->capacity ? b->capacity * 2 : CLIP_GROW_FRAMES;
+        while (capacity < b->frames + frames) {
+            capacity *= 2;
+        }
+        if (stats.bytes + b->frames * sizeof(int16_t) + frames * sizeof(int16_t) > CLIP_CACHE_BYTES_MAX) {
+            return false;
+        }
+        int16_t *pcm = (int16_t *)ps_realloc(b->pcm, capacity * sizeof(int16_t));
+        if (!pcm) {
+            return false;
+        }
+        b->pcm = pcm;
+        b->capacity = capacity;
+    }
+    int16_t *out = b->pcm + b->frames;
+    if (channels == 1) {
+        memcpy(out, in, frames * sizeof(int16_t));
+    } else {
+        for (uint32_t i = 0; i < frames; i++, in += channels) {
+            out[i] = (int16_t)((in[0] + in[1]) >> 1);
+        }
+    }
+    b->frames += frames;
+    return true;
+}
+
+static inline uint16_t rd16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t rd32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool decode_wav(const uint8_t *data, size_t len, pcm_buf_t *out, uint32_t *rate)
+{
+    if (len < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    uint16_t format = 0, channels = 0, bits = 0;
+    for (size_t pos = 12; pos + 8 <= len;) {
+        uint32_t size = rd32(data + pos + 4);
+        const uint8_t *body = data + pos + 8;
+        if (memcmp(data + pos, "fmt ", 4) == 0 && size >= 16 && pos + 8 + 16 <= len) {
+            format = rd16(body);
+            channels = rd16(body + 2);
+            *rate = rd32(body + 4);
+            bits = rd16(body + 14);
+        } else if (memcmp(data + pos, "data", 4) == 0) {
+            // 16 bit PCM only, samples are read in place and must be aligned
+            if (format != 1 || bits != 16 || channels < 1 || channels > 2 || !*rate || ((uintptr_t)body & 1)) {
+                return false;
+            }
+            size_t avail = len - pos - 8 < size ? len - pos - 8 : size;
+            uint32_t frames = avail / (2 * channels);
+            return frames && pcm_push(out, (const int16_t *)body, frames, channels);
+        }
+        pos += 8 + size + (size & 1);
+    }
+    return false;
+}
+
+// Xing or Info tag right after the side information of the first frame,
+// 17 bytes for MPEG-1 mono and 32 for stereo
+static bool is_vbr_tag(const uint8_t *frame)
+{
+    const uint8_t *tag = frame + 4 + ((frame[3] >> 6) == 3 ? 17 : 32);
+    return memcmp(tag, "Xing", 4) == 0 || memcmp(tag, "Info", 4) == 0;
+}
+
+bool clip_cache_decoder_take(TickType_t wait)
+{
+    return !decoder_lock || xSemaphoreTake(decoder_lock, wait) == pdTRUE;
+}
+
+void clip_cache_decoder_give(void)
+{
+    if (decoder_lock) {
+        xSemaphoreGive(decoder_lock);
+    }
+}
+
+static bool decode_mp3(uint8_t *data, size_t len, pcm_buf_t *out, uint32_t *rate)
+{
+    static int16_t frame[CLIP_MP3_FRAME_SAMPLES];
+    size_t pos = 0;
+    if (len > 10 && memcmp(data, "ID3", 3) == 0) {
+        pos = 10 + ((data[6] & 0x7f) << 21 | (data[7] & 0x7f) << 14 | (data[8] & 0x7f) << 7 | (data[9] & 0x7f));
+        if (data[5] & 0x10) {
+            pos += 10;                  // Footer
+        }
+    }
+    if (!clip_cache_decoder_take(portMAX_DELAY)) {
+        return false;
+    }
+    if (!MP3Decoder_AllocateBuffers()) {
+        clip_cache_decoder_give();
+        return false;
+    }
+    bool ok = true;
+    uint32_t decoded = 0;
+    bool first = true;
+    while (pos < len) {
+        int sync = MP3FindSyncWord(data + pos, len - pos);
+        if (sync < 0) {
+            break;
+        }
+        pos += sync;
+        int left = len - pos;
+        int err = MP3Decode(data + pos, &left, frame, 0);
+        size_t used = len - pos - left;
+        if (err == ERR_MP3_NONE && first && used > 40 && is_vbr_tag(data + pos)) {
+            // A VBR header frame decodes to 26 ms of silence ahead of the prompt
+        } else if (err == ERR_MP3_NONE) {
+            int channels = MP3GetChannels();
+            if (!*rate) {
+                *rate = MP3GetSampRate();
+            }
+            if (channels < 1 || channels > 2 || !pcm_push(out, frame, MP3GetOutputSamps() / channels, channels)) {
+                ok = false;
+                break;
+            }
+            decoded++;
+        } else if (err == ERR_MP3_INDATA_UNDERFLOW) {
+            break;                      // Truncated last frame
+        }
+        // The bit reservoir is still filling on the first frames
+        // (MAINDATA_UNDERFLOW), other errors were a false sync
+        pos += used ? used : 2;
+        first = false;
+    }
+    MP3Decoder_FreeBuffers();
+    clip_cache_decoder_give();
+    return ok && decoded;
+}
+
+// Linear interpolation to CLIP_SAMPLE_RATE, replaces the buffer
+static bool resample(pcm_buf_t *b, uint32_t rate)
+{
+    // Up to the last input sample, nothing past it to interpolate toward
+    uint32_t frames = b->frames > 1 ? (uint64_t)(b->frames - 1) * CLIP_SAMPLE_RATE / rate + 1 : 0;
+    if (!frames || stats.bytes + (b->frames + frames) * sizeof(int16_t) > CLIP_CACHE_BYTES_MAX) {
+        return false;
+    }
+    int16_t *out = (int16_t *)ps_malloc(frames * sizeof(int16_t));
+    if (!out) {
+        return false;
+    }
+    // Q32 position, a Q16 step drifts by a tenth of a sample per second
+    uint64_t step = ((uint64_t)rate << 32) / CLIP_SAMPLE_RATE;
+    uint64_t pos = 0;
+    for (uint32_t i = 0; i < frames; i++, pos += step) {
+        uint32_t index = pos >> 32;
+        int32_t frac = (pos >> 16) & 0xFFFF;
+        int32_t a = b->pcm[index];
+        int32_t c = index + 1 < b->frames ? b->pcm[index + 1] : a;
+        out[i] = (int16_t)(a + (((c - a) * frac) >> 16));
+    }
+    free(b->pcm);
+    b->pcm = out;
+    b->frames = b->capacity = frames;
+    return true;
+}
+
+bool clip_cache_load(int id)
+{
+    if (id < 0 || id >= clip_count) {
+        return false;
+    }
+    clip_t *c = &clips[id];
+    if (clip_loaded(c) || c->failed) {
+        return clip_loaded(c);
+    }
+
+    uint32_t start = millis();
+    size_t len = 0;
+    uint8_t *data = c->path ? read_file(c->path, &len) : NULL;
+    pcm_buf_t pcm = {};
+    uint32_t rate = 0;
+    bool ok = data && (decode_wav(data, len, &pcm, &rate) || decode_mp3(data, len, &pcm, &rate));
+    free(data);
+    if (ok && rate != CLIP_SAMPLE_RATE) {
+        ok = resample(&pcm, rate);
+    }
+    if (ok && pcm.capacity > pcm.frames) {
+        int16_t *fit = (int16_t *)ps_realloc(pcm.pcm, pcm.frames * sizeof(int16_t));
+        pcm.pcm = fit ? fit : pcm.pcm;
+    }
+    if (!ok) {
+        free(pcm.pcm);
+        c->failed = true;
+        Serial.printf("Clip cache: %s not loaded\n", c->path ? c->path : c->name);
+        return false;
+    }
+
+    c->pcm = pcm.pcm;
+    c->frames = pcm.frames;
+    c->source_rate = rate;
+    __atomic_store_n(&c->loaded, true, __ATOMIC_RELEASE);
+    uint32_t elapsed = millis() - start;
+    stats.loads++;
+    stats.loaded++;
+    stats.bytes += pcm.frames * sizeof(int16_t);
+    if (elapsed > stats.load_ms_max) {
+        stats.load_ms_max = elapsed;
+    }
+    return true;
+}
+
+bool clip_cache_request(int id)
+{
+    if (id < 0 || id >= clip_count) {
+        return false;
+    }
+    clip_t *c = &clips[id];
+    if (clip_loaded(c) || c->failed) {
+        return clip_loaded(c);
+    }
+    if (!loader_handle) {
+        __atomic_fetch_add(&stats.lazy_loads, 1, __ATOMIC_RELAXED);
+        return clip_cache_load(id);
+    }
+    // Once per clip, the queue holds every clip there is
+    bool expected = false;
+    if (__atomic_compare_exchange_n(&c->requested, &expected, true, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        uint8_t request = id;
+        xQueueSend(requests, &request, 0);
+        __atomic_fetch_add(&stats.lazy_loads, 1, __ATOMIC_RELAXED);
+    }
+    return false;
+}
+
+const int16_t *clip_cache_pcm(int id, uint32_t *frames)
+{
+    if (id < 0 || id >= clip_count || !clip_loaded(&clips[id])) {
+        return NULL;
+    }
+    *frames = clips[id].frames;
+    return clips[id].pcm;
+}
+
+bool clip_cache_failed(int id)
+{
+    return id < 0 || id >= clip_count || clips[id].failed;
+}
+
+
+bool clip_cache_info(int id, clip_info_t *info)
+{
+    if (id < 0 || id >= clip_count) {
+        return false;
+    }
+    const clip_t *c = &clips[id];
+    info->name = c->name;
+    info->loaded = clip_loaded(c);
+    info->frames = info->loaded ? c->frames : 0;
+    info->source_rate = c->source_rate;
+    info->failed = c->failed;
+    return true;
+}
+
+void clip_cache_get_stats(clip_cache_stats_t *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file      clip_cache.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Alarm and voice prompts decoded to PCM ahead of time.
+ *
+ * Each clip is a file on SD or SPIFFS (MP3 or 16 bit PCM WAV), or a siren
+ * synthesized at registration. A clip is decoded once into PSRAM, as mono
+ * 16 bit at CLIP_SAMPLE_RATE: clips marked preload when the loader task
+ * starts, the others when first requested. Playing a cached clip is then a
+ * copy out of PSRAM with nothing to open, parse or decode; the mixer
+ * (audio_mixer.h) does the playing.
+ *
+ * Decoding uses the MP3 decoder of the Audio library, whose state is
+ * global. The loader holds clip_cache_decoder_take() while it decodes, and
+ * whoever plays through Audio holds it from connecttoFS() until the song
+ * has ended or been stopped, so the two never share the decoder.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+#define CLIP_CACHE_MAX          8
+#define CLIP_NAME_MAX           16
+#define CLIP_SAMPLE_RATE        44100
+#define CLIP_FILE_MAX           (512 * 1024)    // Largest compressed clip read into PSRAM
+#define CLIP_CACHE_BYTES_MAX    (3 * 1024 * 1024) // PSRAM for all decoded clips
+#define CLIP_READ_CHUNK         4096            // SD bus held for one chunk at a time
+#define CLIP_TASK_PRIORITY      1               // Loads in the background
+#define CLIP_TASK_STACK         (6 * 1024)      // MP3 decode runs on it
+
+typedef struct {
+    const char *name;
+    uint32_t    frames;                 // At CLIP_SAMPLE_RATE, 0 until loaded
+    uint32_t    source_rate;
+    bool        loaded;
+    bool        failed;                 // Missing or undecodable, not retried
+} clip_info_t;
+
+typedef struct {
+    uint32_t clips;                     // Registered
+    uint32_t loaded;
+    uint32_t bytes;                     // PSRAM held by decoded clips
+    uint32_t loads;
+    uint32_t lazy_loads;                // Requested before they were loaded
+    uint32_t load_ms_max;
+} clip_cache_stats_t;
+
+// Files are looked up on `sd` (SPI bus guarded by `bus`, NULL when not
+// shared) and then on `flash`. With `task` the loader task starts and
+// loads the preload clips, then the requested ones; without it requests
+// load at once on the caller, as in the unit tests.
+bool clip_cache_begin(fs::FS *sd, SemaphoreHandle_t bus, fs::FS *flash, bool task);
+
+// Register a file clip, `path` is absolute on the file systems above.
+// Returns the clip id or -1 when the table is full.
+int clip_cache_add(const char *name, const char *path, bool preload);
+
+// Register a siren sweeping between `lo_hz` and `hi_hz` and back every
+// `period_ms`, `length_ms` long, synthesized straight into the cache
+int clip_cache_add_siren(const char *name, uint16_t lo_hz, uint16_t hi_hz, uint16_t period_ms,
+                         uint32_t length_ms, int16_t amplitude);
+
+int clip_cache_find(const char *name);
+
+// Decode now if not loaded yet, on the caller's task; only one task may
+// load at a time. Returns false when the clip cannot be loaded.
+bool clip_cache_load(int id);
+
+// Any task, never blocks: true when loaded, else the loader task is asked
+// for it once and clip_cache_pcm() has it later
+bool clip_cache_request(int id);
+
+// The decoded samples, NULL until loaded. They stay put once loaded.
+const int16_t *clip_cache_pcm(int id, uint32_t *frames);
+
+// Unknown, missing or undecodable, never comes
+bool clip_cache_failed(int id);
+
+// The Audio library's MP3 decoder, see above. NULL-safe before
+// clip_cache_begin().
+bool clip_cache_decoder_take(TickType_t wait);
+void clip_cache_decoder_give(void);
+
+bool clip_cache_info(int id, clip_info_t *info);
+void clip_cache_get_stats(clip_cache_stats_t *stats);
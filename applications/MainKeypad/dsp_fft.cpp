@@ -0,0 +1,87 @@
+/**
+ * @file      dsp_fft.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "dsp_fft.h"
+#include <math.h>
+
+#if defined(ESP_PLATFORM) && __has_include(<esp_dsp.h>)
+#include <esp_dsp.h>
+#define DSP_FFT_ESP_DSP
+#endif
+
+static portMUX_TYPE fft_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool         fft_ready = false;
+#ifndef DSP_FFT_ESP_DSP
+static float        twiddle[DSP_FFT_SIZE_MAX];      // cos, -sin of the first half turn
+#endif
+
+bool dsp_fft_init(void)
+{
+    portENTER_CRITICAL(&fft_mux);
+    bool ready = fft_ready;
+    portEXIT_CRITICAL(&fft_mux);
+    if (ready) {
+        return true;
+    }
+#ifdef DSP_FFT_ESP_DSP
+    // The table is esp-dsp's own, shared with any other user of the library
+    esp_err_t err = dsps_fft2r_init_fc32(NULL, DSP_FFT_SIZE_MAX);
+    if (err != ESP_OK && err != ESP_ERR_DSP_REINITIALIZED) {
+        return false;
+    }
+#else
+    // Two tasks racing here write the same values
+    for (int k = 0; k < DSP_FFT_SIZE_MAX / 2; k++) {
+        twiddle[2 * k] = cosf(2.0f * (float)M_PI * k / DSP_FFT_SIZE_MAX);
+        twiddle[2 * k + 1] = -sinf(2.0f * (float)M_PI * k / DSP_FFT_SIZE_MAX);
+    }
+#endif
+    portENTER_CRITICAL(&fft_mux);
+    fft_ready = true;
+    portEXIT_CRITICAL(&fft_mux);
+    return true;
+}
+
+void dsp_fft(float *data, int n)
+{
+#ifdef DSP_FFT_ESP_DSP
+    dsps_fft2r_fc32(data, n);
+    dsps_bit_rev_fc32(data, n);
+#else
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float re = data[2 * i], im = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = re;
+            data[2 * j + 1] = im;
+        }
+    }
+    for (int len = 2; len <= n; len <<= 1) {
+        int step = DSP_FFT_SIZE_MAX / len;
+        for (int i = 0; i < n; i += len) {
+            for (int k = 0; k < len / 2; k++) {
+                float wr = twiddle[2 * k * step], wi = twiddle[2 * k * step + 1];
+                float *a = &data[2 * (i + k)], *b = &data[2 * (i + k + len / 2)];
+                float tr = b[0] * wr - b[1] * wi;
+                float ti = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+#endif
+}
@@ -0,0 +1,30 @@
+/**
+ * @file      dsp_fft.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Complex FFT shared by the microphone analysis modules.
+ *
+ * With esp-dsp in the build this is dsps_fft2r_fc32() followed by the bit
+ * reversal, on the library's twiddle table. Without it (host builds) a
+ * plain radix-2 FFT runs on a table of its own. Either way there is one
+ * table, sized for DSP_FFT_SIZE_MAX, and every smaller power of two reads
+ * it with a stride.
+ *
+ * dsp_fft_init() may be called by every user and from any task; the table
+ * is only written once.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define DSP_FFT_SIZE_MAX            512
+
+bool dsp_fft_init(void);
+
+// In place complex FFT of `n` points, a power of two up to
+// DSP_FFT_SIZE_MAX, interleaved re, im, natural order out
+void dsp_fft(float *data, int n);
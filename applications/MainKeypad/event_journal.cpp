@@ -0,0 +1,559 @@
+/**
+ * @file      event_journal.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "event_journal.h"
+#include "utilities.h"
+#include <time.h>
+
+// SPI bus mutex shared with the display and the radio (UnitTest.ino)
+extern SemaphoreHandle_t xSemaphore;
+
+#define JOURNAL_WRITER_STACK        (4 * 1024)
+#define JOURNAL_WRITER_PRIORITY     2       // Below radio, audio and LVGL
+#define JOURNAL_SPI_TIMEOUT_MS      20
+#define JOURNAL_END_TIMEOUT_MS      500     // Shutdown gives up the final flush after this
+#define JOURNAL_VALID_EPOCH         1600000000UL
+
+static fs::FS           *journal_fs = nullptr;
+static File             tail_file;
+static File             spare_file;         // Next segment, zero-filled ahead of use
+static File             index_file;         // Block index of the tail segment
+static journal_block_index_t block_acc;     // Summary of the tail's incomplete block
+static uint32_t         head_segment = 0;
+static uint32_t         tail_segment = 0;
+static uint32_t         tail_records = 0;
+
+static journal_record_t *ring = nullptr;
+static uint32_t         ring_write = 0;     // Free running, masked on access
+static uint32_t         ring_read = 0;
+static uint32_t         next_seq = 0;
+static portMUX_TYPE     ring_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t     writer_handle = NULL;
+static volatile bool    writer_stop = false;
+static journal_stats_t  stats = {0};
+
+static_assert(sizeof(journal_record_t) == JOURNAL_RECORD_SIZE, "journal record layout changed");
+static_assert(sizeof(journal_block_index_t) == 32, "journal index layout changed");
+static_assert((JOURNAL_RING_RECORDS & (JOURNAL_RING_RECORDS - 1)) == 0, "ring size must be a power of two");
+
+// Standard CRC-32 (IEEE 802.3), nibble table to keep the flash footprint small
+uint32_t journal_crc32(const void *data, size_t len)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFF;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+void journal_record_seal(journal_record_t *rec)
+{
+    rec->magic = JOURNAL_RECORD_MAGIC;
+    rec->crc = journal_crc32(rec, offsetof(journal_record_t, crc));
+}
+
+bool journal_record_valid(const journal_record_t *rec)
+{
+    return rec->magic == JOURNAL_RECORD_MAGIC &&
+           rec->type > JOURNAL_EVT_NONE && rec->type < JOURNAL_EVT_MAX &&
+           rec->crc == journal_crc32(rec, offsetof(journal_record_t, crc));
+}
+
+void journal_segment_path(uint32_t segment, char *path, size_t size)
+{
+    snprintf(path, size, JOURNAL_DIR "/%08lu.jnl", (unsigned long)segment);
+}
+
+void journal_index_path(uint32_t segment, char *path, size_t size)
+{
+    snprintf(path, size, JOURNAL_DIR "/%08lu.idx", (unsigned long)segment);
+}
+
+static inline uint32_t node_hash(uint32_t node_id)
+{
+    return node_id * 0x9E3779B1u;   // Fibonacci hashing, top bits are well mixed
+}
+
+void journal_block_index_reset(journal_block_index_t *entry)
+{
+    memset(entry, 0, sizeof(*entry));
+    entry->min_ts = UINT32_MAX;
+}
+
+void journal_block_index_add(journal_block_index_t *entry, const journal_record_t *rec)
+{
+    uint32_t h = node_hash(rec->node_id);
+    entry->min_ts = min(entry->min_ts, rec->timestamp);
+    entry->max_ts = max(entry->max_ts, rec->timestamp);
+    entry->zone_mask |= 1UL << (rec->zone & 31);
+    entry->type_mask |= 1U << (rec->type & 15);
+    entry->flags |= rec->flags & JOURNAL_FLAG_UPTIME;
+    entry->node_bloom[(h >> 30) & 3] |= 1UL << ((h >> 25) & 31);
+    entry->node_bloom[(h >> 23) & 3] |= 1UL << ((h >> 18) & 31);
+    entry->count++;
+}
+
+bool journal_block_index_may_contain_node(const journal_block_index_t *entry, uint32_t node_id)
+{
+    uint32_t h = node_hash(node_id);
+    return (entry->node_bloom[(h >> 30) & 3] & (1UL << ((h >> 25) & 31))) &&
+           (entry->node_bloom[(h >> 23) & 3] & (1UL << ((h >> 18) & 31)));
+}
+
+static inline void spi_deselect_all()
+{
+    digitalWrite(BOARD_SDCARD_CS, HIGH);
+    digitalWrite(RADIO_CS_PIN, HIGH);
+    digitalWrite(BOARD_TFT_CS, HIGH);
+}
+
+static bool read_record(File &file, uint32_t index, journal_record_t *rec)
+{
+    if (!file.seek(index * JOURNAL_RECORD_SIZE)) {
+        return false;
+    }
+    return file.read((uint8_t *)rec, JOURNAL_RECORD_SIZE) == JOURNAL_RECORD_SIZE;
+}
+
+// Records are written strictly in order over a zero-filled file, so "slot is
+// written" is a prefix property and the end can be found by bisection. Torn
+// records at the end are then stepped over backwards with a full CRC check.
+static uint32_t find_segment_end(File &file, uint32_t *last_seq)
+{
+    journal_record_t rec;
+    uint32_t lo = 0;
+    uint32_t hi = file.size() / JOURNAL_RECORD_SIZE;
+    if (hi > JOURNAL_SEGMENT_RECORDS) {
+        hi = JOURNAL_SEGMENT_RECORDS;
+    }
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (read_record(file, mid, &rec) && rec.magic == JOURNAL_RECORD_MAGIC) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    while (lo > 0) {
+        if (read_record(file, lo - 1, &rec) && journal_record_valid(&rec)) {
+            *last_seq = rec.seq;
+            break;
+        }
+        lo--;
+    }
+    return lo;
+}
+
+static bool open_file(File &file, const char *path, bool create)
+{
+    if (!journal_fs->exists(path)) {
+        if (!create) {
+            return false;
+        }
+        File f = journal_fs->open(path, FILE_WRITE);
+        if (!f) {
+            return false;
+        }
+        f.close();
+    }
+    file = journal_fs->open(path, "r+");
+    return (bool)file;
+}
+
+static bool open_segment(File &file, uint32_t segment, bool create)
+{
+    char path[32];
+    journal_segment_path(segment, path, sizeof(path));
+    return open_file(file, path, create);
+}
+
+static bool write_index_entry(uint32_t block, const journal_block_index_t *entry)
+{
+    return index_file.seek(block * sizeof(*entry)) &&
+           index_file.write((const uint8_t *)entry, sizeof(*entry)) == sizeof(*entry);
+}
+
+// Bring the tail's block index up to date after a reboot: entries for
+// complete blocks the previous run did not get to are rebuilt, and the
+// incomplete last block is summarised back into block_acc.
+static bool recover_index(void)
+{
+    char path[32];
+    journal_index_path(tail_segment, path, sizeof(path));
+    if (!open_file(index_file, path, true)) {
+        return false;
+    }
+    uint32_t complete = tail_records / JOURNAL_BLOCK_RECORDS;
+    uint32_t indexed = index_file.size() / sizeof(journal_block_index_t);
+    journal_record_t rec;
+    for (uint32_t block = min(indexed, complete); block <= complete; block++) {
+        uint32_t first = block * JOURNAL_BLOCK_RECORDS;
+        uint32_t last = min(first + JOURNAL_BLOCK_RECORDS, tail_records);
+        journal_block_index_reset(&block_acc);
+        for (uint32_t i = first; i < last; i++) {
+            if (read_record(tail_file, i, &rec)) {
+                journal_block_index_add(&block_acc, &rec);
+            }
+        }
+        if (block < complete && !write_index_entry(block, &block_acc)) {
+            return false;
+        }
+    }
+    if (tail_records % JOURNAL_BLOCK_RECORDS == 0) {
+        journal_block_index_reset(&block_acc);
+    }
+    index_file.flush();
+    return true;
+}
+
+static bool recover(void)
+{
+    File dir = journal_fs->open(JOURNAL_DIR);
+    if (!dir || !dir.isDirectory()) {
+        journal_fs->mkdir(JOURNAL_DIR);
+        dir = journal_fs->open(JOURNAL_DIR);
+        if (!dir) {
+            return false;
+        }
+    }
+
+    bool found = false;
+    uint32_t lowest = UINT32_MAX, highest = 0;
+    File entry = dir.openNextFile();
+    while (entry) {
+        const char *name = entry.name();
+        const char *slash = strrchr(name, '/');
+        name = slash ? slash + 1 : name;
+        char *end = NULL;
+        uint32_t n = strtoul(name, &end, 10);
+        if (end != name && strcmp(end, ".jnl") == 0) {
+            lowest = min(lowest, n);
+            highest = max(highest, n);
+            found = true;
+        }
+        entry = dir.openNextFile();
+    }
+    dir.close();
+
+    uint32_t last_seq = UINT32_MAX;
+    if (!found) {
+        head_segment = tail_segment = 0;
+        tail_records = 0;
+        next_seq = 0;
+        return open_segment(tail_file, tail_segment, true) && recover_index();
+    }
+
+    head_segment = lowest;
+    tail_segment = highest;
+    if (!open_segment(tail_file, tail_segment, false)) {
+        return false;
+    }
+    tail_records = find_segment_end(tail_file, &last_seq);
+
+    // The highest file may be the zero-filled spare of a previous run
+    if (tail_records == 0 && tail_segment > head_segment) {
+        spare_file = tail_file;
+        tail_segment--;
+        if (!open_segment(tail_file, tail_segment, false)) {
+            return false;
+        }
+        tail_records = find_segment_end(tail_file, &last_seq);
+    }
+    next_seq = (last_seq == UINT32_MAX) ? 0 : last_seq + 1;
+    return recover_index();
+}
+
+static bool roll_segment(void)
+{
+    char path[32];
+    tail_file.close();
+    index_file.close();
+    tail_segment++;
+    tail_records = 0;
+    journal_block_index_reset(&block_acc);
+
+    if (spare_file) {
+        tail_file = spare_file;
+        spare_file = File();
+    } else if (!open_segment(tail_file, tail_segment, true)) {
+        return false;
+    }
+    journal_index_path(tail_segment, path, sizeof(path));
+    if (!open_file(index_file, path, true)) {
+        return false;
+    }
+
+    while (tail_segment - head_segment + 1 > JOURNAL_MAX_SEGMENTS) {
+        journal_segment_path(head_segment, path, sizeof(path));
+        journal_fs->remove(path);
+        journal_index_path(head_segment, path, sizeof(path));
+        journal_fs->remove(path);
+        head_segment++;
+    }
+    return true;
+}
+
+// Write up to `count` ring records starting at `first`; returns records written
+static uint32_t write_run(uint32_t first, uint32_t count)
+{
+    uint32_t done = 0;
+    while (done < count) {
+        if (tail_records >= JOURNAL_SEGMENT_RECORDS && !roll_segment()) {
+            break;
+        }
+        uint32_t index = (first + done) & (JOURNAL_RING_RECORDS - 1);
+        uint32_t n = count - done;
+        n = min(n, (uint32_t)(JOURNAL_RING_RECORDS - index));         // Stop at the ring wrap
+        n = min(n, (uint32_t)(JOURNAL_SEGMENT_RECORDS - tail_records)); // Stop at the segment end
+        if (!tail_file.seek(tail_records * JOURNAL_RECORD_SIZE)) {
+            break;
+        }
+        size_t bytes = n * JOURNAL_RECORD_SIZE;
+        if (tail_file.write((const uint8_t *)&ring[index], bytes) != bytes) {
+            break;
+        }
+        // Summarise the records into the block index, one entry per full block
+        for (uint32_t i = 0; i < n; i++) {
+            journal_block_index_add(&block_acc, &ring[index + i]);
+            if (++tail_records % JOURNAL_BLOCK_RECORDS == 0) {
+                write_index_entry(tail_records / JOURNAL_BLOCK_RECORDS - 1, &block_acc);
+                journal_block_index_reset(&block_acc);
+            }
+        }
+        done += n;
+    }
+    return done;
+}
+
+static void commit(void)
+{
+    portENTER_CRITICAL(&ring_mux);
+    uint32_t first = ring_read;
+    uint32_t count = ring_write - ring_read;
+    portEXIT_CRITICAL(&ring_mux);
+
+    if (count == 0 || !tail_file) {
+        return;
+    }
+    if (xSemaphoreTake(xSemaphore, pdMS_TO_TICKS(JOURNAL_SPI_TIMEOUT_MS)) != pdTRUE) {
+        return;     // Bus busy, records stay in the ring until the next pass
+    }
+    uint32_t start = micros();
+    spi_deselect_all();
+    uint32_t written = write_run(first, count);
+    tail_file.flush();
+    index_file.flush();
+    uint32_t elapsed = micros() - start;
+    xSemaphoreGive(xSemaphore);
+
+    portENTER_CRITICAL(&ring_mux);
+    ring_read += written;
+    portEXIT_CRITICAL(&ring_mux);
+
+    stats.committed += written;
+    stats.commits++;
+    stats.max_commit_us = max(stats.max_commit_us, elapsed);
+}
+
+// Zero-fill the current tail up to full size, then the spare segment.
+// Returns true while there is more to do.
+static bool prealloc_step(void)
+{
+    static uint8_t zeros[JOURNAL_PREALLOC_CHUNK];
+
+    File *target = &tail_file;
+    if (tail_file.size() >= JOURNAL_SEGMENT_SIZE) {
+        if (!spare_file && !open_segment(spare_file, tail_segment + 1, true)) {
+            return false;
+        }
+        target = &spare_file;
+    }
+    size_t size = target->size();
+    if (size >= JOURNAL_SEGMENT_SIZE) {
+        return false;
+    }
+    if (xSemaphoreTake(xSemaphore, pdMS_TO_TICKS(JOURNAL_SPI_TIMEOUT_MS)) != pdTRUE) {
+        return true;
+    }
+    spi_deselect_all();
+    size_t n = min((size_t)JOURNAL_PREALLOC_CHUNK, (size_t)(JOURNAL_SEGMENT_SIZE - size));
+    bool ok = target->seek(size) && target->write(zeros, n) == n;
+    target->flush();
+    xSemaphoreGive(xSemaphore);
+    return ok;
+}
+
+static void journal_writer_task(void *params)
+{
+    bool prealloc_pending = true;
+    while (!writer_stop) {
+        TickType_t wait = prealloc_pending ? pdMS_TO_TICKS(5) : pdMS_TO_TICKS(JOURNAL_COMMIT_INTERVAL_MS);
+        ulTaskNotifyTake(pdTRUE, wait);
+        commit();
+
+        // Only spend idle passes on preallocation so commits stay prompt
+        portENTER_CRITICAL(&ring_mux);
+        bool idle = (ring_write == ring_read);
+        portEXIT_CRITICAL(&ring_mux);
+        if (idle || !prealloc_pending) {
+            prealloc_pending = prealloc_step();
+        }
+    }
+    commit();
+    writer_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+bool journal_begin(fs::FS &fs)
+{
+    if (stats.ready) {
+        return true;
+    }
+    journal_fs = &fs;
+    if (!ring) {
+        ring = (journal_record_t *)ps_malloc(JOURNAL_RING_RECORDS * sizeof(journal_record_t));
+        if (!ring) {
+            Serial.println("Journal ring allocation failed!");
+            return false;
+        }
+    }
+
+    if (xSemaphoreTake(xSemaphore, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+    spi_deselect_all();
+    uint32_t start = millis();
+    bool ok = recover();
+    xSemaphoreGive(xSemaphore);
+
+    if (!ok) {
+        Serial.println("Journal recovery failed, journal disabled");
+        return false;
+    }
+    Serial.printf("Journal segments %lu..%lu, tail %lu records, next seq %lu (%lu ms)\n",
+                  head_segment, tail_segment, tail_records, next_seq, millis() - start);
+
+    writer_stop = false;
+    stats.ready = true;
+    xTaskCreate(journal_writer_task, "journal", JOURNAL_WRITER_STACK, NULL, JOURNAL_WRITER_PRIORITY, &writer_handle);
+    journal_append(JOURNAL_EVT_BOOT, 0, 0, NULL, 0);
+    return true;
+}
+
+void journal_end(void)
+{
+    if (!stats.ready) {
+        return;
+    }
+    stats.ready = false;
+    writer_stop = true;
+    if (writer_handle) {
+        xTaskNotifyGive(writer_handle);
+        for (uint32_t ms = 0; writer_handle && ms < JOURNAL_END_TIMEOUT_MS; ms++) {
+            delay(1);
+        }
+    }
+    // Whoever holds the bus may never give it back on the way to sleep, and
+    // a writer still inside commit() owns the files
+    if (writer_handle || xSemaphoreTake(xSemaphore, pdMS_TO_TICKS(JOURNAL_END_TIMEOUT_MS)) != pdTRUE) {
+        portENTER_CRITICAL(&ring_mux);
+        uint32_t pending = ring_write - ring_read;
+        portEXIT_CRITICAL(&ring_mux);
+        Serial.printf("Journal: bus busy at shutdown, %lu records not flushed\n", (unsigned long)pending);
+        return;
+    }
+    tail_file.close();
+    spare_file.close();
+    index_file.close();
+    xSemaphoreGive(xSemaphore);
+}
+
+bool journal_append(journal_event_type_t type, uint32_t node_id, uint8_t zone,
+                    const void *payload, uint8_t len)
+{
+    journal_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = type;
+    rec.zone = zone;
+    rec.node_id = node_id;
+    if (payload && len) {
+        memcpy(rec.payload, payload, min((size_t)len, sizeof(rec.payload)));
+    }
+    time_t now = time(NULL);
+    if (now > (time_t)JOURNAL_VALID_EPOCH) {
+        rec.timestamp = (uint32_t)now;
+    } else {
+        rec.timestamp = millis() / 1000;
+        rec.flags |= JOURNAL_FLAG_UPTIME;
+    }
+
+    bool accepted = false;
+    uint32_t pending = 0;
+    portENTER_CRITICAL(&ring_mux);
+    if (stats.ready && ring_write - ring_read < JOURNAL_RING_RECORDS) {
+        rec.seq = next_seq++;
+        journal_record_seal(&rec);
+        ring[ring_write & (JOURNAL_RING_RECORDS - 1)] = rec;
+        ring_write++;
+        stats.appended++;
+        accepted = true;
+    } else {
+        stats.dropped++;
+    }
+    pending = ring_write - ring_read;
+    portEXIT_CRITICAL(&ring_mux);
+
+    if (accepted && pending >= JOURNAL_COMMIT_BATCH && writer_handle) {
+        xTaskNotifyGive(writer_handle);
+    }
+    return accepted;
+}
+
+bool journal_log_radio(uint32_t node_id, float rssi, float snr, uint16_t node_seq, uint8_t battery)
+{
+    journal_radio_payload_t p;
+    memset(&p, 0, sizeof(p));
+    p.rssi_x10 = (int16_t)lroundf(rssi * 10.0f);
+    p.snr_x10 = (int16_t)lroundf(snr * 10.0f);
+    p.node_seq = node_seq;
+    p.battery = battery;
+    return journal_append(JOURNAL_EVT_RADIO_RX, node_id, 0, &p, sizeof(p));
+}
+
+void journal_flush(void)
+{
+    if (writer_handle) {
+        xTaskNotifyGive(writer_handle);
+    }
+}
+
+void journal_get_stats(journal_stats_t *out)
+{
+    portENTER_CRITICAL(&ring_mux);
+    *out = stats;
+    out->pending = ring_write - ring_read;
+    out->next_seq = next_seq;
+    portEXIT_CRITICAL(&ring_mux);
+    out->head_segment = head_segment;
+    out->tail_segment = tail_segment;
+    out->tail_records = tail_records;
+}
+
+fs::FS *journal_get_fs(void)
+{
+    return stats.ready ? journal_fs : nullptr;
+}
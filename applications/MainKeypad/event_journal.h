@@ -0,0 +1,132 @@
+/**
+ * @file      event_journal.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Append-only, crash-safe event journal on the SD card.
+ *
+ * Events are fixed-size 32 byte records carrying a CRC32. Producers copy a
+ * record into a RAM ring (never touching the SPI bus) and a background
+ * writer task group-commits the ring to preallocated segment files, so a
+ * commit only overwrites sectors of an existing file and never updates the
+ * FAT. On boot only the tail segment is scanned to find the write position.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+// Journal layout
+#define JOURNAL_DIR                 "/journal"
+#define JOURNAL_RECORD_SIZE         32
+#define JOURNAL_SEGMENT_RECORDS     32768                                   // 1 MiB per segment
+#define JOURNAL_SEGMENT_SIZE        (JOURNAL_SEGMENT_RECORDS * JOURNAL_RECORD_SIZE)
+#define JOURNAL_MAX_SEGMENTS        64                                      // Oldest segment is deleted beyond this
+#define JOURNAL_RECORD_MAGIC        0xA5
+
+// Sparse block index written alongside every segment (<segment>.idx): one
+// entry per block of records, so history queries only read matching blocks
+#define JOURNAL_BLOCK_RECORDS       64                                      // 2 KiB of records per entry
+#define JOURNAL_SEGMENT_BLOCKS      (JOURNAL_SEGMENT_RECORDS / JOURNAL_BLOCK_RECORDS)
+
+// Writer tuning: 1024 records buffer ~5 s of events at 200 events/s
+#define JOURNAL_RING_RECORDS        1024
+#define JOURNAL_COMMIT_INTERVAL_MS  250     // Maximum time a record waits in RAM
+#define JOURNAL_COMMIT_BATCH        128     // Commit early once this many records are pending
+#define JOURNAL_PREALLOC_CHUNK      4096    // Bytes of the next segment zero-filled per idle writer pass
+
+// Record flags
+#define JOURNAL_FLAG_UPTIME         0x01    // Timestamp is seconds since boot, wall clock was not set
+
+typedef enum : uint8_t {
+    JOURNAL_EVT_NONE = 0,
+    JOURNAL_EVT_BOOT,
+    JOURNAL_EVT_ALARM,
+    JOURNAL_EVT_ARM,
+    JOURNAL_EVT_DISARM,
+    JOURNAL_EVT_RADIO_RX,           // RSSI/SNR sample of a received packet
+    JOURNAL_EVT_HEARTBEAT,
+    JOURNAL_EVT_TAMPER,
+    JOURNAL_EVT_NODE_LOST,
+    JOURNAL_EVT_MAX,
+} journal_event_type_t;
+
+// On-card record, little endian, exactly JOURNAL_RECORD_SIZE bytes
+typedef struct __attribute__((packed)) {
+    uint8_t  magic;
+    uint8_t  type;                  // journal_event_type_t
+    uint8_t  zone;
+    uint8_t  flags;
+    uint32_t seq;                   // Monotonic across segments and reboots
+    uint32_t timestamp;             // Unix seconds, or uptime seconds with JOURNAL_FLAG_UPTIME
+    uint32_t node_id;
+    uint8_t  payload[12];           // Type specific, see journal_radio_payload_t
+    uint32_t crc;                   // CRC32 over all preceding bytes
+} journal_record_t;
+
+typedef struct __attribute__((packed)) {
+    int16_t  rssi_x10;              // dBm * 10
+    int16_t  snr_x10;               // dB * 10
+    uint16_t node_seq;
+    uint8_t  battery;               // Percent, 0xFF when unknown
+    uint8_t  reserved[5];
+} journal_radio_payload_t;
+
+// Block index entry. Node IDs are summarised in a 128 bit Bloom filter and
+// zones in a 32 bit mask, both may report false positives but never misses.
+typedef struct __attribute__((packed)) {
+    uint32_t min_ts;
+    uint32_t max_ts;
+    uint32_t zone_mask;             // Bit (zone & 31)
+    uint16_t type_mask;             // Bit per journal_event_type_t
+    uint8_t  flags;                 // JOURNAL_FLAG_UPTIME when any record used uptime
+    uint8_t  count;                 // Records summarised, JOURNAL_BLOCK_RECORDS once complete
+    uint32_t node_bloom[4];
+} journal_block_index_t;
+
+typedef struct {
+    uint32_t appended;              // Records accepted into the ring
+    uint32_t committed;             // Records written to the card
+    uint32_t dropped;               // Records lost because the ring was full
+    uint32_t commits;               // Group commits issued
+    uint32_t max_commit_us;         // Slowest commit, SPI lock held time included
+    uint32_t pending;               // Records waiting in the ring
+    uint32_t head_segment;          // Oldest segment on the card
+    uint32_t tail_segment;          // Segment currently written
+    uint32_t tail_records;          // Valid records in the tail segment
+    uint32_t next_seq;
+    bool     ready;
+} journal_stats_t;
+
+// Mount the journal on an already started file system, recover the tail
+// segment and start the writer task. Safe to call without a card: appends
+// are then counted as dropped.
+bool journal_begin(fs::FS &fs);
+void journal_end(void);
+
+// Producer side, callable from any task. Never blocks on the SPI bus.
+bool journal_append(journal_event_type_t type, uint32_t node_id, uint8_t zone,
+                    const void *payload, uint8_t len);
+bool journal_log_radio(uint32_t node_id, float rssi, float snr, uint16_t node_seq, uint8_t battery);
+
+// Ask the writer to commit pending records now instead of at the next interval
+void journal_flush(void);
+void journal_get_stats(journal_stats_t *stats);
+
+// File system the journal is mounted on, NULL before journal_begin()
+fs::FS *journal_get_fs(void);
+
+// Record helpers, exposed for the unit tests and for readers of the segments
+uint32_t journal_crc32(const void *data, size_t len);
+void journal_record_seal(journal_record_t *rec);
+bool journal_record_valid(const journal_record_t *rec);
+void journal_segment_path(uint32_t segment, char *path, size_t size);
+void journal_index_path(uint32_t segment, char *path, size_t size);
+
+// Block index helpers shared by the writer and the query engine
+void journal_block_index_reset(journal_block_index_t *entry);
+void journal_block_index_add(journal_block_index_t *entry, const journal_record_t *rec);
+bool journal_block_index_may_contain_node(const journal_block_index_t *entry, uint32_t node_id);
@@ -0,0 +1,308 @@
+/**
+ * @file      gps_assist.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "gps_assist.h"
+#include "event_journal.h"
+
+#define GPS_ASSIST_MAGIC            0x53415047UL    // "GPAS"
+#define GPS_ASSIST_VERSION          1
+#define GPS_ASSIST_DB_TIMEOUT_MS    5000            // No MGA-DBD at all, the receiver ignored the poll
+
+#define MGA_INI_POS_LLH             0x01
+#define MGA_INI_TIME_UTC            0x10
+
+typedef struct {
+    uint32_t magic;
+    uint8_t  version;
+    uint8_t  model;
+    uint16_t cold_ttff_s;           // Last time to first fix without aiding, 0 when unknown
+    int32_t  lat;                   // 1e-7 degrees
+    int32_t  lon;
+    uint32_t crc;                   // journal_crc32() over the preceding bytes
+} gps_assist_record_t;
+
+enum {
+    DB_IDLE,
+    DB_COLLECTING,
+};
+
+static fs::FS              *assist_fs = NULL;
+static gps_assist_record_t  record;
+static bool                 record_valid = false;
+static gps_assist_model_t   model = GPS_ASSIST_MODEL_NONE;
+static bool                 db_dumps = false;
+static uint8_t              given = 0;
+static bool                 first_fix_seen = false;
+static uint32_t             db_next_ms = 0;
+static bool                 time_synced = false;
+
+// Database dump, handed to the GPS task while collecting
+static uint8_t             *db_buf = NULL;
+static size_t               db_len = 0;
+static uint32_t             db_last_ms = 0;
+static uint8_t              db_state = DB_IDLE;
+
+static inline void put_u2(uint8_t *p, uint16_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static inline void put_u4(uint8_t *p, uint32_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static void save_record(void)
+{
+    if (!assist_fs) {
+        return;
+    }
+    record.magic = GPS_ASSIST_MAGIC;
+    record.version = GPS_ASSIST_VERSION;
+    record.model = model;
+    record.crc = journal_crc32(&record, offsetof(gps_assist_record_t, crc));
+
+    File file = assist_fs->open(GPS_ASSIST_FILE, FILE_WRITE);
+    if (!file || file.write((const uint8_t *)&record, sizeof(record)) != sizeof(record)) {
+        Serial.println("GPS assist: cannot write " GPS_ASSIST_FILE);
+    }
+    file.close();
+}
+
+bool gps_assist_begin(fs::FS *fs)
+{
+    assist_fs = fs;
+    memset(&record, 0, sizeof(record));
+    record_valid = false;
+    if (!assist_fs) {
+        return false;
+    }
+
+    File file = assist_fs->open(GPS_ASSIST_FILE, FILE_READ);
+    if (file && file.read((uint8_t *)&record, sizeof(record)) == sizeof(record) &&
+            record.magic == GPS_ASSIST_MAGIC && record.version == GPS_ASSIST_VERSION &&
+            record.crc == journal_crc32(&record, offsetof(gps_assist_record_t, crc))) {
+        record_valid = record.lat != 0 || record.lon != 0;
+    } else {
+        // Missing or from another build, keep the cold start figure out of it
+        memset(&record, 0, sizeof(record));
+    }
+    file.close();
+    return record_valid;
+}
+
+void gps_assist_start(gps_assist_model_t receiver, gps_protocol_t protocol)
+{
+    model = receiver;
+    db_dumps = receiver == GPS_ASSIST_MODEL_M10 && protocol == GPS_PROTOCOL_UBX;
+    given = 0;
+    first_fix_seen = false;
+    if (record_valid && record.model != receiver) {
+        // Another module was fitted, its cold start time says nothing about this one
+        record.cold_ttff_s = 0;
+    }
+}
+
+size_t gps_assist_mga_time(uint8_t *frame, size_t size, time_t now)
+{
+    if (now < GPS_ASSIST_MIN_EPOCH) {
+        return 0;
+    }
+    struct tm utc;
+    gmtime_r(&now, &utc);
+
+    uint8_t payload[24] = {0};
+    payload[0] = MGA_INI_TIME_UTC;
+    payload[2] = 0;                     // Valid on receipt
+    payload[3] = (uint8_t)-128;         // Leap seconds unknown
+    put_u2(payload + 4, utc.tm_year + 1900);
+    payload[6] = utc.tm_mon + 1;
+    payload[7] = utc.tm_mday;
+    payload[8] = utc.tm_hour;
+    payload[9] = utc.tm_min;
+    payload[10] = utc.tm_sec;
+    put_u2(payload + 16, GPS_ASSIST_TIME_ACC_MS / 1000);
+    put_u4(payload + 20, (GPS_ASSIST_TIME_ACC_MS % 1000) * 1000000UL);
+
+    size_t len = ubx_frame(frame, size, UBX_CLASS_MGA, UBX_MGA_INI, payload, sizeof(payload));
+    if (len) {
+        given |= GPS_ASSIST_TIME;
+    }
+    return len;
+}
+
+size_t gps_assist_mga_ini(uint8_t *frames, size_t size, time_t now)
+{
+    size_t len = 0;
+    if (record_valid) {
+        uint8_t payload[20] = {0};
+        payload[0] = MGA_INI_POS_LLH;
+        put_u4(payload + 4, (uint32_t)record.lat);
+        put_u4(payload + 8, (uint32_t)record.lon);
+        // Altitude is not kept, the accuracy covers it
+        put_u4(payload + 16, GPS_ASSIST_POS_ACC_CM);
+        len = ubx_frame(frames, size, UBX_CLASS_MGA, UBX_MGA_INI, payload, sizeof(payload));
+        if (len) {
+            given |= GPS_ASSIST_POSITION;
+        }
+    }
+    return len + gps_assist_mga_time(frames + len, size - len, now);
+}
+
+size_t gps_assist_db_load(uint8_t *buf, size_t size)
+{
+    if (!assist_fs) {
+        return 0;
+    }
+    File file = assist_fs->open(GPS_ASSIST_DB_FILE, FILE_READ);
+    if (!file) {
+        return 0;
+    }
+    size_t len = file.read(buf, size);
+    file.close();
+
+    // Keep whole MGA-DBD frames only, a write cut by a reset leaves a partial one
+    size_t pos = 0;
+    while (pos + UBX_FRAME_OVERHEAD <= len) {
+        size_t frame = UBX_FRAME_OVERHEAD + (buf[pos + 4] | (buf[pos + 5] << 8));
+        if (buf[pos] != UBX_SYNC_1 || buf[pos + 1] != UBX_SYNC_2 || buf[pos + 2] != UBX_CLASS_MGA ||
+                buf[pos + 3] != UBX_MGA_DBD || pos + frame > len) {
+            break;
+        }
+        pos += frame;
+    }
+    if (pos) {
+        given |= GPS_ASSIST_DATABASE;
+    }
+    return pos;
+}
+
+static void db_flush(void)
+{
+    if (db_len && assist_fs) {
+        File file = assist_fs->open(GPS_ASSIST_DB_FILE, FILE_WRITE);
+        bool ok = file && file.write(db_buf, db_len) == db_len;
+        file.close();
+        Serial.printf("GPS assist: %s %u byte database\n", ok ? "saved" : "cannot save", (unsigned)db_len);
+    }
+    free(db_buf);
+    db_buf = NULL;
+    db_len = 0;
+    __atomic_store_n(&db_state, DB_IDLE, __ATOMIC_RELEASE);
+}
+
+void gps_assist_ubx_frame(const ubx_parser_t *frame)
+{
+    if (__atomic_load_n(&db_state, __ATOMIC_ACQUIRE) != DB_COLLECTING) {
+        return;
+    }
+    uint32_t now = millis();
+    if (frame->cls == UBX_CLASS_MGA && frame->id == UBX_MGA_DBD) {
+        // A full buffer keeps the frames so far, each one stands alone
+        db_len += ubx_frame(db_buf + db_len, GPS_ASSIST_DB_MAX - db_len, frame->cls, frame->id,
+                            frame->payload, frame->len);
+        db_last_ms = now;
+        return;
+    }
+    // NAV-PVT keeps coming at the navigation rate and times the end of the dump
+    if (now - db_last_ms >= (db_len ? GPS_ASSIST_DB_QUIET_MS : GPS_ASSIST_DB_TIMEOUT_MS)) {
+        db_flush();
+    }
+}
+
+static void db_request(uint32_t now)
+{
+    db_next_ms = now + GPS_ASSIST_DB_INTERVAL_MS;
+    db_buf = (uint8_t *)ps_malloc(GPS_ASSIST_DB_MAX);
+    if (!db_buf) {
+        return;
+    }
+    db_len = 0;
+    db_last_ms = now;
+    __atomic_store_n(&db_state, DB_COLLECTING, __ATOMIC_RELEASE);
+
+    uint8_t poll[UBX_FRAME_OVERHEAD];
+    size_t len = ubx_frame(poll, sizeof(poll), UBX_CLASS_MGA, UBX_MGA_DBD, NULL, 0);
+    gps_task_write(poll, len);
+}
+
+void gps_assist_time_synced(void)
+{
+    __atomic_store_n(&time_synced, true, __ATOMIC_RELEASE);
+}
+
+void gps_assist_poll(const gps_fix_t *fix, uint32_t ttff_s)
+{
+    uint32_t now = millis();
+
+    // NTP came after the probe, time still helps while searching
+    if (__atomic_exchange_n(&time_synced, false, __ATOMIC_ACQ_REL) &&
+            model == GPS_ASSIST_MODEL_M10 && !fix->location_valid) {
+        uint8_t frame[32];
+        size_t len = gps_assist_mga_time(frame, sizeof(frame), time(NULL));
+        if (len && gps_task_write(frame, len) == len) {
+            Serial.println("GPS assist: NTP time sent");
+        }
+    }
+
+    if (!fix->location_valid || !ttff_s) {
+        return;
+    }
+
+    int32_t lat = (int32_t)lround(fix->lat * 1e7);
+    int32_t lon = (int32_t)lround(fix->lng * 1e7);
+    bool save = false;
+
+    if (!first_fix_seen) {
+        first_fix_seen = true;
+        db_next_ms = now + GPS_ASSIST_DB_FIRST_MS;
+        Serial.printf("GPS assist: first fix after %lu s, aiding 0x%02x\n", (unsigned long)ttff_s, given);
+        if (!given) {
+            record.cold_ttff_s = ttff_s < 0xFFFF ? ttff_s : 0xFFFF;
+            save = true;
+        }
+    }
+    if (!record_valid || labs(lat - record.lat) > GPS_ASSIST_MOVED_1E7 ||
+            labs(lon - record.lon) > GPS_ASSIST_MOVED_1E7) {
+        save = true;
+    }
+    if (save) {
+        record.lat = lat;
+        record.lon = lon;
+        record_valid = true;
+        save_record();
+    }
+
+    if (db_dumps && assist_fs && (int32_t)(now - db_next_ms) >= 0 &&
+            __atomic_load_n(&db_state, __ATOMIC_ACQUIRE) == DB_IDLE) {
+        db_request(now);
+    }
+}
+
+uint8_t gps_assist_given(void)
+{
+    return given;
+}
+
+void gps_assist_ttff_text(char *buf, size_t len, uint32_t ttff_s)
+{
+    if (!ttff_s) {
+        snprintf(buf, len, "N.A");
+    } else if (given && record.cold_ttff_s) {
+        snprintf(buf, len, "%lu s assisted (cold %u s)", (unsigned long)ttff_s, record.cold_ttff_s);
+    } else if (given) {
+        snprintf(buf, len, "%lu s assisted", (unsigned long)ttff_s);
+    } else {
+        snprintf(buf, len, "%lu s", (unsigned long)ttff_s);
+    }
+}
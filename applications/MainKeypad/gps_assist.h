@@ -0,0 +1,82 @@
+/**
+ * @file      gps_assist.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Assisted start of the GPS receiver.
+ *
+ * The last valid position is kept in a small CRC checked record on flash,
+ * rewritten only when the keypad has moved. For the u-blox M10 the
+ * receiver's navigation database (ephemeris, almanac, AssistNow Autonomous
+ * data) is also dumped with UBX-MGA-DBD once it has had time to collect
+ * it, and kept as the raw frames the receiver sent.
+ *
+ * On the next boot the position goes back to the M10 as UBX-MGA-INI-POS_LLH,
+ * the system time as UBX-MGA-INI-TIME_UTC when it is set (RTC, or NTP once
+ * Wi-Fi syncs), and the database frames are replayed. The time to first fix
+ * is reported on the GPS page against the last unassisted one.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <time.h>
+#include "ubx.h"
+#include "gps_task.h"
+
+#define GPS_ASSIST_FILE             "/gps_assist.bin"
+#define GPS_ASSIST_DB_FILE          "/gps_dbd.bin"
+#define GPS_ASSIST_DB_MAX           (16 * 1024)
+#define GPS_ASSIST_POS_ACC_CM       500000          // 5 km, the keypad may have been moved
+#define GPS_ASSIST_TIME_ACC_MS      2000
+#define GPS_ASSIST_MOVED_1E7        10000           // ~100 m before the position is rewritten
+#define GPS_ASSIST_DB_FIRST_MS      (15 * 60 * 1000)    // A full almanac takes 12.5 minutes
+#define GPS_ASSIST_DB_INTERVAL_MS   (60 * 60 * 1000)
+#define GPS_ASSIST_DB_QUIET_MS      1000            // Dump complete after this long without MGA-DBD
+#define GPS_ASSIST_DB_PACE_MS       2               // Between replayed frames, the receiver has no flow control
+#define GPS_ASSIST_MIN_EPOCH        1700000000      // Older system time is unset
+
+typedef enum {
+    GPS_ASSIST_MODEL_NONE,
+    GPS_ASSIST_MODEL_L76K,
+    GPS_ASSIST_MODEL_M10,
+} gps_assist_model_t;
+
+// What was given to the receiver this boot
+#define GPS_ASSIST_POSITION         0x01
+#define GPS_ASSIST_TIME             0x02
+#define GPS_ASSIST_DATABASE         0x04
+
+// Load the saved record, no file system keeps everything in RAM
+bool gps_assist_begin(fs::FS *fs);
+
+// Receiver identified, called by the GPS probe before it starts injecting.
+// Database dumps need UBX output, the frames come through gps_assist_ubx_frame().
+void gps_assist_start(gps_assist_model_t model, gps_protocol_t protocol);
+
+// UBX-MGA-INI frames for the saved position and for `now` when the clock is
+// set. Returns the bytes written, 0 when there is nothing to give.
+size_t gps_assist_mga_ini(uint8_t *frames, size_t size, time_t now);
+size_t gps_assist_mga_time(uint8_t *frame, size_t size, time_t now);
+
+// Saved MGA-DBD frames into `buf`, returns the bytes read
+size_t gps_assist_db_load(uint8_t *buf, size_t size);
+
+// Every UBX frame received, from the GPS task. Collects the MGA-DBD dump
+// and writes it to flash once the receiver goes quiet.
+void gps_assist_ubx_frame(const ubx_parser_t *frame);
+
+// System time was set from NTP, any task
+void gps_assist_time_synced(void);
+
+// From loopGPS() with the latest fix and the seconds to the first fix (0 before it).
+// Saves the position, requests database dumps and sends late time aiding.
+void gps_assist_poll(const gps_fix_t *fix, uint32_t ttff_s);
+
+uint8_t gps_assist_given(void);
+
+// Time to first fix for the GPS page, e.g. "12 s assisted (cold 41 s)"
+void gps_assist_ttff_text(char *buf, size_t len, uint32_t ttff_s);
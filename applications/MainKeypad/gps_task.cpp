@@ -0,0 +1,265 @@
+/**
+ * @file      gps_task.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "gps_task.h"
+
+static gps_framer_t     framer;
+static TinyGPSPlus     *parser = NULL;
+static HardwareSerial  *uart = NULL;
+static TaskHandle_t     task_handle = NULL;
+static gps_protocol_t   protocol = GPS_PROTOCOL_NMEA;
+static ubx_parser_t     ubx;
+static gps_ubx_hook_t   ubx_hook = NULL;
+
+static gps_fix_t        fix;
+static uint32_t         fix_version = 0;    // Sequence lock, odd while the task is writing
+
+static inline int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool gps_nmea_checksum_ok(const char *sentence, size_t len)
+{
+    // $<body>*HH, followed by the line end
+    uint8_t sum = 0;
+    for (size_t i = 1; i < len; i++) {
+        if (sentence[i] == '*') {
+            if (i + 2 >= len) {
+                return false;
+            }
+            int hi = hex_value(sentence[i + 1]);
+            int lo = hex_value(sentence[i + 2]);
+            return hi >= 0 && lo >= 0 && sum == ((hi << 4) | lo);
+        }
+        sum ^= (uint8_t)sentence[i];
+    }
+    return false;
+}
+
+void gps_framer_init(gps_framer_t *framer)
+{
+    memset(framer, 0, sizeof(*framer));
+}
+
+char *gps_framer_space(gps_framer_t *framer, size_t *space)
+{
+    *space = GPS_FRAME_BUFFER_SIZE - framer->len;
+    return framer->buf + framer->len;
+}
+
+void gps_framer_commit(gps_framer_t *framer, size_t n, gps_sentence_cb_t cb, void *ctx)
+{
+    char *buf = framer->buf;
+    size_t start = 0;
+    size_t pos = framer->scanned;
+    framer->len += n;
+
+    for (;;) {
+        const char *nl = (const char *)memchr(buf + pos, '\n', framer->len - pos);
+        if (!nl) {
+            break;
+        }
+        size_t end = nl - buf + 1;
+        // '$' never occurs inside a sentence, the last one resyncs after line noise
+        size_t begin = end - 1;
+        while (begin > start && buf[begin] != '$') {
+            begin--;
+        }
+        if (buf[begin] == '$') {
+            if (gps_nmea_checksum_ok(buf + begin, end - begin)) {
+                framer->sentences++;
+                cb(buf + begin, end - begin, ctx);
+            } else {
+                framer->bad_checksum++;
+            }
+        }
+        start = pos = end;
+    }
+
+    // Keep the partial sentence, a line filling the whole buffer is dropped
+    size_t remaining = framer->len - start;
+    if (remaining == GPS_FRAME_BUFFER_SIZE) {
+        framer->overflows++;
+        remaining = 0;
+    } else if (start && remaining) {
+        memmove(buf, buf + start, remaining);
+    }
+    framer->len = remaining;
+    framer->scanned = remaining;
+}
+
+static void publish_fix(void)
+{
+    // Reading the values clears the TinyGPSPlus updated flags
+    bool moved = parser->location.isUpdated();
+
+    __atomic_store_n(&fix_version, fix_version + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    fix.lat = parser->location.lat();
+    fix.lng = parser->location.lng();
+    fix.speed = parser->speed.value();
+    fix.year = parser->date.year();
+    fix.month = parser->date.month();
+    fix.day = parser->date.day();
+    fix.hour = parser->time.hour();
+    fix.minute = parser->time.minute();
+    fix.second = parser->time.second();
+    fix.location_valid = parser->location.isValid();
+    if (moved) {
+        fix.location_ms = millis();
+    }
+    fix.chars = parser->charsProcessed();
+    fix.sentences = framer.sentences;
+    fix.bad_sentences = framer.bad_checksum + parser->failedChecksum();
+    fix.overflows = framer.overflows;
+
+    __atomic_store_n(&fix_version, fix_version + 1, __ATOMIC_RELEASE);
+}
+
+static void parse_sentence(const char *sentence, size_t len, void *ctx)
+{
+    parser->encode(sentence, len);
+    publish_fix();
+}
+
+static void publish_pvt(const ubx_nav_pvt_t *pvt)
+{
+    __atomic_store_n(&fix_version, fix_version + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    // Like TinyGPSPlus, keep the last position while there is no fix
+    if (pvt->fix_ok && pvt->fix_type >= 2) {
+        fix.lat = pvt->lat * 1e-7;
+        fix.lng = pvt->lon * 1e-7;
+        fix.speed = pvt->ground_speed_mm_s * (100.0 / 514.444);
+        fix.location_valid = true;
+        fix.location_ms = millis();
+    }
+    if (pvt->date_valid) {
+        fix.year = pvt->year;
+        fix.month = pvt->month;
+        fix.day = pvt->day;
+    }
+    if (pvt->time_valid) {
+        fix.hour = pvt->hour;
+        fix.minute = pvt->minute;
+        fix.second = pvt->second;
+    }
+    fix.chars += UBX_NAV_PVT_LEN + UBX_FRAME_OVERHEAD;
+    fix.sentences = ubx.frames;
+    fix.bad_sentences = ubx.bad_checksum;
+    fix.overflows = ubx.oversize;
+
+    __atomic_store_n(&fix_version, fix_version + 1, __ATOMIC_RELEASE);
+}
+
+void gps_task_ingest_ubx(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        ubx_nav_pvt_t pvt;
+        if (!ubx_parser_feed(&ubx, data[i])) {
+            continue;
+        }
+        if (ubx.cls == UBX_CLASS_NAV && ubx.id == UBX_NAV_PVT && ubx_decode_nav_pvt(ubx.payload, ubx.len, &pvt)) {
+            publish_pvt(&pvt);
+        }
+        if (ubx_hook) {
+            ubx_hook(&ubx);
+        }
+    }
+}
+
+void gps_task_ingest(const uint8_t *data, size_t len)
+{
+    while (len) {
+        size_t space;
+        char *dst = gps_framer_space(&framer, &space);
+        size_t n = len < space ? len : space;
+        memcpy(dst, data, n);
+        gps_framer_commit(&framer, n, parse_sentence, NULL);
+        data += n;
+        len -= n;
+    }
+}
+
+static void gps_task(void *params)
+{
+    while (1) {
+        // Woken by the UART receive event, the timeout covers a missed one
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(GPS_TASK_POLL_MS));
+
+        int available;
+        while ((available = uart->available()) > 0) {
+            if (protocol == GPS_PROTOCOL_UBX) {
+                // Frames are parsed byte by byte, the frame buffer is only scratch
+                size_t n = uart->read((uint8_t *)framer.buf,
+                                      (size_t)available < sizeof(framer.buf) ? (size_t)available : sizeof(framer.buf));
+                gps_task_ingest_ubx((const uint8_t *)framer.buf, n);
+                continue;
+            }
+            // Copy from the driver ring buffer straight into the frame buffer
+            size_t space;
+            char *dst = gps_framer_space(&framer, &space);
+            size_t n = uart->read((uint8_t *)dst, (size_t)available < space ? (size_t)available : space);
+            gps_framer_commit(&framer, n, parse_sentence, NULL);
+        }
+    }
+}
+
+void gps_task_set_ubx_hook(gps_ubx_hook_t hook)
+{
+    ubx_hook = hook;
+}
+
+size_t gps_task_write(const uint8_t *data, size_t len)
+{
+    // The UART driver serialises writers, the task itself only reads
+    return uart ? uart->write(data, len) : 0;
+}
+
+bool gps_task_begin(HardwareSerial *serial, TinyGPSPlus *gps, gps_protocol_t mode)
+{
+    if (task_handle) {
+        return true;
+    }
+    uart = serial;
+    parser = gps;
+    protocol = mode;
+    gps_framer_init(&framer);
+    ubx_parser_init(&ubx);
+
+    if (xTaskCreate(gps_task, "gps", GPS_TASK_STACK, NULL, GPS_TASK_PRIORITY, &task_handle) != pdPASS) {
+        task_handle = NULL;
+        return false;
+    }
+#if defined(ESP_ARDUINO_VERSION) && ESP_ARDUINO_VERSION >= ESP_ARDUINO_VERSION_VAL(2, 0, 3)
+    // Runs on the UART event task for every FIFO full or receive timeout event
+    serial->onReceive([]() {
+        xTaskNotifyGive(task_handle);
+    });
+#endif
+    return true;
+}
+
+bool gps_fix_read(gps_fix_t *out)
+{
+    uint32_t v1, v2;
+    do {
+        v1 = __atomic_load_n(&fix_version, __ATOMIC_ACQUIRE);
+        *out = fix;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        v2 = __atomic_load_n(&fix_version, __ATOMIC_RELAXED);
+    } while ((v1 & 1) || v1 != v2);
+    return v1 != 0;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file      gps_task.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * GPS receiver task.
+ *
+ * The task sleeps until the UART driver reports received data, then drains
+ * the driver buffer straight into the frame buffer. Complete NMEA sentences
+ * are located and checksummed in place; only valid ones are fed to
+ * TinyGPSPlus. Bytes of a partial sentence are moved to the front of the
+ * buffer once per read, never per character.
+ *
+ * A u-blox M10 switched to binary output is read as UBX instead, each
+ * NAV-PVT frame replacing a set of NMEA sentences.
+ *
+ * Every parsed sentence or frame publishes a gps_fix_t under a sequence
+ * lock, so the UI reads a consistent fix without blocking the task and
+ * without sharing the TinyGPSPlus object.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <TinyGPS++.h>
+#include "ubx.h"
+
+#define GPS_FRAME_BUFFER_SIZE   512     // Several sentences, NMEA allows 82 bytes each
+#define GPS_UART_RX_BUFFER      2048    // Driver ring buffer, set before SerialGPS.begin()
+#define GPS_TASK_POLL_MS        20      // Fallback when a receive event is missed
+#define GPS_TASK_PRIORITY       3
+#define GPS_TASK_STACK          (6 * 1024)     // Room for a flash write from the UBX hook
+
+typedef struct {
+    double   lat;
+    double   lng;
+    double   speed;                     // TinyGPSPlus raw value, hundredths of a knot
+    uint16_t year;
+    uint8_t  month;
+    uint8_t  day;
+    uint8_t  hour;
+    uint8_t  minute;
+    uint8_t  second;
+    bool     location_valid;
+    uint32_t location_ms;               // millis() of the last location update
+    uint32_t chars;                     // Bytes of valid sentences or frames parsed
+    uint32_t sentences;                 // Sentences or frames passing the checksum
+    uint32_t bad_sentences;             // Checksum failures
+    uint32_t overflows;                 // Lines or frames dropped for exceeding the buffer
+} gps_fix_t;
+
+typedef enum {
+    GPS_PROTOCOL_NMEA,
+    GPS_PROTOCOL_UBX,                   // NAV-PVT frames only, see ubx_cfg_pvt_only()
+} gps_protocol_t;
+
+// Called from the task for every UBX frame passing the checksum
+typedef void (*gps_ubx_hook_t)(const ubx_parser_t *frame);
+
+// In place NMEA framing, exposed for the unit tests
+typedef void (*gps_sentence_cb_t)(const char *sentence, size_t len, void *ctx);
+
+typedef struct {
+    char     buf[GPS_FRAME_BUFFER_SIZE];
+    uint16_t len;                       // Bytes held
+    uint16_t scanned;                   // Bytes already searched for an end of line
+    uint32_t sentences;
+    uint32_t bad_checksum;
+    uint32_t overflows;
+} gps_framer_t;
+
+void gps_framer_init(gps_framer_t *framer);
+
+// Free space to receive into, then commit the bytes written there.
+// Each complete sentence with a valid checksum, '$' to '\n', is passed to `cb`.
+char *gps_framer_space(gps_framer_t *framer, size_t *space);
+void gps_framer_commit(gps_framer_t *framer, size_t n, gps_sentence_cb_t cb, void *ctx);
+
+bool gps_nmea_checksum_ok(const char *sentence, size_t len);
+
+// Start the task once the module is configured, it owns `serial` and `gps` from then on
+bool gps_task_begin(HardwareSerial *serial, TinyGPSPlus *gps, gps_protocol_t protocol);
+
+// Set before gps_task_begin()
+void gps_task_set_ubx_hook(gps_ubx_hook_t hook);
+
+// Send to the receiver once the task owns the UART, returns the bytes queued
+size_t gps_task_write(const uint8_t *data, size_t len);
+
+// Parse bytes as if received from the UART, used by the task and the unit tests
+void gps_task_ingest(const uint8_t *data, size_t len);
+void gps_task_ingest_ubx(const uint8_t *data, size_t len);
+
+// Latest fix, never blocks. Returns false until a sentence was parsed.
+bool gps_fix_read(gps_fix_t *fix);
@@ -0,0 +1,175 @@
+/**
+ * @file      input_events.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "input_events.h"
+
+#define INPUT_QUEUE_MASK        (INPUT_QUEUE_DEPTH - 1)
+
+static_assert((INPUT_QUEUE_DEPTH & INPUT_QUEUE_MASK) == 0, "INPUT_QUEUE_DEPTH must be a power of two");
+
+typedef struct {
+    input_event_t    ring[INPUT_QUEUE_DEPTH];
+    volatile uint32_t head;                         // Writers, under input_mux
+    volatile uint32_t tail;                         // The reader only
+} input_queue_t;
+
+static input_queue_t    queues[INPUT_QUEUES];
+static input_stats_t    stats;
+static portMUX_TYPE     input_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t          tb_pins[4];
+static bool             tb_attached;
+static uint32_t         tb_last_us[4];
+static int              button_pin = -1;
+static bool             button_down;                // Last change queued
+static uint32_t         button_at_us;
+static int              touch_pin = -1;
+
+void IRAM_ATTR input_events_push(uint8_t queue, uint8_t type, uint32_t at_us)
+{
+    input_queue_t *q = &queues[queue];
+    portENTER_CRITICAL_SAFE(&input_mux);
+    if (q->head - q->tail >= INPUT_QUEUE_DEPTH) {
+        stats.dropped[queue]++;
+    } else {
+        input_event_t *event = &q->ring[q->head & INPUT_QUEUE_MASK];
+        event->type = type;
+        event->at_us = at_us;
+        q->head = q->head + 1;
+        stats.events[queue]++;
+    }
+    portEXIT_CRITICAL_SAFE(&input_mux);
+}
+
+static void IRAM_ATTR tb_isr(void *arg)
+{
+    uint8_t dir = (uint8_t)(uintptr_t)arg;
+    uint32_t now = micros();
+    if (now - tb_last_us[dir] < INPUT_TRACKBALL_GLITCH_US) {
+        stats.glitches++;
+        return;
+    }
+    tb_last_us[dir] = now;
+    input_events_push(INPUT_QUEUE_TRACKBALL, INPUT_EV_RIGHT + dir, now);
+}
+
+// Queues the level if it differs from the last change queued, outside the
+// lockout. From the interrupt and from input_events_sync(), so under the lock.
+static bool IRAM_ATTR button_update(bool down, uint32_t now)
+{
+    bool queued = false;
+    portENTER_CRITICAL_SAFE(&input_mux);
+    if (down != button_down) {
+        if (now - button_at_us < INPUT_BUTTON_DEBOUNCE_US) {
+            stats.bounces++;
+        } else {
+            button_down = down;
+            button_at_us = now;
+            input_events_push(INPUT_QUEUE_TRACKBALL, down ? INPUT_EV_BUTTON_DOWN : INPUT_EV_BUTTON_UP, now);
+            queued = true;
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&input_mux);
+    return queued;
+}
+
+static void IRAM_ATTR button_isr(void)
+{
+    button_update(digitalRead(button_pin) == LOW, micros());
+}
+
+static void IRAM_ATTR touch_isr(void)
+{
+    input_events_push(INPUT_QUEUE_TOUCH, INPUT_EV_TOUCH, micros());
+}
+
+void input_events_begin_trackball(const uint8_t pins[4], int pin)
+{
+    for (int i = 0; i < 4; i++) {
+        tb_pins[i] = pins[i];
+        pinMode(pins[i], INPUT_PULLUP);
+        attachInterruptArg(pins[i], tb_isr, (void *)(uintptr_t)i, FALLING);
+    }
+    tb_attached = true;
+    if (pin >= 0) {
+        button_pin = pin;
+        pinMode(pin, INPUT_PULLUP);
+        button_down = digitalRead(pin) == LOW;
+        button_at_us = micros();
+        attachInterrupt(pin, button_isr, CHANGE);
+    }
+}
+
+void input_events_begin_touch(int int_pin, int edge)
+{
+    touch_pin = int_pin;
+    pinMode(int_pin, INPUT);
+    attachInterrupt(int_pin, touch_isr, edge);
+}
+
+void input_events_end(void)
+{
+    if (tb_attached) {
+        for (int i = 0; i < 4; i++) {
+            detachInterrupt(tb_pins[i]);
+        }
+        tb_attached = false;
+    }
+    if (button_pin >= 0) {
+        detachInterrupt(button_pin);
+        button_pin = -1;
+    }
+    if (touch_pin >= 0) {
+        detachInterrupt(touch_pin);
+        touch_pin = -1;
+    }
+}
+
+bool input_events_next(uint8_t queue, input_event_t *event)
+{
+    input_queue_t *q = &queues[queue];
+    uint32_t tail = q->tail;
+    if (tail == q->head) {
+        return false;
+    }
+    *event = q->ring[tail & INPUT_QUEUE_MASK];
+    q->tail = tail + 1;
+    return true;
+}
+
+size_t input_events_pending(uint8_t queue)
+{
+    return queues[queue].head - queues[queue].tail;
+}
+
+void input_events_sync(void)
+{
+    if (button_pin < 0) {
+        return;
+    }
+    if (button_update(digitalRead(button_pin) == LOW, micros())) {
+        stats.synced++;
+    }
+}
+
+int16_t input_trackball_step(uint32_t interval_us)
+{
+    if (interval_us >= INPUT_TRACKBALL_ACCEL_US) {
+        return INPUT_TRACKBALL_PX;
+    }
+    uint32_t px = (uint32_t)INPUT_TRACKBALL_PX * INPUT_TRACKBALL_ACCEL_US / max(interval_us, (uint32_t)1);
+    return min(px, (uint32_t)INPUT_TRACKBALL_PX_MAX);
+}
+
+void input_events_get_stats(input_stats_t *out)
+{
+    portENTER_CRITICAL(&input_mux);
+    *out = stats;
+    portEXIT_CRITICAL(&input_mux);
+}
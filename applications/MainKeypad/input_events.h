@@ -0,0 +1,91 @@
+/**
+ * @file      input_events.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Interrupt driven trackball and touch input.
+ *
+ * GPIO interrupts put every trackball pulse, button change and touch
+ * controller report into a ring per source, stamped with micros() at the
+ * edge. The LVGL read callbacks drain the rings instead of sampling pins
+ * or the bus on every read, so nothing is missed between reads and the
+ * time between pulses gives the real roll speed for the cursor
+ * acceleration in input_trackball_step().
+ *
+ * The GT911 pulses its INT line for every report it makes while touched,
+ * about every 10 ms. Touch coordinates are read over I2C only after such a
+ * pulse; with the screen untouched there is no touch traffic on the bus.
+ *
+ * Trackball edges closer than INPUT_TRACKBALL_GLITCH_US on one pin are
+ * dropped. The button is debounced by a lockout of INPUT_BUTTON_DEBOUNCE_US
+ * after every change it reports; input_events_sync() catches a change that
+ * fell into the lockout.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define INPUT_QUEUE_DEPTH           64              // Per source, power of two
+#define INPUT_TRACKBALL_GLITCH_US   1000
+#define INPUT_BUTTON_DEBOUNCE_US    20000
+#define INPUT_TRACKBALL_PX          8               // Cursor step of a slow pulse
+#define INPUT_TRACKBALL_PX_MAX      48
+#define INPUT_TRACKBALL_ACCEL_US    50000           // Pulses closer than this move further
+#define INPUT_TOUCH_HOLD_US         60000           // No report for this long is a lift
+
+enum {
+    INPUT_QUEUE_TRACKBALL = 0,
+    INPUT_QUEUE_TOUCH,
+    INPUT_QUEUES,
+};
+
+typedef enum : uint8_t {
+    INPUT_EV_RIGHT = 0,                             // Trackball pulses, one per event
+    INPUT_EV_UP,
+    INPUT_EV_LEFT,
+    INPUT_EV_DOWN,
+    INPUT_EV_BUTTON_DOWN,
+    INPUT_EV_BUTTON_UP,
+    INPUT_EV_TOUCH,                                 // The touch controller has a report
+} input_event_type_t;
+
+typedef struct {
+    uint8_t  type;                                  // input_event_type_t
+    uint32_t at_us;                                 // micros() at the edge
+} input_event_t;
+
+typedef struct {
+    uint32_t events[INPUT_QUEUES];
+    uint32_t dropped[INPUT_QUEUES];                 // Lost to a full ring
+    uint32_t glitches;                              // Trackball edges too close together
+    uint32_t bounces;                               // Button edges inside the lockout
+    uint32_t synced;                                // Button changes caught by input_events_sync()
+} input_stats_t;
+
+// Interrupts on the four trackball pins, right, up, left and down, and the
+// button pin, all active low with pull-ups. `button_pin` may be -1.
+void input_events_begin_trackball(const uint8_t pins[4], int button_pin);
+
+// Interrupt on the touch controller INT pin, `edge` RISING or FALLING
+void input_events_begin_touch(int int_pin, int edge);
+
+void input_events_end(void);
+
+// Reader side, from the LVGL thread
+bool input_events_next(uint8_t queue, input_event_t *event);
+size_t input_events_pending(uint8_t queue);
+
+// Queue a button change the lockout hid, call before draining the trackball
+void input_events_sync(void);
+
+// Cursor pixels for a trackball pulse `interval_us` after the previous one
+// in the same direction
+int16_t input_trackball_step(uint32_t interval_us);
+
+void input_events_get_stats(input_stats_t *stats);
+
+// Writer side, exposed for the unit tests. Safe from interrupts and tasks.
+void input_events_push(uint8_t queue, uint8_t type, uint32_t at_us);
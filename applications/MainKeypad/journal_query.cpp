@@ -0,0 +1,225 @@
+/**
+ * @file      journal_query.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "journal_query.h"
+#include "utilities.h"
+
+// SPI bus mutex shared with the display and the radio (UnitTest.ino)
+extern SemaphoreHandle_t xSemaphore;
+
+#define QUERY_SPI_TIMEOUT_MS        100
+
+// Block index of one segment, loaded on demand (16 KiB in PSRAM)
+static journal_block_index_t *index_cache = nullptr;
+static uint32_t index_cache_segment = UINT32_MAX;
+static uint32_t index_cache_blocks = 0;
+static uint32_t index_cache_records = 0;        // Tail records when the index was read
+
+static journal_record_t *block_buf = nullptr;
+static File     segment_file;
+static uint32_t segment_file_id = UINT32_MAX;
+
+void journal_filter_init(journal_filter_t *filter)
+{
+    filter->from_ts = 0;
+    filter->to_ts = UINT32_MAX;
+    filter->node_id = JOURNAL_QUERY_ANY_NODE;
+    filter->zone = JOURNAL_QUERY_ANY_ZONE;
+    filter->type_mask = 0;
+}
+
+bool journal_filter_match(const journal_filter_t *filter, const journal_record_t *rec)
+{
+    if (rec->timestamp < filter->from_ts || rec->timestamp > filter->to_ts) {
+        return false;
+    }
+    if (filter->type_mask && !(filter->type_mask & JOURNAL_TYPE_BIT(rec->type))) {
+        return false;
+    }
+    if (filter->zone != JOURNAL_QUERY_ANY_ZONE && rec->zone != filter->zone) {
+        return false;
+    }
+    if (filter->node_id != JOURNAL_QUERY_ANY_NODE && rec->node_id != filter->node_id) {
+        return false;
+    }
+    return true;
+}
+
+static bool block_may_match(const journal_filter_t *filter, const journal_block_index_t *entry)
+{
+    if (filter->to_ts < entry->min_ts || filter->from_ts > entry->max_ts) {
+        return false;
+    }
+    if (filter->type_mask && !(entry->type_mask & filter->type_mask)) {
+        return false;
+    }
+    if (filter->zone != JOURNAL_QUERY_ANY_ZONE && !(entry->zone_mask & (1UL << (filter->zone & 31)))) {
+        return false;
+    }
+    if (filter->node_id != JOURNAL_QUERY_ANY_NODE && !journal_block_index_may_contain_node(entry, filter->node_id)) {
+        return false;
+    }
+    return true;
+}
+
+// Wall clock timestamps only grow, so once a block lies entirely before the
+// requested range nothing older can match either. Uptime stamped blocks
+// (written before NTP/GPS time was known) do not allow this shortcut.
+static bool block_before_range(const journal_filter_t *filter, const journal_block_index_t *entry)
+{
+    return !(entry->flags & JOURNAL_FLAG_UPTIME) && entry->max_ts < filter->from_ts;
+}
+
+// `records` is the segment's committed record count, which only moves for
+// the tail. The tail's index is read again only when `block` is past the
+// entries held and blocks were closed since, not once per block walked.
+static bool load_index(fs::FS *fs, uint32_t segment, uint32_t records, uint32_t block)
+{
+    if (segment == index_cache_segment && (block < index_cache_blocks || records == index_cache_records)) {
+        return true;
+    }
+    index_cache_segment = UINT32_MAX;
+    index_cache_blocks = 0;
+
+    char path[32];
+    journal_index_path(segment, path, sizeof(path));
+    File f = fs->open(path, FILE_READ);
+    if (!f) {
+        return false;
+    }
+    size_t blocks = min((size_t)(f.size() / sizeof(journal_block_index_t)), (size_t)JOURNAL_SEGMENT_BLOCKS);
+    size_t bytes = blocks * sizeof(journal_block_index_t);
+    bool ok = f.read((uint8_t *)index_cache, bytes) == bytes;
+    f.close();
+    if (ok) {
+        index_cache_segment = segment;
+        index_cache_blocks = blocks;
+        index_cache_records = records;
+    }
+    return ok;
+}
+
+static size_t read_records(fs::FS *fs, uint32_t segment, bool is_tail, uint32_t first, uint32_t count)
+{
+    // The tail is reopened every time so no stale sector buffer is read back
+    if (segment != segment_file_id || !segment_file || is_tail) {
+        char path[32];
+        segment_file.close();
+        journal_segment_path(segment, path, sizeof(path));
+        segment_file = fs->open(path, FILE_READ);
+        segment_file_id = segment;
+        if (!segment_file) {
+            return 0;
+        }
+    }
+    if (!segment_file.seek(first * JOURNAL_RECORD_SIZE)) {
+        return 0;
+    }
+    return segment_file.read((uint8_t *)block_buf, count * JOURNAL_RECORD_SIZE) / JOURNAL_RECORD_SIZE;
+}
+
+void journal_query_begin(journal_cursor_t *cursor)
+{
+    journal_stats_t st;
+    journal_get_stats(&st);
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->segment = st.tail_segment;
+    cursor->record = st.tail_records;
+    cursor->done = !st.ready;
+}
+
+size_t journal_query_page(const journal_filter_t *filter, journal_cursor_t *cursor,
+                          journal_record_t *out, size_t max)
+{
+    fs::FS *fs = journal_get_fs();
+    if (!fs) {
+        cursor->done = true;
+        return 0;
+    }
+    if (!index_cache) {
+        index_cache = (journal_block_index_t *)ps_malloc(JOURNAL_SEGMENT_BLOCKS * sizeof(journal_block_index_t));
+        block_buf = (journal_record_t *)ps_malloc(JOURNAL_BLOCK_RECORDS * sizeof(journal_record_t));
+        if (!index_cache || !block_buf) {
+            cursor->done = true;
+            return 0;
+        }
+    }
+
+    journal_stats_t st;
+    journal_get_stats(&st);
+
+    size_t found = 0;
+    while (found < max && !cursor->done) {
+        if (cursor->record == 0) {
+            if (cursor->segment <= st.head_segment) {
+                cursor->done = true;
+                break;
+            }
+            // Segments before the tail were only closed once full
+            cursor->segment--;
+            cursor->record = JOURNAL_SEGMENT_RECORDS;
+            continue;
+        }
+
+        uint32_t block = (cursor->record - 1) / JOURNAL_BLOCK_RECORDS;
+        uint32_t first = block * JOURNAL_BLOCK_RECORDS;
+
+        // Hold the bus for one block at a time so display and radio keep running
+        if (xSemaphoreTake(xSemaphore, pdMS_TO_TICKS(QUERY_SPI_TIMEOUT_MS)) != pdTRUE) {
+            break;
+        }
+        digitalWrite(BOARD_SDCARD_CS, HIGH);
+        digitalWrite(RADIO_CS_PIN, HIGH);
+        digitalWrite(BOARD_TFT_CS, HIGH);
+
+        bool is_tail = cursor->segment == st.tail_segment;
+        load_index(fs, cursor->segment, is_tail ? st.tail_records : JOURNAL_SEGMENT_RECORDS, block);
+        if (index_cache_segment == cursor->segment && block < index_cache_blocks) {
+            const journal_block_index_t *entry = &index_cache[block];
+            if (block_before_range(filter, entry)) {
+                xSemaphoreGive(xSemaphore);
+                cursor->done = true;
+                break;
+            }
+            if (!block_may_match(filter, entry)) {
+                xSemaphoreGive(xSemaphore);
+                cursor->blocks_skipped++;
+                cursor->record = first;
+                continue;
+            }
+        }
+        // Blocks without an index entry (the tail's open block) are always read
+        size_t n = read_records(fs, cursor->segment, is_tail, first, cursor->record - first);
+        xSemaphoreGive(xSemaphore);
+        cursor->blocks_read++;
+
+        for (int i = (int)n - 1; i >= 0; i--) {
+            const journal_record_t *rec = &block_buf[i];
+            if (journal_record_valid(rec) && journal_filter_match(filter, rec)) {
+                out[found++] = *rec;
+                if (found == max) {
+                    cursor->record = first + i;
+                    break;
+                }
+            }
+        }
+        if (found < max) {
+            cursor->record = first;
+        }
+    }
+    return found;
+}
+
+void journal_query_reset_cache(void)
+{
+    index_cache_segment = UINT32_MAX;
+    index_cache_blocks = 0;
+    segment_file.close();
+    segment_file_id = UINT32_MAX;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file      journal_query.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Paginated, newest-first queries over the event journal.
+ *
+ * The per-segment block index lets a query skip every 2 KiB block whose time
+ * range, zone mask, event types or node Bloom filter cannot match, so only
+ * candidate blocks are read from the card. The Bloom filter stands in for a
+ * separate per-node index: it answers "may this block hold node N" in the
+ * same 32 byte entry, at the cost of a few false positive block reads.
+ *
+ * Each call returns one page and advances a cursor, which lets the history
+ * screen load rows while scrolling.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "event_journal.h"
+
+#define JOURNAL_QUERY_ANY_NODE      0
+#define JOURNAL_QUERY_ANY_ZONE      -1
+#define JOURNAL_TYPE_BIT(t)         (1U << ((t) & 15))
+
+typedef struct {
+    uint32_t from_ts;               // Inclusive, 0 for open start
+    uint32_t to_ts;                 // Inclusive, UINT32_MAX for open end
+    uint32_t node_id;               // JOURNAL_QUERY_ANY_NODE matches every node
+    int16_t  zone;                  // JOURNAL_QUERY_ANY_ZONE matches every zone
+    uint16_t type_mask;             // JOURNAL_TYPE_BIT() set, 0 matches every type
+} journal_filter_t;
+
+typedef struct {
+    uint32_t segment;               // Segment being walked
+    uint32_t record;                // Records below this index are still to be examined
+    uint32_t blocks_read;           // Statistics for the caller
+    uint32_t blocks_skipped;
+    bool     done;
+} journal_cursor_t;
+
+void journal_filter_init(journal_filter_t *filter);
+bool journal_filter_match(const journal_filter_t *filter, const journal_record_t *rec);
+
+// Position the cursor on the newest committed record
+void journal_query_begin(journal_cursor_t *cursor);
+
+// Fill `out` with up to `max` matching records, newest first. Returns the
+// number of records written; cursor->done is set once the journal is exhausted.
+size_t journal_query_page(const journal_filter_t *filter, journal_cursor_t *cursor,
+                          journal_record_t *out, size_t max);
+
+// Drop the cached block index, e.g. after the card was swapped
+void journal_query_reset_cache(void);
@@ -0,0 +1,228 @@
+/**
+ * @file      keyboard.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "keyboard.h"
+
+#define KB_QUEUE_MASK           (KB_QUEUE_DEPTH - 1)
+#define KB_KEY_UNKNOWN          0xff            // Legacy reads carry no matrix position
+#define KB_MISWIRED_POLLS       2               // Safety polls in a row finding events
+
+static_assert((KB_QUEUE_DEPTH & KB_QUEUE_MASK) == 0, "KB_QUEUE_DEPTH must be a power of two");
+
+static TwoWire *s_wire;
+static int s_int_pin = -1;
+static bool s_event_mode;
+static volatile bool s_signalled;
+static uint32_t s_last_poll;
+static volatile uint8_t s_missed;               // Safety polls in a row that found events
+
+// Filled and drained on the LVGL thread only
+static kb_event_t s_queue[KB_QUEUE_DEPTH];
+static uint32_t s_head, s_tail;
+
+static kb_stats_t s_stats;
+
+static void IRAM_ATTR kb_isr(void)
+{
+    s_signalled = true;
+    s_missed = 0;
+    s_stats.interrupts++;
+}
+
+static void kb_push(uint8_t flags, uint8_t key, uint8_t ch, uint32_t now)
+{
+    if (s_head - s_tail >= KB_QUEUE_DEPTH) {
+        s_stats.dropped++;
+        return;
+    }
+    kb_event_t *event = &s_queue[s_head & KB_QUEUE_MASK];
+    event->flags = flags;
+    event->key = key;
+    event->ch = ch;
+    event->at_ms = now;
+    s_head++;
+    s_stats.events++;
+}
+
+int keyboard_feed_burst(const uint8_t *buf, size_t len, uint32_t now, bool *more)
+{
+    *more = false;
+    if (len < 2 || buf[0] != KB_BURST_MAGIC) {
+        s_stats.bad_bursts++;
+        return -1;
+    }
+    size_t count = buf[1] & KB_BURST_COUNT_MASK;
+    if (count > (len - 2) / KB_EVENT_BYTES) {
+        // Never trust the count past what was read
+        s_stats.bad_bursts++;
+        count = (len - 2) / KB_EVENT_BYTES;
+    }
+    if (buf[1] & KB_BURST_OVERFLOW) {
+        s_stats.overflows++;
+    }
+    *more = (buf[1] & KB_BURST_MORE) != 0;
+    s_stats.bursts++;
+
+    const uint8_t *p = buf + 2;
+    for (size_t i = 0; i < count; i++, p += KB_EVENT_BYTES) {
+        kb_push(p[0], p[1], p[2], now);
+    }
+    return count;
+}
+
+// A sleeping keyboard does not answer, which is only an error when it
+// signalled events
+static int kb_read_burst(bool *more, bool expected)
+{
+    uint8_t buf[KB_BURST_BYTES];
+    size_t len = s_wire->requestFrom((uint8_t)KB_I2C_ADDR, (uint8_t)KB_BURST_BYTES);
+    if (len == 0) {
+        if (expected) {
+            s_stats.errors++;
+        }
+        *more = false;
+        return -1;
+    }
+    len = s_wire->readBytes(buf, min(len, sizeof(buf)));
+    int queued = keyboard_feed_burst(buf, len, millis(), more);
+    return queued < 0 ? 0 : queued;
+}
+
+// Firmware without the event mode, one character per read
+static int kb_read_legacy(void)
+{
+    s_wire->beginTransmission(KB_I2C_ADDR);
+    if (s_wire->endTransmission() != 0) {
+        s_stats.errors++;
+        return -1;
+    }
+    uint8_t ch = 0;
+    s_wire->requestFrom((uint8_t)KB_I2C_ADDR, (uint8_t)1);
+    while (s_wire->available() > 0) {
+        ch = s_wire->read();
+    }
+    if (!ch) {
+        return 0;
+    }
+    uint32_t now = millis();
+    kb_push(KB_EVT_PRESSED, KB_KEY_UNKNOWN, ch, now);
+    kb_push(0, KB_KEY_UNKNOWN, ch, now);
+    return 2;
+}
+
+bool keyboard_begin(TwoWire *wire, int int_pin)
+{
+    s_wire = wire;
+    s_int_pin = int_pin;
+    s_event_mode = false;
+    s_head = s_tail = 0;
+    s_missed = 0;
+
+    wire->setClock(KB_I2C_FREQ);
+    wire->beginTransmission(KB_I2C_ADDR);
+    wire->write(LILYGO_KB_MODE_EVENT_CMD);
+    if (wire->endTransmission() != 0) {
+        Serial.println("Keyboard: no answer to the event mode switch");
+        return false;
+    }
+    // The keyboard takes the command on its own task
+    delay(5);
+
+    // Anything already queued comes with the answer
+    bool more;
+    uint8_t buf[KB_BURST_BYTES];
+    size_t len = wire->requestFrom((uint8_t)KB_I2C_ADDR, (uint8_t)KB_BURST_BYTES);
+    len = wire->readBytes(buf, min(len, sizeof(buf)));
+    if (len < 2 || buf[0] != KB_BURST_MAGIC) {
+        Serial.println("Keyboard: firmware without event mode, polling");
+        return false;
+    }
+    keyboard_feed_burst(buf, len, millis(), &more);
+    s_event_mode = true;
+    s_signalled = more;
+    if (buf[1] & KB_BURST_NO_INT) {
+        s_int_pin = int_pin = -1;
+    }
+
+    if (int_pin >= 0) {
+        // GPIO46 has a strapping pull-down, the keyboard only ever pulls low
+        pinMode(int_pin, INPUT_PULLUP);
+        attachInterrupt(int_pin, kb_isr, FALLING);
+    }
+    Serial.printf("Keyboard: event mode, %s\n", int_pin >= 0 ? "interrupt driven" : "polled");
+    return true;
+}
+
+int keyboard_service(void)
+{
+    if (!s_wire) {
+        return -1;
+    }
+    if (!s_event_mode) {
+        return kb_read_legacy();
+    }
+    bool safety = false;
+    if (s_int_pin >= 0) {
+        // The line stays low while events keep arriving during a read, so
+        // check the level as well as the edge
+        if (!s_signalled && digitalRead(s_int_pin) != LOW) {
+            if (millis() - s_last_poll < KB_SAFETY_POLL_MS) {
+                return 0;
+            }
+            safety = true;
+        }
+    } else if (!s_signalled && millis() - s_last_poll < KB_POLL_MS) {
+        return 0;
+    }
+    s_signalled = false;
+    s_last_poll = millis();
+
+    int queued = 0;
+    bool more = true;
+    for (int i = 0; i < KB_BURSTS_MAX && more; i++) {
+        int n = kb_read_burst(&more, !safety);
+        if (n < 0) {
+            return safety ? 0 : -1;
+        }
+        queued += n;
+    }
+    // Leave the rest for the next call rather than hold the bus
+    s_signalled = more;
+
+    if (safety) {
+        s_stats.safety_polls++;
+        if (queued && ++s_missed >= KB_MISWIRED_POLLS) {
+            Serial.printf("Keyboard: events without the interrupt on GPIO%d, miswired? Polling\n", s_int_pin);
+            detachInterrupt(s_int_pin);
+            s_int_pin = -1;
+        }
+    }
+    return queued;
+}
+
+bool keyboard_next(kb_event_t *event)
+{
+    if (s_tail == s_head) {
+        return false;
+    }
+    *event = s_queue[s_tail & KB_QUEUE_MASK];
+    s_tail++;
+    return true;
+}
+
+size_t keyboard_pending(void)
+{
+    return s_head - s_tail;
+}
+
+void keyboard_get_stats(kb_stats_t *stats)
+{
+    *stats = s_stats;
+    stats->event_mode = s_event_mode;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file      keyboard.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * ESP32-C3 keyboard driver.
+ *
+ * In event mode the keyboard queues every press and release, with the
+ * modifiers held at the time, and pulls BOARD_KEYBOARD_INT low while its
+ * queue is not empty. The interrupt only raises a flag; the next
+ * keyboard_service() from the LVGL thread, which owns the I2C bus shared
+ * with the touch panel, drains the queue in bursts of up to
+ * KB_BURST_EVENTS events at 400 kHz. While no key moves there is no I2C
+ * traffic at all, and keys pressed between two LVGL reads are no longer
+ * lost.
+ *
+ * A burst starts with KB_BURST_MAGIC and a count, then KB_EVENT_BYTES per
+ * event: flags (KB_EVT_PRESSED and the KB_MOD_* bits), the matrix position
+ * col * KB_MATRIX_ROWS + row and the character the key stands for with
+ * those modifiers, 0 for modifiers and unmapped keys. A release carries
+ * the character of its press.
+ *
+ * Keyboard firmware older than the event mode ignores the switch and
+ * answers one character per read; keyboard_begin() notices the missing
+ * magic and keyboard_service() falls back to reading one character per
+ * call, turned into a press and a release, as before.
+ *
+ * An idle keyboard in event mode light sleeps and wakes on a key or on SDA
+ * going low, missing the transaction that woke it. Bursts are normally only
+ * read while it holds the interrupt line, awake; other commands are retried.
+ *
+ * In case the line is not where the keyboard firmware drives it, interrupt
+ * mode still reads once every KB_SAFETY_POLL_MS without it. When those reads
+ * find events twice in a row with the line high, the line is taken for
+ * miswired and the driver falls back to polling every KB_POLL_MS.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define KB_I2C_ADDR             0x55
+#define KB_I2C_FREQ             400000
+#define KB_MATRIX_ROWS          7
+#define KB_MATRIX_COLS          5
+#define KB_BURST_MAGIC          0xEB
+#define KB_BURST_EVENTS         16              // Per read, 50 bytes is within the Wire buffer
+#define KB_EVENT_BYTES          3
+#define KB_BURST_BYTES          (2 + KB_BURST_EVENTS * KB_EVENT_BYTES)
+#define KB_BURSTS_MAX           4               // Per keyboard_service(), the C3 holds 32 events
+#define KB_QUEUE_DEPTH          64              // Power of two
+#define KB_POLL_MS              20              // Event mode without an interrupt line
+#define KB_SAFETY_POLL_MS       250             // Event mode with one, in case it is miswired
+
+#define LILYGO_KB_MODE_EVENT_CMD    0x05
+#define LILYGO_KB_SCAN_RATE_CMD     0x06        // Argument: matrix scan rate / 10 Hz
+
+// Burst count byte
+#define KB_BURST_COUNT_MASK     0x1f
+#define KB_BURST_NO_INT         0x20            // The keyboard has no interrupt line, poll it
+#define KB_BURST_MORE           0x40            // More events still queued on the keyboard
+#define KB_BURST_OVERFLOW       0x80            // The keyboard dropped events since the last burst
+
+// Event flags
+#define KB_EVT_PRESSED          0x80
+#define KB_MOD_SHIFT            0x01
+#define KB_MOD_SYM              0x02
+#define KB_MOD_ALT              0x04
+#define KB_MOD_MIC              0x08
+
+typedef struct {
+    uint8_t  flags;                     // KB_EVT_PRESSED | KB_MOD_*
+    uint8_t  key;                       // col * KB_MATRIX_ROWS + row
+    uint8_t  ch;                        // 0 for modifiers and unmapped keys
+    uint32_t at_ms;                     // millis() when the burst was read
+} kb_event_t;
+
+typedef struct {
+    bool     event_mode;
+    uint32_t bursts;                    // Burst reads, each one I2C transaction
+    uint32_t events;                    // Queued for LVGL
+    uint32_t interrupts;
+    uint32_t safety_polls;              // Reads in interrupt mode without the line low
+    uint32_t overflows;                 // Bursts telling the keyboard dropped events
+    uint32_t dropped;                   // Lost to a full queue here
+    uint32_t bad_bursts;                // Short reads or no magic
+    uint32_t errors;                    // I2C errors
+} kb_stats_t;
+
+// Switch the keyboard on `wire` to event mode and raise the bus to
+// KB_I2C_FREQ. With `int_pin` -1, a keyboard built without its interrupt
+// line or a line found miswired, event mode polls every KB_POLL_MS.
+// Returns true when the keyboard answered in event mode.
+bool keyboard_begin(TwoWire *wire, int int_pin);
+
+// Read what the keyboard has, from the thread that owns the bus. Returns the
+// events queued, or -1 on an I2C error.
+int keyboard_service(void);
+
+// Next queued event, oldest first
+bool keyboard_next(kb_event_t *event);
+size_t keyboard_pending(void);
+
+void keyboard_get_stats(kb_stats_t *stats);
+
+// Parse one burst into the queue, exposed for the unit tests. Returns the
+// events found, or -1 without the magic.
+int keyboard_feed_burst(const uint8_t *buf, size_t len, uint32_t now, bool *more);
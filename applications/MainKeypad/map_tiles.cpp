@@ -0,0 +1,304 @@
+/**
+ * @file      map_tiles.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "map_tiles.h"
+#include <math.h>
+
+#define MAP_LAT_LIMIT           85.0511287798
+
+typedef struct {
+    uint64_t  key;                      // Zoom, x and y, see tile_key()
+    uint16_t *pixels;                   // MAP_TILE_BYTES in PSRAM
+    uint32_t  used;                     // View frame of the last lookup
+    uint32_t  stamp;                    // LRU clock of the last lookup
+    uint8_t   state;                    // map_tile_state_t
+} map_slot_t;
+
+static map_slot_t         slots[MAP_CACHE_SLOTS];
+static uint8_t           *pixel_pool = NULL;
+static uint32_t           lru_clock = 0;
+static uint32_t           latest_frame = 0;
+static uint32_t           generation = 0;
+static QueueHandle_t      requests = NULL;
+static TaskHandle_t       loader_handle = NULL;
+static fs::FS            *tile_fs = NULL;
+static SemaphoreHandle_t  tile_bus = NULL;
+static map_tiles_stats_t  stats;
+
+static map_node_t         nodes[MAP_NODES_MAX];
+static uint32_t           node_count = 0;
+
+static inline uint64_t tile_key(uint8_t zoom, uint32_t x, uint32_t y)
+{
+    return ((uint64_t)zoom << 56) | ((uint64_t)x << 28) | y;
+}
+
+static inline bool bus_take(void)
+{
+    return !tile_bus || xSemaphoreTake(tile_bus, portMAX_DELAY) == pdTRUE;
+}
+
+static inline void bus_give(void)
+{
+    if (tile_bus) {
+        xSemaphoreGive(tile_bus);
+    }
+}
+
+static inline uint8_t slot_state(const map_slot_t *slot)
+{
+    return __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+}
+
+static void loader_task(void *params)
+{
+    while (1) {
+        map_tiles_service(portMAX_DELAY);
+    }
+}
+
+bool map_tiles_begin(fs::FS *fs, SemaphoreHandle_t bus, bool task)
+{
+    tile_fs = fs;
+    tile_bus = bus;
+    if (!pixel_pool) {
+        pixel_pool = (uint8_t *)ps_malloc((size_t)MAP_CACHE_SLOTS * MAP_TILE_BYTES);
+        if (!pixel_pool) {
+            Serial.println("Map: no PSRAM for the tile cache");
+            return false;
+        }
+        for (int i = 0; i < MAP_CACHE_SLOTS; i++) {
+            slots[i].pixels = (uint16_t *)(pixel_pool + (size_t)i * MAP_TILE_BYTES);
+        }
+    }
+    if (!requests) {
+        requests = xQueueCreate(MAP_REQUEST_DEPTH, sizeof(uint8_t));
+        if (!requests) {
+            return false;
+        }
+    }
+    memset(&stats, 0, sizeof(stats));
+    map_tiles_flush();
+
+    if (task && !loader_handle &&
+            xTaskCreate(loader_task, "map", MAP_LOADER_STACK, NULL, MAP_LOADER_PRIORITY, &loader_handle) != pdPASS) {
+        loader_handle = NULL;
+        return false;
+    }
+    return true;
+}
+
+const uint16_t *map_tiles_get(uint8_t zoom, uint32_t x, uint32_t y, uint32_t frame)
+{
+    if (!pixel_pool) {
+        return NULL;
+    }
+    __atomic_store_n(&latest_frame, frame, __ATOMIC_RELAXED);
+
+    uint64_t key = tile_key(zoom, x, y);
+    int victim = -1;
+    uint32_t oldest = UINT32_MAX;
+    for (int i = 0; i < MAP_CACHE_SLOTS; i++) {
+        map_slot_t *slot = &slots[i];
+        uint8_t state = slot_state(slot);
+        if (state != MAP_TILE_EMPTY && slot->key == key) {
+            __atomic_store_n(&slot->used, frame, __ATOMIC_RELAXED);
+            slot->stamp = ++lru_clock;
+            if (state == MAP_TILE_READY) {
+                stats.hits++;
+                return slot->pixels;
+            }
+            return NULL;
+        }
+        // Empty slots first, then the least recently used, never one being loaded
+        uint32_t age = state == MAP_TILE_EMPTY ? 0 : slot->stamp;
+        if (state != MAP_TILE_LOADING && age < oldest) {
+            oldest = age;
+            victim = i;
+        }
+    }
+
+    if (victim < 0) {
+        return NULL;
+    }
+    map_slot_t *slot = &slots[victim];
+    uint8_t previous = slot_state(slot);
+    slot->key = key;
+    slot->used = frame;
+    slot->stamp = ++lru_clock;
+    __atomic_store_n(&slot->state, MAP_TILE_LOADING, __ATOMIC_RELEASE);
+
+    uint8_t index = victim;
+    if (xQueueSend(requests, &index, 0) != pdTRUE) {
+        // Queue full while panning fast, asked again on the next frame
+        __atomic_store_n(&slot->state, MAP_TILE_EMPTY, __ATOMIC_RELEASE);
+        return NULL;
+    }
+    stats.misses++;
+    if (previous == MAP_TILE_READY) {
+        stats.evictions++;
+    }
+    return NULL;
+}
+
+static bool read_tile(const char *path, uint8_t *dst)
+{
+    if (!tile_fs || !bus_take()) {
+        return false;
+    }
+    File file = tile_fs->open(path, FILE_READ);
+    bool ok = file && file.size() == MAP_TILE_BYTES;
+    bus_give();
+
+    for (size_t pos = 0; ok && pos < MAP_TILE_BYTES; pos += MAP_READ_CHUNK) {
+        if (!bus_take()) {
+            ok = false;
+            break;
+        }
+        ok = file.read(dst + pos, MAP_READ_CHUNK) == MAP_READ_CHUNK;
+        bus_give();
+    }
+    if (file && bus_take()) {
+        file.close();
+        bus_give();
+    }
+    return ok;
+}
+
+static_assert(MAP_TILE_BYTES % MAP_READ_CHUNK == 0, "tiles must be read in whole chunks");
+static_assert(MAP_CACHE_SLOTS <= 255, "slot index is sent as a byte");
+
+bool map_tiles_service(TickType_t wait)
+{
+    uint8_t index;
+    if (!requests || xQueueReceive(requests, &index, wait) != pdTRUE) {
+        return false;
+    }
+    map_slot_t *slot = &slots[index];
+
+    // Panned away before its turn came
+    uint32_t frame = __atomic_load_n(&latest_frame, __ATOMIC_RELAXED);
+    if (frame - __atomic_load_n(&slot->used, __ATOMIC_RELAXED) > MAP_STALE_FRAMES) {
+        stats.skipped++;
+        __atomic_store_n(&slot->state, MAP_TILE_EMPTY, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    char path[48];
+    snprintf(path, sizeof(path), MAP_TILE_DIR "/%u/%lu/%lu.565", (unsigned)(slot->key >> 56),
+             (unsigned long)((slot->key >> 28) & 0x0FFFFFFF), (unsigned long)(slot->key & 0x0FFFFFFF));
+
+    uint32_t start = micros();
+    bool ok = read_tile(path, (uint8_t *)slot->pixels);
+    uint32_t elapsed = micros() - start;
+    if (ok) {
+        stats.loads++;
+        if (elapsed > stats.load_us_max) {
+            stats.load_us_max = elapsed;
+        }
+    } else {
+        stats.missing++;
+    }
+    __atomic_store_n(&slot->state, ok ? MAP_TILE_READY : MAP_TILE_MISSING, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&generation, 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint32_t map_tiles_generation(void)
+{
+    return __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+}
+
+map_tile_state_t map_tiles_state(uint8_t zoom, uint32_t x, uint32_t y)
+{
+    uint64_t key = tile_key(zoom, x, y);
+    for (int i = 0; i < MAP_CACHE_SLOTS; i++) {
+        uint8_t state = slot_state(&slots[i]);
+        if (state != MAP_TILE_EMPTY && slots[i].key == key) {
+            return (map_tile_state_t)state;
+        }
+    }
+    return MAP_TILE_EMPTY;
+}
+
+void map_tiles_get_stats(map_tiles_stats_t *out)
+{
+    *out = stats;
+}
+
+void map_tiles_flush(void)
+{
+    for (int i = 0; i < MAP_CACHE_SLOTS; i++) {
+        // Slots being loaded finish on their own and are replaced later
+        if (slot_state(&slots[i]) != MAP_TILE_LOADING) {
+            __atomic_store_n(&slots[i].state, MAP_TILE_EMPTY, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+void map_project(double lat, double lng, uint32_t *mx, uint32_t *my)
+{
+    lat = constrain(lat, -MAP_LAT_LIMIT, MAP_LAT_LIMIT);
+    double x = (lng + 180.0) / 360.0;
+    double s = sin(lat * M_PI / 180.0);
+    double y = 0.5 - log((1.0 + s) / (1.0 - s)) / (4.0 * M_PI);
+    *mx = (uint32_t)constrain(x * 4294967296.0, 0.0, 4294967295.0);
+    *my = (uint32_t)constrain(y * 4294967296.0, 0.0, 4294967295.0);
+}
+
+uint32_t map_nodes_load(fs::FS *fs)
+{
+    node_count = 0;
+    const size_t size = MAP_NODES_MAX * 40;
+    char *text = (char *)malloc(size + 1);
+    if (!text || !fs || !bus_take()) {
+        free(text);
+        return 0;
+    }
+    File file = fs->open(MAP_NODES_FILE, FILE_READ);
+    size_t len = file ? file.read((uint8_t *)text, size) : 0;
+    file.close();
+    bus_give();
+    text[len] = '\0';
+
+    // "<node id hex>,<lat>,<lon>" per line, anything else is skipped
+    for (char *line = text; line && *line && node_count < MAP_NODES_MAX;) {
+        char *next = strchr(line, '\n');
+        if (next) {
+            *next++ = '\0';
+        }
+        char *end;
+        uint32_t id = strtoul(line, &end, 16);
+        if (id && *end == ',') {
+            double lat = strtod(end + 1, &end);
+            if (*end == ',') {
+                double lng = strtod(end + 1, &end);
+                if (*end == '\0' || *end == '\r') {
+                    map_node_t *node = &nodes[node_count++];
+                    node->node_id = id;
+                    map_project(lat, lng, &node->mx, &node->my);
+                }
+            }
+        }
+        line = next;
+    }
+    free(text);
+    Serial.printf("Map: %lu node positions\n", (unsigned long)node_count);
+    return node_count;
+}
+
+uint32_t map_nodes_count(void)
+{
+    return node_count;
+}
+
+const map_node_t *map_nodes_get(uint32_t index)
+{
+    return index < node_count ? &nodes[index] : NULL;
+}
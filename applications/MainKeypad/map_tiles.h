@@ -0,0 +1,112 @@
+/**
+ * @file      map_tiles.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Map tiles for the node map page.
+ *
+ * Tiles are pre-rendered on a PC in Web Mercator, 128 x 128 pixels, and
+ * stored on SD as raw RGB565 in the display byte order, so loading a tile
+ * is a plain read with nothing to decode:
+ *
+ *     /map/<zoom>/<x>/<y>.565
+ *
+ * Loaded tiles live in a PSRAM cache with least recently used eviction.
+ * The LVGL task only ever looks tiles up; a miss queues the tile for the
+ * loader task and the map draws a placeholder until it is resident, so a
+ * slow SD card never stalls a frame. The loader reads in chunks and gives
+ * the SPI bus back between them, the display keeps flushing meanwhile.
+ *
+ * Positions are kept as fractions of the Mercator world in 32 bits, which
+ * gives a pixel coordinate at any zoom with a shift.
+ *
+ * Node positions come from /map/nodes.csv on the same card, one
+ * "<node id hex>,<lat>,<lon>" line per node, written by the installer with
+ * the tiles.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+#define MAP_TILE_SIZE           128
+#define MAP_TILE_SHIFT          7
+#define MAP_TILE_BYTES          (MAP_TILE_SIZE * MAP_TILE_SIZE * 2)
+#define MAP_TILE_DIR            "/map"
+#define MAP_NODES_FILE          "/map/nodes.csv"
+#define MAP_ZOOM_MIN            2
+#define MAP_ZOOM_MAX            18
+#define MAP_CACHE_SLOTS         48              // 1.5 MB of PSRAM, four screens of tiles
+#define MAP_REQUEST_DEPTH       16
+#define MAP_READ_CHUNK          4096            // SPI bus held for one chunk at a time
+#define MAP_STALE_FRAMES        4               // View changes before a queued tile is skipped
+#define MAP_NODES_MAX           128
+#define MAP_LOADER_PRIORITY     1               // Below the LVGL and GPS tasks
+#define MAP_LOADER_STACK        (4 * 1024)
+
+typedef enum : uint8_t {
+    MAP_TILE_EMPTY = 0,
+    MAP_TILE_LOADING,                   // Owned by the loader task
+    MAP_TILE_READY,
+    MAP_TILE_MISSING,                   // No such file, cached so it is not retried
+} map_tile_state_t;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;                    // Loads queued
+    uint32_t loads;
+    uint32_t missing;
+    uint32_t skipped;                   // Dropped as stale before the read
+    uint32_t evictions;
+    uint32_t load_us_max;
+} map_tiles_stats_t;
+
+typedef struct {
+    uint32_t node_id;
+    uint32_t mx;                        // Mercator world fraction, 0 = west/north edge
+    uint32_t my;
+} map_node_t;
+
+// Allocate the cache and start the loader. `fs` is the SD card, `bus` the
+// mutex guarding its SPI bus (NULL when not shared). Without `task` requests
+// are only served by map_tiles_service(), as in the unit tests.
+bool map_tiles_begin(fs::FS *fs, SemaphoreHandle_t bus, bool task);
+
+// LVGL task. Pixels of a resident tile, or NULL after queueing its load.
+// `frame` counts the caller's view changes, queued tiles not asked for in
+// the last MAP_STALE_FRAMES of them are dropped unread.
+const uint16_t *map_tiles_get(uint8_t zoom, uint32_t x, uint32_t y, uint32_t frame);
+
+// Load one queued tile, waits up to `wait` for a request. Returns false on timeout.
+bool map_tiles_service(TickType_t wait);
+
+// Bumped whenever a tile finishes loading, the view redraws when it changes
+uint32_t map_tiles_generation(void);
+
+map_tile_state_t map_tiles_state(uint8_t zoom, uint32_t x, uint32_t y);
+void map_tiles_get_stats(map_tiles_stats_t *stats);
+
+// Drop every cached tile, the card was swapped
+void map_tiles_flush(void);
+
+// Web Mercator, latitudes are clamped to the +-85.05 degree square
+void map_project(double lat, double lng, uint32_t *mx, uint32_t *my);
+
+// Pixel of a world fraction at `zoom`
+static inline int32_t map_world_px(uint32_t m, uint8_t zoom)
+{
+    return (int32_t)(m >> (32 - MAP_TILE_SHIFT - zoom));
+}
+
+static inline uint32_t map_world_size(uint8_t zoom)
+{
+    return (uint32_t)MAP_TILE_SIZE << zoom;
+}
+
+// Node positions from MAP_NODES_FILE, returns how many were read
+uint32_t map_nodes_load(fs::FS *fs);
+uint32_t map_nodes_count(void);
+const map_node_t *map_nodes_get(uint32_t index);
@@ -0,0 +1,392 @@
+/**
+ * @file      mic_array.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "mic_array.h"
+#include "mic_capture.h"
+#include "dsp_fft.h"
+#include <math.h>
+
+#define MIC_ARRAY_PAIRS_MAX     (MIC_ARRAY_MICS_MAX * (MIC_ARRAY_MICS_MAX - 1) / 2)
+#define MIC_ARRAY_AZIMUTHS      (360 / MIC_ARRAY_AZIMUTH_STEP)
+#define MIC_ARRAY_BINS          (MIC_ARRAY_FFT_SIZE / 2 + 1)
+
+static_assert(MIC_ARRAY_FFT_SIZE <= DSP_FFT_SIZE_MAX, "MIC_ARRAY_FFT_SIZE above the shared FFT table");
+
+static mic_position_t     mic_pos[MIC_ARRAY_MICS_MAX];
+static uint8_t            mic_count = 0;
+static uint8_t            pair_a[MIC_ARRAY_PAIRS_MAX];
+static uint8_t            pair_b[MIC_ARRAY_PAIRS_MAX];
+static uint8_t            pair_count = 0;
+static float              pair_lag[MIC_ARRAY_PAIRS_MAX][MIC_ARRAY_AZIMUTHS];    // Expected lag per azimuth
+static float              mic_lead[MIC_ARRAY_MICS_MAX][MIC_ARRAY_AZIMUTHS];     // Samples ahead of the centre
+static int16_t            azimuth_first;
+static uint16_t           azimuth_count;
+static uint16_t           lag_max;
+static uint16_t           band_lo, band_hi;
+
+static float              window[MIC_ARRAY_FFT_SIZE];
+static float              fft_buf[2 * MIC_ARRAY_FFT_SIZE];                      // Interleaved re, im
+static float              spectra[MIC_ARRAY_MICS_MAX][2 * MIC_ARRAY_BINS];
+static float              lags[MIC_ARRAY_PAIRS_MAX][2 * MIC_ARRAY_LAG_MAX + 1];
+static float              response[MIC_ARRAY_AZIMUTHS];                         // Of the last block
+static float              event_response[MIC_ARRAY_AZIMUTHS];                   // Summed over the event
+static uint32_t           event_blocks = 0;
+
+static int                consumer = -1;
+static TaskHandle_t       array_handle = NULL;
+static int16_t            block[MIC_ARRAY_FFT_SIZE * MIC_CHANNELS_MAX];
+static int16_t            planar_buf[MIC_CHANNELS_MAX][MIC_ARRAY_FFT_SIZE];
+static uint64_t           noise_floor = 0;
+static mic_array_stats_t  stats;
+
+static mic_doa_t          latest;
+static uint32_t           latest_version = 0;
+
+static const char *const sectors[] = {
+    "Front", "Front right", "Right", "Back right", "Back", "Back left", "Left", "Front left",
+};
+
+void mic_deinterleave(const int16_t *in, size_t frames, uint8_t channels, int16_t *const *out)
+{
+    if (channels == 4) {
+        int16_t *c0 = out[0], *c1 = out[1], *c2 = out[2], *c3 = out[3];
+        for (size_t i = 0; i < frames; i++, in += 4) {
+            c0[i] = in[0];
+            c1[i] = in[1];
+            c2[i] = in[2];
+            c3[i] = in[3];
+        }
+        return;
+    }
+    for (size_t i = 0; i < frames; i++) {
+        for (uint8_t ch = 0; ch < channels; ch++) {
+            out[ch][i] = *in++;
+        }
+    }
+}
+
+static void array_task(void *params)
+{
+    consumer = mic_capture_subscribe("doa");
+    while (1) {
+        mic_array_service(portMAX_DELAY);
+    }
+}
+
+bool mic_array_begin(const mic_position_t *mics, uint8_t count, uint32_t sample_rate, bool task)
+{
+    if (count < 2 || count > MIC_ARRAY_MICS_MAX || !sample_rate) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (mics[i].channel >= MIC_CHANNELS_MAX) {
+            return false;
+        }
+    }
+    memcpy(mic_pos, mics, count * sizeof(mic_position_t));
+    mic_count = count;
+
+    if (!dsp_fft_init()) {
+        return false;
+    }
+    for (int n = 0; n < MIC_ARRAY_FFT_SIZE; n++) {
+        window[n] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * n / MIC_ARRAY_FFT_SIZE);
+    }
+    band_lo = MIC_ARRAY_BAND_LO_HZ * MIC_ARRAY_FFT_SIZE / sample_rate;
+    band_hi = min((uint32_t)MIC_ARRAY_BAND_HI_HZ * MIC_ARRAY_FFT_SIZE / sample_rate, (uint32_t)MIC_ARRAY_FFT_SIZE / 2 - 1);
+    band_lo = max(band_lo, (uint16_t)1);
+
+    // Two microphones only see the angle to their axis, search one half
+    azimuth_first = count == 2 ? -90 : 0;
+    azimuth_count = count == 2 ? 180 / MIC_ARRAY_AZIMUTH_STEP + 1 : MIC_ARRAY_AZIMUTHS;
+
+    // A source in direction u reaches microphone p (p . u) / c early
+    const float scale = (float)sample_rate / MIC_ARRAY_SOUND_MM_S;
+    float lead_max = 0;
+    for (uint16_t a = 0; a < azimuth_count; a++) {
+        float rad = (azimuth_first + a * MIC_ARRAY_AZIMUTH_STEP) * (float)M_PI / 180.0f;
+        float ux = sinf(rad), uy = cosf(rad);
+        for (uint8_t m = 0; m < count; m++) {
+            mic_lead[m][a] = (mic_pos[m].x_mm * ux + mic_pos[m].y_mm * uy) * scale;
+        }
+    }
+    pair_count = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        for (uint8_t j = i + 1; j < count; j++, pair_count++) {
+            pair_a[pair_count] = i;
+            pair_b[pair_count] = j;
+            for (uint16_t a = 0; a < azimuth_count; a++) {
+                pair_lag[pair_count][a] = mic_lead[j][a] - mic_lead[i][a];
+                lead_max = max(lead_max, fabsf(pair_lag[pair_count][a]));
+            }
+        }
+    }
+    lag_max = (uint16_t)ceilf(lead_max) + 2;              // Room for the cubic on either side
+    if (lag_max > MIC_ARRAY_LAG_MAX) {
+        Serial.println("Mic array: microphones too far apart");
+        return false;
+    }
+
+    noise_floor = 0;
+    event_blocks = 0;
+    memset(&stats, 0, sizeof(stats));
+    __atomic_store_n(&latest_version, latest_version + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memset(&latest, 0, sizeof(latest));
+    __atomic_store_n(&latest_version, latest_version + 1, __ATOMIC_RELEASE);
+
+    if (!task) {
+        if (consumer < 0) {
+            consumer = mic_capture_subscribe("doa");
+        }
+        return consumer >= 0;
+    }
+    if (!array_handle &&
+            xTaskCreate(array_task, "doa", MIC_ARRAY_TASK_STACK, NULL, MIC_ARRAY_TASK_PRIORITY, &array_handle) != pdPASS) {
+        array_handle = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Correlation of a pair at a fractional lag. Cubic, a linear one peaks at
+// whole lags only and would pull every azimuth to the few they give.
+static inline float lag_at(const float *r, float lag)
+{
+    float pos = lag + lag_max;
+    int i = (int)pos;
+    float f = pos - i;
+    float p0 = r[i - 1], p1 = r[i], p2 = r[i + 1], p3 = r[i + 2];
+    return p1 + 0.5f * f * (p2 - p0 + f * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3 + f * (3.0f * (p1 - p2) + p3 - p0)));
+}
+
+// PHAT weighted cross spectrum of a pair at bin k
+static inline void phat(uint8_t p, int k, float *re, float *im)
+{
+    const float *x = &spectra[pair_a[p]][2 * k];
+    const float *y = &spectra[pair_b[p]][2 * k];
+    float gr = x[0] * y[0] + x[1] * y[1];
+    float gi = x[1] * y[0] - x[0] * y[1];
+    float mag = sqrtf(gr * gr + gi * gi) + 1e-12f;
+    *re = gr / mag;
+    *im = gi / mag;
+}
+
+// Steered response of one block into `response`
+static void steer(const int16_t *const *planar)
+{
+    const int n = MIC_ARRAY_FFT_SIZE;
+
+    // Two real microphones per complex FFT, separated by symmetry
+    for (uint8_t m = 0; m < mic_count; m += 2) {
+        const int16_t *a = planar[mic_pos[m].channel];
+        const int16_t *b = m + 1 < mic_count ? planar[mic_pos[m + 1].channel] : NULL;
+        for (int i = 0; i < n; i++) {
+            fft_buf[2 * i] = a[i] * window[i];
+            fft_buf[2 * i + 1] = b ? b[i] * window[i] : 0.0f;
+        }
+        dsp_fft(fft_buf, MIC_ARRAY_FFT_SIZE);
+        for (int k = 0; k < MIC_ARRAY_BINS; k++) {
+            const float *z = &fft_buf[2 * k];
+            const float *zc = &fft_buf[2 * ((n - k) & (n - 1))];
+            spectra[m][2 * k] = 0.5f * (z[0] + zc[0]);
+            spectra[m][2 * k + 1] = 0.5f * (z[1] - zc[1]);
+            if (b) {
+                spectra[m + 1][2 * k] = 0.5f * (z[1] + zc[1]);
+                spectra[m + 1][2 * k + 1] = 0.5f * (zc[0] - z[0]);
+            }
+        }
+    }
+
+    // Correlations are real: two pairs per inverse FFT, one in each part
+    for (uint8_t p = 0; p < pair_count; p += 2) {
+        bool second = p + 1 < pair_count;
+        memset(fft_buf, 0, sizeof(fft_buf));
+        for (int k = band_lo; k <= band_hi; k++) {
+            float g1r, g1i, g2r = 0, g2i = 0;
+            phat(p, k, &g1r, &g1i);
+            if (second) {
+                phat(p + 1, k, &g2r, &g2i);
+            }
+            // W[k] = G1 + jG2, W[n - k] = conj(G1) + j conj(G2), stored
+            // conjugated so the forward FFT computes the inverse
+            fft_buf[2 * k] = g1r - g2i;
+            fft_buf[2 * k + 1] = -(g1i + g2r);
+            fft_buf[2 * (n - k)] = g1r + g2i;
+            fft_buf[2 * (n - k) + 1] = g1i - g2r;
+        }
+        dsp_fft(fft_buf, MIC_ARRAY_FFT_SIZE);
+        for (int l = -lag_max; l <= lag_max; l++) {
+            const float *r = &fft_buf[2 * (l & (n - 1))];
+            lags[p][l + lag_max] = r[0] / n;
+            if (second) {
+                lags[p + 1][l + lag_max] = -r[1] / n;
+            }
+        }
+    }
+
+    // Every pair's correlation at the lags of each direction
+    for (uint16_t a = 0; a < azimuth_count; a++) {
+        float sum = 0;
+        for (uint8_t p = 0; p < pair_count; p++) {
+            sum += lag_at(lags[p], pair_lag[p][a]);
+        }
+        response[a] = sum;
+    }
+}
+
+// Strongest direction of a response summed over `blocks`
+static bool pick(const float *sum, uint32_t blocks, mic_doa_t *doa)
+{
+    uint16_t best = 0;
+    for (uint16_t a = 1; a < azimuth_count; a++) {
+        if (sum[a] > sum[best]) {
+            best = a;
+        }
+    }
+    // A perfectly coherent pair peaks at the share of bins in the band
+    float peak = blocks * pair_count * 2.0f * (band_hi - band_lo + 1) / MIC_ARRAY_FFT_SIZE;
+    int coherence = (int)(100.0f * sum[best] / peak + 0.5f);
+    doa->azimuth = azimuth_first + best * MIC_ARRAY_AZIMUTH_STEP;
+    doa->coherence = (uint8_t)constrain(coherence, 0, 100);
+    return doa->coherence >= MIC_ARRAY_MIN_COHERENCE;
+}
+
+bool mic_array_estimate(const int16_t *const *planar, mic_doa_t *doa)
+{
+    if (mic_count < 2) {
+        return false;
+    }
+    steer(planar);
+    return pick(response, 1, doa);
+}
+
+size_t mic_array_beamform(const int16_t *const *planar, size_t frames, int16_t azimuth, int16_t *out)
+{
+    if (mic_count < 2) {
+        return 0;
+    }
+    int a = (azimuth - azimuth_first) / MIC_ARRAY_AZIMUTH_STEP;
+    a = constrain(a, 0, azimuth_count - 1);
+
+    // Read each microphone later by how much earlier the others hear it
+    float lead_max = -1e30f;
+    for (uint8_t m = 0; m < mic_count; m++) {
+        lead_max = max(lead_max, mic_lead[m][a]);
+    }
+    const int16_t *src[MIC_ARRAY_MICS_MAX];
+    size_t shift_max = 0;
+    for (uint8_t m = 0; m < mic_count; m++) {
+        size_t shift = (size_t)lroundf(lead_max - mic_lead[m][a]);
+        src[m] = planar[mic_pos[m].channel] + shift;
+        shift_max = max(shift_max, shift);
+    }
+    if (frames <= shift_max) {
+        return 0;
+    }
+    frames -= shift_max;
+    for (size_t i = 0; i < frames; i++) {
+        int32_t sum = 0;
+        for (uint8_t m = 0; m < mic_count; m++) {
+            sum += src[m][i];
+        }
+        out[i] = (int16_t)(sum / mic_count);
+    }
+    return frames;
+}
+
+bool mic_array_service(TickType_t wait)
+{
+    if (consumer < 0 || mic_capture_read(consumer, block, MIC_ARRAY_FFT_SIZE, wait) != MIC_ARRAY_FFT_SIZE) {
+        return false;
+    }
+    uint8_t channels = mic_capture_channels();
+    stats.blocks++;
+
+    // Level of the first microphone against the floor of the quiet blocks
+    uint8_t first = mic_pos[0].channel;
+    if (first >= channels) {
+        return true;
+    }
+    uint64_t energy = 0;
+    for (int i = 0; i < MIC_ARRAY_FFT_SIZE; i++) {
+        int32_t s = block[i * channels + first];
+        energy += (uint64_t)(s * s);
+    }
+    energy /= MIC_ARRAY_FFT_SIZE;
+    uint16_t rms = (uint16_t)sqrtf((float)energy);
+
+    if (stats.blocks == 1) {
+        noise_floor = energy;
+    }
+    if (energy <= noise_floor * MIC_ARRAY_ONSET_RATIO || rms < MIC_ARRAY_MIN_RMS) {
+        noise_floor = noise_floor + ((int64_t)(energy - noise_floor) >> MIC_ARRAY_FLOOR_SHIFT);
+        stats.noise_floor = (uint32_t)min(noise_floor, (uint64_t)UINT32_MAX);
+        event_blocks = 0;
+        return true;
+    }
+    stats.onsets++;
+
+    int16_t *planar[MIC_CHANNELS_MAX];
+    for (uint8_t ch = 0; ch < channels; ch++) {
+        planar[ch] = planar_buf[ch];
+    }
+    mic_deinterleave(block, MIC_ARRAY_FFT_SIZE, channels, planar);
+
+    // Loud blocks in a row are one event, the direction firms up as it lasts
+    uint32_t start = micros();
+    steer(planar);
+    if (!event_blocks) {
+        memset(event_response, 0, sizeof(event_response));
+    }
+    for (uint16_t a = 0; a < azimuth_count; a++) {
+        event_response[a] += response[a];
+    }
+    mic_doa_t doa;
+    bool ok = pick(event_response, ++event_blocks, &doa);
+    uint32_t elapsed = micros() - start;
+    if (elapsed > stats.doa_us_max) {
+        stats.doa_us_max = elapsed;
+    }
+    if (!ok) {
+        return true;
+    }
+    stats.estimates++;
+    doa.rms = rms;
+    doa.at_ms = millis();
+    doa.count = stats.estimates;
+
+    __atomic_store_n(&latest_version, latest_version + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    latest = doa;
+    __atomic_store_n(&latest_version, latest_version + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void mic_array_latest(mic_doa_t *doa)
+{
+    uint32_t v1, v2;
+    do {
+        v1 = __atomic_load_n(&latest_version, __ATOMIC_ACQUIRE);
+        *doa = latest;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        v2 = __atomic_load_n(&latest_version, __ATOMIC_RELAXED);
+    } while (v1 != v2 || (v1 & 1));
+}
+
+void mic_array_get_stats(mic_array_stats_t *out)
+{
+    *out = stats;
+}
+
+const char *mic_array_sector(int16_t azimuth)
+{
+    int a = ((azimuth % 360) + 360 + 22) % 360;
+    return sectors[a / 45];
+}
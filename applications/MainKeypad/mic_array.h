@@ -0,0 +1,97 @@
+/**
+ * @file      mic_array.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Direction of a noise from the ES7210 microphones.
+ *
+ * The ES7210 runs in TDM, its four ADC channels interleaved in the capture
+ * ring (mic_capture.h). A consumer task watches the level of the first
+ * microphone against a slowly tracked noise floor; a block rising well
+ * above it is split into channels and its direction estimated by
+ * SRP-PHAT: the GCC-PHAT cross correlation of every microphone pair is
+ * summed at the lags each candidate azimuth would give, and the azimuth
+ * with the highest sum wins. Loud blocks in a row are one event and their
+ * sums add up, so the direction firms up while the noise lasts.
+ *
+ * Spectra come from one complex FFT per two microphones and correlations
+ * from one inverse FFT per two pairs. On the ESP32-S3 the FFTs are the
+ * esp-dsp ones using the vector instructions.
+ *
+ * Azimuths are degrees clockwise from the keypad's top edge (+y), with
+ * microphone positions in millimetres in the same frame. With two
+ * microphones front and back cannot be told apart and azimuths are
+ * reported between -90 and +90.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define MIC_ARRAY_MICS_MAX          4
+#define MIC_ARRAY_FFT_SIZE          512             // 32 ms at 16 kHz, one analysis block
+#define MIC_ARRAY_LAG_MAX           16              // Samples, 34 cm of path difference at 16 kHz
+#define MIC_ARRAY_AZIMUTH_STEP      5               // Degrees between candidate directions
+#define MIC_ARRAY_BAND_LO_HZ        200             // Correlated band, below is handling and wind noise
+#define MIC_ARRAY_BAND_HI_HZ        6000
+#define MIC_ARRAY_SOUND_MM_S        343000
+#define MIC_ARRAY_ONSET_RATIO       8               // Block energy over the noise floor, 9 dB
+#define MIC_ARRAY_MIN_RMS           40              // Ignore onsets in near silence
+#define MIC_ARRAY_FLOOR_SHIFT       5               // Noise floor follows quiet blocks over ~1 s
+#define MIC_ARRAY_MIN_COHERENCE     20              // Percent, below it the direction is not reported
+#define MIC_ARRAY_TASK_PRIORITY     4               // Below the capture and VAD tasks
+#define MIC_ARRAY_TASK_STACK        (4 * 1024)
+
+typedef struct {
+    int16_t x_mm;
+    int16_t y_mm;
+    uint8_t channel;                    // TDM slot of the microphone
+} mic_position_t;
+
+typedef struct {
+    int16_t  azimuth;                   // Degrees, see above
+    uint8_t  coherence;                 // Percent of a perfect correlation at that azimuth
+    uint16_t rms;                       // Level of the block, first microphone
+    uint32_t at_ms;                     // millis() of the estimate
+    uint32_t count;                     // Estimates since begin, 0 when none yet
+} mic_doa_t;
+
+typedef struct {
+    uint32_t blocks;                    // Blocks examined
+    uint32_t onsets;                    // Blocks above the onset level
+    uint32_t estimates;                 // Directions reported
+    uint32_t doa_us_max;                // Longest estimate
+    uint32_t noise_floor;               // Mean square of quiet blocks
+} mic_array_stats_t;
+
+// Split `frames` interleaved frames of `channels` into one buffer per channel
+void mic_deinterleave(const int16_t *in, size_t frames, uint8_t channels, int16_t *const *out);
+
+// Set the microphone geometry and sample rate, then with `task` start the
+// consumer of the capture ring. Without it blocks are only examined by
+// mic_array_service(), as in the unit tests.
+bool mic_array_begin(const mic_position_t *mics, uint8_t count, uint32_t sample_rate, bool task);
+
+// Examine the next block from the capture ring, waits up to `wait` for it.
+// Returns false when no block was available.
+bool mic_array_service(TickType_t wait);
+
+// Direction of one block, `planar` holds MIC_ARRAY_FFT_SIZE samples per
+// TDM channel. Returns false when the correlation is too weak to trust.
+bool mic_array_estimate(const int16_t *const *planar, mic_doa_t *doa);
+
+// Delay and sum steered at `azimuth`: each microphone is advanced by its
+// lead for that direction and the sum scaled back to one. Writes and
+// returns `frames` less the largest relative delay, the tail needs
+// samples past the end of the block.
+size_t mic_array_beamform(const int16_t *const *planar, size_t frames, int16_t azimuth, int16_t *out);
+
+// Latest reported direction, consistent while the task updates it
+void mic_array_latest(mic_doa_t *doa);
+
+void mic_array_get_stats(mic_array_stats_t *stats);
+
+// One of eight sectors around the keypad for the UI, "Front", "Front right" ...
+const char *mic_array_sector(int16_t azimuth);
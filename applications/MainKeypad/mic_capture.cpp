@@ -0,0 +1,308 @@
+/**
+ * @file      mic_capture.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "mic_capture.h"
+
+#define MIC_RING_MASK           (MIC_RING_FRAMES - 1)
+
+typedef struct {
+    const char  *name;
+    TaskHandle_t task;                  // Notified after every commit
+    uint32_t     pos;                   // Next frame to read
+    uint32_t     frames;
+    uint32_t     lag_max;
+    uint32_t     overruns;
+    uint32_t     lost_frames;
+    bool         used;
+} mic_consumer_t;
+
+static int16_t            *ring = NULL;
+static uint8_t             ring_channels = 1;
+static uint32_t            write_pos = 0;
+static i2s_port_t          capture_port;
+static TaskHandle_t        capture_handle = NULL;
+static mic_consumer_t      consumers[MIC_CONSUMERS_MAX];
+static mic_capture_stats_t stats;
+
+static_assert((MIC_RING_FRAMES & MIC_RING_MASK) == 0, "ring index is masked");
+static_assert(MIC_RING_FRAMES % MIC_CAPTURE_CHUNK == 0, "chunks must not straddle the ring end");
+
+static inline uint32_t written(void)
+{
+    return __atomic_load_n(&write_pos, __ATOMIC_ACQUIRE);
+}
+
+static void capture_task(void *params)
+{
+    const size_t frame_bytes = ring_channels * sizeof(int16_t);
+    while (1) {
+        size_t frames;
+        int16_t *dst = mic_capture_space(&frames);
+        size_t bytes = 0;
+        // Blocks until the DMA has the whole chunk, the next read is issued
+        // straight away so the driver never runs out of buffers
+        esp_err_t err = i2s_read(capture_port, dst, frames * frame_bytes, &bytes, portMAX_DELAY);
+        if (err != ESP_OK || bytes != frames * frame_bytes) {
+            stats.short_reads++;
+        }
+        if (bytes >= frame_bytes) {
+            mic_capture_commit(bytes / frame_bytes);
+        }
+    }
+}
+
+bool mic_capture_begin(i2s_port_t port, uint8_t channels, bool task)
+{
+    if (channels == 0 || channels > MIC_CHANNELS_MAX) {
+        return false;
+    }
+    if (!ring) {
+        // Sized for the most channels so a format change never reallocates
+        ring = (int16_t *)ps_malloc((size_t)MIC_RING_FRAMES * MIC_CHANNELS_MAX * sizeof(int16_t));
+        if (!ring) {
+            Serial.println("Mic: no PSRAM for the capture ring");
+            return false;
+        }
+    }
+    capture_port = port;
+    ring_channels = channels;
+    __atomic_store_n(&write_pos, 0, __ATOMIC_RELEASE);
+    for (int i = 0; i < MIC_CONSUMERS_MAX; i++) {
+        consumers[i].pos = 0;
+    }
+    memset(&stats, 0, sizeof(stats));
+
+    if (task && !capture_handle &&
+            xTaskCreate(capture_task, "mic", MIC_CAPTURE_STACK, NULL, MIC_CAPTURE_PRIORITY, &capture_handle) != pdPASS) {
+        capture_handle = NULL;
+        return false;
+    }
+    return true;
+}
+
+void mic_capture_stop(void)
+{
+    if (capture_handle) {
+        vTaskDelete(capture_handle);
+        capture_handle = NULL;
+    }
+}
+
+uint8_t mic_capture_channels(void)
+{
+    return ring_channels;
+}
+
+uint32_t mic_capture_position(void)
+{
+    return written();
+}
+
+int16_t *mic_capture_space(size_t *frames)
+{
+    uint32_t index = write_pos & MIC_RING_MASK;
+    uint32_t room = MIC_RING_FRAMES - index;
+    *frames = room < MIC_CAPTURE_CHUNK ? room : MIC_CAPTURE_CHUNK;
+    return ring + (size_t)index * ring_channels;
+}
+
+void mic_capture_commit(size_t frames)
+{
+    __atomic_store_n(&write_pos, write_pos + (uint32_t)frames, __ATOMIC_RELEASE);
+    stats.frames += frames;
+    for (int i = 0; i < MIC_CONSUMERS_MAX; i++) {
+        mic_consumer_t *c = &consumers[i];
+        if (__atomic_load_n(&c->used, __ATOMIC_ACQUIRE) && c->task) {
+            xTaskNotifyGive(c->task);
+        }
+    }
+}
+
+int mic_capture_subscribe(const char *name)
+{
+    for (int i = 0; i < MIC_CONSUMERS_MAX; i++) {
+        mic_consumer_t *c = &consumers[i];
+        bool expected = false;
+        if (!__atomic_load_n(&c->used, __ATOMIC_RELAXED) &&
+                __atomic_compare_exchange_n(&c->used, &expected, true, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            c->name = name;
+            c->task = xTaskGetCurrentTaskHandle();
+            c->frames = 0;
+            c->lag_max = 0;
+            c->overruns = 0;
+            c->lost_frames = 0;
+            __atomic_store_n(&c->pos, written(), __ATOMIC_RELEASE);
+            return i;
+        }
+    }
+    return -1;
+}
+
+void mic_capture_unsubscribe(int id)
+{
+    if (id >= 0 && id < MIC_CONSUMERS_MAX) {
+        __atomic_store_n(&consumers[id].used, false, __ATOMIC_RELEASE);
+    }
+}
+
+static inline mic_consumer_t *consumer(int id)
+{
+    if (!ring || id < 0 || id >= MIC_CONSUMERS_MAX || !consumers[id].used) {
+        return NULL;
+    }
+    return &consumers[id];
+}
+
+// The writer may be filling the chunk after `w`, frames from there back to a
+// whole ring behind it are safe to read
+static inline bool intact(uint32_t w, uint32_t pos)
+{
+    return w - pos + MIC_CAPTURE_CHUNK <= MIC_RING_FRAMES;
+}
+
+// Move a cursor the writer has lapped to the oldest frame still held
+static uint32_t catch_up(mic_consumer_t *c, uint32_t w)
+{
+    if (!intact(w, c->pos)) {
+        uint32_t oldest = w + MIC_CAPTURE_CHUNK - MIC_RING_FRAMES;
+        c->overruns++;
+        c->lost_frames += oldest - c->pos;
+        c->pos = oldest;
+    }
+    uint32_t lag = w - c->pos;
+    if (lag > c->lag_max) {
+        c->lag_max = lag;
+    }
+    return lag;
+}
+
+static bool wait_for(mic_consumer_t *c, size_t frames, TickType_t wait)
+{
+    while (catch_up(c, written()) < frames) {
+        if (!wait || !c->task || ulTaskNotifyTake(pdTRUE, wait) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t read_frames(int id, int channel, int16_t *dst, size_t frames, TickType_t wait)
+{
+    mic_consumer_t *c = consumer(id);
+    if (!c || frames == 0 || frames > MIC_RING_FRAMES - MIC_CAPTURE_CHUNK) {
+        return 0;
+    }
+    while (wait_for(c, frames, wait)) {
+        uint32_t pos = c->pos;
+        int16_t *out = dst;
+        for (size_t left = frames; left;) {
+            uint32_t index = pos & MIC_RING_MASK;
+            size_t run = MIC_RING_FRAMES - index;
+            if (run > left) {
+                run = left;
+            }
+            const int16_t *src = ring + (size_t)index * ring_channels;
+            if (channel < 0) {
+                memcpy(out, src, run * ring_channels * sizeof(int16_t));
+                out += run * ring_channels;
+            } else {
+                src += channel;
+                for (size_t i = 0; i < run; i++, src += ring_channels) {
+                    *out++ = *src;
+                }
+            }
+            pos += run;
+            left -= run;
+        }
+        // Lapped while copying: count it and read again from the oldest frame
+        if (intact(written(), c->pos)) {
+            c->pos = pos;
+            c->frames += frames;
+            return frames;
+        }
+    }
+    return 0;
+}
+
+size_t mic_capture_read(int id, int16_t *dst, size_t frames, TickType_t wait)
+{
+    return read_frames(id, -1, dst, frames, wait);
+}
+
+size_t mic_capture_read_channel(int id, uint8_t channel, int16_t *dst, size_t frames, TickType_t wait)
+{
+    if (channel >= ring_channels) {
+        return 0;
+    }
+    return read_frames(id, channel, dst, frames, wait);
+}
+
+size_t mic_capture_available(int id)
+{
+    mic_consumer_t *c = consumer(id);
+    return c ? catch_up(c, written()) : 0;
+}
+
+uint32_t mic_capture_cursor(int id)
+{
+    mic_consumer_t *c = consumer(id);
+    if (!c) {
+        return 0;
+    }
+    catch_up(c, written());
+    return c->pos;
+}
+
+const int16_t *mic_capture_peek(int id, size_t *frames)
+{
+    mic_consumer_t *c = consumer(id);
+    *frames = 0;
+    if (!c) {
+        return NULL;
+    }
+    uint32_t lag = catch_up(c, written());
+    uint32_t index = c->pos & MIC_RING_MASK;
+    uint32_t run = MIC_RING_FRAMES - index;
+    *frames = lag < run ? lag : run;
+    return ring + (size_t)index * ring_channels;
+}
+
+bool mic_capture_advance(int id, size_t frames)
+{
+    mic_consumer_t *c = consumer(id);
+    if (!c) {
+        return false;
+    }
+    if (!intact(written(), c->pos)) {
+        catch_up(c, written());
+        return false;
+    }
+    c->pos += frames;
+    c->frames += frames;
+    return true;
+}
+
+void mic_capture_get_stats(mic_capture_stats_t *out)
+{
+    *out = stats;
+}
+
+bool mic_capture_consumer_stats(int id, mic_consumer_stats_t *out)
+{
+    mic_consumer_t *c = consumer(id);
+    if (!c) {
+        return false;
+    }
+    out->name = c->name;
+    out->frames = c->frames;
+    out->lag_max = c->lag_max;
+    out->overruns = c->overruns;
+    out->lost_frames = c->lost_frames;
+    return true;
+}
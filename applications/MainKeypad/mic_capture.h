@@ -0,0 +1,94 @@
+/**
+ * @file      mic_capture.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * ES7210 microphone capture.
+ *
+ * One task reads the I2S DMA buffers back to back, straight into a PSRAM
+ * ring of interleaved 16 bit frames, and never sleeps between reads, so the
+ * stream has no gaps. The ring has a single writer and any number of
+ * readers up to MIC_CONSUMERS_MAX, each with its own cursor: the VAD, the
+ * SD recorder and the event detector read at their own pace and never
+ * block the capture or one another. There are no locks; the writer
+ * publishes a frame counter and a reader checks after copying that the
+ * writer has not come round to the frames it copied.
+ *
+ * A reader may fall behind by up to MIC_RING_FRAMES - MIC_CAPTURE_CHUNK
+ * frames, about four seconds, without losing audio. Past that its cursor
+ * is moved to the oldest frame still held and the loss is counted in its
+ * statistics.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <driver/i2s.h>
+
+#define MIC_RING_FRAMES         65536           // 4.1 s at 16 kHz, power of two
+#define MIC_CAPTURE_CHUNK       256             // Frames per i2s_read, 16 ms at 16 kHz
+#define MIC_CHANNELS_MAX        4               // ES7210 TDM slots
+#define MIC_CONSUMERS_MAX       4
+#define MIC_CAPTURE_PRIORITY    13              // Above every consumer
+#define MIC_CAPTURE_STACK       (3 * 1024)
+
+typedef struct {
+    uint32_t frames;                    // Frames captured since begin
+    uint32_t short_reads;               // i2s_read errors or partial reads
+} mic_capture_stats_t;
+
+typedef struct {
+    const char *name;
+    uint32_t    frames;                 // Frames delivered
+    uint32_t    lag_max;                // Most frames ever waiting unread
+    uint32_t    overruns;               // Times the writer caught up with the cursor
+    uint32_t    lost_frames;
+} mic_consumer_stats_t;
+
+// Allocate the ring and start capturing `channels` interleaved channels from
+// `port`, which must already be installed. Without `task` frames only arrive
+// through mic_capture_space()/mic_capture_commit(), as in the unit tests.
+bool mic_capture_begin(i2s_port_t port, uint8_t channels, bool task);
+
+// Stop the capture task before sleep, consumers keep their cursors
+void mic_capture_stop(void);
+
+uint8_t mic_capture_channels(void);
+
+// Frames written since begin, wraps after three days at 16 kHz
+uint32_t mic_capture_position(void);
+
+// Writer side, exposed for the unit tests. Contiguous room for up to
+// MIC_CAPTURE_CHUNK frames, then publish the frames written there.
+int16_t *mic_capture_space(size_t *frames);
+void mic_capture_commit(size_t frames);
+
+// Claim a cursor starting at the newest frame. Call from the consumer's own
+// task, it is notified whenever frames arrive. Returns -1 when all are taken.
+int mic_capture_subscribe(const char *name);
+void mic_capture_unsubscribe(int id);
+
+// Frames waiting for the consumer
+size_t mic_capture_available(int id);
+
+// Position of the consumer's next frame, on the mic_capture_position() scale
+uint32_t mic_capture_cursor(int id);
+
+// Copy the next `frames` interleaved frames, waiting up to `wait` for them.
+// Returns `frames`, or 0 on timeout with the cursor unchanged.
+size_t mic_capture_read(int id, int16_t *dst, size_t frames, TickType_t wait);
+
+// As mic_capture_read() for one channel only, `dst` holds `frames` samples
+size_t mic_capture_read_channel(int id, uint8_t channel, int16_t *dst, size_t frames, TickType_t wait);
+
+// Zero copy access for consumers writing the ring out as it is. Points at
+// the next frame, `frames` is how many follow it contiguously. After using
+// them, mic_capture_advance() returns false if the writer overwrote them
+// meanwhile; the cursor has then moved on and the loss is counted.
+const int16_t *mic_capture_peek(int id, size_t *frames);
+bool mic_capture_advance(int id, size_t frames);
+
+void mic_capture_get_stats(mic_capture_stats_t *stats);
+bool mic_capture_consumer_stats(int id, mic_consumer_stats_t *stats);
@@ -0,0 +1,468 @@
+/**
+ * @file      node_registry.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "node_registry.h"
+#include "event_journal.h"
+#include <time.h>
+
+#define NODE_VALID_EPOCH            1600000000UL
+#define NODE_SEEN_PERSIST_S         600     // Radio statistics alone dirty a page at most this often
+
+// On-flash record, one per slot
+typedef struct __attribute__((packed)) {
+    uint32_t node_id;               // 0 marks an unused record
+    uint32_t last_seen_epoch;
+    uint32_t rx_count;
+    uint32_t seq_lost;
+    int16_t  rssi_x16;
+    int16_t  snr_x16;
+    uint16_t last_seq;
+    uint8_t  battery;
+    uint8_t  zone;
+    uint8_t  flags;
+    uint8_t  reserved[3];
+    uint32_t crc;                   // journal_crc32() over the preceding bytes
+} node_record_t;
+
+static_assert(sizeof(node_record_t) == NODE_REGISTRY_RECORD_SIZE, "node record layout changed");
+static_assert((NODE_REGISTRY_INDEX_SIZE & (NODE_REGISTRY_INDEX_SIZE - 1)) == 0, "index size must be a power of two");
+static_assert(NODE_REGISTRY_INDEX_SIZE >= 2 * NODE_REGISTRY_CAPACITY, "index load factor above 0.5");
+static_assert(NODE_REGISTRY_CAPACITY % NODE_REGISTRY_PAGE_RECORDS == 0, "capacity must fill whole pages");
+static_assert(NODE_SEQ_WINDOW <= 32, "the sequence window is one 32-bit word");
+
+// Struct of arrays, internal RAM for predictable lookup latency
+static uint32_t node_id[NODE_REGISTRY_CAPACITY];
+static uint32_t last_seen_ms[NODE_REGISTRY_CAPACITY];
+static uint32_t last_seen_epoch[NODE_REGISTRY_CAPACITY];
+static uint32_t rx_count[NODE_REGISTRY_CAPACITY];
+static uint32_t seq_lost[NODE_REGISTRY_CAPACITY];
+static int16_t  rssi_x16[NODE_REGISTRY_CAPACITY];
+static int16_t  snr_x16[NODE_REGISTRY_CAPACITY];
+static uint16_t last_seq[NODE_REGISTRY_CAPACITY];
+static uint8_t  battery[NODE_REGISTRY_CAPACITY];
+static uint8_t  zone[NODE_REGISTRY_CAPACITY];
+static uint8_t  flags[NODE_REGISTRY_CAPACITY];
+static uint32_t version[NODE_REGISTRY_CAPACITY];        // Sequence lock, odd while the writer is inside
+static uint32_t persisted_epoch[NODE_REGISTRY_CAPACITY]; // Writer private: last time a save was scheduled
+static uint32_t seq_window[NODE_REGISTRY_CAPACITY];     // Writer private: bit n set when last_seq - n was heard
+
+// Slot + 1 per bucket, 0 is empty. Linear probing, entries are never removed.
+static uint16_t index_table[NODE_REGISTRY_INDEX_SIZE];
+static uint32_t slot_count = 0;
+
+static uint32_t dirty[(NODE_REGISTRY_PAGES + 31) / 32];
+static fs::FS   *registry_fs = nullptr;
+
+static inline uint32_t bucket_of(uint32_t id)
+{
+    // Fibonacci hashing spreads sequential IDs across the table
+    return (uint32_t)(id * 0x9E3779B1U) >> (32 - __builtin_ctz(NODE_REGISTRY_INDEX_SIZE));
+}
+
+static inline void mark_dirty(int slot)
+{
+    uint32_t page = slot / NODE_REGISTRY_PAGE_RECORDS;
+    __atomic_fetch_or(&dirty[page / 32], 1UL << (page % 32), __ATOMIC_RELAXED);
+}
+
+static inline void write_begin(int slot)
+{
+    __atomic_store_n(&version[slot], version[slot] + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void write_end(int slot)
+{
+    __atomic_store_n(&version[slot], version[slot] + 1, __ATOMIC_RELEASE);
+}
+
+int node_registry_find(uint32_t id)
+{
+    if (id == 0) {
+        return -1;
+    }
+    uint32_t bucket = bucket_of(id);
+    for (uint32_t probe = 0; probe < NODE_REGISTRY_INDEX_SIZE; probe++) {
+        uint16_t entry = __atomic_load_n(&index_table[bucket], __ATOMIC_ACQUIRE);
+        if (entry == 0) {
+            return -1;
+        }
+        if (node_id[entry - 1] == id) {
+            return entry - 1;
+        }
+        bucket = (bucket + 1) & (NODE_REGISTRY_INDEX_SIZE - 1);
+    }
+    return -1;
+}
+
+// Writer only. `slot` must be filled in before it becomes reachable.
+static bool index_insert(uint32_t id, int slot)
+{
+    uint32_t bucket = bucket_of(id);
+    for (uint32_t probe = 0; probe < NODE_REGISTRY_INDEX_SIZE; probe++) {
+        if (index_table[bucket] == 0) {
+            __atomic_store_n(&index_table[bucket], (uint16_t)(slot + 1), __ATOMIC_RELEASE);
+            return true;
+        }
+        bucket = (bucket + 1) & (NODE_REGISTRY_INDEX_SIZE - 1);
+    }
+    return false;
+}
+
+static int insert_node(uint32_t id)
+{
+    uint32_t slot = slot_count;
+    if (slot >= NODE_REGISTRY_CAPACITY) {
+        return -1;
+    }
+    write_begin(slot);
+    node_id[slot] = id;
+    last_seen_ms[slot] = 0;
+    last_seen_epoch[slot] = 0;
+    rx_count[slot] = 0;
+    seq_lost[slot] = 0;
+    rssi_x16[slot] = 0;
+    snr_x16[slot] = 0;
+    last_seq[slot] = 0;
+    battery[slot] = 0xFF;
+    zone[slot] = 0;
+    flags[slot] = 0;
+    write_end(slot);
+    persisted_epoch[slot] = 0;
+    seq_window[slot] = 0;
+
+    index_insert(id, slot);
+    __atomic_store_n(&slot_count, slot + 1, __ATOMIC_RELEASE);
+    mark_dirty(slot);
+    return slot;
+}
+
+void node_registry_reset(void)
+{
+    __atomic_store_n(&slot_count, 0, __ATOMIC_RELEASE);
+    memset(index_table, 0, sizeof(index_table));
+    memset(node_id, 0, sizeof(node_id));
+    memset(dirty, 0, sizeof(dirty));
+}
+
+static bool record_valid(const node_record_t *rec)
+{
+    return rec->node_id != 0 && rec->crc == journal_crc32(rec, offsetof(node_record_t, crc));
+}
+
+static bool load(void)
+{
+    File file = registry_fs->open(NODE_REGISTRY_FILE, FILE_READ);
+    if (!file || file.size() != NODE_REGISTRY_CAPACITY * NODE_REGISTRY_RECORD_SIZE) {
+        file.close();
+        return false;
+    }
+
+    node_record_t page[NODE_REGISTRY_PAGE_RECORDS];
+    uint32_t loaded = 0;
+    for (uint32_t p = 0; p < NODE_REGISTRY_PAGES; p++) {
+        if (file.read((uint8_t *)page, sizeof(page)) != sizeof(page)) {
+            break;
+        }
+        for (uint32_t i = 0; i < NODE_REGISTRY_PAGE_RECORDS; i++) {
+            const node_record_t *rec = &page[i];
+            // Records keep their slot so a page on flash always holds the same nodes
+            uint32_t slot = p * NODE_REGISTRY_PAGE_RECORDS + i;
+            if (!record_valid(rec) || node_registry_find(rec->node_id) >= 0) {
+                continue;
+            }
+            node_id[slot] = rec->node_id;
+            last_seen_ms[slot] = 0;
+            last_seen_epoch[slot] = rec->last_seen_epoch;
+            rx_count[slot] = rec->rx_count;
+            seq_lost[slot] = rec->seq_lost;
+            rssi_x16[slot] = rec->rssi_x16;
+            snr_x16[slot] = rec->snr_x16;
+            last_seq[slot] = rec->last_seq;
+            battery[slot] = rec->battery;
+            zone[slot] = rec->zone;
+            flags[slot] = rec->flags & ~NODE_FLAG_SEEN;
+            persisted_epoch[slot] = rec->last_seen_epoch;
+            // What was heard before the reboot is unknown, assume all of it
+            seq_window[slot] = UINT32_MAX;
+            index_insert(rec->node_id, slot);
+            __atomic_store_n(&slot_count, max(slot_count, slot + 1), __ATOMIC_RELEASE);
+            loaded++;
+        }
+    }
+    file.close();
+    Serial.printf("Node registry: %lu nodes loaded\n", (unsigned long)loaded);
+    return true;
+}
+
+static bool create_file(void)
+{
+    File file = registry_fs->open(NODE_REGISTRY_FILE, FILE_WRITE);
+    if (!file) {
+        return false;
+    }
+    uint8_t zeros[NODE_REGISTRY_PAGE_RECORDS * NODE_REGISTRY_RECORD_SIZE] = {0};
+    bool ok = true;
+    for (uint32_t p = 0; p < NODE_REGISTRY_PAGES && ok; p++) {
+        ok = file.write(zeros, sizeof(zeros)) == sizeof(zeros);
+    }
+    file.close();
+    return ok;
+}
+
+bool node_registry_begin(fs::FS *fs)
+{
+    node_registry_reset();
+    registry_fs = fs;
+    if (!registry_fs) {
+        return false;
+    }
+    if (load()) {
+        return true;
+    }
+    // Missing or from a build with another capacity: start empty
+    if (!create_file()) {
+        Serial.println("Node registry: cannot create " NODE_REGISTRY_FILE);
+        registry_fs = nullptr;
+        return false;
+    }
+    return true;
+}
+
+static inline int16_t ewma_update(int16_t avg, float sample, bool first)
+{
+    int32_t s = (int32_t)(sample * NODE_EWMA_SCALE);
+    if (first) {
+        return (int16_t)s;
+    }
+    return (int16_t)(avg + ((s - avg) >> NODE_EWMA_SHIFT));
+}
+
+int node_registry_update_rx(uint32_t id, float rssi, float snr, uint16_t seq, uint8_t batt)
+{
+    int slot = node_registry_find(id);
+    if (slot < 0) {
+        if (id == 0 || (slot = insert_node(id)) < 0) {
+            return -1;
+        }
+    }
+
+    time_t now = time(NULL);
+    uint32_t epoch = now > (time_t)NODE_VALID_EPOCH ? (uint32_t)now : 0;
+    bool first = rx_count[slot] == 0;
+    bool persist = batt != battery[slot] ||
+                   (epoch && epoch - persisted_epoch[slot] >= NODE_SEEN_PERSIST_S);
+
+    write_begin(slot);
+    int16_t ahead = (int16_t)(seq - last_seq[slot]);
+    uint16_t behind = (uint16_t)(last_seq[slot] - seq);
+    if (first) {
+        last_seq[slot] = seq;
+        seq_window[slot] = 1;
+    } else if (ahead > 0) {
+        // A large jump (node rebooted) does not count as loss
+        if (ahead - 1 < NODE_SEQ_MAX_GAP) {
+            seq_lost[slot] += ahead - 1;
+        }
+        seq_window[slot] = ahead < NODE_SEQ_WINDOW ? (seq_window[slot] << ahead) | 1 : 1;
+        last_seq[slot] = seq;
+    } else if (behind < NODE_SEQ_WINDOW) {
+        // A late frame was counted as lost when its successor came in
+        if (!(seq_window[slot] & (1UL << behind))) {
+            seq_window[slot] |= 1UL << behind;
+            if (seq_lost[slot]) {
+                seq_lost[slot]--;
+            }
+        }
+    } else {
+        // The node rebooted and started counting again
+        last_seq[slot] = seq;
+        seq_window[slot] = 1;
+    }
+    rssi_x16[slot] = ewma_update(rssi_x16[slot], rssi, first);
+    snr_x16[slot] = ewma_update(snr_x16[slot], snr, first);
+    battery[slot] = batt;
+    last_seen_ms[slot] = millis();
+    if (epoch) {
+        last_seen_epoch[slot] = epoch;
+    }
+    rx_count[slot]++;
+    flags[slot] |= NODE_FLAG_SEEN;
+    write_end(slot);
+
+    if (persist) {
+        persisted_epoch[slot] = epoch;
+        mark_dirty(slot);
+    }
+    return slot;
+}
+
+bool node_registry_seq_fresh(uint32_t id, uint16_t seq)
+{
+    int slot = node_registry_find(id);
+    if (slot < 0 || rx_count[slot] == 0) {
+        return true;
+    }
+    int16_t ahead = (int16_t)(seq - last_seq[slot]);
+    uint16_t behind = (uint16_t)(last_seq[slot] - seq);
+    if (ahead > 0) {
+        return true;
+    }
+    if (behind < NODE_SEQ_WINDOW) {
+        return !(seq_window[slot] & (1UL << behind));
+    }
+    return seq < NODE_SEQ_WINDOW;
+}
+
+bool node_registry_set_zone(uint32_t id, uint8_t z)
+{
+    int slot = node_registry_find(id);
+    if (slot < 0) {
+        return false;
+    }
+    write_begin(slot);
+    zone[slot] = z;
+    write_end(slot);
+    mark_dirty(slot);
+    return true;
+}
+
+bool node_registry_set_flags(uint32_t id, uint8_t set, uint8_t clear)
+{
+    int slot = node_registry_find(id);
+    if (slot < 0) {
+        return false;
+    }
+    write_begin(slot);
+    flags[slot] = (flags[slot] & ~clear) | set;
+    write_end(slot);
+    mark_dirty(slot);
+    return true;
+}
+
+uint32_t node_registry_count(void)
+{
+    return __atomic_load_n(&slot_count, __ATOMIC_ACQUIRE);
+}
+
+bool node_registry_snapshot(int slot, node_snapshot_t *out)
+{
+    if (slot < 0 || (uint32_t)slot >= node_registry_count()) {
+        return false;
+    }
+    uint32_t v1, v2;
+    do {
+        v1 = __atomic_load_n(&version[slot], __ATOMIC_ACQUIRE);
+        out->node_id = node_id[slot];
+        out->last_seen_ms = last_seen_ms[slot];
+        out->last_seen_epoch = last_seen_epoch[slot];
+        out->rx_count = rx_count[slot];
+        out->seq_lost = seq_lost[slot];
+        out->rssi_x16 = rssi_x16[slot];
+        out->snr_x16 = snr_x16[slot];
+        out->last_seq = last_seq[slot];
+        out->battery = battery[slot];
+        out->zone = zone[slot];
+        out->flags = flags[slot];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        v2 = __atomic_load_n(&version[slot], __ATOMIC_RELAXED);
+    } while ((v1 & 1) || v1 != v2);
+    // Slots left empty by a sparse registry file
+    return out->node_id != 0;
+}
+
+bool node_registry_lookup(uint32_t id, node_snapshot_t *out)
+{
+    return node_registry_snapshot(node_registry_find(id), out);
+}
+
+uint32_t node_registry_dirty_pages(void)
+{
+    uint32_t pages = 0;
+    for (size_t w = 0; w < sizeof(dirty) / sizeof(dirty[0]); w++) {
+        pages += __builtin_popcount(__atomic_load_n(&dirty[w], __ATOMIC_RELAXED));
+    }
+    return pages;
+}
+
+uint32_t node_registry_save(void)
+{
+    if (!registry_fs || node_registry_dirty_pages() == 0) {
+        return 0;
+    }
+    File file = registry_fs->open(NODE_REGISTRY_FILE, "r+");
+    if (!file) {
+        return 0;
+    }
+
+    uint32_t written = 0;
+    node_record_t page[NODE_REGISTRY_PAGE_RECORDS];
+    for (size_t w = 0; w < sizeof(dirty) / sizeof(dirty[0]); w++) {
+        // Claim the bits first, an update racing with the copy dirties the page again
+        uint32_t bits = __atomic_exchange_n(&dirty[w], 0, __ATOMIC_ACQ_REL);
+        while (bits) {
+            uint32_t p = w * 32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+
+            memset(page, 0, sizeof(page));
+            for (uint32_t i = 0; i < NODE_REGISTRY_PAGE_RECORDS; i++) {
+                node_snapshot_t snap;
+                node_record_t *rec = &page[i];
+                if (!node_registry_snapshot(p * NODE_REGISTRY_PAGE_RECORDS + i, &snap)) {
+                    continue;
+                }
+                rec->node_id = snap.node_id;
+                rec->last_seen_epoch = snap.last_seen_epoch;
+                rec->rx_count = snap.rx_count;
+                rec->seq_lost = snap.seq_lost;
+                rec->rssi_x16 = snap.rssi_x16;
+                rec->snr_x16 = snap.snr_x16;
+                rec->last_seq = snap.last_seq;
+                rec->battery = snap.battery;
+                rec->zone = snap.zone;
+                rec->flags = snap.flags & ~NODE_FLAG_SEEN;
+                rec->crc = journal_crc32(rec, offsetof(node_record_t, crc));
+            }
+            if (!file.seek(p * sizeof(page)) || file.write((uint8_t *)page, sizeof(page)) != sizeof(page)) {
+                // Retry on the next save
+                __atomic_fetch_or(&dirty[w], 1UL << (p % 32), __ATOMIC_RELAXED);
+                continue;
+            }
+            written++;
+        }
+    }
+    file.close();
+    return written;
+}
+
+bool node_frame_parse(const char *text, node_frame_t *frame)
+{
+    if (!text || text[0] != '@') {
+        return false;
+    }
+    char *end;
+    frame->node_id = strtoul(text + 1, &end, 16);
+    if (end == text + 1 || *end != ',' || frame->node_id == 0) {
+        return false;
+    }
+    const char *p = end + 1;
+    unsigned long seq = strtoul(p, &end, 10);
+    if (end == p || *end != ',' || seq > UINT16_MAX) {
+        return false;
+    }
+    p = end + 1;
+    unsigned long batt = strtoul(p, &end, 10);
+    if (end == p || (*end != ',' && *end != '\0') || (batt > 100 && batt != 0xFF)) {
+        return false;
+    }
+    frame->seq = (uint16_t)seq;
+    frame->battery = (uint8_t)batt;
+    frame->payload = *end == ',' ? end + 1 : end;
+    return true;
+}
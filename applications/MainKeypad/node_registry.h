@@ -0,0 +1,106 @@
+/**
+ * @file      node_registry.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Registry of the field nodes (sensors, sirens) heard by the keypad.
+ *
+ * State is kept as a fixed-capacity struct of arrays, so scanning one field
+ * (e.g. last-seen times for supervision) touches only that array. Node IDs
+ * are resolved through an open-addressing hash index in O(1).
+ *
+ * Concurrency: there is a single writer, the alarm pipeline decode task
+ * (alarm_pipeline.h). Every slot carries a sequence lock, so any other task
+ * can take consistent snapshots without blocking the writer. Slots are never
+ * freed, which keeps the index readable without locks as well.
+ *
+ * Persistence: every slot maps to a fixed 32 byte record in a flash file.
+ * Updates mark the 256 byte page holding the record dirty, and
+ * node_registry_save() rewrites only the dirty pages.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+#define NODE_REGISTRY_CAPACITY      512
+#define NODE_REGISTRY_INDEX_SIZE    1024                    // Power of two, load factor <= 0.5
+#define NODE_REGISTRY_FILE          "/nodes.bin"
+#define NODE_REGISTRY_RECORD_SIZE   32
+#define NODE_REGISTRY_PAGE_RECORDS  8                       // 256 bytes, one SPIFFS page
+#define NODE_REGISTRY_PAGES         (NODE_REGISTRY_CAPACITY / NODE_REGISTRY_PAGE_RECORDS)
+#define NODE_REGISTRY_SAVE_INTERVAL_MS  30000
+
+// RSSI/SNR averages are kept in 1/16 dB, updated with weight 1/8
+#define NODE_EWMA_SHIFT             3
+#define NODE_EWMA_SCALE             16
+
+// A jump of more than this in node_seq is treated as a node reboot, not loss
+#define NODE_SEQ_MAX_GAP            1000
+
+// Sequence numbers up to this far behind the newest one are tracked in a
+// bitmap; a frame within the window is accepted once, anything further
+// behind is taken for a replay. Nodes restart their count at 0 on boot.
+#define NODE_SEQ_WINDOW             32
+
+// Node flags
+#define NODE_FLAG_ARMED             0x01
+#define NODE_FLAG_BYPASSED          0x02    // Excluded from arming, still supervised
+#define NODE_FLAG_SUSPECT           0x04    // Healthy link went silent, see supervision.h
+#define NODE_FLAG_LOST              0x08    // Missed too many heartbeats
+#define NODE_FLAG_SEEN              0x80    // Heard since boot (not persisted)
+
+typedef struct {
+    uint32_t node_id;
+    uint32_t last_seen_ms;          // millis() of the last packet, valid with NODE_FLAG_SEEN
+    uint32_t last_seen_epoch;       // Unix time of the last packet, 0 when unknown
+    uint32_t rx_count;
+    uint32_t seq_lost;              // Packets missed according to node_seq gaps
+    int16_t  rssi_x16;              // RSSI EWMA, dBm * 16
+    int16_t  snr_x16;               // SNR EWMA, dB * 16
+    uint16_t last_seq;
+    uint8_t  battery;               // Percent, 0xFF when unknown
+    uint8_t  zone;
+    uint8_t  flags;
+} node_snapshot_t;
+
+// Frame header sent by field nodes, in text so it survives the String RX
+// path: "@<node id hex>,<seq>,<battery>[,<payload>]"
+typedef struct {
+    uint32_t node_id;
+    uint16_t seq;
+    uint8_t  battery;
+    const char *payload;            // Points into the parsed buffer, "" when absent
+} node_frame_t;
+
+// Clear the table and load it from `fs`, creating the backing file if needed.
+// Passing no file system keeps the registry in RAM only.
+bool node_registry_begin(fs::FS *fs);
+void node_registry_reset(void);
+
+// Writer side: update or insert a node on reception. Returns the slot or -1
+// when the registry is full.
+int  node_registry_update_rx(uint32_t node_id, float rssi, float snr, uint16_t seq, uint8_t battery);
+bool node_registry_set_zone(uint32_t node_id, uint8_t zone);
+bool node_registry_set_flags(uint32_t node_id, uint8_t set, uint8_t clear);
+
+// Writer side replay check, before node_registry_update_rx(). True for a seq
+// ahead of the newest one heard from the node, modulo 2^16, for one not seen
+// yet within NODE_SEQ_WINDOW behind it, for a count restarted below
+// NODE_SEQ_WINDOW by a reboot, and for nodes never heard.
+bool node_registry_seq_fresh(uint32_t node_id, uint16_t seq);
+
+// Reader side, callable from any task
+int      node_registry_find(uint32_t node_id);
+uint32_t node_registry_count(void);             // Slots in use, valid slots are 0..count-1
+bool     node_registry_snapshot(int slot, node_snapshot_t *out);
+bool     node_registry_lookup(uint32_t node_id, node_snapshot_t *out);
+
+// Write dirty pages to flash. Returns the number of pages written.
+uint32_t node_registry_save(void);
+uint32_t node_registry_dirty_pages(void);
+
+bool node_frame_parse(const char *text, node_frame_t *frame);
@@ -0,0 +1,143 @@
+/**
+ * @file      supervision.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "supervision.h"
+#include "timer_wheel.h"
+#include "event_journal.h"
+
+typedef enum : uint8_t {
+    STAGE_IDLE = 0,                 // No timer armed
+    STAGE_AWAIT,                    // Waiting for the next heartbeat
+    STAGE_LATE,                     // Heartbeat missed, waiting for the lost deadline
+    STAGE_LOST,
+} supervision_stage_t;
+
+static timer_wheel_t        wheel;
+static timer_wheel_entry_t  entries[NODE_REGISTRY_CAPACITY];
+static uint8_t              stage[NODE_REGISTRY_CAPACITY];
+static uint16_t             interval_s[NODE_REGISTRY_CAPACITY];     // 0 selects the default
+static uint32_t             heard_tick[NODE_REGISTRY_CAPACITY];
+
+static supervision_handler_t event_handler = NULL;
+
+// Free running tick count, immune to the 49 day millis() wrap
+static uint32_t tick_now = 0;
+static uint32_t tick_ms = 0;
+
+static uint32_t current_tick(void)
+{
+    uint32_t elapsed = (millis() - tick_ms) / SUPERVISION_TICK_MS;
+    tick_now += elapsed;
+    tick_ms += elapsed * SUPERVISION_TICK_MS;
+    return tick_now;
+}
+
+static inline uint32_t interval_ticks(int slot)
+{
+    uint32_t seconds = interval_s[slot] ? interval_s[slot] : SUPERVISION_DEFAULT_INTERVAL_S;
+    return seconds * 1000UL / SUPERVISION_TICK_MS;
+}
+
+static void report(const node_snapshot_t *node, supervision_event_t event)
+{
+    static const journal_event_type_t journal_type[] = {
+        JOURNAL_EVT_TAMPER, JOURNAL_EVT_NODE_LOST, JOURNAL_EVT_HEARTBEAT,
+    };
+    static const char *const names[] = {"tamper suspected", "lost", "restored"};
+
+    journal_append(journal_type[event], node->node_id, node->zone, NULL, 0);
+    Serial.printf("Supervision: node %08lX %s\n", (unsigned long)node->node_id, names[event]);
+    if (event_handler) {
+        event_handler(node, event);
+    }
+}
+
+static void on_deadline(uint16_t slot, void *ctx)
+{
+    node_snapshot_t node;
+    if (!node_registry_snapshot(slot, &node)) {
+        stage[slot] = STAGE_IDLE;
+        return;
+    }
+
+    if (stage[slot] == STAGE_AWAIT) {
+        stage[slot] = STAGE_LATE;
+        timer_wheel_schedule(&wheel, slot, heard_tick[slot] + interval_ticks(slot) * SUPERVISION_LOST_MISSES);
+        if (node.rx_count && node.rssi_x16 > SUPERVISION_STRONG_RSSI_DBM * NODE_EWMA_SCALE) {
+            node_registry_set_flags(node.node_id, NODE_FLAG_SUSPECT, 0);
+            node.flags |= NODE_FLAG_SUSPECT;
+            report(&node, SUPERVISION_EVT_TAMPER_SUSPECTED);
+        }
+    } else if (stage[slot] == STAGE_LATE) {
+        stage[slot] = STAGE_LOST;
+        node_registry_set_flags(node.node_id, NODE_FLAG_LOST, 0);
+        node.flags |= NODE_FLAG_LOST;
+        report(&node, SUPERVISION_EVT_NODE_LOST);
+    }
+}
+
+void supervision_begin(void)
+{
+    tick_ms = millis();
+    tick_now = 0;
+    timer_wheel_init(&wheel, entries, NODE_REGISTRY_CAPACITY, tick_now);
+    memset(stage, STAGE_IDLE, sizeof(stage));
+    memset(interval_s, 0, sizeof(interval_s));
+
+    // Known nodes count as heard at boot, already lost nodes stay lost until heard
+    node_snapshot_t node;
+    for (uint32_t slot = 0; slot < node_registry_count(); slot++) {
+        if (!node_registry_snapshot(slot, &node)) {
+            continue;
+        }
+        heard_tick[slot] = tick_now;
+        if (node.flags & NODE_FLAG_LOST) {
+            stage[slot] = STAGE_LOST;
+            continue;
+        }
+        stage[slot] = STAGE_LATE;
+        timer_wheel_schedule(&wheel, slot, tick_now + interval_ticks(slot) * SUPERVISION_LOST_MISSES);
+    }
+}
+
+void supervision_set_handler(supervision_handler_t handler)
+{
+    event_handler = handler;
+}
+
+void supervision_node_heard(int slot)
+{
+    if (slot < 0 || slot >= NODE_REGISTRY_CAPACITY) {
+        return;
+    }
+    uint32_t now = current_tick();
+    node_snapshot_t node;
+    if (node_registry_snapshot(slot, &node) && (node.flags & (NODE_FLAG_SUSPECT | NODE_FLAG_LOST))) {
+        node_registry_set_flags(node.node_id, 0, NODE_FLAG_SUSPECT | NODE_FLAG_LOST);
+        node.flags &= ~(NODE_FLAG_SUSPECT | NODE_FLAG_LOST);
+        report(&node, SUPERVISION_EVT_RESTORED);
+    }
+
+    uint32_t interval = interval_ticks(slot);
+    stage[slot] = STAGE_AWAIT;
+    heard_tick[slot] = now;
+    timer_wheel_schedule(&wheel, slot, now + interval + interval * SUPERVISION_GRACE_PCT / 100);
+}
+
+void supervision_set_interval(int slot, uint16_t seconds)
+{
+    if (slot >= 0 && slot < NODE_REGISTRY_CAPACITY) {
+        interval_s[slot] = seconds;
+    }
+}
+
+uint32_t supervision_poll(void)
+{
+    return timer_wheel_advance(&wheel, current_tick(), on_deadline, NULL);
+}
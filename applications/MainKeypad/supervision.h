@@ -0,0 +1,53 @@
+/**
+ * @file      supervision.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Heartbeat supervision of the field nodes in the node registry.
+ *
+ * Every node has one timer in a hierarchical timing wheel holding its next
+ * deadline, so a tick costs O(1) regardless of the number of nodes:
+ *
+ *   heard --(interval + grace)--> late --(LOST_MISSES intervals)--> lost
+ *
+ * A node whose link was strong when it went silent is reported as tamper
+ * suspected when it becomes late: fading links degrade first, a removed or
+ * jammed sensor stops abruptly. Events update the registry flags, go to the
+ * journal and are passed to the optional handler.
+ *
+ * All calls must come from the node registry writer task, the alarm
+ * pipeline decode task.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "node_registry.h"
+
+#define SUPERVISION_TICK_MS             250
+#define SUPERVISION_DEFAULT_INTERVAL_S  60
+#define SUPERVISION_GRACE_PCT           25      // Late after interval + 25 %
+#define SUPERVISION_LOST_MISSES         3       // Lost after three silent intervals
+#define SUPERVISION_STRONG_RSSI_DBM     -100    // Link considered healthy above this
+
+typedef enum {
+    SUPERVISION_EVT_TAMPER_SUSPECTED = 0,
+    SUPERVISION_EVT_NODE_LOST,
+    SUPERVISION_EVT_RESTORED,
+} supervision_event_t;
+
+typedef void (*supervision_handler_t)(const node_snapshot_t *node, supervision_event_t event);
+
+// Arm every node already in the registry (after node_registry_begin()).
+// Nodes that are not heard again are reported lost after LOST_MISSES intervals.
+void supervision_begin(void);
+void supervision_set_handler(supervision_handler_t handler);
+
+// Restart the deadline of a node after a packet, `slot` from node_registry_update_rx()
+void supervision_node_heard(int slot);
+void supervision_set_interval(int slot, uint16_t seconds);
+
+// Advance the wheel to the current time. Returns the number of deadlines handled.
+uint32_t supervision_poll(void);
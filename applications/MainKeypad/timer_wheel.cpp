@@ -0,0 +1,152 @@
+/**
+ * @file      timer_wheel.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "timer_wheel.h"
+
+#define L1_BASE     TIMER_WHEEL_L0_SIZE
+#define L2_BASE     (TIMER_WHEEL_L0_SIZE + TIMER_WHEEL_LN_SIZE)
+#define L1_SHIFT    TIMER_WHEEL_L0_BITS
+#define L2_SHIFT    (TIMER_WHEEL_L0_BITS + TIMER_WHEEL_LN_BITS)
+#define LN_MASK     (TIMER_WHEEL_LN_SIZE - 1)
+#define L0_MASK     (TIMER_WHEEL_L0_SIZE - 1)
+
+static void unlink(timer_wheel_t *wheel, uint16_t id)
+{
+    timer_wheel_entry_t *e = &wheel->entries[id];
+    if (e->prev != TIMER_WHEEL_NIL) {
+        wheel->entries[e->prev].next = e->next;
+    } else {
+        wheel->heads[e->bucket] = e->next;
+    }
+    if (e->next != TIMER_WHEEL_NIL) {
+        wheel->entries[e->next].prev = e->prev;
+    }
+    e->bucket = TIMER_WHEEL_NIL;
+}
+
+static void place(timer_wheel_t *wheel, uint16_t id)
+{
+    timer_wheel_entry_t *e = &wheel->entries[id];
+    // Relative to the next tick to process, which cascades have not passed yet
+    uint32_t base = wheel->now + 1;
+    uint32_t expires = e->expires;
+    int32_t delta = (int32_t)(expires - base);
+    uint16_t bucket;
+
+    if (delta < 0) {
+        // Already due, fires on the next tick
+        bucket = base & L0_MASK;
+    } else if ((uint32_t)delta < TIMER_WHEEL_L0_SIZE) {
+        bucket = expires & L0_MASK;
+    } else if ((uint32_t)delta < (1U << L2_SHIFT)) {
+        bucket = L1_BASE + ((expires >> L1_SHIFT) & LN_MASK);
+    } else {
+        if ((uint32_t)delta > TIMER_WHEEL_MAX_DELTA) {
+            // Park in the farthest bucket, the cascade files it again
+            expires = base + TIMER_WHEEL_MAX_DELTA;
+        }
+        bucket = L2_BASE + ((expires >> L2_SHIFT) & LN_MASK);
+    }
+
+    e->bucket = bucket;
+    e->prev = TIMER_WHEEL_NIL;
+    e->next = wheel->heads[bucket];
+    if (e->next != TIMER_WHEEL_NIL) {
+        wheel->entries[e->next].prev = id;
+    }
+    wheel->heads[bucket] = id;
+}
+
+void timer_wheel_init(timer_wheel_t *wheel, timer_wheel_entry_t *entries, uint16_t capacity, uint32_t now)
+{
+    wheel->now = now;
+    wheel->capacity = capacity;
+    wheel->entries = entries;
+    for (size_t i = 0; i < TIMER_WHEEL_BUCKETS; i++) {
+        wheel->heads[i] = TIMER_WHEEL_NIL;
+    }
+    for (uint16_t i = 0; i < capacity; i++) {
+        entries[i].bucket = TIMER_WHEEL_NIL;
+    }
+}
+
+void timer_wheel_schedule(timer_wheel_t *wheel, uint16_t id, uint32_t expires)
+{
+    if (id >= wheel->capacity) {
+        return;
+    }
+    if (wheel->entries[id].bucket != TIMER_WHEEL_NIL) {
+        unlink(wheel, id);
+    }
+    wheel->entries[id].expires = expires;
+    place(wheel, id);
+}
+
+void timer_wheel_cancel(timer_wheel_t *wheel, uint16_t id)
+{
+    if (id < wheel->capacity && wheel->entries[id].bucket != TIMER_WHEEL_NIL) {
+        unlink(wheel, id);
+    }
+}
+
+bool timer_wheel_pending(const timer_wheel_t *wheel, uint16_t id)
+{
+    return id < wheel->capacity && wheel->entries[id].bucket != TIMER_WHEEL_NIL;
+}
+
+// Move every timer of a higher level bucket down to where it now belongs
+static void cascade(timer_wheel_t *wheel, uint16_t bucket)
+{
+    uint16_t id = wheel->heads[bucket];
+    wheel->heads[bucket] = TIMER_WHEEL_NIL;
+    while (id != TIMER_WHEEL_NIL) {
+        uint16_t next = wheel->entries[id].next;
+        place(wheel, id);
+        id = next;
+    }
+}
+
+uint32_t timer_wheel_advance(timer_wheel_t *wheel, uint32_t now, timer_wheel_cb_t cb, void *ctx)
+{
+    uint32_t fired = 0;
+    while ((int32_t)(now - wheel->now) > 0) {
+        uint32_t tick = wheel->now + 1;
+
+        // Cascade before `now` moves, so timers due at `tick` land in its bucket
+        if ((tick & L0_MASK) == 0) {
+            uint32_t l1 = (tick >> L1_SHIFT) & LN_MASK;
+            if (l1 == 0) {
+                cascade(wheel, L2_BASE + ((tick >> L2_SHIFT) & LN_MASK));
+            }
+            cascade(wheel, L1_BASE + l1);
+        }
+        wheel->now = tick;
+
+        // Detach the bucket first so callbacks can re-arm timers freely
+        uint16_t bucket = tick & L0_MASK;
+        uint16_t id = wheel->heads[bucket];
+        wheel->heads[bucket] = TIMER_WHEEL_NIL;
+        while (id != TIMER_WHEEL_NIL) {
+            timer_wheel_entry_t *e = &wheel->entries[id];
+            uint16_t next = e->next;
+            if ((int32_t)(e->expires - tick) > 0) {
+                // Parked beyond the wheel range, not due yet
+                place(wheel, id);
+            } else {
+                e->bucket = TIMER_WHEEL_NIL;
+                fired++;
+                if (cb) {
+                    cb(id, ctx);
+                }
+            }
+            id = next;
+        }
+    }
+    return fired;
+}
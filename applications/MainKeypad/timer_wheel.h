@@ -0,0 +1,60 @@
+/**
+ * @file      timer_wheel.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Hierarchical timing wheel for large numbers of long-running timeouts.
+ *
+ * Three levels of 256, 64 and 64 buckets cover 2^20 ticks (~73 h at 250 ms).
+ * Scheduling, cancelling and rescheduling are O(1); each tick walks only
+ * the expiring bucket, plus one cascade every 256 ticks. Timers are
+ * identified by a small integer (e.g. a node registry slot) and the caller
+ * provides the entry storage, so there is no allocation.
+ *
+ * Freestanding: no Arduino or FreeRTOS dependencies, not thread safe.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TIMER_WHEEL_L0_BITS         8
+#define TIMER_WHEEL_LN_BITS         6
+#define TIMER_WHEEL_L0_SIZE         (1 << TIMER_WHEEL_L0_BITS)
+#define TIMER_WHEEL_LN_SIZE         (1 << TIMER_WHEEL_LN_BITS)
+#define TIMER_WHEEL_BUCKETS         (TIMER_WHEEL_L0_SIZE + 2 * TIMER_WHEEL_LN_SIZE)
+#define TIMER_WHEEL_MAX_DELTA       ((1U << (TIMER_WHEEL_L0_BITS + 2 * TIMER_WHEEL_LN_BITS)) - 1)
+#define TIMER_WHEEL_NIL             0xFFFF
+
+typedef struct {
+    uint32_t expires;               // Absolute tick
+    uint16_t next;
+    uint16_t prev;
+    uint16_t bucket;                // TIMER_WHEEL_NIL when not pending
+} timer_wheel_entry_t;
+
+typedef struct {
+    uint32_t now;                   // Last processed tick
+    uint16_t capacity;
+    timer_wheel_entry_t *entries;
+    uint16_t heads[TIMER_WHEEL_BUCKETS];
+} timer_wheel_t;
+
+typedef void (*timer_wheel_cb_t)(uint16_t id, void *ctx);
+
+void timer_wheel_init(timer_wheel_t *wheel, timer_wheel_entry_t *entries, uint16_t capacity, uint32_t now);
+
+// Arm (or re-arm) timer `id` to fire at absolute tick `expires`. Ticks in the
+// past fire on the next tick; deltas beyond TIMER_WHEEL_MAX_DELTA are parked
+// and re-filed until they are in range.
+void timer_wheel_schedule(timer_wheel_t *wheel, uint16_t id, uint32_t expires);
+void timer_wheel_cancel(timer_wheel_t *wheel, uint16_t id);
+bool timer_wheel_pending(const timer_wheel_t *wheel, uint16_t id);
+
+// Process every tick up to and including `now`. Expired timers are disarmed
+// before `cb` runs, so the callback may schedule or cancel the timer that
+// fired, but no other timer. Returns the number of timers fired.
+uint32_t timer_wheel_advance(timer_wheel_t *wheel, uint32_t now, timer_wheel_cb_t cb, void *ctx);
@@ -0,0 +1,197 @@
+/**
+ * @file      ubx.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "ubx.h"
+
+enum {
+    UBX_STATE_SYNC_1,
+    UBX_STATE_SYNC_2,
+    UBX_STATE_CLASS,
+    UBX_STATE_ID,
+    UBX_STATE_LEN_1,
+    UBX_STATE_LEN_2,
+    UBX_STATE_PAYLOAD,
+    UBX_STATE_CK_A,
+    UBX_STATE_CK_B,
+};
+
+// M10 configuration keys, from the u-blox M10 interface description
+#define UBX_KEY_UART1OUTPROT_UBX        0x10740001UL
+#define UBX_KEY_UART1OUTPROT_NMEA       0x10740002UL
+#define UBX_KEY_MSGOUT_NAV_PVT_UART1    0x20910007UL
+#define UBX_KEY_RATE_MEAS               0x30210001UL
+#define UBX_KEY_RATE_NAV                0x30210002UL
+#define UBX_LAYER_RAM                   0x01
+
+static inline uint16_t get_u2(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t get_u4(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint8_t *put_key(uint8_t *p, uint32_t key, uint32_t value, uint8_t size)
+{
+    for (int i = 0; i < 4; i++) {
+        *p++ = key >> (8 * i);
+    }
+    for (int i = 0; i < size; i++) {
+        *p++ = value >> (8 * i);
+    }
+    return p;
+}
+
+void ubx_parser_init(ubx_parser_t *parser)
+{
+    memset(parser, 0, sizeof(*parser));
+}
+
+bool ubx_parser_feed(ubx_parser_t *parser, uint8_t c)
+{
+    // Checksum runs over class, id, length and payload
+    if (parser->state >= UBX_STATE_CLASS && parser->state <= UBX_STATE_PAYLOAD) {
+        parser->ck_a += c;
+        parser->ck_b += parser->ck_a;
+    }
+
+    switch (parser->state) {
+    case UBX_STATE_SYNC_1:
+        if (c == UBX_SYNC_1) {
+            parser->state = UBX_STATE_SYNC_2;
+        }
+        break;
+    case UBX_STATE_SYNC_2:
+        if (c == UBX_SYNC_2) {
+            parser->state = UBX_STATE_CLASS;
+            parser->ck_a = parser->ck_b = 0;
+        } else if (c != UBX_SYNC_1) {
+            parser->state = UBX_STATE_SYNC_1;
+        }
+        break;
+    case UBX_STATE_CLASS:
+        parser->cls = c;
+        parser->state = UBX_STATE_ID;
+        break;
+    case UBX_STATE_ID:
+        parser->id = c;
+        parser->state = UBX_STATE_LEN_1;
+        break;
+    case UBX_STATE_LEN_1:
+        parser->len = c;
+        parser->state = UBX_STATE_LEN_2;
+        break;
+    case UBX_STATE_LEN_2:
+        parser->len |= c << 8;
+        parser->pos = 0;
+        if (parser->len > UBX_MAX_PAYLOAD) {
+            // Rather than skip an unknown length, resync on the next sync bytes
+            parser->oversize++;
+            parser->state = UBX_STATE_SYNC_1;
+        } else {
+            parser->state = parser->len ? UBX_STATE_PAYLOAD : UBX_STATE_CK_A;
+        }
+        break;
+    case UBX_STATE_PAYLOAD:
+        parser->payload[parser->pos++] = c;
+        if (parser->pos == parser->len) {
+            parser->state = UBX_STATE_CK_A;
+        }
+        break;
+    case UBX_STATE_CK_A:
+        if (c == parser->ck_a) {
+            parser->state = UBX_STATE_CK_B;
+        } else {
+            parser->bad_checksum++;
+            parser->state = UBX_STATE_SYNC_1;
+        }
+        break;
+    case UBX_STATE_CK_B:
+        parser->state = UBX_STATE_SYNC_1;
+        if (c == parser->ck_b) {
+            parser->frames++;
+            return true;
+        }
+        parser->bad_checksum++;
+        break;
+    }
+    return false;
+}
+
+size_t ubx_frame(uint8_t *frame, size_t size, uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len)
+{
+    if (size < (size_t)len + UBX_FRAME_OVERHEAD) {
+        return 0;
+    }
+    frame[0] = UBX_SYNC_1;
+    frame[1] = UBX_SYNC_2;
+    frame[2] = cls;
+    frame[3] = id;
+    frame[4] = len & 0xFF;
+    frame[5] = len >> 8;
+    if (len) {
+        memcpy(frame + 6, payload, len);
+    }
+
+    uint8_t ck_a = 0, ck_b = 0;
+    for (size_t i = 2; i < 6 + (size_t)len; i++) {
+        ck_a += frame[i];
+        ck_b += ck_a;
+    }
+    frame[6 + len] = ck_a;
+    frame[7 + len] = ck_b;
+    return len + UBX_FRAME_OVERHEAD;
+}
+
+bool ubx_decode_nav_pvt(const uint8_t *payload, uint16_t len, ubx_nav_pvt_t *pvt)
+{
+    if (len != UBX_NAV_PVT_LEN) {
+        return false;
+    }
+    pvt->itow_ms = get_u4(payload + 0);
+    pvt->year = get_u2(payload + 4);
+    pvt->month = payload[6];
+    pvt->day = payload[7];
+    pvt->hour = payload[8];
+    pvt->minute = payload[9];
+    pvt->second = payload[10];
+    pvt->date_valid = payload[11] & 0x01;
+    pvt->time_valid = payload[11] & 0x02;
+    pvt->fix_type = payload[20];
+    pvt->fix_ok = payload[21] & 0x01;
+    pvt->num_sv = payload[23];
+    pvt->lon = (int32_t)get_u4(payload + 24);
+    pvt->lat = (int32_t)get_u4(payload + 28);
+    pvt->height_msl_mm = (int32_t)get_u4(payload + 36);
+    pvt->h_acc_mm = get_u4(payload + 40);
+    pvt->ground_speed_mm_s = (int32_t)get_u4(payload + 60);
+    pvt->heading_motion = (int32_t)get_u4(payload + 64);
+    pvt->pdop = get_u2(payload + 76);
+    return true;
+}
+
+size_t ubx_cfg_pvt_only(uint8_t *frame, size_t size, uint16_t meas_ms)
+{
+    uint8_t payload[4 + 5 * 4 + 1 + 1 + 1 + 2 + 2];
+    uint8_t *p = payload;
+
+    *p++ = 0x00;                        // Version
+    *p++ = UBX_LAYER_RAM;
+    *p++ = 0x00;                        // Reserved
+    *p++ = 0x00;
+    p = put_key(p, UBX_KEY_UART1OUTPROT_NMEA, 0, 1);
+    p = put_key(p, UBX_KEY_UART1OUTPROT_UBX, 1, 1);
+    p = put_key(p, UBX_KEY_MSGOUT_NAV_PVT_UART1, 1, 1);
+    p = put_key(p, UBX_KEY_RATE_MEAS, meas_ms, 2);
+    p = put_key(p, UBX_KEY_RATE_NAV, 1, 2);
+
+    return ubx_frame(frame, size, UBX_CLASS_CFG, UBX_CFG_VALSET, payload, p - payload);
+}
@@ -0,0 +1,90 @@
+/**
+ * @file      ubx.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * u-blox UBX binary protocol.
+ *
+ * A byte-at-a-time frame parser that checks the Fletcher checksum, the
+ * NAV-PVT decoder, and the CFG-VALSET frame that switches the M10 to
+ * binary-only NAV-PVT output. One 100 byte NAV-PVT frame carries what
+ * RMC, GGA and VTG spread over ~230 bytes of text, already in integers.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define UBX_SYNC_1              0xB5
+#define UBX_SYNC_2              0x62
+#define UBX_FRAME_OVERHEAD      8       // Sync, class, id, length, checksum
+#define UBX_MAX_PAYLOAD         256
+
+#define UBX_CLASS_NAV           0x01
+#define UBX_NAV_PVT             0x07
+#define UBX_NAV_PVT_LEN         92
+#define UBX_CLASS_ACK           0x05
+#define UBX_ACK_NAK             0x00
+#define UBX_ACK_ACK             0x01
+#define UBX_CLASS_CFG           0x06
+#define UBX_CFG_VALSET          0x8A
+#define UBX_CLASS_MGA           0x13
+#define UBX_MGA_INI             0x40
+#define UBX_MGA_DBD             0x80
+
+// NAV-PVT rate, 100 byte frames fill half of a 9600 baud link at 5 Hz
+#define UBX_PVT_FAST_MS         100
+#define UBX_PVT_SLOW_MS         200
+#define UBX_PVT_FAST_MIN_BAUD   38400
+
+typedef struct {
+    uint8_t  state;
+    uint8_t  cls;
+    uint8_t  id;
+    uint16_t len;
+    uint16_t pos;
+    uint8_t  ck_a;
+    uint8_t  ck_b;
+    uint32_t frames;                    // Frames passing the checksum
+    uint32_t bad_checksum;
+    uint32_t oversize;                  // Frames longer than the payload buffer, dropped
+    uint8_t  payload[UBX_MAX_PAYLOAD];
+} ubx_parser_t;
+
+typedef struct {
+    uint32_t itow_ms;                   // GPS time of week of the epoch
+    uint16_t year;
+    uint8_t  month;
+    uint8_t  day;
+    uint8_t  hour;
+    uint8_t  minute;
+    uint8_t  second;
+    bool     date_valid;
+    bool     time_valid;
+    uint8_t  fix_type;                  // 0 none, 2 2D, 3 3D, 4 GNSS + dead reckoning
+    bool     fix_ok;                    // Within the configured accuracy masks
+    uint8_t  num_sv;
+    int32_t  lon;                       // 1e-7 degrees
+    int32_t  lat;                       // 1e-7 degrees
+    int32_t  height_msl_mm;
+    uint32_t h_acc_mm;
+    int32_t  ground_speed_mm_s;
+    int32_t  heading_motion;            // 1e-5 degrees
+    uint16_t pdop;                      // 0.01
+} ubx_nav_pvt_t;
+
+void ubx_parser_init(ubx_parser_t *parser);
+
+// Returns true when `c` completes a frame with a valid checksum. Its class,
+// id, len and payload stay valid until the next call.
+bool ubx_parser_feed(ubx_parser_t *parser, uint8_t c);
+
+// Writes a complete frame into `frame`, returns its size or 0 if it does not fit
+size_t ubx_frame(uint8_t *frame, size_t size, uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len);
+
+bool ubx_decode_nav_pvt(const uint8_t *payload, uint16_t len, ubx_nav_pvt_t *pvt);
+
+// CFG-VALSET to RAM: UBX only on UART1, NAV-PVT every measurement of `meas_ms`
+size_t ubx_cfg_pvt_only(uint8_t *frame, size_t size, uint16_t meas_ms);
@@ -13,13 +13,17 @@
 #include "lvgl.h"
 #include "utilities.h"
 #include "ui_performance.h"  // Performance optimizations - temporarily disabled
+#include "ui_pages.h"
+#include "boot_profile.h"
+#include "journal_query.h"
+#include "node_registry.h"
+#include "alarm_pipeline.h"
+#include "gps_assist.h"
+#include "ui_map.h"
+#include "mic_array.h"
 
-#include <vector>
 #include "config.h"
 
-// Performance optimization: Use faster vector with reserved capacity
-std::vector<lv_obj_t *> sub_section;
-
 // Pre-allocate string buffers to avoid dynamic allocation
 static char gps_lat_buffer[16];
 static char gps_lng_buffer[16]; 
@@ -51,14 +55,21 @@ typedef struct __attribute__((packed)) {
 static Deck_GPS_t sub_gps_val;
 static Deck_Radio_t sub_radio_val;
 static lv_obj_t *sound_vad_label;
+static lv_obj_t *sound_doa_label;
+
+// Sub pages in the page registry, built on first navigation
+typedef enum {
+    UI_PAGE_RADIO = 0,
+    UI_PAGE_SOUND,
+    UI_PAGE_DISPLAY,
+    UI_PAGE_GPS,
+    UI_PAGE_KEYBOARD,
+    UI_PAGE_SETTINGS,
+    UI_PAGE_HISTORY,
+    UI_PAGE_MAP,
+    UI_PAGE_MAX,
+} ui_page_id_t;
 
-// Forward declarations for pages
-static lv_obj_t *sub_mechanics_page;
-static lv_obj_t *sub_sound_page;
-static lv_obj_t *sub_display_page;
-static lv_obj_t *sub_gps_page;
-static lv_obj_t *sub_kb_page;
-static lv_obj_t *sub_setting_page;
 lv_obj_t *home_screen;
 
 static void back_event_handler(lv_event_t *e);
@@ -83,27 +94,21 @@ static lv_obj_t *create_switch(lv_obj_t *parent,
                                const char *icon, const char *txt, bool chk, lv_event_cb_t cb);
 static lv_obj_t *create_label(lv_obj_t *parent, const char *icon, const char *txt, const char *default_text);
 static lv_obj_t *create_dropdown(lv_obj_t *parent, const char *icon, const char *txt, const char *options, uint8_t default_sel, lv_event_cb_t cb);
-static lv_obj_t *create_app_icon(lv_obj_t *parent, const char *icon, const char *label, lv_obj_t *target_page, lv_event_cb_t cb);
+static lv_obj_t *create_app_icon(lv_obj_t *parent, const char *icon, const char *label, ui_page_id_t page, lv_event_cb_t cb);
 
 // iPhone-style section header
 static lv_obj_t *create_section_header(lv_obj_t *parent, const char *title)
 {
     lv_obj_t *header = lv_obj_create(parent);
-    lv_obj_set_size(header, LV_PCT(90), LV_SIZE_CONTENT);
-    lv_obj_set_style_bg_opa(header, LV_OPA_TRANSP, LV_PART_MAIN);
-    lv_obj_set_style_border_width(header, 0, LV_PART_MAIN);
-    lv_obj_set_style_pad_all(header, 4, LV_PART_MAIN);
-    lv_obj_set_style_pad_top(header, 12, LV_PART_MAIN);
-    lv_obj_set_style_pad_bottom(header, 4, LV_PART_MAIN);
+    lv_obj_add_style(header, &ui_theme.bare, LV_PART_MAIN);
+    lv_obj_add_style(header, &ui_theme.section_header, LV_PART_MAIN);
     
     // Make header sticky/fixed - disable scrolling for this object
     lv_obj_clear_flag(header, LV_OBJ_FLAG_SCROLLABLE);
     
     lv_obj_t *title_label = lv_label_create(header);
     lv_label_set_text(title_label, title);
-    lv_obj_set_style_text_color(title_label, lv_color_hex(0xCCCCCC), LV_PART_MAIN);
-    lv_obj_set_style_text_font(title_label, &lv_font_montserrat_12, LV_PART_MAIN);
-    lv_obj_align(title_label, LV_ALIGN_LEFT_MID, 0, 0);
+    lv_obj_add_style(title_label, &ui_theme.header_text, LV_PART_MAIN);
     
     return header;
 }
@@ -133,33 +138,36 @@ static void optimize_page_scrolling(lv_obj_t *page)
     lv_obj_clear_flag(page, LV_OBJ_FLAG_SCROLL_ONE); // Allow free scrolling
 }
 
-// Performance-optimized section group creation using cached styles
+// Section group box, styles are shared by all sections
 static lv_obj_t *create_section_group(lv_obj_t *parent)
 {
     lv_obj_t *group = lv_obj_create(parent);
-    lv_obj_set_size(group, LV_PCT(90), LV_SIZE_CONTENT);
-    
-    // Use cached styles for better performance
-    // if (g_style_cache.initialized) {
-    //     lv_obj_add_style(group, &g_style_cache.section_style, LV_PART_MAIN);
-    // } else {
-        // Fallback to manual styling if cache not initialized
-        lv_obj_set_style_bg_color(group, lv_color_hex(0x2D2D30), LV_PART_MAIN);
-        lv_obj_set_style_bg_opa(group, LV_OPA_COVER, LV_PART_MAIN);
-        lv_obj_set_style_radius(group, 6, LV_PART_MAIN);
-        lv_obj_set_style_border_width(group, 1, LV_PART_MAIN);
-        lv_obj_set_style_border_color(group, lv_color_hex(0x3E3E42), LV_PART_MAIN);
-        lv_obj_set_style_pad_all(group, 8, LV_PART_MAIN);
-        lv_obj_set_style_pad_top(group, 10, LV_PART_MAIN);
-        lv_obj_set_style_pad_bottom(group, 10, LV_PART_MAIN);
-    // }
-    
-    // Optimize animation performance
-    // ui_reduce_animation_time(group);
-    
+    lv_obj_add_style(group, &ui_theme.section, LV_PART_MAIN);
+    lv_obj_add_style(group, &ui_theme.section_opa, LV_PART_MAIN);
+    ui_optimize_scrolling(group);
     return group;
 }
 
+// Full screen page with a back button, hidden until opened from the home screen
+static lv_obj_t *create_page(void)
+{
+    lv_obj_t *page = lv_obj_create(lv_scr_act());
+    lv_obj_add_style(page, &ui_theme.page, LV_PART_MAIN);
+    lv_obj_add_flag(page, LV_OBJ_FLAG_HIDDEN);
+
+    // Apply comprehensive scroll optimizations for smooth scrolling
+    optimize_page_scrolling(page);
+
+    lv_obj_t *back_btn = lv_btn_create(page);
+    lv_obj_add_style(back_btn, &ui_theme.back_button, LV_PART_MAIN);
+    lv_obj_add_event_cb(back_btn, back_to_home_cb, LV_EVENT_CLICKED, NULL);
+
+    lv_obj_t *back_label = lv_label_create(back_btn);
+    lv_label_set_text(back_label, LV_SYMBOL_LEFT " Back");
+    lv_obj_add_style(back_label, &ui_theme.back_text, LV_PART_MAIN);
+    return page;
+}
+
 extern void setBrightness(uint8_t value);
 extern void setTx();
 extern void setRx();
@@ -173,11 +181,19 @@ extern bool        enterSleep;
 
 extern String gps_model;
 
+// Settings made on pages that can be torn down, restored when they are rebuilt
+static uint8_t screen_brightness = 16;
+static uint8_t background_opa = DEFAULT_OPA;
+static uint8_t kb_backlight = DEFAULT_OPA;
+static bool radio_rx_mode = false;
+static char radio_msg_text[96] = "N.A";
+static bool radio_msg_alert = false;
 
 void lv_brightness_cb(lv_event_t *e)
 {
     lv_obj_t *obj = lv_event_get_target(e);
     uint8_t val =  lv_slider_get_value(obj);
+    screen_brightness = val;
     setBrightness(val);
 }
 
@@ -185,6 +201,7 @@ void lv_kb_brightness_cb(lv_event_t *e)
 {
     lv_obj_t *obj = lv_event_get_target(e);
     uint8_t val =  lv_slider_get_value(obj);
+    kb_backlight = val;
     setKeyboardBrightness(val);
 }
 
@@ -192,9 +209,24 @@ void lv_background_opa_cb(lv_event_t *e)
 {
     lv_obj_t *obj = lv_event_get_target(e);
     uint8_t val =  lv_slider_get_value(obj);
-    std::vector<lv_obj_t *>::iterator it;
-    for (it = sub_section.begin(); it != sub_section.end(); it++) {
-        lv_obj_set_style_bg_opa(*it, val, LV_PART_MAIN);
+    background_opa = val;
+    ui_theme_set_section_opa(val);
+}
+
+static void set_radio_message(const char *text, bool alert)
+{
+    if (text != radio_msg_text) {
+        snprintf(radio_msg_text, sizeof(radio_msg_text), "%s", text);
+    }
+    radio_msg_alert = alert;
+    // Kept in radio_msg_text while the Radio page is not built
+    if (!sub_radio_val.label_radio_msg) {
+        return;
+    }
+    lv_label_set_text(sub_radio_val.label_radio_msg, radio_msg_text);
+    lv_obj_remove_style(sub_radio_val.label_radio_msg, &ui_theme.alert_text, LV_PART_MAIN);
+    if (alert) {
+        lv_obj_add_style(sub_radio_val.label_radio_msg, &ui_theme.alert_text, LV_PART_MAIN);
     }
 }
 
@@ -202,7 +234,8 @@ void lv_radio_tx_event_cb(lv_event_t *e)
 {
     Serial.println("set TX");
     setTx();
-    lv_label_set_text(sub_radio_val.label_radio_msg, "RF Tx Starting");
+    radio_rx_mode = false;
+    set_radio_message("RF Tx Starting", false);
     lv_obj_t *obj =  (lv_obj_t *)lv_event_get_target(e);
     lv_obj_t *swRx = (lv_obj_t *)lv_obj_get_user_data(obj);
     lv_obj_clear_state(swRx, LV_STATE_CHECKED);
@@ -212,7 +245,8 @@ void lv_radio_rx_event_cb(lv_event_t *e)
 {
     Serial.println("set RX");
     setRx();
-    lv_label_set_text(sub_radio_val.label_radio_msg, "RF monitoring");
+    radio_rx_mode = true;
+    set_radio_message("RF monitoring", false);
     lv_obj_t *obj =  (lv_obj_t *)lv_event_get_target(e);
     lv_obj_t *swTx = (lv_obj_t *)lv_obj_get_user_data(obj);
     lv_obj_clear_state(swTx, LV_STATE_CHECKED);
@@ -230,79 +264,97 @@ void sleep_event_cb(lv_event_t *e)
 
 void setLoRaMessage(const char *text)
 {
-    lv_label_set_text(sub_radio_val.label_radio_msg, text);
+    set_radio_message(text, false);
 }
 
-// Performance-optimized GPS update function
-void updateGPS(double lat, double lng,
-               uint16_t year, uint8_t month, uint8_t day,
-               uint8_t hour, uint8_t minute, uint8_t second,
-               double speed, uint32_t rx_char, uint32_t use_sec)
+// Alarm pipeline UI mailbox, drained on the LVGL task
+static void show_alarm_event(const alarm_event_t *event)
 {
-    // Static variables to avoid unnecessary updates
-    static double last_lat = 999.0, last_lng = 999.0, last_speed = -1.0;
-    static uint16_t last_year = 0;
-    static uint8_t last_month = 0, last_day = 0, last_hour = 25, last_minute = 61, last_second = 61;
-    static uint32_t last_rx_char = 0, last_use_sec = 0;
-    
+    static const char *const class_names[ALARM_CLASS_MAX] = {"PANIC", "INTRUSION", "TAMPER", "RX"};
+    char buf[96];
+    snprintf(buf, sizeof(buf), "%s N%08lX %s\nRSSI:%.1f SNR:%.1f", class_names[event->cls],
+             (unsigned long)event->node_id, event->text, event->rssi_x10 / 10.0f, event->snr_x10 / 10.0f);
+    set_radio_message(buf, event->cls != ALARM_CLASS_TELEMETRY);
+    if (event->cls != ALARM_CLASS_TELEMETRY) {
+        ui_map_node_alarm(event->node_id);
+    }
+}
+
+// Latest fix from loopGPS(), applied to the labels whenever the GPS page is built
+typedef struct {
+    double lat, lng, speed;
+    uint16_t year;
+    uint8_t month, day, hour, minute, second;
+    uint32_t rx_char, use_sec;
+} gps_view_t;
+
+// Values the fresh "N.A" labels stand for
+static const gps_view_t gps_view_unset = {999.0, 999.0, -1.0, 0, 0, 0, 25, 61, 61, 0, 0};
+static gps_view_t gps_latest;
+static gps_view_t gps_shown = gps_view_unset;
+static bool gps_latest_valid = false;
+
+// Only touch the labels whose value changed since they were last written
+static void gps_labels_update(void)
+{
+    const gps_view_t *v = &gps_latest;
     bool needs_update = false;
     
     // Batch updates for better performance
     ui_batch_style_updates_begin();
     
     // Only update use_seconds if changed
-    if (use_sec != last_use_sec) {
-        if (use_sec == 0) {
-            lv_label_set_text(sub_gps_val.label_use_seconds, "N.A");
-        } else {
-            lv_label_set_text_fmt(sub_gps_val.label_use_seconds, "%u", use_sec);
-        }
-        last_use_sec = use_sec;
+    if (v->use_sec != gps_shown.use_sec) {
+        // Shows whether the fix was assisted and the last cold start to compare with
+        char ttff[48];
+        gps_assist_ttff_text(ttff, sizeof(ttff), v->use_sec);
+        lv_label_set_text(sub_gps_val.label_use_seconds, ttff);
+        gps_shown.use_sec = v->use_sec;
         needs_update = true;
     }
     
     // Only update coordinates if changed significantly (> 0.000001 degrees)
-    if (fabs(lng - last_lng) > 0.000001) {
-        lv_label_set_text_fmt(sub_gps_val.label_lng, "%.6f", lng);
-        last_lng = lng;
+    if (fabs(v->lng - gps_shown.lng) > 0.000001) {
+        lv_label_set_text_fmt(sub_gps_val.label_lng, "%.6f", v->lng);
+        gps_shown.lng = v->lng;
         needs_update = true;
     }
     
-    if (fabs(lat - last_lat) > 0.000001) {
-        lv_label_set_text_fmt(sub_gps_val.label_lat, "%.6f", lat);
-        last_lat = lat;
+    if (fabs(v->lat - gps_shown.lat) > 0.000001) {
+        lv_label_set_text_fmt(sub_gps_val.label_lat, "%.6f", v->lat);
+        gps_shown.lat = v->lat;
         needs_update = true;
     }
     
     // Only update date if changed
-    if (year != last_year || month != last_month || day != last_day) {
-        lv_label_set_text_fmt(sub_gps_val.label_date, "%u/%u/%u", year, month, day);
-        last_year = year;
-        last_month = month;
-        last_day = day;
+    if (v->year != gps_shown.year || v->month != gps_shown.month || v->day != gps_shown.day) {
+        lv_label_set_text_fmt(sub_gps_val.label_date, "%u/%u/%u", v->year, v->month, v->day);
+        gps_shown.year = v->year;
+        gps_shown.month = v->month;
+        gps_shown.day = v->day;
         needs_update = true;
     }
     
     // Only update time if changed
-    if (hour != last_hour || minute != last_minute || second != last_second) {
-        lv_label_set_text_fmt(sub_gps_val.label_time, "%u:%02u:%02u", hour, minute, second);
-        last_hour = hour;
-        last_minute = minute;
-        last_second = second;
+    if (v->hour != gps_shown.hour || v->minute != gps_shown.minute || v->second != gps_shown.second) {
+        lv_label_set_text_fmt(sub_gps_val.label_time, "%u:%02u:%02u", v->hour, v->minute, v->second);
+        gps_shown.hour = v->hour;
+        gps_shown.minute = v->minute;
+        gps_shown.second = v->second;
         needs_update = true;
     }
     
     // Only update speed if changed significantly (> 0.01)
-    if (fabs(speed - last_speed) > 0.01) {
-        lv_label_set_text_fmt(sub_gps_val.label_speed, "%.2f", speed);
-        last_speed = speed;
+    if (fabs(v->speed - gps_shown.speed) > 0.01) {
+        lv_label_set_text_fmt(sub_gps_val.label_speed, "%.2f", v->speed);
+        gps_shown.speed = v->speed;
         needs_update = true;
     }
     
     // Only update rx_char if changed
-    if (rx_char != last_rx_char) {
-        lv_label_set_text_fmt(sub_gps_val.label_processchar, "%u", rx_char);
-        last_rx_char = rx_char;
+    if (v->rx_char != gps_shown.rx_char) {
+        lv_label_set_text_fmt(sub_gps_val.label_processchar, "%u", v->rx_char);
+        gps_shown.rx_char = v->rx_char;
         needs_update = true;
     }
     
@@ -312,11 +364,152 @@ void updateGPS(double lat, double lng,
     }
 }
 
+// Performance-optimized GPS update function
+void updateGPS(double lat, double lng,
+               uint16_t year, uint8_t month, uint8_t day,
+               uint8_t hour, uint8_t minute, uint8_t second,
+               double speed, uint32_t rx_char, uint32_t use_sec)
+{
+    gps_latest.lat = lat;
+    gps_latest.lng = lng;
+    gps_latest.speed = speed;
+    gps_latest.year = year;
+    gps_latest.month = month;
+    gps_latest.day = day;
+    gps_latest.hour = hour;
+    gps_latest.minute = minute;
+    gps_latest.second = second;
+    gps_latest.rx_char = rx_char;
+    gps_latest.use_sec = use_sec;
+    gps_latest_valid = true;
+    ui_map_set_self(lat, lng);
+
+    // GPS page not built, shown when it is
+    if (!sub_gps_val.label_lat) {
+        return;
+    }
+    gps_labels_update();
+}
+
+// Written by the VAD task, shown by a Sound page timer on the LVGL task
+static volatile int32_t noise_count = -1;
+static int32_t noise_shown = -1;
+static uint32_t doa_shown = 0;
+
 void updateNoiseLabel(uint32_t cnt)
 {
-    if (sound_vad_label) {
-        lv_label_set_text_fmt(sound_vad_label, "%u", cnt);
+    noise_count = (int32_t)cnt;
+}
+
+// Alarm history: rows are created one query page at a time while scrolling
+#define HISTORY_PAGE_ROWS           20
+#define HISTORY_MAX_ROWS            400     // Bound the LVGL heap used by one listing
+
+static lv_obj_t *history_list;
+static lv_obj_t *history_status;
+static journal_filter_t history_filter;
+static journal_cursor_t history_cursor;
+static uint32_t history_rows = 0;
+static uint8_t history_zone_sel = 0;
+static uint8_t history_range_sel = 0;
+
+static const char *const history_type_names[JOURNAL_EVT_MAX] = {
+    "-", "BOOT", "ALARM", "ARM", "DISARM", "RX", "HEARTBEAT", "TAMPER", "LOST",
+};
+
+const char *history_zone_list =
+    "All zones\n"
+    "Zone 1\n"
+    "Zone 2\n"
+    "Zone 3\n"
+    "Zone 4\n"
+    "Zone 5\n"
+    "Zone 6\n"
+    "Zone 7\n"
+    "Zone 8";
+
+const char *history_range_list =
+    "All\n"
+    "Last hour\n"
+    "Last 24h\n"
+    "Last 7 days";
+const uint32_t history_range_args_list[] = {0, 3600, 86400, 7 * 86400};
+
+static void history_add_row(const journal_record_t *rec)
+{
+    char when[24];
+    if (rec->flags & JOURNAL_FLAG_UPTIME) {
+        snprintf(when, sizeof(when), "+%lus", (unsigned long)rec->timestamp);
+    } else {
+        time_t ts = rec->timestamp;
+        struct tm tm_info;
+        localtime_r(&ts, &tm_info);
+        strftime(when, sizeof(when), "%m/%d %H:%M:%S", &tm_info);
+    }
+    const char *type = rec->type < JOURNAL_EVT_MAX ? history_type_names[rec->type] : "?";
+
+    lv_obj_t *row = lv_label_create(history_list);
+    lv_label_set_text_fmt(row, "%s  %s  N%08lX  Z%u", when, type, (unsigned long)rec->node_id, rec->zone);
+    lv_obj_add_style(row, &ui_theme.list_row, LV_PART_MAIN);
+    if (rec->type == JOURNAL_EVT_ALARM || rec->type == JOURNAL_EVT_TAMPER) {
+        lv_obj_add_style(row, &ui_theme.alert_text, LV_PART_MAIN);
+    }
+}
+
+static void history_load_page(void)
+{
+    static journal_record_t page[HISTORY_PAGE_ROWS];
+    if (history_cursor.done || history_rows >= HISTORY_MAX_ROWS) {
+        return;
+    }
+    size_t n = journal_query_page(&history_filter, &history_cursor, page, HISTORY_PAGE_ROWS);
+    for (size_t i = 0; i < n; i++) {
+        history_add_row(&page[i]);
     }
+    history_rows += n;
+
+    if (history_rows == 0 && history_cursor.done) {
+        lv_label_set_text(history_status, journal_get_fs() ? "No events" : "Journal offline");
+    } else {
+        lv_label_set_text_fmt(history_status, "%lu events%s", (unsigned long)history_rows,
+                              history_cursor.done ? "" : (history_rows >= HISTORY_MAX_ROWS ? ", refine filter" : "..."));
+    }
+}
+
+static void history_reload(void)
+{
+    lv_obj_clean(history_list);
+    history_rows = 0;
+    journal_query_begin(&history_cursor);
+    history_load_page();
+}
+
+static void history_scroll_cb(lv_event_t *e)
+{
+    lv_obj_t *list = lv_event_get_target(e);
+    // Fetch the next page before the user reaches the last row
+    if (lv_obj_get_scroll_bottom(list) < 60) {
+        history_load_page();
+    }
+}
+
+static void history_zone_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = (lv_obj_t *)lv_event_get_target(e);
+    uint32_t index = lv_dropdown_get_selected(obj);
+    history_zone_sel = index;
+    history_filter.zone = index == 0 ? JOURNAL_QUERY_ANY_ZONE : (int16_t)index;
+    history_reload();
+}
+
+static void history_range_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = (lv_obj_t *)lv_event_get_target(e);
+    history_range_sel = lv_dropdown_get_selected(obj);
+    uint32_t range = history_range_args_list[history_range_sel];
+    time_t now = time(NULL);
+    history_filter.from_ts = (range && now > (time_t)range) ? (uint32_t)(now - range) : 0;
+    history_reload();
 }
 
 const char *radio_freq_list =
@@ -365,6 +558,15 @@ const char   *radio_tx_interval_list =
     "5000ms";
 const float radio_tx_interval_args_list[] = {100, 200, 500, 1000, 2000, 3000, 5000};
 
+#ifdef  JAPAN_MIC
+static uint8_t radio_freq_sel = 0;
+#else
+static uint8_t radio_freq_sel = 2;
+#endif
+static uint8_t radio_bandwidth_sel = 0;
+static uint8_t radio_power_sel = 6;
+static uint8_t radio_interval_sel = 3;
+
 static void radio_freq_cb(lv_event_t *e)
 {
     lv_obj_t *obj = (lv_obj_t *)lv_event_get_target(e);
@@ -372,6 +574,7 @@ static void radio_freq_cb(lv_event_t *e)
     lv_dropdown_get_selected_str(obj, buf, sizeof(buf));
     uint32_t index = lv_dropdown_get_selected(obj);
     Serial.printf("Option: %s id:%u\n", buf, index);
+    radio_freq_sel = index;
     setFreq(freq_list[index]);
 }
 
@@ -383,6 +586,7 @@ static void radio_power_cb(lv_event_t *e)
     lv_dropdown_get_selected_str(obj, buf, sizeof(buf));
     uint32_t index = lv_dropdown_get_selected(obj);
     Serial.printf("Option: %s id:%u\n", buf, index);
+    radio_power_sel = index;
     setTxPower(radio_power_args_list[index]);
 
 }
@@ -394,6 +598,7 @@ static void radio_bandwidth_cb(lv_event_t *e)
     lv_dropdown_get_selected_str(obj, buf, sizeof(buf));
     uint32_t index = lv_dropdown_get_selected(obj);
     Serial.printf("Option: %s id:%u\n", buf, index);
+    radio_bandwidth_sel = index;
     setBandWidth(bandwidth_list[index]);
 }
 
@@ -404,6 +609,7 @@ static void radio_interval_cb(lv_event_t *e)
     lv_dropdown_get_selected_str(obj, buf, sizeof(buf));
     uint32_t index = lv_dropdown_get_selected(obj);
     Serial.printf("Option: %s id:%u\n", buf, index);
+    radio_interval_sel = index;
     setSenderInterval(radio_tx_interval_args_list[index]);
 }
 
@@ -413,7 +619,6 @@ extern bool  hasRadio;
 
 // Global variable for icon transparency control
 static uint8_t icon_transparency = 180; // Default semi-transparent (70% opacity)
-static std::vector<lv_obj_t *> app_icons; // Store all app icons for transparency updates
 
 // Callback to update icon transparency
 void lv_icon_transparency_cb(lv_event_t *e)
@@ -422,417 +627,189 @@ void lv_icon_transparency_cb(lv_event_t *e)
     uint8_t val = lv_slider_get_value(obj);
     icon_transparency = val;
     
-    // Update transparency for all app icons
-    for (auto icon : app_icons) {
-        if (icon) {
-            lv_obj_set_style_bg_opa(icon, val, LV_PART_MAIN);
-            lv_obj_set_style_border_opa(icon, val, LV_PART_MAIN);
-        }
-    }
-}
-
-// Function to create icon button with navigation
-static lv_obj_t *create_app_icon(lv_obj_t *parent, const char *icon, const char *label, lv_obj_t *target_page, lv_event_cb_t cb)
-{
-    lv_obj_t *btn = lv_btn_create(parent);
-    lv_obj_set_size(btn, 80, 80);
-    lv_obj_set_style_bg_color(btn, lv_color_hex(0x2D2D30), LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(btn, icon_transparency, LV_PART_MAIN); // Use adjustable transparency
-    lv_obj_set_style_radius(btn, 16, LV_PART_MAIN);
-    lv_obj_set_style_border_width(btn, 1, LV_PART_MAIN);
-    lv_obj_set_style_border_color(btn, lv_color_hex(0x3E3E42), LV_PART_MAIN);
-    lv_obj_set_style_border_opa(btn, icon_transparency, LV_PART_MAIN); // Make border transparent too
-    lv_obj_set_style_shadow_width(btn, 4, LV_PART_MAIN);
-    lv_obj_set_style_shadow_color(btn, lv_color_black(), LV_PART_MAIN);
-    lv_obj_set_style_shadow_opa(btn, LV_OPA_30, LV_PART_MAIN); // Slightly more visible shadow for depth
-    lv_obj_set_style_shadow_ofs_y(btn, 2, LV_PART_MAIN);
-    
-    // Pressed state - more opaque when pressed
-    lv_obj_set_style_bg_color(btn, lv_color_hex(0x007ACC), LV_STATE_PRESSED);
-    lv_obj_set_style_bg_opa(btn, LV_OPA_COVER, LV_STATE_PRESSED); // Full opacity when pressed
-    lv_obj_set_style_transform_zoom(btn, 240, LV_STATE_PRESSED);
-    
-    // Icon
-    lv_obj_t *icon_label = lv_label_create(btn);
-    lv_label_set_text(icon_label, icon);
-    lv_obj_set_style_text_color(icon_label, lv_color_hex(0x007ACC), LV_PART_MAIN);
-    lv_obj_set_style_text_font(icon_label, &lv_font_montserrat_12, LV_PART_MAIN);
-    lv_obj_align(icon_label, LV_ALIGN_CENTER, 0, -10);
-    
-    // Label
-    lv_obj_t *text_label = lv_label_create(btn);
-    lv_label_set_text(text_label, label);
-    lv_obj_set_style_text_color(text_label, lv_color_hex(0xCCCCCC), LV_PART_MAIN);
-    lv_obj_set_style_text_font(text_label, &lv_font_montserrat_12, LV_PART_MAIN);
-    lv_obj_align(text_label, LV_ALIGN_CENTER, 0, 15);
-    
-    // Store target page in user data
-    lv_obj_set_user_data(btn, target_page);
-    
-    if (cb) {
-        lv_obj_add_event_cb(btn, cb, LV_EVENT_CLICKED, NULL);
-    }
-    
-    // Store icon in vector for transparency updates
-    app_icons.push_back(btn);
-    
-    return btn;
+    // All app icons share one style
+    ui_theme_set_icon_opa(val);
 }
 
-// Navigation callback for app icons with debouncing
-static void app_icon_cb(lv_event_t *e)
+// !RADIO
+static void build_radio_page(lv_obj_t *page)
 {
-    static uint32_t last_click_time = 0;
-    uint32_t current_time = lv_tick_get();
-    
-    // Debounce: ignore clicks within 300ms of the last click
-    if (current_time - last_click_time < 300) {
+    // Radio - Each control gets its own individual section/box
+    if (!hasRadio) {
+        lv_obj_t *offline_section = create_section_group(page);
+        lv_obj_t *label = lv_label_create(offline_section);
+        lv_label_set_text(label, "Radio is offline");
+        lv_obj_add_style(label, &ui_theme.header_text, LV_PART_MAIN);
+        lv_obj_center(label);
         return;
     }
-    last_click_time = current_time;
-    
-    lv_obj_t *btn = lv_event_get_target(e);
-    lv_obj_t *target_page = (lv_obj_t *)lv_obj_get_user_data(btn);
-    
-    if (target_page) {
-        // Isolate touch input during screen transition to prevent cross-menu button activation
-        uint32_t screen_id = (uint32_t)target_page; // Use page pointer as unique screen ID
-        isolate_touch_input(screen_id);
-        
-        // Start display update batching for better performance
-        lv_disp_t *disp = lv_disp_get_default();
-        if (disp) {
-            // Pause screen refreshing during batch updates
-            lv_disp_enable_invalidation(disp, false);
+
+    lv_obj_t *tx_section = create_section_group(page);
+    lv_obj_t *swTx = create_switch(tx_section, LV_SYMBOL_UP, "Tx", !radio_rx_mode, lv_radio_tx_event_cb);
+
+    lv_obj_t *rx_section = create_section_group(page);
+    lv_obj_t *swRx = create_switch(rx_section, LV_SYMBOL_DOWN, "Rx", radio_rx_mode, lv_radio_rx_event_cb);
+
+    lv_obj_set_user_data(swTx, swRx);
+    lv_obj_set_user_data(swRx, swTx);
+
+    lv_obj_t *message_section = create_section_group(page);
+    create_label(message_section, LV_SYMBOL_LOOP, "Message", NULL);
+    sub_radio_val.label_radio_msg = create_label(message_section, NULL, NULL, "N.A");
+    set_radio_message(radio_msg_text, radio_msg_alert);
+
+    lv_obj_t *nodes_section = create_section_group(page);
+    lv_obj_t *nodes_label = create_label(nodes_section, LV_SYMBOL_WIFI, "Nodes", "N.A");
+    lv_timer_t *nodes_timer = ui_page_timer_create([](lv_timer_t *t) {
+        lv_obj_t *nodes_label = (lv_obj_t *)t->user_data;
+        // Read through snapshots, never blocks the radio path
+        uint32_t total = 0, heard = 0, lost = 0, now = millis();
+        node_snapshot_t snap, last = {0};
+        for (uint32_t slot = 0; slot < node_registry_count(); slot++) {
+            if (!node_registry_snapshot(slot, &snap)) {
+                continue;
+            }
+            total++;
+            if (snap.flags & NODE_FLAG_LOST) {
+                lost++;
+            }
+            if ((snap.flags & NODE_FLAG_SEEN) && now - snap.last_seen_ms < 5 * 60 * 1000UL) {
+                heard++;
+                if (!last.node_id || (int32_t)(snap.last_seen_ms - last.last_seen_ms) > 0) {
+                    last = snap;
+                }
+            }
         }
-        
-        // Hide home screen
-        lv_obj_add_flag(home_screen, LV_OBJ_FLAG_HIDDEN);
-        
-        // Hide all pages first
-        lv_obj_add_flag(sub_mechanics_page, LV_OBJ_FLAG_HIDDEN);
-        lv_obj_add_flag(sub_sound_page, LV_OBJ_FLAG_HIDDEN);
-        lv_obj_add_flag(sub_display_page, LV_OBJ_FLAG_HIDDEN);
-        lv_obj_add_flag(sub_gps_page, LV_OBJ_FLAG_HIDDEN);
-        lv_obj_add_flag(sub_kb_page, LV_OBJ_FLAG_HIDDEN);
-        lv_obj_add_flag(sub_setting_page, LV_OBJ_FLAG_HIDDEN);
-        
-        // Show the target page
-        lv_obj_clear_flag(target_page, LV_OBJ_FLAG_HIDDEN);
-        
-        // Re-enable screen refreshing and force immediate update
-        if (disp) {
-            lv_disp_enable_invalidation(disp, true);
-            lv_obj_invalidate(lv_scr_act()); // Force full screen redraw
+        if (last.node_id) {
+            lv_label_set_text_fmt(nodes_label, "%lu/%lu %lu lost  N%08lX %d dBm", (unsigned long)heard,
+                                  (unsigned long)total, (unsigned long)lost,
+                                  (unsigned long)last.node_id, last.rssi_x16 / NODE_EWMA_SCALE);
+        } else {
+            lv_label_set_text_fmt(nodes_label, "%lu/%lu %lu lost", (unsigned long)heard, (unsigned long)total,
+                                  (unsigned long)lost);
         }
-        
-        // Force immediate LVGL processing to ensure responsive UI
-        lv_task_handler();
-    }
-}
-
-// Back to home callback
-static void back_to_home_cb(lv_event_t *e)
-{
-    // Isolate touch input during screen transition back to home
-    isolate_touch_input(0); // Use 0 as home screen ID
-    
-    // Hide all pages
-    lv_obj_add_flag(sub_mechanics_page, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_add_flag(sub_sound_page, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_add_flag(sub_display_page, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_add_flag(sub_gps_page, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_add_flag(sub_kb_page, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_add_flag(sub_setting_page, LV_OBJ_FLAG_HIDDEN);
-    
-    // Show home screen
-    lv_obj_clear_flag(home_screen, LV_OBJ_FLAG_HIDDEN);
-}
+    }, 2000, nodes_label);
+    LV_ASSERT_NULL(nodes_timer);
 
-void setupUI(void)
-{
-    // Initialize performance optimizations first
-    ui_performance_init();
-    
-    // Reserve capacity for sub_section vector to avoid reallocations
-    sub_section.reserve(32);  // Estimate of total sections needed
-    
-    // Pre-allocate string buffers
-    memset(gps_lat_buffer, 0, sizeof(gps_lat_buffer));
-    memset(gps_lng_buffer, 0, sizeof(gps_lng_buffer));
-    memset(gps_speed_buffer, 0, sizeof(gps_speed_buffer));
-    memset(gps_date_buffer, 0, sizeof(gps_date_buffer));
-    memset(gps_time_buffer, 0, sizeof(gps_time_buffer));
-    memset(battery_buffer, 0, sizeof(battery_buffer));
-    memset(wifi_rssi_buffer, 0, sizeof(wifi_rssi_buffer));
-    
-    // Batch all UI creation for better performance
-    ui_batch_style_updates_begin();
-    // Create a simple full-screen container instead of menu
-    home_screen = lv_obj_create(lv_scr_act());
-    lv_obj_set_size(home_screen, LV_PCT(100), LV_PCT(100));
-    
-    // Use system background image instead of solid color
-    lv_obj_set_style_bg_img_src(home_screen, &system_background, LV_PART_MAIN);
-    lv_obj_set_style_bg_img_opa(home_screen, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_bg_img_tiled(home_screen, false, LV_PART_MAIN);
-    
-    lv_obj_set_style_border_width(home_screen, 0, LV_PART_MAIN);
-    lv_obj_set_style_pad_all(home_screen, 0, LV_PART_MAIN);
-    lv_obj_center(home_screen);
-    
-    // Store main screen reference instead of menu
-    global_menu = home_screen;
-
-    lv_obj_t *cont;
-    lv_obj_t *section;
-
-  
-    /*Create sub pages as simple containers*/
-    // !RADIO
-    sub_mechanics_page = lv_obj_create(lv_scr_act());
-    lv_obj_set_size(sub_mechanics_page, LV_PCT(100), LV_PCT(100));
-    lv_obj_set_style_pad_all(sub_mechanics_page, 10, 0);
-    lv_obj_set_style_bg_color(sub_mechanics_page, lv_color_hex(0x1E1E1E), LV_PART_MAIN);
-    lv_obj_set_style_border_width(sub_mechanics_page, 0, LV_PART_MAIN);
-    lv_obj_add_flag(sub_mechanics_page, LV_OBJ_FLAG_HIDDEN); // Hide initially
-    lv_obj_set_flex_flow(sub_mechanics_page, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(sub_mechanics_page, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    
-    // Apply comprehensive scroll optimizations for smooth scrolling
-    optimize_page_scrolling(sub_mechanics_page);
-    
-    // Add back button at the top
-    lv_obj_t *radio_back_btn = lv_btn_create(sub_mechanics_page);
-    lv_obj_set_size(radio_back_btn, LV_SIZE_CONTENT, 40);
-    lv_obj_set_style_bg_color(radio_back_btn, lv_color_hex(0x007ACC), LV_PART_MAIN);
-    lv_obj_set_style_radius(radio_back_btn, 8, LV_PART_MAIN);
-    lv_obj_add_event_cb(radio_back_btn, back_to_home_cb, LV_EVENT_CLICKED, NULL);
-    
-    lv_obj_t *radio_back_label = lv_label_create(radio_back_btn);
-    lv_label_set_text(radio_back_label, LV_SYMBOL_LEFT " Back");
-    lv_obj_set_style_text_color(radio_back_label, lv_color_white(), LV_PART_MAIN);
-    lv_obj_center(radio_back_label);
-    
-    // Radio - Each control gets its own individual section/box
-    if (hasRadio) {
-        lv_obj_t *tx_section = create_section_group(sub_mechanics_page);
-        sub_section.push_back(tx_section);
-        lv_obj_t *swTx = create_switch(tx_section, LV_SYMBOL_UP, "Tx", true, lv_radio_tx_event_cb);
+    lv_obj_t *freq_section = create_section_group(page);
+    create_dropdown(freq_section, NULL, "Freq", radio_freq_list, radio_freq_sel, radio_freq_cb);
 
-        lv_obj_t *rx_section = create_section_group(sub_mechanics_page);
-        sub_section.push_back(rx_section);
-        lv_obj_t *swRx = create_switch(rx_section, LV_SYMBOL_DOWN, "Rx", false, lv_radio_rx_event_cb);
+    lv_obj_t *bandwidth_section = create_section_group(page);
+    create_dropdown(bandwidth_section, NULL, "BandWidth", radio_bandwidth_list, radio_bandwidth_sel, radio_bandwidth_cb);
 
-        lv_obj_set_user_data(swTx, swRx);
-        lv_obj_set_user_data(swRx, swTx);
+    lv_obj_t *power_section = create_section_group(page);
+    create_dropdown(power_section, NULL, "TxPower", radio_power_level_list, radio_power_sel, radio_power_cb);
 
-        lv_obj_t *message_section = create_section_group(sub_mechanics_page);
-        sub_section.push_back(message_section);
-        create_label(message_section, LV_SYMBOL_LOOP, "Message", NULL);
-        sub_radio_val.label_radio_msg = create_label(message_section, NULL, NULL, "N.A");
-
-#ifdef  JAPAN_MIC
-        uint8_t freq_index = 0;
-#else
-        uint8_t freq_index = 2;
-#endif
-        lv_obj_t *freq_section = create_section_group(sub_mechanics_page);
-        sub_section.push_back(freq_section);
-        create_dropdown(freq_section, NULL, "Freq", radio_freq_list, freq_index, radio_freq_cb);
-
-        lv_obj_t *bandwidth_section = create_section_group(sub_mechanics_page);
-        sub_section.push_back(bandwidth_section);
-        create_dropdown(bandwidth_section, NULL, "BandWidth", radio_bandwidth_list, 0, radio_bandwidth_cb);
-
-        lv_obj_t *power_section = create_section_group(sub_mechanics_page);
-        sub_section.push_back(power_section);
-        create_dropdown(power_section, NULL, "TxPower", radio_power_level_list, 6, radio_power_cb);
-
-        lv_obj_t *interval_section = create_section_group(sub_mechanics_page);
-        sub_section.push_back(interval_section);
-        create_dropdown(interval_section, NULL, "Interval", radio_tx_interval_list, 3, radio_interval_cb);
-
-    } else {
-        lv_obj_t *offline_section = create_section_group(sub_mechanics_page);
-        sub_section.push_back(offline_section);
-        lv_obj_t *label = lv_label_create(offline_section);
-        lv_label_set_text(label, "Radio is offline");
-        lv_obj_set_style_text_color(label, lv_color_hex(0xCCCCCC), LV_PART_MAIN);
-        lv_obj_center(label);
-    }
-
-
-    // !SOUND
-    sub_sound_page = lv_obj_create(lv_scr_act());
-    lv_obj_set_size(sub_sound_page, LV_PCT(100), LV_PCT(100));
-    lv_obj_set_style_pad_all(sub_sound_page, 10, 0);
-    lv_obj_set_style_bg_color(sub_sound_page, lv_color_hex(0x1E1E1E), LV_PART_MAIN);
-    lv_obj_set_style_border_width(sub_sound_page, 0, LV_PART_MAIN);
-    lv_obj_add_flag(sub_sound_page, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_set_flex_flow(sub_sound_page, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(sub_sound_page, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    
-    // Apply comprehensive scroll optimizations for smooth scrolling
-    optimize_page_scrolling(sub_sound_page);
+    lv_obj_t *interval_section = create_section_group(page);
+    create_dropdown(interval_section, NULL, "Interval", radio_tx_interval_list, radio_interval_sel, radio_interval_cb);
+}
 
-    // Add back button
-    lv_obj_t *sound_back_btn = lv_btn_create(sub_sound_page);
-    lv_obj_set_size(sound_back_btn, LV_SIZE_CONTENT, 40);
-    lv_obj_set_style_bg_color(sound_back_btn, lv_color_hex(0x007ACC), LV_PART_MAIN);
-    lv_obj_set_style_radius(sound_back_btn, 8, LV_PART_MAIN);
-    lv_obj_add_event_cb(sound_back_btn, back_to_home_cb, LV_EVENT_CLICKED, NULL);
-    
-    lv_obj_t *sound_back_label = lv_label_create(sound_back_btn);
-    lv_label_set_text(sound_back_label, LV_SYMBOL_LEFT " Back");
-    lv_obj_set_style_text_color(sound_back_label, lv_color_white(), LV_PART_MAIN);
-    lv_obj_center(sound_back_label);
+static void teardown_radio_page(void)
+{
+    memset(&sub_radio_val, 0, sizeof(sub_radio_val));
+}
 
+// !SOUND
+static void build_sound_page(lv_obj_t *page)
+{
     // Sound - Each control gets its own individual section/box
-    create_section_header(sub_sound_page, "AUDIO OUTPUT");
-    lv_obj_t *speaker_section = create_section_group(sub_sound_page);
-    sub_section.push_back(speaker_section);
+    create_section_header(page, "AUDIO OUTPUT");
+    lv_obj_t *speaker_section = create_section_group(page);
     create_button(speaker_section, LV_SYMBOL_AUDIO, "Test Speaker", speaker_play_event);
 
-    create_section_header(sub_sound_page, "MICROPHONE");
-    lv_obj_t *mic_section = create_section_group(sub_sound_page);
-    sub_section.push_back(mic_section);
+    create_section_header(page, "MICROPHONE");
+    lv_obj_t *mic_section = create_section_group(page);
     sound_vad_label = create_label(mic_section, LV_SYMBOL_VOLUME_MAX, "Voice Activity", "N.A");
+    lv_obj_t *doa_section = create_section_group(page);
+    sound_doa_label = create_label(doa_section, LV_SYMBOL_GPS, "Noise Direction", "N.A");
+
+    noise_shown = -1;
+    doa_shown = 0;
+    lv_timer_t *mic_timer = ui_page_timer_create([](lv_timer_t *t) {
+        int32_t cnt = noise_count;
+        if (cnt >= 0 && cnt != noise_shown) {
+            lv_label_set_text_fmt(sound_vad_label, "%ld", (long)cnt);
+            noise_shown = cnt;
+        }
+        mic_doa_t doa;
+        mic_array_latest(&doa);
+        if (doa.count != doa_shown) {
+            lv_label_set_text_fmt(sound_doa_label, "%s, %d deg", mic_array_sector(doa.azimuth), doa.azimuth);
+            doa_shown = doa.count;
+        }
+    }, 250, NULL);
+    LV_ASSERT_NULL(mic_timer);
+}
 
+static void teardown_sound_page(void)
+{
+    sound_vad_label = NULL;
+    sound_doa_label = NULL;
+}
 
-    // !DISPLAY
-    sub_display_page = lv_obj_create(lv_scr_act());
-    lv_obj_set_size(sub_display_page, LV_PCT(100), LV_PCT(100));
-    lv_obj_set_style_pad_all(sub_display_page, 10, 0);
-    lv_obj_set_style_bg_color(sub_display_page, lv_color_hex(0x1E1E1E), LV_PART_MAIN);
-    lv_obj_set_style_border_width(sub_display_page, 0, LV_PART_MAIN);
-    lv_obj_add_flag(sub_display_page, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_set_flex_flow(sub_display_page, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(sub_display_page, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    
-    // Apply comprehensive scroll optimizations for smooth scrolling
-    optimize_page_scrolling(sub_display_page);
-
-    // Add back button
-    lv_obj_t *display_back_btn = lv_btn_create(sub_display_page);
-    lv_obj_set_size(display_back_btn, LV_SIZE_CONTENT, 40);
-    lv_obj_set_style_bg_color(display_back_btn, lv_color_hex(0x007ACC), LV_PART_MAIN);
-    lv_obj_set_style_radius(display_back_btn, 8, LV_PART_MAIN);
-    lv_obj_add_event_cb(display_back_btn, back_to_home_cb, LV_EVENT_CLICKED, NULL);
-    
-    lv_obj_t *display_back_label = lv_label_create(display_back_btn);
-    lv_label_set_text(display_back_label, LV_SYMBOL_LEFT " Back");
-    lv_obj_set_style_text_color(display_back_label, lv_color_white(), LV_PART_MAIN);
-    lv_obj_center(display_back_label);
-
+// !DISPLAY
+static void build_display_page(lv_obj_t *page)
+{
     // Display - Each slider gets its own individual section/box
-    create_section_header(sub_display_page, "BRIGHTNESS");
-    lv_obj_t *screen_brightness_section = create_section_group(sub_display_page);
-    sub_section.push_back(screen_brightness_section);
-    create_slider(screen_brightness_section, LV_SYMBOL_SETTINGS, "Screen Brightness", 1, 16, 16, lv_brightness_cb, LV_EVENT_VALUE_CHANGED);
+    create_section_header(page, "BRIGHTNESS");
+    lv_obj_t *screen_brightness_section = create_section_group(page);
+    create_slider(screen_brightness_section, LV_SYMBOL_SETTINGS, "Screen Brightness", 1, 16, screen_brightness, lv_brightness_cb, LV_EVENT_VALUE_CHANGED);
 
-    lv_obj_t *background_opacity_section = create_section_group(sub_display_page);
-    sub_section.push_back(background_opacity_section);
-    create_slider(background_opacity_section, LV_SYMBOL_SETTINGS, "Background Opacity", 0, 255, DEFAULT_OPA, lv_background_opa_cb, LV_EVENT_VALUE_CHANGED);
+    lv_obj_t *background_opacity_section = create_section_group(page);
+    create_slider(background_opacity_section, LV_SYMBOL_SETTINGS, "Background Opacity", 0, 255, background_opa, lv_background_opa_cb, LV_EVENT_VALUE_CHANGED);
 
-    lv_obj_t *keyboard_backlight_section = create_section_group(sub_display_page);
-    sub_section.push_back(keyboard_backlight_section);
-    create_slider(keyboard_backlight_section, LV_SYMBOL_SETTINGS, "Keyboard Backlight", 0, 255, DEFAULT_OPA, lv_kb_brightness_cb, LV_EVENT_VALUE_CHANGED);
+    lv_obj_t *keyboard_backlight_section = create_section_group(page);
+    create_slider(keyboard_backlight_section, LV_SYMBOL_SETTINGS, "Keyboard Backlight", 0, 255, kb_backlight, lv_kb_brightness_cb, LV_EVENT_VALUE_CHANGED);
 
-    lv_obj_t *icon_transparency_section = create_section_group(sub_display_page);
-    sub_section.push_back(icon_transparency_section);
+    lv_obj_t *icon_transparency_section = create_section_group(page);
     create_slider(icon_transparency_section, LV_SYMBOL_SETTINGS, "Icon Transparency", 50, 255, icon_transparency, lv_icon_transparency_cb, LV_EVENT_VALUE_CHANGED);
+}
 
-
-    // !GPS
-    sub_gps_page = lv_obj_create(lv_scr_act());
-    lv_obj_set_size(sub_gps_page, LV_PCT(100), LV_PCT(100));
-    lv_obj_set_style_pad_all(sub_gps_page, 10, 0);
-    lv_obj_set_style_bg_color(sub_gps_page, lv_color_hex(0x1E1E1E), LV_PART_MAIN);
-    lv_obj_set_style_border_width(sub_gps_page, 0, LV_PART_MAIN);
-    lv_obj_add_flag(sub_gps_page, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_set_flex_flow(sub_gps_page, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(sub_gps_page, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    // Enable scrolling for GPS page
-    lv_obj_set_scroll_dir(sub_gps_page, LV_DIR_VER);
-    
-    // Apply comprehensive scroll optimizations for smooth scrolling
-    optimize_page_scrolling(sub_gps_page);
-
-    // Add back button
-    lv_obj_t *gps_back_btn = lv_btn_create(sub_gps_page);
-    lv_obj_set_size(gps_back_btn, LV_SIZE_CONTENT, 40);
-    lv_obj_set_style_bg_color(gps_back_btn, lv_color_hex(0x007ACC), LV_PART_MAIN);
-    lv_obj_set_style_radius(gps_back_btn, 8, LV_PART_MAIN);
-    lv_obj_add_event_cb(gps_back_btn, back_to_home_cb, LV_EVENT_CLICKED, NULL);
-    
-    lv_obj_t *gps_back_label = lv_label_create(gps_back_btn);
-    lv_label_set_text(gps_back_label, LV_SYMBOL_LEFT " Back");
-    lv_obj_set_style_text_color(gps_back_label, lv_color_white(), LV_PART_MAIN);
-    lv_obj_center(gps_back_label);
-
+// !GPS
+static void build_gps_page(lv_obj_t *page)
+{
     // GPS - Each label gets its own individual section/box
-    lv_obj_t *model_section = create_section_group(sub_gps_page);
-    sub_section.push_back(model_section);
-    lv_obj_t *model_label = create_label(model_section, LV_SYMBOL_GPS, "Model", gps_model.c_str());
+    lv_obj_t *model_section = create_section_group(page);
+    create_label(model_section, LV_SYMBOL_GPS, "Model", gps_model.c_str());
 
-    lv_obj_t *use_seconds_section = create_section_group(sub_gps_page);
-    sub_section.push_back(use_seconds_section);
+    lv_obj_t *use_seconds_section = create_section_group(page);
     sub_gps_val.label_use_seconds = create_label(use_seconds_section, LV_SYMBOL_GPS, "Use Seconds", "N.A");
 
-    lv_obj_t *lat_section = create_section_group(sub_gps_page);
-    sub_section.push_back(lat_section);
+    lv_obj_t *lat_section = create_section_group(page);
     sub_gps_val.label_lat = create_label(lat_section, LV_SYMBOL_GPS, "lat", "N.A");
 
-    lv_obj_t *lng_section = create_section_group(sub_gps_page);
-    sub_section.push_back(lng_section);
+    lv_obj_t *lng_section = create_section_group(page);
     sub_gps_val.label_lng = create_label(lng_section, LV_SYMBOL_GPS, "lng", "N.A");
 
-    lv_obj_t *speed_section = create_section_group(sub_gps_page);
-    sub_section.push_back(speed_section);
+    lv_obj_t *speed_section = create_section_group(page);
     sub_gps_val.label_speed = create_label(speed_section, LV_SYMBOL_SETTINGS, "Speed", "N.A");
 
-    lv_obj_t *date_section = create_section_group(sub_gps_page);
-    sub_section.push_back(date_section);
+    lv_obj_t *date_section = create_section_group(page);
     sub_gps_val.label_date = create_label(date_section, LV_SYMBOL_SETTINGS, "Date", "N.A");
 
-    lv_obj_t *time_section = create_section_group(sub_gps_page);
-    sub_section.push_back(time_section);
+    lv_obj_t *time_section = create_section_group(page);
     sub_gps_val.label_time = create_label(time_section, LV_SYMBOL_SETTINGS, "Time", "N.A");
 
-    lv_obj_t *rx_section = create_section_group(sub_gps_page);
-    sub_section.push_back(rx_section);
+    lv_obj_t *rx_section = create_section_group(page);
     sub_gps_val.label_processchar = create_label(rx_section, LV_SYMBOL_SETTINGS, "Rx", "N.A");
 
-    //! KEYBOARD
-    sub_kb_page = lv_obj_create(lv_scr_act());
-    lv_obj_set_size(sub_kb_page, LV_PCT(100), LV_PCT(100));
-    lv_obj_set_style_pad_all(sub_kb_page, 10, 0);
-    lv_obj_set_style_bg_color(sub_kb_page, lv_color_hex(0x1E1E1E), LV_PART_MAIN);
-    lv_obj_set_style_border_width(sub_kb_page, 0, LV_PART_MAIN);
-    lv_obj_add_flag(sub_kb_page, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_set_flex_flow(sub_kb_page, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(sub_kb_page, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    
-    // Apply comprehensive scroll optimizations for smooth scrolling
-    optimize_page_scrolling(sub_kb_page);
+    gps_shown = gps_view_unset;
+    if (gps_latest_valid) {
+        gps_labels_update();
+    }
+}
 
-    // Add back button
-    lv_obj_t *kb_back_btn = lv_btn_create(sub_kb_page);
-    lv_obj_set_size(kb_back_btn, LV_SIZE_CONTENT, 40);
-    lv_obj_set_style_bg_color(kb_back_btn, lv_color_hex(0x007ACC), LV_PART_MAIN);
-    lv_obj_set_style_radius(kb_back_btn, 8, LV_PART_MAIN);
-    lv_obj_add_event_cb(kb_back_btn, back_to_home_cb, LV_EVENT_CLICKED, NULL);
-    
-    lv_obj_t *kb_back_label = lv_label_create(kb_back_btn);
-    lv_label_set_text(kb_back_label, LV_SYMBOL_LEFT " Back");
-    lv_obj_set_style_text_color(kb_back_label, lv_color_white(), LV_PART_MAIN);
-    lv_obj_center(kb_back_label);
+static void teardown_gps_page(void)
+{
+    memset(&sub_gps_val, 0, sizeof(sub_gps_val));
+}
 
+//! KEYBOARD
+static void build_keyboard_page(lv_obj_t *page)
+{
     // Keyboard - Text input gets its own individual section/box
-    create_section_header(sub_kb_page, "TEXT INPUT");
-    lv_obj_t *textarea_section = create_section_group(sub_kb_page);
-    sub_section.push_back(textarea_section);
+    create_section_header(page, "TEXT INPUT");
+    lv_obj_t *textarea_section = create_section_group(page);
 
     lv_obj_t *radio_ta = lv_textarea_create(textarea_section);
     lv_textarea_set_cursor_click_pos(radio_ta, false);
@@ -841,21 +818,13 @@ void setupUI(void)
     lv_textarea_set_text(radio_ta, "");
     lv_textarea_set_max_length(radio_ta, 1024);
     
-    // iPhone-style textarea
-    lv_obj_set_style_bg_color(radio_ta, lv_color_hex(0x2D2D30), LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(radio_ta, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_radius(radio_ta, 8, LV_PART_MAIN);
-    lv_obj_set_style_border_width(radio_ta, 1, LV_PART_MAIN);
-    lv_obj_set_style_border_color(radio_ta, lv_color_hex(0x3E3E42), LV_PART_MAIN);
-    lv_obj_set_style_border_opa(radio_ta, LV_OPA_60, LV_PART_MAIN);
-    lv_obj_set_style_pad_all(radio_ta, 8, LV_PART_MAIN);
-    lv_obj_set_style_text_font(radio_ta, &lv_font_montserrat_12, LV_PART_MAIN);
-    lv_obj_set_style_text_color(radio_ta, lv_color_hex(0xCCCCCC), LV_PART_MAIN);
-    
-    sub_section.push_back(radio_ta);
+    // iPhone-style textarea, translucent like the sections
+    lv_obj_add_style(radio_ta, &ui_theme.field, LV_PART_MAIN);
+    lv_obj_add_style(radio_ta, &ui_theme.section_opa, LV_PART_MAIN);
+    ui_optimize_scrolling(radio_ta);
 
 
-    lv_timer_create([](lv_timer_t *t) {
+    lv_timer_t *kb_timer = ui_page_timer_create([](lv_timer_t *t) {
         extern lv_indev_t  *kb_indev ;
         if (NULL == kb_indev) {
             lv_obj_t *radio_ta = (lv_obj_t *)t->user_data;
@@ -863,71 +832,47 @@ void setupUI(void)
             lv_obj_invalidate(radio_ta);
         }
     }, 3000, radio_ta);
+    LV_ASSERT_NULL(kb_timer);
+}
 
-    //! SD
-    // lv_obj_t *sub_sd_page = lv_menu_page_create(menu, NULL);
-    // lv_obj_set_style_pad_hor(sub_sd_page, lv_obj_get_style_pad_left(lv_menu_get_main_header(menu), 0), 0);
-    // lv_menu_separator_create(sub_sd_page);
-    // section = lv_menu_section_create(sub_sd_page);
-
-    //! SETTING
-    sub_setting_page = lv_obj_create(lv_scr_act());
-    lv_obj_set_size(sub_setting_page, LV_PCT(100), LV_PCT(100));
-    lv_obj_set_style_pad_all(sub_setting_page, 10, 0);
-    lv_obj_set_style_bg_color(sub_setting_page, lv_color_hex(0x1E1E1E), LV_PART_MAIN);
-    lv_obj_set_style_border_width(sub_setting_page, 0, LV_PART_MAIN);
-    lv_obj_add_flag(sub_setting_page, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_set_flex_flow(sub_setting_page, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(sub_setting_page, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    
-    // Apply comprehensive scroll optimizations for smooth scrolling
-    optimize_page_scrolling(sub_setting_page);
-
-    // Add back button
-    lv_obj_t *settings_back_btn = lv_btn_create(sub_setting_page);
-    lv_obj_set_size(settings_back_btn, LV_SIZE_CONTENT, 40);
-    lv_obj_set_style_bg_color(settings_back_btn, lv_color_hex(0x007ACC), LV_PART_MAIN);
-    lv_obj_set_style_radius(settings_back_btn, 8, LV_PART_MAIN);
-    lv_obj_add_event_cb(settings_back_btn, back_to_home_cb, LV_EVENT_CLICKED, NULL);
-    
-    lv_obj_t *settings_back_label = lv_label_create(settings_back_btn);
-    lv_label_set_text(settings_back_label, LV_SYMBOL_LEFT " Back");
-    lv_obj_set_style_text_color(settings_back_label, lv_color_white(), LV_PART_MAIN);
-    lv_obj_center(settings_back_label);
+//! SD
+// lv_obj_t *sub_sd_page = lv_menu_page_create(menu, NULL);
+// lv_obj_set_style_pad_hor(sub_sd_page, lv_obj_get_style_pad_left(lv_menu_get_main_header(menu), 0), 0);
+// lv_menu_separator_create(sub_sd_page);
+// section = lv_menu_section_create(sub_sd_page);
 
+//! SETTING
+static void build_settings_page(lv_obj_t *page)
+{
     // Settings - Each item gets its own individual section/box
-    create_section_header(sub_setting_page, "DEVICE INFO");
+    create_section_header(page, "DEVICE INFO");
     
-    lv_obj_t *mac_section = create_section_group(sub_setting_page);
-    sub_section.push_back(mac_section);
+    lv_obj_t *mac_section = create_section_group(page);
     uint8_t mac[6] = {0};
     esp_efuse_mac_get_default(mac);
     static char buffer [128] = {0};
     snprintf(buffer, 128, "%X:%X:%X:%X:%X:%X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
     create_label(mac_section, NULL, "MAC Address", buffer);
 
-    lv_obj_t *sd_section = create_section_group(sub_setting_page);
-    sub_section.push_back(sd_section);
+    lv_obj_t *sd_section = create_section_group(page);
     float sd_size = SD.cardSize() / 1024 / 1024 / 1024.0;
     create_label(sd_section, NULL, "SD Card", (SD.cardSize() != 0) ? (String(sd_size) + "GB").c_str() : "N.A");
 
-    lv_obj_t *battery_section = create_section_group(sub_setting_page);
-    sub_section.push_back(battery_section);
+    lv_obj_t *battery_section = create_section_group(page);
     lv_obj_t *voltage_label = create_label(battery_section, NULL, "Battery", "N.A");
-    lv_timer_create([](lv_timer_t *t) {
+    lv_timer_t *voltage_timer = ui_page_timer_create([](lv_timer_t *t) {
         lv_obj_t *voltage_label = (lv_obj_t *)t->user_data;
         lv_label_set_text_fmt(voltage_label, "%u mV", analogReadMilliVolts(BOARD_BAT_ADC) * 2);
     }, 10000, voltage_label);
+    LV_ASSERT_NULL(voltage_timer);
 
-    create_section_header(sub_setting_page, "NETWORK");
+    create_section_header(page, "NETWORK");
     
-    lv_obj_t *wifi_ssid_section = create_section_group(sub_setting_page);
-    sub_section.push_back(wifi_ssid_section);
+    lv_obj_t *wifi_ssid_section = create_section_group(page);
     const char *wifi_name = WIFI_SSID;
     create_label(wifi_ssid_section, NULL, "WiFi SSID", wifi_name);
 
-    lv_obj_t *ip_section = create_section_group(sub_setting_page);
-    sub_section.push_back(ip_section);
+    lv_obj_t *ip_section = create_section_group(page);
     const char *wifi_ip = "N.A";
     lv_obj_t *label = create_label(ip_section, NULL, "IP Address", wifi_ip);
     lv_msg_subsribe_obj(_BV(1), label, NULL);
@@ -939,24 +884,25 @@ void setupUI(void)
             lv_label_set_text(label, "N.A");
         }
     }, LV_EVENT_MSG_RECEIVED, NULL);
+    // The connect message may have been sent before the page was built
+    lv_event_send(label, LV_EVENT_MSG_RECEIVED, NULL);
 
-    lv_obj_t *signal_section = create_section_group(sub_setting_page);
-    sub_section.push_back(signal_section);
+    lv_obj_t *signal_section = create_section_group(page);
     const char *wifi_rssi = "N.A";
     lv_obj_t *wifi_rssi_label = create_label(signal_section, NULL, "Signal Strength", wifi_rssi);
 
-    lv_timer_create([](lv_timer_t *t) {
+    lv_timer_t *rssi_timer = ui_page_timer_create([](lv_timer_t *t) {
         lv_obj_t *wifi_rssi_label = (lv_obj_t *)t->user_data;
         if (WiFi.isConnected()) {
             lv_label_set_text_fmt(wifi_rssi_label, "%d dBm", (WiFi.RSSI()));
         }
     }, 3000, wifi_rssi_label);
+    LV_ASSERT_NULL(rssi_timer);
 
-    lv_obj_t *ntp_section = create_section_group(sub_setting_page);
-    sub_section.push_back(ntp_section);
+    lv_obj_t *ntp_section = create_section_group(page);
     lv_obj_t *ntp_datetime = create_label(ntp_section, NULL, "Network Time", "00:00:00");
 
-    lv_timer_create([](lv_timer_t *t) {
+    lv_timer_t *ntp_timer = ui_page_timer_create([](lv_timer_t *t) {
         lv_obj_t *ntp_datetime = (lv_obj_t *)t->user_data;
         if (WiFi.isConnected()) {
             time_t now;
@@ -969,30 +915,221 @@ void setupUI(void)
             lv_label_set_text_fmt(ntp_datetime, "%s", datetime);
         }
     }, 1000, ntp_datetime);
+    LV_ASSERT_NULL(ntp_timer);
 
-    create_section_header(sub_setting_page, "SOFTWARE");
+    create_section_header(page, "SOFTWARE");
     
-    lv_obj_t *lvgl_section = create_section_group(sub_setting_page);
-    sub_section.push_back(lvgl_section);
+    lv_obj_t *lvgl_section = create_section_group(page);
     String lvgl_version = String('V') + lv_version_major() + "." + lv_version_minor() + "." + lv_version_patch();
     create_label(lvgl_section, NULL, "LVGL", lvgl_version.c_str());
 
-    lv_obj_t *arduino_section = create_section_group(sub_setting_page);
-    sub_section.push_back(arduino_section);
+    lv_obj_t *arduino_section = create_section_group(page);
     String arduino_version = String('V') + String(ESP_ARDUINO_VERSION_MAJOR) + "." + String(ESP_ARDUINO_VERSION_MINOR) + "." + String(ESP_ARDUINO_VERSION_PATCH);
     create_label(arduino_section, NULL, "Arduino ESP32", arduino_version.c_str());
 
-    lv_obj_t *tft_section = create_section_group(sub_setting_page);
-    sub_section.push_back(tft_section);
+    lv_obj_t *tft_section = create_section_group(page);
     const char *tft_espi_version = "V2.5.22";
     create_label(tft_section, NULL, "TFT_eSPI", tft_espi_version);
 
-    create_section_header(sub_setting_page, "POWER");
-    lv_obj_t *power_section = create_section_group(sub_setting_page);
-    sub_section.push_back(power_section);
+    create_section_header(page, "BOOT");
+    lv_obj_t *boot_section = create_section_group(page);
+    lv_obj_t *boot_label = create_label(boot_section, NULL, "Boot Time", "N.A");
+    if (boot_profile_ready_ms()) {
+        lv_label_set_text_fmt(boot_label, "%lu ms", (unsigned long)boot_profile_ready_ms());
+    }
+
+    // Phase start and duration in ms, background probes may still be running
+    lv_obj_t *phases_section = create_section_group(page);
+    static char boot_phases[BOOT_PROFILE_CAPACITY * 40];
+    boot_profile_format(boot_phases, sizeof(boot_phases));
+    create_label(phases_section, NULL, "Phases", boot_phases);
+
+    create_section_header(page, "POWER");
+    lv_obj_t *power_section = create_section_group(page);
     create_button(power_section, LV_SYMBOL_POWER, "Sleep Mode", sleep_event_cb);
+}
+
+//! HISTORY
+static void build_history_page(lv_obj_t *page)
+{
+    // Only the event list scrolls, filters and back button stay in place
+    lv_obj_clear_flag(page, LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_t *history_zone_section = create_section_group(page);
+    create_dropdown(history_zone_section, NULL, "Zone", history_zone_list, history_zone_sel, history_zone_cb);
 
+    lv_obj_t *history_range_section = create_section_group(page);
+    create_dropdown(history_range_section, NULL, "Range", history_range_list, history_range_sel, history_range_cb);
 
+    history_status = lv_label_create(page);
+    lv_label_set_text(history_status, "N.A");
+    lv_obj_add_style(history_status, &ui_theme.value, LV_PART_MAIN);
+
+    history_list = lv_obj_create(page);
+    lv_obj_add_style(history_list, &ui_theme.list, LV_PART_MAIN);
+    optimize_page_scrolling(history_list);
+    lv_obj_add_event_cb(history_list, history_scroll_cb, LV_EVENT_SCROLL, NULL);
+}
+
+static void teardown_history_page(void)
+{
+    history_list = NULL;
+    history_status = NULL;
+}
+
+// The keyboard page holds typed text that exists nowhere else
+static ui_page_t ui_page_table[UI_PAGE_MAX] = {
+    {"Radio",    build_radio_page,    teardown_radio_page,   false},
+    {"Sound",    build_sound_page,    teardown_sound_page,   false},
+    {"Display",  build_display_page,  NULL,                  false},
+    {"GPS",      build_gps_page,      teardown_gps_page,     false},
+    {"Keyboard", build_keyboard_page, NULL,                  true},
+    {"Settings", build_settings_page, NULL,                  false},
+    {"History",  build_history_page,  teardown_history_page, false},
+    {"Map",      ui_map_build,        ui_map_teardown,       false},
+};
+
+// Function to create icon button with navigation
+static lv_obj_t *create_app_icon(lv_obj_t *parent, const char *icon, const char *label, ui_page_id_t page, lv_event_cb_t cb)
+{
+    lv_obj_t *btn = lv_btn_create(parent);
+    lv_obj_add_style(btn, &ui_theme.icon, LV_PART_MAIN);
+    // Pressed state - more opaque when pressed
+    lv_obj_add_style(btn, &ui_theme.icon_pressed, LV_STATE_PRESSED);
+    
+    // Icon
+    lv_obj_t *icon_label = lv_label_create(btn);
+    lv_label_set_text(icon_label, icon);
+    lv_obj_add_style(icon_label, &ui_theme.icon_glyph, LV_PART_MAIN);
+    
+    // Label
+    lv_obj_t *text_label = lv_label_create(btn);
+    lv_label_set_text(text_label, label);
+    lv_obj_add_style(text_label, &ui_theme.icon_text, LV_PART_MAIN);
+    
+    // Store target page id in user data, the page may not exist yet
+    lv_obj_set_user_data(btn, (void *)(uintptr_t)page);
+    
+    if (cb) {
+        lv_obj_add_event_cb(btn, cb, LV_EVENT_CLICKED, NULL);
+    }
+    
+    return btn;
+}
+
+// Navigation callback for app icons with debouncing
+static void app_icon_cb(lv_event_t *e)
+{
+    static uint32_t last_click_time = 0;
+    uint32_t current_time = lv_tick_get();
+    
+    // Debounce: ignore clicks within 300ms of the last click
+    if (current_time - last_click_time < 300) {
+        return;
+    }
+    last_click_time = current_time;
+    
+    lv_obj_t *btn = lv_event_get_target(e);
+    ui_page_id_t target_page = (ui_page_id_t)(uintptr_t)lv_obj_get_user_data(btn);
+    
+    if (target_page < UI_PAGE_MAX) {
+        // Isolate touch input during screen transition to prevent cross-menu button activation
+        uint32_t screen_id = target_page + 1; // 0 is the home screen
+        isolate_touch_input(screen_id);
+        
+        // Start display update batching for better performance
+        lv_disp_t *disp = lv_disp_get_default();
+        if (disp) {
+            // Pause screen refreshing during batch updates
+            lv_disp_enable_invalidation(disp, false);
+        }
+        
+        // Hide home screen
+        lv_obj_add_flag(home_screen, LV_OBJ_FLAG_HIDDEN);
+        
+        // Build the page on first use, hide the others and resume its timers
+        ui_pages_open(target_page);
+
+        // History is queried fresh on every visit
+        if (target_page == UI_PAGE_HISTORY) {
+            history_reload();
+        }
+        
+        // Re-enable screen refreshing and force immediate update
+        if (disp) {
+            lv_disp_enable_invalidation(disp, true);
+            lv_obj_invalidate(lv_scr_act()); // Force full screen redraw
+        }
+        
+        // Force immediate LVGL processing to ensure responsive UI
+        lv_task_handler();
+    }
+}
+
+// Back to home callback
+static void back_to_home_cb(lv_event_t *e)
+{
+    // Isolate touch input during screen transition back to home
+    isolate_touch_input(0); // Use 0 as home screen ID
+    
+    // Hide the page and pause its timers, idle pages are freed later
+    ui_pages_close();
+    
+    // Show home screen
+    lv_obj_clear_flag(home_screen, LV_OBJ_FLAG_HIDDEN);
+}
+
+void setupUI(void)
+{
+    uint32_t start_ms = millis();
+    size_t heap_mark = ui_heap_mark();
+
+    // Initialize performance optimizations first
+    ui_performance_init();
+    
+    ui_theme_set_section_opa(DEFAULT_OPA);
+    ui_theme_set_icon_opa(icon_transparency);
+    
+    // Pre-allocate string buffers
+    memset(gps_lat_buffer, 0, sizeof(gps_lat_buffer));
+    memset(gps_lng_buffer, 0, sizeof(gps_lng_buffer));
+    memset(gps_speed_buffer, 0, sizeof(gps_speed_buffer));
+    memset(gps_date_buffer, 0, sizeof(gps_date_buffer));
+    memset(gps_time_buffer, 0, sizeof(gps_time_buffer));
+    memset(battery_buffer, 0, sizeof(battery_buffer));
+    memset(wifi_rssi_buffer, 0, sizeof(wifi_rssi_buffer));
+    
+    // Batch all UI creation for better performance
+    ui_batch_style_updates_begin();
+    // Create a simple full-screen container instead of menu
+    home_screen = lv_obj_create(lv_scr_act());
+    lv_obj_set_size(home_screen, LV_PCT(100), LV_PCT(100));
+    
+    // Use system background image instead of solid color
+    lv_obj_set_style_bg_img_src(home_screen, &system_background, LV_PART_MAIN);
+    lv_obj_set_style_bg_img_opa(home_screen, LV_OPA_COVER, LV_PART_MAIN);
+    lv_obj_set_style_bg_img_tiled(home_screen, false, LV_PART_MAIN);
+    
+    lv_obj_set_style_border_width(home_screen, 0, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(home_screen, 0, LV_PART_MAIN);
+    lv_obj_center(home_screen);
+    
+    // Store main screen reference instead of menu
+    global_menu = home_screen;
+
+    // Pages are built on first navigation, see ui_page_table
+    journal_filter_init(&history_filter);
+    history_filter.type_mask = JOURNAL_TYPE_BIT(JOURNAL_EVT_ALARM) | JOURNAL_TYPE_BIT(JOURNAL_EVT_TAMPER) |
+                               JOURNAL_TYPE_BIT(JOURNAL_EVT_ARM) | JOURNAL_TYPE_BIT(JOURNAL_EVT_DISARM) |
+                               JOURNAL_TYPE_BIT(JOURNAL_EVT_NODE_LOST);
+    ui_pages_begin(ui_page_table, UI_PAGE_MAX, create_page, UI_PAGE_IDLE_TEARDOWN_MS);
+
+    // Alarm events reach the Radio message whether or not the page is built,
+    // and supervision and acoustic events arrive without the radio;
+    // only the Radio page itself depends on hasRadio
+    lv_timer_create([](lv_timer_t *t) {
+        alarm_pipeline_ui_poll(show_alarm_event, 8);
+    }, 50, NULL);
 
     /*Create a home page with app icons*/
     // Create the home screen app icons
@@ -1004,45 +1141,42 @@ void setupUI(void)
     // Create grid container for app icons
     lv_obj_t *grid_cont = lv_obj_create(home_screen);
     lv_obj_set_size(grid_cont, LV_PCT(100), LV_PCT(100));
-    lv_obj_set_style_bg_opa(grid_cont, LV_OPA_TRANSP, LV_PART_MAIN);
-    lv_obj_set_style_border_width(grid_cont, 0, LV_PART_MAIN);
+    lv_obj_add_style(grid_cont, &ui_theme.bare, LV_PART_MAIN);
     lv_obj_set_style_pad_all(grid_cont, 10, LV_PART_MAIN);
     
-    // Set grid layout (3 columns, auto rows)
+    // Set grid layout (3 columns, auto rows, scrolls once icons exceed the screen)
     static lv_coord_t col_dsc[] = {LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_TEMPLATE_LAST};
-    static lv_coord_t row_dsc[] = {LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_TEMPLATE_LAST};
+    static lv_coord_t row_dsc[] = {LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
     lv_obj_set_grid_dsc_array(grid_cont, col_dsc, row_dsc);
     
     // Create app icons with navigation
-    lv_obj_t *radio_icon = create_app_icon(grid_cont, LV_SYMBOL_SETTINGS, "Radio", sub_mechanics_page, app_icon_cb);
+    lv_obj_t *radio_icon = create_app_icon(grid_cont, LV_SYMBOL_SETTINGS, "Radio", UI_PAGE_RADIO, app_icon_cb);
     lv_obj_set_grid_cell(radio_icon, LV_GRID_ALIGN_CENTER, 0, 1, LV_GRID_ALIGN_CENTER, 0, 1);
     
-    lv_obj_t *sound_icon = create_app_icon(grid_cont, LV_SYMBOL_AUDIO, "Sound", sub_sound_page, app_icon_cb);
+    lv_obj_t *sound_icon = create_app_icon(grid_cont, LV_SYMBOL_AUDIO, "Sound", UI_PAGE_SOUND, app_icon_cb);
     lv_obj_set_grid_cell(sound_icon, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 0, 1);
     
-    lv_obj_t *display_icon = create_app_icon(grid_cont, LV_SYMBOL_EYE_OPEN, "Display", sub_display_page, app_icon_cb);
+    lv_obj_t *display_icon = create_app_icon(grid_cont, LV_SYMBOL_EYE_OPEN, "Display", UI_PAGE_DISPLAY, app_icon_cb);
     lv_obj_set_grid_cell(display_icon, LV_GRID_ALIGN_CENTER, 2, 1, LV_GRID_ALIGN_CENTER, 0, 1);
     
-    lv_obj_t *gps_icon = create_app_icon(grid_cont, LV_SYMBOL_GPS, "GPS", sub_gps_page, app_icon_cb);
+    lv_obj_t *gps_icon = create_app_icon(grid_cont, LV_SYMBOL_GPS, "GPS", UI_PAGE_GPS, app_icon_cb);
     lv_obj_set_grid_cell(gps_icon, LV_GRID_ALIGN_CENTER, 0, 1, LV_GRID_ALIGN_CENTER, 1, 1);
     
-    lv_obj_t *kb_icon = create_app_icon(grid_cont, LV_SYMBOL_KEYBOARD, "Keyboard", sub_kb_page, app_icon_cb);
+    lv_obj_t *kb_icon = create_app_icon(grid_cont, LV_SYMBOL_KEYBOARD, "Keyboard", UI_PAGE_KEYBOARD, app_icon_cb);
     lv_obj_set_grid_cell(kb_icon, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 1, 1);
     
-    lv_obj_t *config_icon = create_app_icon(grid_cont, LV_SYMBOL_SETTINGS, "Settings", sub_setting_page, app_icon_cb);
+    lv_obj_t *config_icon = create_app_icon(grid_cont, LV_SYMBOL_SETTINGS, "Settings", UI_PAGE_SETTINGS, app_icon_cb);
     lv_obj_set_grid_cell(config_icon, LV_GRID_ALIGN_CENTER, 2, 1, LV_GRID_ALIGN_CENTER, 1, 1);
 
+    lv_obj_t *history_icon = create_app_icon(grid_cont, LV_SYMBOL_LIST, "History", UI_PAGE_HISTORY, app_icon_cb);
+    lv_obj_set_grid_cell(history_icon, LV_GRID_ALIGN_CENTER, 0, 1, LV_GRID_ALIGN_CENTER, 2, 1);
+
+    lv_obj_t *map_icon = create_app_icon(grid_cont, LV_SYMBOL_IMAGE, "Map", UI_PAGE_MAP, app_icon_cb);
+    lv_obj_set_grid_cell(map_icon, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 2, 1);
+
     // Show home screen by default (container-based navigation)
     // No need for sidebar or back button handlers anymore
     
-    // Apply basic styling to sections
-    std::vector<lv_obj_t *>::iterator it;
-    for (it = sub_section.begin(); it != sub_section.end(); it++) {
-        lv_obj_set_style_bg_opa(*it, DEFAULT_OPA, LV_PART_MAIN);
-        // Optimize scrolling for each section
-        ui_optimize_scrolling(*it);
-    }
-    
     // End batched updates for better performance
     ui_batch_style_updates_end();
     
@@ -1055,6 +1189,9 @@ void setupUI(void)
         lv_timer_handler();
         lv_refr_now(NULL);  // Force immediate refresh
     }
+
+    Serial.printf("UI home screen ready in %lu ms\n", (unsigned long)(millis() - start_ms));
+    ui_heap_report("home screen", heap_mark);
     
     // Set up optimized timers for periodic updates - commented out for now
     /*
@@ -1099,32 +1236,14 @@ static void switch_handler(lv_event_t *e)
 
 static lv_obj_t *create_text(lv_obj_t *parent, const char *icon, const char *txt)
 {
-    // Create a simple container for the text element
+    // Column container, text above the control
     lv_obj_t *obj = lv_obj_create(parent);
-    
-    // Simple styling that should work with any LVGL version
-    lv_obj_set_style_bg_color(obj, lv_color_hex(0x2D2D30), LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(obj, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_border_width(obj, 1, LV_PART_MAIN);
-    lv_obj_set_style_border_color(obj, lv_color_hex(0x3E3E42), LV_PART_MAIN);
-    lv_obj_set_style_pad_all(obj, 12, LV_PART_MAIN);
-    lv_obj_set_style_min_height(obj, 60, LV_PART_MAIN);
-    lv_obj_set_width(obj, LV_PCT(100));
-    lv_obj_set_height(obj, LV_SIZE_CONTENT);
-    
-    // Use column layout for sliders to stack text above controls
-    lv_obj_set_flex_flow(obj, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(obj, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_add_style(obj, &ui_theme.row, LV_PART_MAIN);
     
     // Create header row for icon and text
     lv_obj_t *header_row = lv_obj_create(obj);
-    lv_obj_set_width(header_row, LV_PCT(100));
-    lv_obj_set_height(header_row, LV_SIZE_CONTENT);
-    lv_obj_set_style_bg_opa(header_row, LV_OPA_TRANSP, LV_PART_MAIN);
-    lv_obj_set_style_border_width(header_row, 0, LV_PART_MAIN);
-    lv_obj_set_style_pad_all(header_row, 0, LV_PART_MAIN);
-    lv_obj_set_flex_flow(header_row, LV_FLEX_FLOW_ROW);
-    lv_obj_set_flex_align(header_row, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_add_style(header_row, &ui_theme.bare, LV_PART_MAIN);
+    lv_obj_add_style(header_row, &ui_theme.row_header, LV_PART_MAIN);
     
     lv_obj_t *img = NULL;
     lv_obj_t *label = NULL;
@@ -1132,21 +1251,28 @@ static lv_obj_t *create_text(lv_obj_t *parent, const char *icon, const char *txt
     if (icon) {
         img = lv_img_create(header_row);
         lv_img_set_src(img, icon);
-        lv_obj_set_style_pad_right(img, 8, LV_PART_MAIN);
+        lv_obj_add_style(img, &ui_theme.row_icon, LV_PART_MAIN);
     }
 
     if (txt) {
         label = lv_label_create(header_row);
         lv_label_set_text(label, txt);
-        lv_obj_set_style_text_color(label, lv_color_hex(0xCCCCCC), LV_PART_MAIN);
-        lv_obj_set_style_text_font(label, &lv_font_montserrat_14, LV_PART_MAIN);
-        lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_LEFT, LV_PART_MAIN);
-        lv_obj_set_flex_grow(label, 1); // Take up remaining space
+        lv_obj_add_style(label, &ui_theme.title, LV_PART_MAIN); // Takes up remaining space
     }
 
     return obj;
 }
 
+// Greyed out while at the minimum, indicator and knob border follow the state
+static void slider_update_idle(lv_obj_t *slider)
+{
+    if (lv_slider_get_value(slider) > lv_slider_get_min_value(slider)) {
+        lv_obj_clear_state(slider, UI_THEME_STATE_IDLE);
+    } else {
+        lv_obj_add_state(slider, UI_THEME_STATE_IDLE);
+    }
+}
+
 static lv_obj_t *create_slider(lv_obj_t *parent, const char *icon, const char *txt, int32_t min, int32_t max,
                                int32_t val, lv_event_cb_t cb, lv_event_code_t filter)
 {
@@ -1156,12 +1282,10 @@ static lv_obj_t *create_slider(lv_obj_t *parent, const char *icon, const char *t
     lv_obj_t *header_row = lv_obj_get_child(obj, 0);  // Get the header row container
     lv_obj_t *value_label = lv_label_create(header_row);
     lv_label_set_text_fmt(value_label, "%d", (int)val);
-    lv_obj_set_style_text_color(value_label, lv_color_hex(0x007ACC), LV_PART_MAIN);
-    lv_obj_set_style_text_font(value_label, &lv_font_montserrat_12, LV_PART_MAIN);
-    lv_obj_set_style_text_align(value_label, LV_TEXT_ALIGN_RIGHT, LV_PART_MAIN);
+    lv_obj_add_style(value_label, &ui_theme.slider_value, LV_PART_MAIN);
 
     // Add some spacing between text and slider
-    lv_obj_set_style_pad_top(obj, 8, LV_PART_MAIN);
+    lv_obj_add_style(obj, &ui_theme.row_slider, LV_PART_MAIN);
 
     lv_obj_t *slider = lv_slider_create(obj);
     lv_slider_set_range(slider, min, max);
@@ -1170,66 +1294,26 @@ static lv_obj_t *create_slider(lv_obj_t *parent, const char *icon, const char *t
     // Store value label reference in slider user data for updates
     lv_obj_set_user_data(slider, value_label);
     
-    // Center the slider and give it appropriate width
-    lv_obj_set_width(slider, LV_PCT(80)); // Use percentage for responsive design
-    lv_obj_set_height(slider, 8);
-    lv_obj_set_style_pad_top(slider, 8, LV_PART_MAIN);
-    
-    // iPhone-style slider track
-    lv_obj_set_style_bg_color(slider, lv_color_hex(0x3E3E42), LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(slider, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_radius(slider, LV_RADIUS_CIRCLE, LV_PART_MAIN);
-    lv_obj_set_style_border_width(slider, 0, LV_PART_MAIN);
-    lv_obj_set_style_outline_width(slider, 0, LV_PART_MAIN);
-    lv_obj_set_style_shadow_width(slider, 0, LV_PART_MAIN);
-    
-    // Slider indicator (filled part) - color based on value
-    if (val > min) {
-        // Slider has value - use blue color
-        lv_obj_set_style_bg_color(slider, lv_color_hex(0x007ACC), LV_PART_INDICATOR);
-    } else {
-        // Slider at minimum - use greyed out color
-        lv_obj_set_style_bg_color(slider, lv_color_hex(0x5A5A5A), LV_PART_INDICATOR);
-    }
-    lv_obj_set_style_bg_opa(slider, LV_OPA_COVER, LV_PART_INDICATOR);
-    lv_obj_set_style_radius(slider, LV_RADIUS_CIRCLE, LV_PART_INDICATOR);
-    
-    // Slider knob
-    lv_obj_set_style_bg_color(slider, lv_color_hex(0xCCCCCC), LV_PART_KNOB);
-    lv_obj_set_style_bg_opa(slider, LV_OPA_COVER, LV_PART_KNOB);
-    lv_obj_set_style_radius(slider, LV_RADIUS_CIRCLE, LV_PART_KNOB);
-    lv_obj_set_style_border_width(slider, 1, LV_PART_KNOB);
-    lv_obj_set_style_border_color(slider, val > min ? lv_color_hex(0x007ACC) : lv_color_hex(0x5A5A5A), LV_PART_KNOB);
-    lv_obj_set_style_shadow_width(slider, 4, LV_PART_KNOB);
-    lv_obj_set_style_shadow_color(slider, lv_color_black(), LV_PART_KNOB);
-    lv_obj_set_style_shadow_opa(slider, LV_OPA_20, LV_PART_KNOB);
-    lv_obj_set_style_shadow_spread(slider, 1, LV_PART_KNOB);
-    lv_obj_set_style_width(slider, 22, LV_PART_KNOB);
-    lv_obj_set_style_height(slider, 22, LV_PART_KNOB);
+    // iPhone-style track, indicator and knob
+    lv_obj_add_style(slider, &ui_theme.slider_track, LV_PART_MAIN);
+    lv_obj_add_style(slider, &ui_theme.slider_indicator, LV_PART_INDICATOR);
+    lv_obj_add_style(slider, &ui_theme.slider_indicator_idle, LV_PART_INDICATOR | UI_THEME_STATE_IDLE);
+    lv_obj_add_style(slider, &ui_theme.slider_knob, LV_PART_KNOB);
+    lv_obj_add_style(slider, &ui_theme.slider_knob_idle, LV_PART_KNOB | UI_THEME_STATE_IDLE);
+    slider_update_idle(slider);
 
     if (cb != NULL) {
         lv_obj_add_event_cb(slider, cb, filter, NULL);
         // Add event to update styling and value label when slider changes
         lv_obj_add_event_cb(slider, [](lv_event_t *e) {
             lv_obj_t *slider = lv_event_get_target(e);
-            int32_t value = lv_slider_get_value(slider);
-            int32_t min_val = lv_slider_get_min_value(slider);
             
             // Update value label
             lv_obj_t *value_label = (lv_obj_t *)lv_obj_get_user_data(slider);
             if (value_label) {
-                lv_label_set_text_fmt(value_label, "%d", (int)value);
-            }
-            
-            if (value > min_val) {
-                // Slider has value - use blue color
-                lv_obj_set_style_bg_color(slider, lv_color_hex(0x007ACC), LV_PART_INDICATOR);
-                lv_obj_set_style_border_color(slider, lv_color_hex(0x007ACC), LV_PART_KNOB);
-            } else {
-                // Slider at minimum - use greyed out color
-                lv_obj_set_style_bg_color(slider, lv_color_hex(0x5A5A5A), LV_PART_INDICATOR);
-                lv_obj_set_style_border_color(slider, lv_color_hex(0x5A5A5A), LV_PART_KNOB);
+                lv_label_set_text_fmt(value_label, "%d", (int)lv_slider_get_value(slider));
             }
+            slider_update_idle(slider);
         }, LV_EVENT_VALUE_CHANGED, NULL);
     }
 
@@ -1243,48 +1327,13 @@ static lv_obj_t *create_switch(lv_obj_t *parent, const char *icon, const char *t
     lv_obj_t *sw = lv_switch_create(obj);
     lv_obj_add_state(sw, chk ? LV_STATE_CHECKED : 0);
     
-    // iPhone-style switch styling
-    lv_obj_set_style_width(sw, 40, LV_PART_MAIN);
-    lv_obj_set_style_height(sw, 24, LV_PART_MAIN);
-    lv_obj_set_style_radius(sw, LV_RADIUS_CIRCLE, LV_PART_MAIN);
-    lv_obj_set_style_border_width(sw, 0, LV_PART_MAIN);
-    lv_obj_set_style_outline_width(sw, 0, LV_PART_MAIN);
-    lv_obj_set_style_shadow_width(sw, 0, LV_PART_MAIN);
-    
-    // Style based on switch state
-    if (chk) {
-        // Switch is ON - use blue color
-        lv_obj_set_style_bg_color(sw, lv_color_hex(0x007ACC), LV_PART_MAIN);
-        lv_obj_set_style_bg_opa(sw, LV_OPA_COVER, LV_PART_MAIN);
-    } else {
-        // Switch is OFF - use greyed out color
-        lv_obj_set_style_bg_color(sw, lv_color_hex(0x3E3E42), LV_PART_MAIN);
-        lv_obj_set_style_bg_opa(sw, LV_OPA_COVER, LV_PART_MAIN);
-    }
-    
-    // Knob styling
-    lv_obj_set_style_bg_color(sw, lv_color_white(), LV_PART_KNOB);
-    lv_obj_set_style_bg_opa(sw, LV_OPA_COVER, LV_PART_KNOB);
-    lv_obj_set_style_radius(sw, LV_RADIUS_CIRCLE, LV_PART_KNOB);
-    lv_obj_set_style_shadow_width(sw, 2, LV_PART_KNOB);
-    lv_obj_set_style_shadow_color(sw, lv_color_black(), LV_PART_KNOB);
-    lv_obj_set_style_shadow_opa(sw, LV_OPA_30, LV_PART_KNOB);
+    // iPhone-style switch, blue while checked and grey otherwise
+    lv_obj_add_style(sw, &ui_theme.switch_track, LV_PART_MAIN);
+    lv_obj_add_style(sw, &ui_theme.switch_on, LV_PART_MAIN | LV_STATE_CHECKED);
+    lv_obj_add_style(sw, &ui_theme.switch_knob, LV_PART_KNOB);
     
     if (cb) {
         lv_obj_add_event_cb(sw, cb, LV_EVENT_VALUE_CHANGED, NULL);
-        // Also add event to update styling when switch changes
-        lv_obj_add_event_cb(sw, [](lv_event_t *e) {
-            lv_obj_t *sw = lv_event_get_target(e);
-            bool is_checked = lv_obj_has_state(sw, LV_STATE_CHECKED);
-            
-            if (is_checked) {
-                // Switch turned ON - use blue color
-                lv_obj_set_style_bg_color(sw, lv_color_hex(0x007ACC), LV_PART_MAIN);
-            } else {
-                // Switch turned OFF - use greyed out color
-                lv_obj_set_style_bg_color(sw, lv_color_hex(0x3E3E42), LV_PART_MAIN);
-            }
-        }, LV_EVENT_VALUE_CHANGED, NULL);
     }
     
     return sw;
@@ -1296,30 +1345,13 @@ static lv_obj_t *create_button(lv_obj_t *parent, const char *icon, const char *t
     lv_obj_t *btn = lv_btn_create(obj);
     
     // iPhone-style button
-    lv_obj_set_style_bg_color(btn, lv_color_hex(0x007ACC), LV_PART_MAIN); // VS Code blue
-    lv_obj_set_style_bg_opa(btn, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_radius(btn, 8, LV_PART_MAIN);
-    lv_obj_set_style_border_width(btn, 0, LV_PART_MAIN);
-    lv_obj_set_style_outline_width(btn, 0, LV_PART_MAIN);
-    lv_obj_set_style_shadow_width(btn, 3, LV_PART_MAIN);
-    lv_obj_set_style_shadow_color(btn, lv_color_black(), LV_PART_MAIN);
-    lv_obj_set_style_shadow_opa(btn, LV_OPA_20, LV_PART_MAIN);
-    lv_obj_set_style_shadow_ofs_y(btn, 2, LV_PART_MAIN);
-    lv_obj_set_style_pad_all(btn, 8, LV_PART_MAIN);
-    
-    // Button pressed state
-    lv_obj_set_style_bg_color(btn, lv_color_hex(0x005A9E), LV_STATE_PRESSED);
-    lv_obj_set_style_transform_zoom(btn, 245, LV_STATE_PRESSED);
+    lv_obj_add_style(btn, &ui_theme.button, LV_PART_MAIN);
+    lv_obj_add_style(btn, &ui_theme.button_pressed, LV_STATE_PRESSED);
     
     // Button text
     lv_obj_t *btn_label = lv_label_create(btn);
     lv_label_set_text(btn_label, "Action");
-    lv_obj_set_style_text_color(btn_label, lv_color_white(), LV_PART_MAIN);
-    lv_obj_set_style_text_font(btn_label, &lv_font_montserrat_12, LV_PART_MAIN);
-    lv_obj_center(btn_label);
-    
-    lv_obj_set_size(btn, lv_pct(25), 28);
-    lv_obj_align(btn, LV_ALIGN_RIGHT_MID, -4, 0);
+    lv_obj_add_style(btn_label, &ui_theme.button_text, LV_PART_MAIN);
     
     if (cb) {
         lv_obj_add_event_cb(btn, cb, LV_EVENT_CLICKED, NULL);
@@ -1335,9 +1367,7 @@ static lv_obj_t *create_label(lv_obj_t *parent, const char *icon, const char *tx
         lv_label_set_text(label, default_text);
         
         // iPhone-style secondary text
-        lv_obj_set_style_text_color(label, lv_color_hex(0x9CDCFE), LV_PART_MAIN); // VS Code light blue
-        lv_obj_set_style_text_font(label, &lv_font_montserrat_12, LV_PART_MAIN);
-        lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_RIGHT, LV_PART_MAIN);
+        lv_obj_add_style(label, &ui_theme.value, LV_PART_MAIN);
         
         return label;
     }
@@ -1351,48 +1381,14 @@ static lv_obj_t *create_dropdown(lv_obj_t *parent, const char *icon, const char
     lv_dropdown_set_options(dd, options);
     lv_dropdown_set_selected(dd, default_sel);
     
-    // iPhone-style dropdown
-    lv_obj_set_style_bg_color(dd, lv_color_hex(0x2D2D30), LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(dd, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_radius(dd, 8, LV_PART_MAIN);
-    lv_obj_set_style_border_width(dd, 1, LV_PART_MAIN);
-    lv_obj_set_style_border_color(dd, lv_color_hex(0x3E3E42), LV_PART_MAIN);
-    lv_obj_set_style_border_opa(dd, LV_OPA_60, LV_PART_MAIN);
-    lv_obj_set_style_shadow_width(dd, 2, LV_PART_MAIN);
-    lv_obj_set_style_shadow_color(dd, lv_color_black(), LV_PART_MAIN);
-    lv_obj_set_style_shadow_opa(dd, LV_OPA_10, LV_PART_MAIN);
-    lv_obj_set_style_shadow_ofs_y(dd, 1, LV_PART_MAIN);
-    lv_obj_set_style_pad_all(dd, 8, LV_PART_MAIN);
-    lv_obj_set_style_text_color(dd, lv_color_hex(0xCCCCCC), LV_PART_MAIN);
-    lv_obj_set_style_text_font(dd, &lv_font_montserrat_12, LV_PART_MAIN);
-    
-    // Dropdown list styling
-    lv_obj_set_style_bg_color(dd, lv_color_hex(0x007ACC), LV_PART_SELECTED);
-    lv_obj_set_style_bg_opa(dd, LV_OPA_COVER, LV_PART_SELECTED);
-    lv_obj_set_style_text_color(dd, lv_color_hex(0xFFFFFF), LV_PART_SELECTED);
-    
-    // Dropdown button (arrow)
-    lv_obj_set_style_bg_color(dd, lv_color_hex(0x007ACC), LV_PART_INDICATOR);
-    lv_obj_set_style_bg_opa(dd, LV_OPA_COVER, LV_PART_INDICATOR);
-    lv_obj_set_style_radius(dd, 4, LV_PART_INDICATOR);
-    
-    lv_obj_set_width(dd, 80);
+    // iPhone-style dropdown, selected option and arrow in the accent color
+    lv_obj_add_style(dd, &ui_theme.field, LV_PART_MAIN);
+    lv_obj_add_style(dd, &ui_theme.dropdown, LV_PART_MAIN);
+    lv_obj_add_style(dd, &ui_theme.dropdown_accent, LV_PART_SELECTED);
+    lv_obj_add_style(dd, &ui_theme.dropdown_accent, LV_PART_INDICATOR);
     
     if (cb) {
         lv_obj_add_event_cb(dd, cb, LV_EVENT_VALUE_CHANGED, NULL);
     }
     return dd;
 }
-
-
-
-
-
-
-
-
-
-
-
-
-
@@ -0,0 +1,331 @@
+/**
+ * @file      ui_map.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "ui_map.h"
+#include "ui_pages.h"
+#include "ui_theme.h"
+#include "map_tiles.h"
+#include "node_registry.h"
+
+#define UI_MAP_COLOR_BACKGROUND     0x2D2D30
+#define UI_MAP_COLOR_SELF           0x0A84FF
+#define UI_MAP_COLOR_OK             0x30D158
+#define UI_MAP_COLOR_SUSPECT        0xFF9F0A
+#define UI_MAP_COLOR_ALARM          0xFF3B30
+#define UI_MAP_COLOR_LOST           0x8E8E93
+#define UI_MAP_COLOR_UNKNOWN        0x64D2FF
+
+static lv_obj_t *map_obj = NULL;
+
+// View centre as a Mercator world fraction, kept across teardowns
+static uint32_t  view_mx = 0x80000000UL;
+static uint32_t  view_my = 0x80000000UL;
+static uint8_t   view_zoom = UI_MAP_ZOOM_DEFAULT;
+static bool      view_placed = false;
+static bool      follow_self = true;
+static uint32_t  view_frame = 0;         // Counts view changes, see map_tiles_get()
+static uint32_t  tiles_drawn_gen = 0;
+
+static bool      self_valid = false;
+static uint32_t  self_mx, self_my;
+
+static uint32_t  alarm_ms[MAP_NODES_MAX];
+static lv_color_t marker_color[MAP_NODES_MAX];
+
+static lv_img_dsc_t tile_img;
+
+static void center_on(uint32_t mx, uint32_t my)
+{
+    view_mx = mx;
+    view_my = my;
+    view_placed = true;
+    view_frame++;
+    if (map_obj) {
+        lv_obj_invalidate(map_obj);
+    }
+}
+
+static void draw_marker(lv_draw_ctx_t *draw_ctx, lv_coord_t x, lv_coord_t y, lv_color_t color)
+{
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.radius = LV_RADIUS_CIRCLE;
+    dsc.bg_color = color;
+    dsc.border_color = lv_color_white();
+    dsc.border_width = 2;
+
+    lv_area_t area = {
+        (lv_coord_t)(x - UI_MAP_MARKER_SIZE / 2), (lv_coord_t)(y - UI_MAP_MARKER_SIZE / 2),
+        (lv_coord_t)(x + UI_MAP_MARKER_SIZE / 2), (lv_coord_t)(y + UI_MAP_MARKER_SIZE / 2)
+    };
+    lv_draw_rect(draw_ctx, &dsc, &area);
+}
+
+static void map_draw_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    int32_t width = lv_area_get_width(&coords);
+    int32_t height = lv_area_get_height(&coords);
+
+    // World pixel of the top left corner
+    uint8_t zoom = view_zoom;
+    int32_t left = map_world_px(view_mx, zoom) - width / 2;
+    int32_t top = map_world_px(view_my, zoom) - height / 2;
+    int32_t tiles = 1L << zoom;
+
+    lv_draw_img_dsc_t img_dsc;
+    lv_draw_img_dsc_init(&img_dsc);
+    lv_draw_rect_dsc_t empty_dsc;
+    lv_draw_rect_dsc_init(&empty_dsc);
+    empty_dsc.bg_color = lv_color_hex(UI_MAP_COLOR_BACKGROUND);
+
+    // Visible tiles first so they are queued first, then a ring around them to pan into
+    int32_t tx0 = left >> MAP_TILE_SHIFT;
+    int32_t ty0 = top >> MAP_TILE_SHIFT;
+    int32_t tx1 = (left + width - 1) >> MAP_TILE_SHIFT;
+    int32_t ty1 = (top + height - 1) >> MAP_TILE_SHIFT;
+    for (int32_t ty = ty0; ty <= ty1; ty++) {
+        for (int32_t tx = tx0; tx <= tx1; tx++) {
+            lv_area_t area;
+            area.x1 = coords.x1 + (tx << MAP_TILE_SHIFT) - left;
+            area.y1 = coords.y1 + (ty << MAP_TILE_SHIFT) - top;
+            area.x2 = area.x1 + MAP_TILE_SIZE - 1;
+            area.y2 = area.y1 + MAP_TILE_SIZE - 1;
+
+            lv_area_t clipped;
+            if (!_lv_area_intersect(&clipped, &area, draw_ctx->clip_area)) {
+                continue;
+            }
+            // Wraps around the antimeridian, nothing beyond the poles
+            const uint16_t *pixels = NULL;
+            if (ty >= 0 && ty < tiles) {
+                pixels = map_tiles_get(zoom, (uint32_t)tx & (tiles - 1), ty, view_frame);
+            }
+            if (pixels) {
+                tile_img.data = (const uint8_t *)pixels;
+                lv_draw_img(draw_ctx, &img_dsc, &area, &tile_img);
+            } else {
+                lv_draw_rect(draw_ctx, &empty_dsc, &clipped);
+            }
+        }
+    }
+    // With a partial draw buffer, once the last band has asked for its visible tiles
+    for (int32_t ty = ty0 - 1; ty <= ty1 + 1 && draw_ctx->clip_area->y2 >= coords.y2; ty++) {
+        for (int32_t tx = tx0 - 1; tx <= tx1 + 1; tx++) {
+            bool visible = ty >= ty0 && ty <= ty1 && tx >= tx0 && tx <= tx1;
+            if (!visible && ty >= 0 && ty < tiles) {
+                map_tiles_get(zoom, (uint32_t)tx & (tiles - 1), ty, view_frame);
+            }
+        }
+    }
+
+    // Node markers, skipping the ones outside the view cheaply
+    uint32_t count = map_nodes_count();
+    for (uint32_t i = 0; i < count; i++) {
+        const map_node_t *node = map_nodes_get(i);
+        int32_t x = map_world_px(node->mx, zoom) - left;
+        int32_t y = map_world_px(node->my, zoom) - top;
+        if (x < -UI_MAP_MARKER_SIZE || y < -UI_MAP_MARKER_SIZE ||
+                x > width + UI_MAP_MARKER_SIZE || y > height + UI_MAP_MARKER_SIZE) {
+            continue;
+        }
+        draw_marker(draw_ctx, coords.x1 + x, coords.y1 + y, marker_color[i]);
+    }
+    if (self_valid) {
+        draw_marker(draw_ctx, coords.x1 + map_world_px(self_mx, zoom) - left,
+                    coords.y1 + map_world_px(self_my, zoom) - top, lv_color_hex(UI_MAP_COLOR_SELF));
+    }
+}
+
+static void map_drag_cb(lv_event_t *e)
+{
+    lv_indev_t *indev = lv_indev_get_act();
+    if (!indev) {
+        return;
+    }
+    lv_point_t vect;
+    lv_indev_get_vect(indev, &vect);
+    // The map follows the finger
+    if (vect.x || vect.y) {
+        ui_map_pan(-vect.x, -vect.y);
+    }
+}
+
+static void refresh_markers(void)
+{
+    uint32_t now = millis();
+    uint32_t count = map_nodes_count();
+    for (uint32_t i = 0; i < count; i++) {
+        node_snapshot_t snap;
+        uint32_t color = UI_MAP_COLOR_UNKNOWN;
+        if (alarm_ms[i] && now - alarm_ms[i] < UI_MAP_ALARM_SHOW_MS) {
+            color = UI_MAP_COLOR_ALARM;
+        } else if (node_registry_lookup(map_nodes_get(i)->node_id, &snap)) {
+            if (snap.flags & NODE_FLAG_LOST) {
+                color = UI_MAP_COLOR_LOST;
+            } else if (snap.flags & NODE_FLAG_SUSPECT) {
+                color = UI_MAP_COLOR_SUSPECT;
+            } else {
+                color = UI_MAP_COLOR_OK;
+            }
+        }
+        marker_color[i] = lv_color_hex(color);
+    }
+}
+
+static void zoom_in_cb(lv_event_t *e)
+{
+    ui_map_zoom(1);
+}
+
+static void zoom_out_cb(lv_event_t *e)
+{
+    ui_map_zoom(-1);
+}
+
+static void follow_cb(lv_event_t *e)
+{
+    follow_self = true;
+    if (self_valid) {
+        center_on(self_mx, self_my);
+    }
+}
+
+static lv_obj_t *map_button(lv_obj_t *parent, const char *symbol, lv_coord_t y, lv_event_cb_t cb)
+{
+    lv_obj_t *btn = lv_btn_create(parent);
+    lv_obj_add_style(btn, &ui_theme.button, LV_PART_MAIN);
+    lv_obj_add_style(btn, &ui_theme.button_pressed, LV_STATE_PRESSED);
+    lv_obj_add_flag(btn, LV_OBJ_FLAG_IGNORE_LAYOUT);
+    lv_obj_set_size(btn, 36, 36);
+    lv_obj_align(btn, LV_ALIGN_TOP_RIGHT, -6, y);
+    lv_obj_add_event_cb(btn, cb, LV_EVENT_CLICKED, NULL);
+
+    lv_obj_t *label = lv_label_create(btn);
+    lv_label_set_text(label, symbol);
+    lv_obj_add_style(label, &ui_theme.button_text, LV_PART_MAIN);
+    lv_obj_center(label);
+    return btn;
+}
+
+void ui_map_build(lv_obj_t *page)
+{
+    // The map pans itself, the page stays put
+    lv_obj_clear_flag(page, LV_OBJ_FLAG_SCROLLABLE);
+
+    tile_img.header.always_zero = 0;
+    tile_img.header.cf = LV_IMG_CF_TRUE_COLOR;
+    tile_img.header.w = MAP_TILE_SIZE;
+    tile_img.header.h = MAP_TILE_SIZE;
+    tile_img.data_size = MAP_TILE_BYTES;
+
+    map_obj = lv_obj_create(page);
+    lv_obj_remove_style_all(map_obj);
+    lv_obj_set_width(map_obj, LV_PCT(100));
+    lv_obj_set_flex_grow(map_obj, 1);
+    lv_obj_clear_flag(map_obj, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_GESTURE_BUBBLE | LV_OBJ_FLAG_SCROLL_CHAIN);
+    lv_obj_add_flag(map_obj, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(map_obj, map_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+    lv_obj_add_event_cb(map_obj, map_drag_cb, LV_EVENT_PRESSING, NULL);
+
+    map_button(map_obj, LV_SYMBOL_PLUS, 6, zoom_in_cb);
+    map_button(map_obj, LV_SYMBOL_MINUS, 48, zoom_out_cb);
+    map_button(map_obj, LV_SYMBOL_GPS, 90, follow_cb);
+
+    // First visit: the keypad if it has a fix, else the first node
+    if (!view_placed) {
+        if (self_valid) {
+            center_on(self_mx, self_my);
+        } else if (map_nodes_count()) {
+            center_on(map_nodes_get(0)->mx, map_nodes_get(0)->my);
+        }
+    }
+    refresh_markers();
+    tiles_drawn_gen = map_tiles_generation();
+
+    lv_timer_t *tiles_timer = ui_page_timer_create([](lv_timer_t *t) {
+        uint32_t gen = map_tiles_generation();
+        if (gen != tiles_drawn_gen) {
+            tiles_drawn_gen = gen;
+            lv_obj_invalidate(map_obj);
+        }
+    }, UI_MAP_TILE_POLL_MS, NULL);
+    LV_ASSERT_NULL(tiles_timer);
+    lv_timer_t *markers_timer = ui_page_timer_create([](lv_timer_t *t) {
+        refresh_markers();
+        lv_obj_invalidate(map_obj);
+    }, UI_MAP_MARKER_POLL_MS, NULL);
+    LV_ASSERT_NULL(markers_timer);
+}
+
+void ui_map_teardown(void)
+{
+    map_obj = NULL;
+}
+
+bool ui_map_pan(lv_coord_t dx, lv_coord_t dy)
+{
+    if (!map_obj || !lv_obj_is_visible(map_obj)) {
+        return false;
+    }
+    follow_self = false;
+    // One screen pixel is 2^(32 - 7 - zoom) of the world
+    uint8_t shift = 32 - MAP_TILE_SHIFT - view_zoom;
+    center_on(view_mx + ((uint32_t)(int32_t)dx << shift), view_my + ((uint32_t)(int32_t)dy << shift));
+    return true;
+}
+
+void ui_map_zoom(int8_t delta)
+{
+    int zoom = constrain(view_zoom + delta, MAP_ZOOM_MIN, MAP_ZOOM_MAX);
+    if (zoom != view_zoom) {
+        view_zoom = zoom;
+        view_frame++;
+        if (map_obj) {
+            lv_obj_invalidate(map_obj);
+        }
+    }
+}
+
+void ui_map_set_self(double lat, double lng)
+{
+    // TinyGPSPlus reports 0, 0 until the first fix
+    if (lat == 0.0 && lng == 0.0) {
+        return;
+    }
+    uint32_t mx, my;
+    map_project(lat, lng, &mx, &my);
+    bool moved = !self_valid || mx != self_mx || my != self_my;
+    self_mx = mx;
+    self_my = my;
+    self_valid = true;
+    if (follow_self && moved) {
+        center_on(mx, my);
+    }
+}
+
+void ui_map_node_alarm(uint32_t node_id)
+{
+    uint32_t count = map_nodes_count();
+    for (uint32_t i = 0; i < count; i++) {
+        if (map_nodes_get(i)->node_id == node_id) {
+            // 0 marks no alarm
+            alarm_ms[i] = millis() | 1;
+            marker_color[i] = lv_color_hex(UI_MAP_COLOR_ALARM);
+            if (map_obj) {
+                lv_obj_invalidate(map_obj);
+            }
+            return;
+        }
+    }
+}
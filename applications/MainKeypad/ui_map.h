@@ -0,0 +1,45 @@
+/**
+ * @file      ui_map.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Node map page: SD map tiles with the field nodes and the keypad's own
+ * fix drawn on top.
+ *
+ * The map is one LVGL object drawing straight from the tile cache
+ * (map_tiles.h) in its draw event, only the tiles crossing the visible
+ * area. Panning moves the view centre and invalidates the object; no
+ * widgets are created or moved per tile or per node. Node colours follow
+ * the registry flags and recent alarms, refreshed once a second.
+ *
+ * All calls must come from the LVGL task.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+#define UI_MAP_ZOOM_DEFAULT         16
+#define UI_MAP_TRACKBALL_STEP       32          // Pixels panned per trackball tick
+#define UI_MAP_ALARM_SHOW_MS        (10 * 60 * 1000)
+#define UI_MAP_MARKER_SIZE          10
+#define UI_MAP_TILE_POLL_MS         50          // Redraw when the loader brought new tiles
+#define UI_MAP_MARKER_POLL_MS       1000
+
+// Page build and teardown for the page registry (ui_pages.h)
+void ui_map_build(lv_obj_t *page);
+void ui_map_teardown(void);
+
+// Move the view by whole pixels. Returns false when the map is not shown,
+// so the trackball moves the cursor instead.
+bool ui_map_pan(lv_coord_t dx, lv_coord_t dy);
+void ui_map_zoom(int8_t delta);
+
+// Keypad position, kept while the page is torn down
+void ui_map_set_self(double lat, double lng);
+
+// An alarm event from the node, it is drawn red for UI_MAP_ALARM_SHOW_MS
+void ui_map_node_alarm(uint32_t node_id);
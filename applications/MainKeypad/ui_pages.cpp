@@ -0,0 +1,169 @@
+/**
+ * @file      ui_pages.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "ui_pages.h"
+#include "ui_performance.h"
+
+#define UI_PAGES_REAP_PERIOD_MS     5000
+
+static ui_page_t       *pages = NULL;
+static uint8_t          page_count = 0;
+static ui_page_create_t page_create = NULL;
+static uint32_t         idle_teardown_ms = 0;
+static int              current = UI_PAGE_NONE;
+static ui_page_t       *building = NULL;
+static lv_timer_t      *reap_timer = NULL;
+
+static void reap_cb(lv_timer_t *t)
+{
+    ui_pages_reap(millis());
+}
+
+static void page_hide(ui_page_t *page)
+{
+    lv_obj_add_flag(page->obj, LV_OBJ_FLAG_HIDDEN);
+    for (uint8_t i = 0; i < page->timer_count; i++) {
+        lv_timer_pause(page->timers[i]);
+    }
+    page->hidden_ms = millis();
+}
+
+void ui_pages_begin(ui_page_t *table, uint8_t count, ui_page_create_t create, uint32_t idle_ms)
+{
+    pages = table;
+    page_count = count;
+    page_create = create;
+    idle_teardown_ms = idle_ms;
+    current = UI_PAGE_NONE;
+
+    for (uint8_t i = 0; i < count; i++) {
+        pages[i].obj = NULL;
+        pages[i].timer_count = 0;
+        pages[i].hidden_ms = 0;
+    }
+
+    if (reap_timer) {
+        lv_timer_del(reap_timer);
+        reap_timer = NULL;
+    }
+    if (idle_teardown_ms) {
+        reap_timer = lv_timer_create(reap_cb, UI_PAGES_REAP_PERIOD_MS, NULL);
+    }
+}
+
+lv_obj_t *ui_pages_open(uint8_t id)
+{
+    if (id >= page_count) return NULL;
+    ui_page_t *page = &pages[id];
+
+    if (!page->obj) {
+#ifdef UI_PERF_STATS
+        size_t heap_mark = ui_heap_mark();
+        uint32_t start = millis();
+#endif
+
+        page->obj = page_create();
+        building = page;
+        page->build(page->obj);
+        building = NULL;
+
+#ifdef UI_PERF_STATS
+        Serial.printf("UI %s page built in %lu ms, %ld bytes\n", page->name,
+                      (unsigned long)(millis() - start), (long)heap_mark - (long)ui_heap_mark());
+#endif
+    }
+
+    if (current != UI_PAGE_NONE && current != id) {
+        page_hide(&pages[current]);
+    }
+    current = id;
+
+    lv_obj_clear_flag(page->obj, LV_OBJ_FLAG_HIDDEN);
+    for (uint8_t i = 0; i < page->timer_count; i++) {
+        // Refresh right away instead of showing values from the last visit
+        lv_timer_resume(page->timers[i]);
+        lv_timer_ready(page->timers[i]);
+    }
+    return page->obj;
+}
+
+void ui_pages_close(void)
+{
+    if (current == UI_PAGE_NONE) return;
+    page_hide(&pages[current]);
+    current = UI_PAGE_NONE;
+}
+
+int ui_pages_current(void)
+{
+    return current;
+}
+
+bool ui_pages_built(uint8_t id)
+{
+    return id < page_count && pages[id].obj != NULL;
+}
+
+void ui_pages_destroy(uint8_t id)
+{
+    if (id >= page_count || !pages[id].obj) return;
+    ui_page_t *page = &pages[id];
+#ifdef UI_PERF_STATS
+    size_t heap_mark = ui_heap_mark();
+#endif
+
+    // Safe from inside a timer callback, lv_timer_handler() restarts its walk
+    for (uint8_t i = 0; i < page->timer_count; i++) {
+        lv_timer_del(page->timers[i]);
+    }
+    page->timer_count = 0;
+
+    lv_obj_del(page->obj);
+    page->obj = NULL;
+    if (page->teardown) {
+        page->teardown();
+    }
+    if (current == id) {
+        current = UI_PAGE_NONE;
+    }
+
+#ifdef UI_PERF_STATS
+    Serial.printf("UI %s page released %ld bytes\n", page->name, (long)ui_heap_mark() - (long)heap_mark);
+#endif
+}
+
+uint32_t ui_pages_reap(uint32_t now)
+{
+    uint32_t destroyed = 0;
+    if (!idle_teardown_ms) return 0;
+
+    for (uint8_t i = 0; i < page_count; i++) {
+        ui_page_t *page = &pages[i];
+        if (!page->obj || page->keep || i == current) continue;
+        if (now - page->hidden_ms >= idle_teardown_ms) {
+            ui_pages_destroy(i);
+            destroyed++;
+        }
+    }
+    return destroyed;
+}
+
+lv_timer_t *ui_page_timer_create(lv_timer_cb_t cb, uint32_t period, void *user_data)
+{
+    if (!building) return lv_timer_create(cb, period, user_data);
+
+    // A timer the page does not track would outlive it and run on freed objects
+    if (building->timer_count >= UI_PAGE_MAX_TIMERS) {
+        Serial.printf("UI %s page: too many timers\n", building->name);
+        return NULL;
+    }
+    lv_timer_t *timer = lv_timer_create(cb, period, user_data);
+    building->timers[building->timer_count++] = timer;
+    return timer;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file      ui_pages.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Registry of the keypad sub-pages opened from the home screen.
+ *
+ * A page is built on its first navigation instead of at boot, so the home
+ * screen comes up faster and pages that are never opened cost no LVGL heap.
+ * Periodic refresh timers created with ui_page_timer_create() while a page
+ * is built belong to that page: they run only while it is visible and are
+ * deleted with it. A page hidden for longer than the idle timeout is torn
+ * down again and rebuilt on the next visit; its teardown callback must
+ * forget every pointer into the page. Pages holding user input that exists
+ * nowhere else set `keep`.
+ *
+ * All calls must come from the LVGL task.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+#define UI_PAGE_MAX_TIMERS      4
+#define UI_PAGE_NONE            -1
+
+typedef struct {
+    const char *name;
+    void      (*build)(lv_obj_t *page);     // Fill the empty page container
+    void      (*teardown)(void);            // Optional, called after the page is deleted
+    bool        keep;                       // Never torn down once built
+
+    // Runtime state
+    lv_obj_t   *obj;
+    lv_timer_t *timers[UI_PAGE_MAX_TIMERS];
+    uint8_t     timer_count;
+    uint32_t    hidden_ms;
+} ui_page_t;
+
+typedef lv_obj_t *(*ui_page_create_t)(void);
+
+// `create` returns a new hidden page container. An `idle_teardown_ms` of 0
+// keeps every page once built.
+void ui_pages_begin(ui_page_t *pages, uint8_t count, ui_page_create_t create, uint32_t idle_teardown_ms);
+
+// Build the page if needed, hide the current one and show it
+lv_obj_t *ui_pages_open(uint8_t id);
+
+// Hide the current page and pause its timers, back to the home screen
+void ui_pages_close(void);
+
+int  ui_pages_current(void);
+bool ui_pages_built(uint8_t id);
+
+// Delete the page, its timers, and call its teardown
+void ui_pages_destroy(uint8_t id);
+
+// Tear down pages hidden for the idle timeout, returns how many were destroyed.
+// Runs from an internal LVGL timer, exposed for the unit tests.
+uint32_t ui_pages_reap(uint32_t now);
+
+// Create a refresh timer owned by the page being built. Returns NULL, with
+// no timer created, past UI_PAGE_MAX_TIMERS; page builders know how many
+// they create and LV_ASSERT_NULL() the result.
+lv_timer_t *ui_page_timer_create(lv_timer_cb_t cb, uint32_t period, void *user_data);
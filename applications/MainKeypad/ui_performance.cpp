@@ -23,8 +23,11 @@ const lv_color_t UI_COLOR_ACCENT_BLUE = LV_COLOR_MAKE(0x00, 0x7A, 0xCC);
 const lv_color_t UI_COLOR_TEXT_PRIMARY = LV_COLOR_MAKE(0xCC, 0xCC, 0xCC);
 const lv_color_t UI_COLOR_TEXT_SECONDARY = LV_COLOR_MAKE(0x9C, 0xDC, 0xFE);
 
-// Global style cache
-ui_style_cache_t g_style_cache = {0};
+// Display refresh statistics, fed by the display driver monitor callback
+static uint32_t g_frame_count = 0;
+static uint32_t g_frame_ms_total = 0;
+static uint32_t g_frame_ms_max = 0;
+static uint32_t g_frame_px_total = 0;
 
 // Memory pool for UI objects
 static void* g_ui_memory_pool = nullptr;
@@ -38,30 +41,8 @@ void ui_performance_init(void) {
     // Set faster LVGL refresh rate
     ui_set_fast_refresh_rate();
     
-    // Initialize style cache
-    if (!g_style_cache.initialized) {
-        // Pre-create and cache frequently used styles
-        lv_style_init(&g_style_cache.section_style);
-        lv_style_set_bg_color(&g_style_cache.section_style, UI_COLOR_BG_SECTION);
-        lv_style_set_bg_opa(&g_style_cache.section_style, LV_OPA_COVER);
-        lv_style_set_radius(&g_style_cache.section_style, 6);
-        lv_style_set_border_width(&g_style_cache.section_style, 1);
-        lv_style_set_border_color(&g_style_cache.section_style, UI_COLOR_BORDER);
-        lv_style_set_pad_all(&g_style_cache.section_style, 8);
-        
-        lv_style_init(&g_style_cache.button_style);
-        lv_style_set_bg_color(&g_style_cache.button_style, UI_COLOR_ACCENT_BLUE);
-        lv_style_set_bg_opa(&g_style_cache.button_style, LV_OPA_COVER);
-        lv_style_set_radius(&g_style_cache.button_style, 8);
-        lv_style_set_shadow_width(&g_style_cache.button_style, 3);
-        lv_style_set_shadow_opa(&g_style_cache.button_style, LV_OPA_20);
-        
-        lv_style_init(&g_style_cache.label_style);
-        lv_style_set_text_color(&g_style_cache.label_style, UI_COLOR_TEXT_PRIMARY);
-        lv_style_set_text_font(&g_style_cache.label_style, &lv_font_montserrat_12);
-        
-        g_style_cache.initialized = true;
-    }
+    // Shared widget styles, see ui_theme.h
+    ui_theme_init();
 }
 
 void ui_memory_pool_init(void) {
@@ -191,3 +172,32 @@ void ui_update_wifi_fast(int32_t rssi, bool connected) {
         last_connected = connected;
     }
 }
+
+size_t ui_heap_mark(void) {
+    // LVGL allocates with malloc (LV_MEM_CUSTOM), which may land in PSRAM
+    return heap_caps_get_free_size(MALLOC_CAP_8BIT);
+}
+
+void ui_heap_report(const char* what, size_t mark) {
+    long used = (long)mark - (long)ui_heap_mark();
+    Serial.printf("UI %s: %ld bytes\n", what, used);
+}
+
+void ui_perf_monitor_cb(lv_disp_drv_t* drv, uint32_t time, uint32_t px) {
+    g_frame_count++;
+    g_frame_ms_total += time;
+    g_frame_px_total += px;
+    if (time > g_frame_ms_max) {
+        g_frame_ms_max = time;
+    }
+}
+
+void ui_perf_print_stats(void) {
+    if (g_frame_count == 0) {
+        return;
+    }
+    Serial.printf("UI frames: %lu, draw %lu ms avg %lu ms max, %lu px avg\n",
+                  (unsigned long)g_frame_count, (unsigned long)(g_frame_ms_total / g_frame_count),
+                  (unsigned long)g_frame_ms_max, (unsigned long)(g_frame_px_total / g_frame_count));
+    g_frame_count = g_frame_ms_total = g_frame_ms_max = g_frame_px_total = 0;
+}
@@ -11,6 +11,7 @@
 
 #include <Arduino.h>
 #include "lvgl.h"
+#include "ui_theme.h"
 
 // Performance optimization constants
 #define UI_REFRESH_RATE_MS          16    // 60 FPS (1000/60 = 16.67ms)
@@ -19,6 +20,7 @@
 #define UI_BATTERY_UPDATE_RATE_MS   5000  // Battery updates every 5s
 #define UI_WIFI_UPDATE_RATE_MS      2000  // WiFi updates every 2s
 #define UI_MEMORY_POOL_SIZE         8192  // 8KB memory pool for UI objects
+#define UI_PAGE_IDLE_TEARDOWN_MS    60000 // Free pages hidden for 60s, 0 keeps them
 
 // Memory optimization - pre-allocate common strings
 extern const char* const LOADING_TEXT;
@@ -51,14 +53,10 @@ void ui_update_gps_fast(double lat, double lng, double speed, const char* time_s
 void ui_update_battery_fast(uint16_t voltage_mv);
 void ui_update_wifi_fast(int32_t rssi, bool connected);
 
-// Style cache for performance
-typedef struct {
-    lv_style_t section_style;
-    lv_style_t button_style;
-    lv_style_t label_style;
-    lv_style_t slider_style;
-    lv_style_t switch_style;
-    bool initialized;
-} ui_style_cache_t;
-
-extern ui_style_cache_t g_style_cache;
+// Heap and draw time measurement. ui_heap_report() prints the heap consumed
+// since ui_heap_mark(); ui_perf_monitor_cb() is the display driver monitor_cb
+// and accumulates refresh time until ui_perf_print_stats() prints and resets.
+size_t ui_heap_mark(void);
+void ui_heap_report(const char* what, size_t mark);
+void ui_perf_monitor_cb(lv_disp_drv_t* drv, uint32_t time, uint32_t px);
+void ui_perf_print_stats(void);
@@ -0,0 +1,345 @@
+/**
+ * @file      ui_theme.cpp
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ */
+
+#include "ui_theme.h"
+
+#define COLOR_BG_DARK           0x1E1E1E
+#define COLOR_BG_SECTION        0x2D2D30
+#define COLOR_BORDER            0x3E3E42
+#define COLOR_ACCENT            0x007ACC
+#define COLOR_ACCENT_PRESSED    0x005A9E
+#define COLOR_IDLE              0x5A5A5A
+#define COLOR_TEXT_PRIMARY      0xCCCCCC
+#define COLOR_TEXT_SECONDARY    0x9CDCFE
+#define COLOR_ALERT             0xF44747
+
+ui_theme_t ui_theme;
+
+static void init_flex_column(lv_style_t *style, lv_flex_align_t main_place)
+{
+    lv_style_set_layout(style, LV_LAYOUT_FLEX);
+    lv_style_set_flex_flow(style, LV_FLEX_FLOW_COLUMN);
+    lv_style_set_flex_main_place(style, main_place);
+    lv_style_set_flex_cross_place(style, LV_FLEX_ALIGN_CENTER);
+    lv_style_set_flex_track_place(style, LV_FLEX_ALIGN_CENTER);
+}
+
+static void init_round(lv_style_t *style, uint32_t color)
+{
+    lv_style_set_bg_color(style, lv_color_hex(color));
+    lv_style_set_bg_opa(style, LV_OPA_COVER);
+    lv_style_set_radius(style, LV_RADIUS_CIRCLE);
+}
+
+static void init_containers(void)
+{
+    lv_style_t *s = &ui_theme.page;
+    lv_style_init(s);
+    lv_style_set_width(s, LV_PCT(100));
+    lv_style_set_height(s, LV_PCT(100));
+    lv_style_set_pad_all(s, 10);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_BG_DARK));
+    lv_style_set_border_width(s, 0);
+    init_flex_column(s, LV_FLEX_ALIGN_START);
+
+    s = &ui_theme.bare;
+    lv_style_init(s);
+    lv_style_set_bg_opa(s, LV_OPA_TRANSP);
+    lv_style_set_border_width(s, 0);
+    lv_style_set_pad_all(s, 0);
+
+    s = &ui_theme.section;
+    lv_style_init(s);
+    lv_style_set_width(s, LV_PCT(90));
+    lv_style_set_height(s, LV_SIZE_CONTENT);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_BG_SECTION));
+    lv_style_set_bg_opa(s, LV_OPA_COVER);
+    lv_style_set_radius(s, 6);
+    lv_style_set_border_width(s, 1);
+    lv_style_set_border_color(s, lv_color_hex(COLOR_BORDER));
+    lv_style_set_pad_hor(s, 8);
+    lv_style_set_pad_ver(s, 10);
+
+    s = &ui_theme.section_opa;
+    lv_style_init(s);
+    lv_style_set_bg_opa(s, LV_OPA_COVER);
+
+    s = &ui_theme.section_header;
+    lv_style_init(s);
+    lv_style_set_width(s, LV_PCT(90));
+    lv_style_set_height(s, LV_SIZE_CONTENT);
+    lv_style_set_pad_hor(s, 4);
+    lv_style_set_pad_top(s, 12);
+    lv_style_set_pad_bottom(s, 4);
+
+    s = &ui_theme.header_text;
+    lv_style_init(s);
+    lv_style_set_text_color(s, lv_color_hex(COLOR_TEXT_PRIMARY));
+    lv_style_set_text_font(s, &lv_font_montserrat_12);
+    lv_style_set_align(s, LV_ALIGN_LEFT_MID);
+
+    // create_text(): icon and title above the control
+    s = &ui_theme.row;
+    lv_style_init(s);
+    lv_style_set_width(s, LV_PCT(100));
+    lv_style_set_height(s, LV_SIZE_CONTENT);
+    lv_style_set_min_height(s, 60);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_BG_SECTION));
+    lv_style_set_bg_opa(s, LV_OPA_COVER);
+    lv_style_set_border_width(s, 1);
+    lv_style_set_border_color(s, lv_color_hex(COLOR_BORDER));
+    lv_style_set_pad_all(s, 12);
+    init_flex_column(s, LV_FLEX_ALIGN_CENTER);
+
+    s = &ui_theme.row_header;
+    lv_style_init(s);
+    lv_style_set_width(s, LV_PCT(100));
+    lv_style_set_height(s, LV_SIZE_CONTENT);
+    lv_style_set_layout(s, LV_LAYOUT_FLEX);
+    lv_style_set_flex_flow(s, LV_FLEX_FLOW_ROW);
+    lv_style_set_flex_main_place(s, LV_FLEX_ALIGN_START);
+    lv_style_set_flex_cross_place(s, LV_FLEX_ALIGN_CENTER);
+    lv_style_set_flex_track_place(s, LV_FLEX_ALIGN_CENTER);
+
+    s = &ui_theme.row_icon;
+    lv_style_init(s);
+    lv_style_set_pad_right(s, 8);
+
+    s = &ui_theme.row_slider;
+    lv_style_init(s);
+    lv_style_set_pad_top(s, 8);
+}
+
+static void init_text(void)
+{
+    lv_style_t *s = &ui_theme.title;
+    lv_style_init(s);
+    lv_style_set_text_color(s, lv_color_hex(COLOR_TEXT_PRIMARY));
+    lv_style_set_text_font(s, &lv_font_montserrat_14);
+    lv_style_set_text_align(s, LV_TEXT_ALIGN_LEFT);
+    lv_style_set_flex_grow(s, 1);
+
+    s = &ui_theme.value;
+    lv_style_init(s);
+    lv_style_set_text_color(s, lv_color_hex(COLOR_TEXT_SECONDARY));
+    lv_style_set_text_font(s, &lv_font_montserrat_12);
+    lv_style_set_text_align(s, LV_TEXT_ALIGN_RIGHT);
+
+    s = &ui_theme.slider_value;
+    lv_style_init(s);
+    lv_style_set_text_color(s, lv_color_hex(COLOR_ACCENT));
+    lv_style_set_text_font(s, &lv_font_montserrat_12);
+    lv_style_set_text_align(s, LV_TEXT_ALIGN_RIGHT);
+
+    s = &ui_theme.list;
+    lv_style_init(s);
+    lv_style_set_width(s, LV_PCT(90));
+    lv_style_set_flex_grow(s, 1);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_BG_SECTION));
+    lv_style_set_border_width(s, 0);
+    lv_style_set_pad_all(s, 6);
+    init_flex_column(s, LV_FLEX_ALIGN_START);
+
+    s = &ui_theme.list_row;
+    lv_style_init(s);
+    lv_style_set_width(s, LV_PCT(100));
+    lv_style_set_text_color(s, lv_color_hex(COLOR_TEXT_PRIMARY));
+    lv_style_set_text_font(s, &lv_font_montserrat_12);
+
+    s = &ui_theme.alert_text;
+    lv_style_init(s);
+    lv_style_set_text_color(s, lv_color_hex(COLOR_ALERT));
+}
+
+static void init_buttons(void)
+{
+    lv_style_t *s = &ui_theme.back_button;
+    lv_style_init(s);
+    lv_style_set_width(s, LV_SIZE_CONTENT);
+    lv_style_set_height(s, 40);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_ACCENT));
+    lv_style_set_radius(s, 8);
+
+    s = &ui_theme.back_text;
+    lv_style_init(s);
+    lv_style_set_text_color(s, lv_color_white());
+    lv_style_set_align(s, LV_ALIGN_CENTER);
+
+    s = &ui_theme.button;
+    lv_style_init(s);
+    lv_style_set_width(s, LV_PCT(25));
+    lv_style_set_height(s, 28);
+    lv_style_set_align(s, LV_ALIGN_RIGHT_MID);
+    lv_style_set_x(s, -4);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_ACCENT));
+    lv_style_set_bg_opa(s, LV_OPA_COVER);
+    lv_style_set_radius(s, 8);
+    lv_style_set_border_width(s, 0);
+    lv_style_set_outline_width(s, 0);
+    lv_style_set_shadow_width(s, 3);
+    lv_style_set_shadow_color(s, lv_color_black());
+    lv_style_set_shadow_opa(s, LV_OPA_20);
+    lv_style_set_shadow_ofs_y(s, 2);
+    lv_style_set_pad_all(s, 8);
+
+    s = &ui_theme.button_pressed;
+    lv_style_init(s);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_ACCENT_PRESSED));
+    lv_style_set_transform_zoom(s, 245);
+
+    s = &ui_theme.button_text;
+    lv_style_init(s);
+    lv_style_set_text_color(s, lv_color_white());
+    lv_style_set_text_font(s, &lv_font_montserrat_12);
+    lv_style_set_align(s, LV_ALIGN_CENTER);
+
+    s = &ui_theme.icon;
+    lv_style_init(s);
+    lv_style_set_width(s, 80);
+    lv_style_set_height(s, 80);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_BG_SECTION));
+    lv_style_set_bg_opa(s, LV_OPA_COVER);
+    lv_style_set_radius(s, 16);
+    lv_style_set_border_width(s, 1);
+    lv_style_set_border_color(s, lv_color_hex(COLOR_BORDER));
+    lv_style_set_border_opa(s, LV_OPA_COVER);
+    lv_style_set_shadow_width(s, 4);
+    lv_style_set_shadow_color(s, lv_color_black());
+    lv_style_set_shadow_opa(s, LV_OPA_30);
+    lv_style_set_shadow_ofs_y(s, 2);
+
+    s = &ui_theme.icon_pressed;
+    lv_style_init(s);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_ACCENT));
+    lv_style_set_bg_opa(s, LV_OPA_COVER);
+    lv_style_set_transform_zoom(s, 240);
+
+    s = &ui_theme.icon_glyph;
+    lv_style_init(s);
+    lv_style_set_text_color(s, lv_color_hex(COLOR_ACCENT));
+    lv_style_set_text_font(s, &lv_font_montserrat_12);
+    lv_style_set_align(s, LV_ALIGN_CENTER);
+    lv_style_set_y(s, -10);
+
+    s = &ui_theme.icon_text;
+    lv_style_init(s);
+    lv_style_set_text_color(s, lv_color_hex(COLOR_TEXT_PRIMARY));
+    lv_style_set_text_font(s, &lv_font_montserrat_12);
+    lv_style_set_align(s, LV_ALIGN_CENTER);
+    lv_style_set_y(s, 15);
+}
+
+static void init_controls(void)
+{
+    lv_style_t *s = &ui_theme.field;
+    lv_style_init(s);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_BG_SECTION));
+    lv_style_set_bg_opa(s, LV_OPA_COVER);
+    lv_style_set_radius(s, 8);
+    lv_style_set_border_width(s, 1);
+    lv_style_set_border_color(s, lv_color_hex(COLOR_BORDER));
+    lv_style_set_border_opa(s, LV_OPA_60);
+    lv_style_set_pad_all(s, 8);
+    lv_style_set_text_color(s, lv_color_hex(COLOR_TEXT_PRIMARY));
+    lv_style_set_text_font(s, &lv_font_montserrat_12);
+
+    s = &ui_theme.dropdown;
+    lv_style_init(s);
+    lv_style_set_width(s, 80);
+    lv_style_set_shadow_width(s, 2);
+    lv_style_set_shadow_color(s, lv_color_black());
+    lv_style_set_shadow_opa(s, LV_OPA_10);
+    lv_style_set_shadow_ofs_y(s, 1);
+
+    s = &ui_theme.dropdown_accent;
+    lv_style_init(s);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_ACCENT));
+    lv_style_set_bg_opa(s, LV_OPA_COVER);
+    lv_style_set_text_color(s, lv_color_white());
+    lv_style_set_radius(s, 4);
+
+    s = &ui_theme.slider_track;
+    lv_style_init(s);
+    lv_style_set_width(s, LV_PCT(80));
+    lv_style_set_height(s, 8);
+    lv_style_set_pad_top(s, 8);
+    init_round(s, COLOR_BORDER);
+    lv_style_set_border_width(s, 0);
+    lv_style_set_outline_width(s, 0);
+    lv_style_set_shadow_width(s, 0);
+
+    s = &ui_theme.slider_indicator;
+    lv_style_init(s);
+    init_round(s, COLOR_ACCENT);
+
+    s = &ui_theme.slider_indicator_idle;
+    lv_style_init(s);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_IDLE));
+
+    s = &ui_theme.slider_knob;
+    lv_style_init(s);
+    lv_style_set_width(s, 22);
+    lv_style_set_height(s, 22);
+    init_round(s, COLOR_TEXT_PRIMARY);
+    lv_style_set_border_width(s, 1);
+    lv_style_set_border_color(s, lv_color_hex(COLOR_ACCENT));
+    lv_style_set_shadow_width(s, 4);
+    lv_style_set_shadow_color(s, lv_color_black());
+    lv_style_set_shadow_opa(s, LV_OPA_20);
+    lv_style_set_shadow_spread(s, 1);
+
+    s = &ui_theme.slider_knob_idle;
+    lv_style_init(s);
+    lv_style_set_border_color(s, lv_color_hex(COLOR_IDLE));
+
+    s = &ui_theme.switch_track;
+    lv_style_init(s);
+    lv_style_set_width(s, 40);
+    lv_style_set_height(s, 24);
+    init_round(s, COLOR_BORDER);
+    lv_style_set_border_width(s, 0);
+    lv_style_set_outline_width(s, 0);
+    lv_style_set_shadow_width(s, 0);
+
+    s = &ui_theme.switch_on;
+    lv_style_init(s);
+    lv_style_set_bg_color(s, lv_color_hex(COLOR_ACCENT));
+
+    s = &ui_theme.switch_knob;
+    lv_style_init(s);
+    init_round(s, 0xFFFFFF);
+    lv_style_set_shadow_width(s, 2);
+    lv_style_set_shadow_color(s, lv_color_black());
+    lv_style_set_shadow_opa(s, LV_OPA_30);
+}
+
+void ui_theme_init(void)
+{
+    if (ui_theme.initialized) {
+        return;
+    }
+    init_containers();
+    init_text();
+    init_buttons();
+    init_controls();
+    ui_theme.initialized = true;
+}
+
+void ui_theme_set_section_opa(lv_opa_t opa)
+{
+    lv_style_set_bg_opa(&ui_theme.section_opa, opa);
+    lv_obj_report_style_change(&ui_theme.section_opa);
+}
+
+void ui_theme_set_icon_opa(lv_opa_t opa)
+{
+    lv_style_set_bg_opa(&ui_theme.icon, opa);
+    lv_style_set_border_opa(&ui_theme.icon, opa);
+    lv_obj_report_style_change(&ui_theme.icon);
+}
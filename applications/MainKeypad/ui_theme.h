@@ -0,0 +1,75 @@
+/**
+ * @file      ui_theme.h
+ * @author    Citadel ADS One Keypad firmware
+ * @license   MIT
+ * @copyright Copyright (c) 2026
+ * @date      2026-10-18
+ *
+ * Shared LVGL styles for the widget factories in ui.cpp.
+ *
+ * Every widget role (page, section, row, slider track/indicator/knob, switch,
+ * button, app icon, ...) has one static lv_style_t that all objects of that
+ * role reference with lv_obj_add_style(). An object then carries a few
+ * 8 byte style references instead of a heap allocated local style holding
+ * 10-25 properties per part and state.
+ *
+ * Runtime changes (icon transparency, section opacity) modify the shared
+ * style once and notify LVGL, instead of walking every object.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+// Slider sitting at its minimum value, shown greyed out
+#define UI_THEME_STATE_IDLE     LV_STATE_USER_1
+
+typedef struct {
+    lv_style_t page;                    // Full screen page container, flex column
+    lv_style_t bare;                    // Transparent container without border and padding
+    lv_style_t section;                 // Rounded group box
+    lv_style_t section_opa;             // Background opacity of sections, follows the slider
+    lv_style_t section_header;          // Caption row above a group of sections
+    lv_style_t header_text;
+    lv_style_t row;                     // Icon + title row of create_text()
+    lv_style_t row_header;
+    lv_style_t row_icon;
+    lv_style_t row_slider;
+    lv_style_t title;
+    lv_style_t value;                   // Secondary value text, right aligned
+    lv_style_t slider_value;
+    lv_style_t list;                    // Scrolling list box, history events
+    lv_style_t list_row;                // History list entry
+    lv_style_t alert_text;              // Alarm and tamper entries
+    lv_style_t back_button;
+    lv_style_t back_text;
+    lv_style_t button;
+    lv_style_t button_pressed;
+    lv_style_t button_text;
+    lv_style_t icon;                    // Home screen app icon, opacity follows the slider
+    lv_style_t icon_pressed;
+    lv_style_t icon_glyph;
+    lv_style_t icon_text;
+    lv_style_t field;                   // Dropdown and text area box
+    lv_style_t dropdown;
+    lv_style_t dropdown_accent;         // Selected option and arrow
+    lv_style_t slider_track;
+    lv_style_t slider_indicator;
+    lv_style_t slider_indicator_idle;
+    lv_style_t slider_knob;
+    lv_style_t slider_knob_idle;
+    lv_style_t switch_track;
+    lv_style_t switch_on;
+    lv_style_t switch_knob;
+    bool initialized;
+} ui_theme_t;
+
+extern ui_theme_t ui_theme;
+
+// Build the styles once, after lv_init()
+void ui_theme_init(void);
+
+// Update a shared style and refresh every object using it
+void ui_theme_set_section_opa(lv_opa_t opa);
+void ui_theme_set_icon_opa(lv_opa_t opa);
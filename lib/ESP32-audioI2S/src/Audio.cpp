@@ -2277,21 +2277,29 @@ uint32_t Audio::stopSong() {
     }
 #endif                                           // AUDIO_NO_SD_FS
     memset(m_outBuff, 0, sizeof(m_outBuff));     //Clear OutputBuffer
-    i2s_zero_dma_buffer((i2s_port_t) m_i2s_num);
+    if(m_f_i2sOutput) i2s_zero_dma_buffer((i2s_port_t) m_i2s_num);
     return pos;
 }
 //---------------------------------------------------------------------------------------------------------------------
 void Audio::playI2Sremains() { // returns true if all dma_buffs flushed
+    if(!m_f_i2sOutput) return;  // nothing of ours queued in DMA
     if(!getSampleRate()) setSampleRate(96000);
     if(!getChannels()) setChannels(2);
     if(getBitsPerSample() > 8) memset(m_outBuff,   0, sizeof(m_outBuff));     //Clear OutputBuffer (signed)
     else                       memset(m_outBuff, 128, sizeof(m_outBuff));     //Clear OutputBuffer (unsigned, PCM 8u)
 
-    m_validSamples = m_i2s_config.dma_buf_len * m_i2s_config.dma_buf_count;
-    while(m_validSamples) {
-        playChunk();
+    // m_outBuff holds 2048 stereo or 4096 mono words, refill the DMA buffers from it in turns
+    uint32_t remains = m_i2s_config.dma_buf_len * m_i2s_config.dma_buf_count;
+    uint16_t words   = (getBitsPerSample() == 16 && getChannels() == 2) ? 2048 : 4096;
+    while(remains) {
+        m_validSamples = min(remains, (uint32_t)words);
+        m_curSample = 0;
+        remains -= m_validSamples;
+        while(m_validSamples) {
+            playChunk();
+        }
     }
-    i2s_zero_dma_buffer((i2s_port_t) m_i2s_num);
+    if(m_f_i2sOutput) i2s_zero_dma_buffer((i2s_port_t) m_i2s_num);
     return;
 }
 //---------------------------------------------------------------------------------------------------------------------
@@ -2302,95 +2310,78 @@ bool Audio::pauseResume() {
         retVal = true;
         if(!m_f_running) {
             memset(m_outBuff, 0, sizeof(m_outBuff));               //Clear OutputBuffer
-            i2s_zero_dma_buffer((i2s_port_t) m_i2s_num);
+            if(m_f_i2sOutput) i2s_zero_dma_buffer((i2s_port_t) m_i2s_num);
         }
     }
     return retVal;
 }
 //---------------------------------------------------------------------------------------------------------------------
 bool Audio::playChunk() {
-    // If we've got data, try and pump it out..
-    int16_t sample[2];
-    if(getBitsPerSample() == 8) {
-        if(getChannels() == 1) {
-            while(m_validSamples) {
-                uint8_t x =  m_outBuff[m_curSample] & 0x00FF;
-                uint8_t y = (m_outBuff[m_curSample] & 0xFF00) >> 8;
-                sample[LEFTCHANNEL]  = x;
-                sample[RIGHTCHANNEL] = x;
-                while(1) {
-                    if(playSample(sample)) break;
-                } // Can't send?
-                sample[LEFTCHANNEL]  = y;
-                sample[RIGHTCHANNEL] = y;
-                while(1) {
-                    if(playSample(sample)) break;
-                } // Can't send?
-                m_validSamples--;
-                m_curSample++;
-            }
-        }
-        if(getChannels() == 2) {
-            while(m_validSamples) {
-                uint8_t x =  m_outBuff[m_curSample] & 0x00FF;
-                uint8_t y = (m_outBuff[m_curSample] & 0xFF00) >> 8;
-                if(!m_f_forceMono) { // stereo mode
-                    sample[LEFTCHANNEL]  = x;
-                    sample[RIGHTCHANNEL] = y;
+    // If we've got data, try and pump it out, one DMA buffer per i2s_write
+    if(getBitsPerSample() != 8 && getBitsPerSample() != 16) {
+        log_e("BitsPer Sample must be 8 or 16!");
+        m_validSamples = 0;
+        stopSong();
+        return false;
+    }
+    bool mono   = getChannels() == 1;
+    bool pcm8   = getBitsPerSample() == 8;
+    int16_t* in = m_outBuff + m_curSample * (mono ? 1 : 2);
+    while(m_validSamples) {
+        int16_t* out = m_blockBuff;
+        uint16_t frames = 0;
+        if(pcm8) { // upsample from unsigned 8 bits to signed 16 bits
+            // mono: two samples per word, stereo: one frame per word
+            uint16_t perWord = mono ? 2 : 1;
+            while(m_validSamples && frames + perWord <= m_blockFrames) {
+                uint8_t x =  *in & 0x00FF;
+                uint8_t y = (*in & 0xFF00) >> 8;
+                in++;
+                if(mono) {
+                    out[0] = out[1] = (x - 128) << 8;
+                    out[2] = out[3] = (y - 128) << 8;
+                }
+                else if(!m_f_forceMono) { // stereo mode
+                    out[LEFTCHANNEL]  = (x - 128) << 8;
+                    out[RIGHTCHANNEL] = (y - 128) << 8;
                 }
                 else { // force mono
                     uint8_t xy = (x + y) / 2;
-                    sample[LEFTCHANNEL]  = xy;
-                    sample[RIGHTCHANNEL] = xy;
+                    out[0] = out[1] = (xy - 128) << 8;
                 }
-
-                while(1) {
-                    if(playSample(sample)) break;
-                } // Can't send?
+                out += 2 * perWord;
+                frames += perWord;
                 m_validSamples--;
                 m_curSample++;
             }
         }
-        m_curSample = 0;
-        return true;
-    }
-    if(getBitsPerSample() == 16) {
-        if(getChannels() == 1) {
-            while(m_validSamples) {
-                sample[LEFTCHANNEL]  = m_outBuff[m_curSample];
-                sample[RIGHTCHANNEL] = m_outBuff[m_curSample];
-                if(!playSample(sample)) {
-                    log_e("can't send");
-                    return false;
-                } // Can't send
-                m_validSamples--;
-                m_curSample++;
-            }
-        }
-        if(getChannels() == 2) {
-            m_curSample = 0;
-            while(m_validSamples) {
-                if(!m_f_forceMono) { // stereo mode
-                    sample[LEFTCHANNEL]  = m_outBuff[m_curSample * 2];
-                    sample[RIGHTCHANNEL] = m_outBuff[m_curSample * 2 + 1];
+        else {
+            for(; m_validSamples && frames < m_blockFrames; frames++) {
+                if(mono) {
+                    out[LEFTCHANNEL] = out[RIGHTCHANNEL] = *in++;
+                }
+                else if(!m_f_forceMono) { // stereo mode
+                    out[LEFTCHANNEL]  = in[0];
+                    out[RIGHTCHANNEL] = in[1];
+                    in += 2;
                 }
                 else { // mono mode, #100
-                    int16_t xy = (m_outBuff[m_curSample * 2] + m_outBuff[m_curSample * 2 + 1]) / 2;
-                    sample[LEFTCHANNEL] = xy;
-                    sample[RIGHTCHANNEL] = xy;
+                    int16_t xy = (in[0] + in[1]) / 2;
+                    out[LEFTCHANNEL] = out[RIGHTCHANNEL] = xy;
+                    in += 2;
                 }
-                playSample(sample);
+                out += 2;
                 m_validSamples--;
                 m_curSample++;
             }
         }
-        m_curSample = 0;
-        return true;
+        if(!playBlock(frames)) {
+            log_e("can't send");
+            return false;
+        }
     }
-    log_e("BitsPer Sample must be 8 or 16!");
-    m_validSamples = 0;
-    stopSong();
-    return false;
+    m_curSample = 0;
+    return true;
 }
 //---------------------------------------------------------------------------------------------------------------------
 void Audio::loop() {
@@ -4049,7 +4040,7 @@ int Audio::sendBytes(uint8_t* data, size_t len) {
     }
     if(ret < 0) { // Error, skip the frame...
         if(m_f_Log) if(m_codec == CODEC_M4A){log_i("begin not found"); return 1;}
-        i2s_zero_dma_buffer((i2s_port_t)m_i2s_num);
+        if(m_f_i2sOutput) i2s_zero_dma_buffer((i2s_port_t)m_i2s_num);
         if(!getChannels() && (ret == -2)) {
              ; // suppress errorcode MAINDATA_UNDERFLOW
         }
@@ -4314,6 +4305,15 @@ uint32_t Audio::getTotalPlayingTime() {
     return millis() - m_PlayingStartTime;
 }
 //---------------------------------------------------------------------------------------------------------------------
+void Audio::getOutputStats(uint32_t* frames, uint32_t* i2sWrites, uint32_t* processUs) {
+    // frames sent, i2s_write calls and time in filters, gain and audio_process_i2s since start,
+    // take differences around a song for its figures. With setI2SOutput(false) no i2s_write is
+    // counted and the time includes audio_process_block(), i.e. the handover to the mixer.
+    *frames    = m_framesOut;
+    *i2sWrites = m_i2sWrites;
+    *processUs = m_processUs;
+}
+//---------------------------------------------------------------------------------------------------------------------
 bool Audio::setTimeOffset(int sec){
     // fast forward or rewind the current position in seconds
     // audiosource must be a mp3, aac or wav file
@@ -4358,13 +4358,13 @@ bool Audio::audioFileSeek(const float speed) {
     if((speed > 1.5f) || (speed < 0.25f)) return false;
 
     uint32_t srate = getSampleRate() * speed;
-    i2s_set_sample_rates((i2s_port_t)m_i2s_num, srate);
+    if(m_f_i2sOutput) i2s_set_sample_rates((i2s_port_t)m_i2s_num, srate);
     return true;
 }
 //---------------------------------------------------------------------------------------------------------------------
 bool Audio::setSampleRate(uint32_t sampRate) {
     if(!sampRate) sampRate = 16000; // fuse, if there is no value -> set default #209
-    i2s_set_sample_rates((i2s_port_t)m_i2s_num, sampRate);
+    if(m_f_i2sOutput) i2s_set_sample_rates((i2s_port_t)m_i2s_num, sampRate);
     m_sampleRate = sampRate;
     IIR_calculateCoefficients(m_gain0, m_gain1, m_gain2); // must be recalculated after each samplerate change
     return true;
@@ -4431,10 +4431,16 @@ void Audio::setI2SCommFMT_LSB(bool commFMT) {
 
     }
     AUDIO_INFO("commFMT = %i", m_i2s_config.communication_format);
+    if(!m_f_i2sOutput) return;
     i2s_driver_uninstall((i2s_port_t)m_i2s_num);
     i2s_driver_install  ((i2s_port_t)m_i2s_num, &m_i2s_config, 0, NULL);
 }
 //---------------------------------------------------------------------------------------------------------------------
+void Audio::setI2SOutput(bool enable) {
+    // with a mixer owning the port, Audio must not change its rate or clear its DMA buffers
+    m_f_i2sOutput = enable;
+}
+//---------------------------------------------------------------------------------------------------------------------
 bool Audio::playSample(int16_t sample[2]) {
 
     if (getBitsPerSample() == 8) { // Upsample from unsigned 8 bits to signed 16 bits
@@ -4465,8 +4471,11 @@ bool Audio::playSample(int16_t sample[2]) {
     if(m_f_internalDAC) {
         s32 += 0x80008000;
     }
+    if(!m_f_i2sOutput) return true;
     m_i2s_bytesWritten = 0;
     esp_err_t err = i2s_write((i2s_port_t) m_i2s_num, (const char*) &s32, sizeof(uint32_t), &m_i2s_bytesWritten, 100);
+    m_i2sWrites++;
+    m_framesOut++;
     if(err != ESP_OK) {
         log_e("ESP32 Errorcode %i", err);
         return false;
@@ -4478,6 +4487,81 @@ bool Audio::playSample(int16_t sample[2]) {
     return true;
 }
 //---------------------------------------------------------------------------------------------------------------------
+bool Audio::playBlock(uint16_t frames) {
+    // Same steps as playSample() for a whole block of interleaved L/R frames in m_blockBuff
+    uint32_t t0 = micros();
+    int16_t* buff = m_blockBuff;
+    for(uint16_t i = 0; i < frames * 2; i++) {
+        buff[i] = buff[i] >> 1; // half Vin so we can boost up to 6dB in filters
+    }
+
+    m_eq.process(buff, frames);             // returns at once while setTone(0, 0, 0)
+
+    int32_t volL, volR;
+    GainSteps(&volL, &volR);
+    for(uint16_t i = 0; i < frames * 2; i += 2) {
+        buff[i + LEFTCHANNEL]  = (buff[i + LEFTCHANNEL]  * volL) >> 6;
+        buff[i + RIGHTCHANNEL] = (buff[i + RIGHTCHANNEL] * volR) >> 6;
+    }
+
+    if(audio_process_block){
+        // the whole block before it is packed for i2s, e.g. for a mixer
+        bool continueI2S = false;
+        audio_process_block(buff, frames, &continueI2S);
+        if(!continueI2S){
+            m_processUs += micros() - t0;
+            m_framesOut += frames;
+            return true;
+        }
+    }
+    if(!m_f_i2sOutput) {
+        // decoded and filtered all the same, count it like a block handed over
+        m_processUs += micros() - t0;
+        m_framesOut += frames;
+        return true;
+    }
+
+    uint16_t n = 0;
+    for(uint16_t i = 0; i < frames; i++, buff += 2) {
+        int32_t l = buff[LEFTCHANNEL];
+        int32_t r = buff[RIGHTCHANNEL];
+        uint32_t s32 = ((uint32_t)l << 16) | (r & 0xffff);
+        if(audio_process_i2s){
+            // process audio sample just before writing to i2s
+            bool continueI2S = false;
+            audio_process_i2s(&s32, &continueI2S);
+            if(!continueI2S){
+                continue;
+            }
+        }
+        if(m_f_internalDAC) {
+            s32 += 0x80008000;
+        }
+        m_i2sBuff[n++] = s32;
+    }
+    m_processUs += micros() - t0;
+    m_framesOut += frames;
+
+    const char* p = (const char*) m_i2sBuff;
+    size_t len = n * sizeof(uint32_t);
+    while(len) {
+        m_i2s_bytesWritten = 0;
+        esp_err_t err = i2s_write((i2s_port_t) m_i2s_num, p, len, &m_i2s_bytesWritten, 100);
+        m_i2sWrites++;
+        if(err != ESP_OK) {
+            log_e("ESP32 Errorcode %i", err);
+            return false;
+        }
+        if(m_i2s_bytesWritten == 0) {
+            log_e("Can't stuff any more in I2S..."); // increase waitingtime or outputbuffer
+            return false;
+        }
+        p   += m_i2s_bytesWritten;
+        len -= m_i2s_bytesWritten;
+    }
+    return true;
+}
+//---------------------------------------------------------------------------------------------------------------------
 void Audio::setTone(int8_t gainLowPass, int8_t gainBandPass, int8_t gainHighPass){
     // see https://www.earlevel.com/main/2013/10/13/biquad-calculator-v2/
     // values can be between -40 ... +6 (dB)
@@ -4530,7 +4614,16 @@ uint8_t Audio::getI2sPort() {
 }
 //---------------------------------------------------------------------------------------------------------------------
 int32_t Audio::Gain(int16_t s[2]) {
-    int32_t v[2];
+    int32_t v[2], volL, volR;
+    GainSteps(&volL, &volR);
+
+    v[LEFTCHANNEL] = (s[LEFTCHANNEL]  * volL) >> 6;
+    v[RIGHTCHANNEL]= (s[RIGHTCHANNEL] * volR) >> 6;
+
+    return (v[LEFTCHANNEL] << 16) | (v[RIGHTCHANNEL] & 0xffff);
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Audio::GainSteps(int32_t* volL, int32_t* volR) {
     float step = (float)m_vol /64;
     uint8_t l = 0, r = 0;
 
@@ -4543,10 +4636,8 @@ int32_t Audio::Gain(int16_t s[2]) {
         r = (uint8_t)(step);
     }
 
-    v[LEFTCHANNEL] = (s[LEFTCHANNEL]  * (m_vol - l)) >> 6;
-    v[RIGHTCHANNEL]= (s[RIGHTCHANNEL] * (m_vol - r)) >> 6;
-
-    return (v[LEFTCHANNEL] << 16) | (v[RIGHTCHANNEL] & 0xffff);
+    *volL = m_vol - l;
+    *volR = m_vol - r;
 }
 //---------------------------------------------------------------------------------------------------------------------
 uint32_t Audio::inBufferFilled() {
@@ -4650,6 +4741,11 @@ void Audio::IIR_calculateCoefficients(int8_t G0, int8_t G1, int8_t G2){  // Infi
         m_filter[HIFGSHELF].b2 = (V - sqrtf(2*V) * K + K * K) * norm;
     }
 
+    int8_t gain[3] = {G0, G1, G2};
+    for(uint8_t i = 0; i < 3; i++) {
+        m_eq.setStage(i, m_filter[i].a0, m_filter[i].a1, m_filter[i].a2, m_filter[i].b1, m_filter[i].b2, gain[i] == 0);
+    }
+
 //    log_i("LS a0=%f, a1=%f, a2=%f, b1=%f, b2=%f", m_filter[0].a0, m_filter[0].a1, m_filter[0].a2,
 //                                                  m_filter[0].b1, m_filter[0].b2);
 //    log_i("EQ a0=%f, a1=%f, a2=%f, b1=%f, b2=%f", m_filter[1].a0, m_filter[1].a1, m_filter[1].a2,
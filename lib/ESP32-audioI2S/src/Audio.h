@@ -20,6 +20,7 @@
 #include <WiFiClientSecure.h>
 #include <vector>
 #include <driver/i2s.h>
+#include "biquad_eq/biquad_eq.h"
 
 #ifndef AUDIO_NO_SD_FS
 #include <SPI.h>
@@ -86,6 +87,7 @@ extern __attribute__((weak)) void audio_eof_speech(const char*);
 extern __attribute__((weak)) void audio_eof_stream(const char*); // The webstream comes to an end
 extern __attribute__((weak)) void audio_process_extern(int16_t* buff, uint16_t len, bool *continueI2S); // record audiodata or send via BT
 extern __attribute__((weak)) void audio_process_i2s(uint32_t* sample, bool *continueI2S); // record audiodata or send via BT
+extern __attribute__((weak)) void audio_process_block(int16_t* buff, uint16_t frames, bool *continueI2S); // L/R after EQ and volume, at getSampleRate()
 
 #define AUDIO_INFO(...) {char buff[512 + 64]; sprintf(buff,__VA_ARGS__); if(audio_info) audio_info(buff);}
 
@@ -201,12 +203,14 @@ public:
     uint32_t getAudioFileDuration();
     uint32_t getAudioCurrentTime();
     uint32_t getTotalPlayingTime();
+    void     getOutputStats(uint32_t* frames, uint32_t* i2sWrites, uint32_t* processUs); // running totals
 
     esp_err_t i2s_mclk_pin_select(const uint8_t pin);
     uint32_t inBufferFilled(); // returns the number of stored bytes in the inputbuffer
     uint32_t inBufferFree();   // returns the number of free bytes in the inputbuffer
     void setTone(int8_t gainLowPass, int8_t gainBandPass, int8_t gainHighPass);
     void setI2SCommFMT_LSB(bool commFMT);
+    void setI2SOutput(bool enable); // false: the I2S port is left alone, blocks go to audio_process_block() only
     int getCodec() {return m_codec;}
     const char *getCodecname() {return codecname[m_codec];}
 
@@ -256,9 +260,11 @@ private:
     bool setChannels(int channels);
     bool setBitrate(int br);
     bool playChunk();
+    bool playBlock(uint16_t frames);
     bool playSample(int16_t sample[2]) ;
     void playI2Sremains();
     int32_t Gain(int16_t s[2]);
+    void GainSteps(int32_t* volL, int32_t* volR);
     bool fill_InputBuf();
     void showstreamtitle(const char* ml);
     bool parseContentType(char* ct);
@@ -497,6 +503,7 @@ private:
     char*           m_playlistBuff = NULL;          // stores playlistdata
     const uint16_t  m_plsBuffEntryLen = 256;        // length of each entry in playlistBuff
     filter_t        m_filter[3];                    // digital filters
+    BiquadEQ        m_eq;                           // same filters in fixed point for playBlock()
     int             m_LFcount = 0;                  // Detection of end of header
     uint32_t        m_sampleRate=16000;
     uint32_t        m_bitRate=0;                    // current bitrate given fom decoder
@@ -517,6 +524,12 @@ private:
     uint8_t         m_streamType = ST_NONE;
     uint8_t         m_ID3Size = 0;                  // lengt of ID3frame - ID3header
     int16_t         m_outBuff[2048*2];              // Interleaved L/R
+    static const uint16_t m_blockFrames = 512;      // frames per i2s_write, one DMA buffer
+    int16_t         m_blockBuff[m_blockFrames*2];   // Interleaved L/R, converted from m_outBuff
+    uint32_t        m_i2sBuff[m_blockFrames];       // packed frames as written to I2S
+    uint32_t        m_framesOut = 0;                // output statistics, see getOutputStats()
+    uint32_t        m_i2sWrites = 0;
+    uint32_t        m_processUs = 0;
     int16_t         m_validSamples = 0;
     int16_t         m_curSample = 0;
     uint16_t        m_datamode = 0;                 // Statemaschine
@@ -552,6 +565,7 @@ private:
     bool            m_f_loop = false;               // Set if audio file should loop
     bool            m_f_forceMono = false;          // if true stereo -> mono
     bool            m_f_internalDAC = false;        // false: output vis I2S, true output via internal DAC
+    bool            m_f_i2sOutput = true;           // false: someone else owns the I2S port, see setI2SOutput()
     bool            m_f_rtsp = false;               // set if RTSP is used (m3u8 stream)
     bool            m_f_m3u8data = false;           // used in processM3U8entries
     bool            m_f_Log = false;                // set in platformio.ini  -DAUDIO_LOG and -DCORE_DEBUG_LEVEL=3 or 4
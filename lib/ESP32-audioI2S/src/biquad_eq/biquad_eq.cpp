@@ -0,0 +1,90 @@
+/*
+ * biquad_eq.cpp
+ *
+ * Created on: Oct 18,2026
+ *
+ *  Direct form I biquads, y = a0*x + a1*x1 + a2*x2 - b1*y1 - b2*y2
+ *  see https://www.earlevel.com/main/2012/11/26/biquad-c-source-code/
+ *
+ */
+#include "biquad_eq.h"
+
+static inline int32_t toFixed(float c) {
+    float f = c * (float)(1 << BIQUAD_EQ_COEF_BITS);
+    if(f >=  2147483647.0f) return INT32_MAX;
+    if(f <= -2147483648.0f) return INT32_MIN;
+    return (int32_t)lroundf(f);
+}
+
+static inline int16_t saturate16(int32_t v) {
+    if(v >  32767) return  32767;
+    if(v < -32768) return -32768;
+    return (int16_t)v;
+}
+//---------------------------------------------------------------------------------------------------------------------
+BiquadEQ::BiquadEQ() {
+    for(uint8_t i = 0; i < BIQUAD_EQ_STAGES; i++) {
+        m_active[i] = false;
+        setStage(i, 1, 0, 0, 0, 0, true);
+    }
+    reset();
+}
+//---------------------------------------------------------------------------------------------------------------------
+void BiquadEQ::setStage(uint8_t stage, float a0, float a1, float a2, float b1, float b2, bool flat) {
+    if(stage >= BIQUAD_EQ_STAGES) return;
+    m_coef[stage][0] = toFixed(a0);
+    m_coef[stage][1] = toFixed(a1);
+    m_coef[stage][2] = toFixed(a2);
+    m_coef[stage][3] = toFixed(b1);
+    m_coef[stage][4] = toFixed(b2);
+    if(!flat && !m_active[stage]) {
+        // the memory is stale from before the bypass
+        memset(m_state[stage], 0, sizeof(m_state[stage]));
+    }
+    m_active[stage] = !flat;
+}
+//---------------------------------------------------------------------------------------------------------------------
+void BiquadEQ::reset() {
+    memset(m_state, 0, sizeof(m_state));
+}
+//---------------------------------------------------------------------------------------------------------------------
+bool BiquadEQ::isFlat() {
+    for(uint8_t i = 0; i < BIQUAD_EQ_STAGES; i++) {
+        if(m_active[i]) return false;
+    }
+    return true;
+}
+//---------------------------------------------------------------------------------------------------------------------
+void BiquadEQ::process(int16_t* buff, uint16_t frames) {
+    for(uint8_t i = 0; i < BIQUAD_EQ_STAGES; i++) {
+        if(m_active[i]) processStage(i, buff, frames);
+    }
+}
+//---------------------------------------------------------------------------------------------------------------------
+void BiquadEQ::processStage(uint8_t stage, int16_t* buff, uint16_t frames) {
+    const int64_t a0 = m_coef[stage][0], a1 = m_coef[stage][1], a2 = m_coef[stage][2];
+    const int64_t b1 = m_coef[stage][3], b2 = m_coef[stage][4];
+    const int64_t round = (int64_t)1 << (BIQUAD_EQ_COEF_BITS - 1);
+    const int32_t mask  = (1 << BIQUAD_EQ_FRAC_BITS) - 1;
+
+    for(uint8_t ch = 0; ch < 2; ch++) {
+        int32_t* st = m_state[stage][ch];
+        int32_t x1 = st[0], x2 = st[1], y1 = st[2], y2 = st[3];
+        int16_t* s = buff + ch;
+        for(uint16_t i = 0; i < frames; i++, s += 2) {
+            int32_t x = *s;
+            int64_t acc = ((a0 * x + a1 * x1 + a2 * x2) << BIQUAD_EQ_FRAC_BITS) - b1 * y1 - b2 * y2;
+            acc = (acc + round) >> BIQUAD_EQ_COEF_BITS;
+            // 16 times full scale fits, only a broken coefficient set gets here
+            if(acc > INT32_MAX) acc = INT32_MAX;
+            if(acc < INT32_MIN) acc = INT32_MIN;
+            int32_t y = (int32_t)acc;
+            x2 = x1; x1 = x;
+            y2 = y1; y1 = y;
+            // toward zero like the (int16_t) cast of the float filters, the stages
+            // amplify each other's rounding otherwise
+            *s = saturate16((y + (y < 0 ? mask : 0)) >> BIQUAD_EQ_FRAC_BITS);
+        }
+        st[0] = x1; st[1] = x2; st[2] = y1; st[3] = y2;
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * biquad_eq.h
+ *
+ * Created on: Oct 18,2026
+ *
+ *  Fixed point block equalizer for Audio::setTone()
+ *
+ *  Three biquad stages (low shelf, peak EQ, high shelf) run one after the
+ *  other over a block of interleaved L/R frames, each stage over the whole
+ *  block before the next. Coefficients are the float ones from
+ *  Audio::IIR_calculateCoefficients() converted to Q29, samples are Q15 and
+ *  the filter output is kept with BIQUAD_EQ_FRAC_BITS more bits for the
+ *  feedback path; products add up in a 64 bit accumulator. Each stage stays
+ *  within one LSB of its float filter, the three chained within four LSB.
+ *
+ *  A stage set to 0 dB is skipped, with all three flat the block is left
+ *  untouched.
+ */
+#pragma once
+
+#include "Arduino.h"
+
+#define BIQUAD_EQ_STAGES        3
+#define BIQUAD_EQ_COEF_BITS     29      // Q29, coefficients between -4 and +4
+#define BIQUAD_EQ_FRAC_BITS     12      // extra bits of the fed back output
+
+class BiquadEQ {
+public:
+    BiquadEQ();
+    // a0, a1, a2, b1, b2 as in Audio::filter_t, `flat` stages are skipped
+    void setStage(uint8_t stage, float a0, float a1, float a2, float b1, float b2, bool flat);
+    void reset();                                   // clear the filter memory
+    bool isFlat();
+    void process(int16_t* buff, uint16_t frames);   // interleaved L/R, in place
+
+private:
+    void processStage(uint8_t stage, int16_t* buff, uint16_t frames);
+
+    int32_t  m_coef[BIQUAD_EQ_STAGES][5];           // a0, a1, a2, b1, b2
+    int32_t  m_state[BIQUAD_EQ_STAGES][2][4];       // per channel x1, x2, y1, y2
+    bool     m_active[BIQUAD_EQ_STAGES];
+};
@@ -1538,6 +1538,9 @@ void MP3Decoder_ClearBuffer(void) {
         heap_caps_malloc_prefer(size, 2, MALLOC_CAP_DEFAULT|MALLOC_CAP_INTERNAL, MALLOC_CAP_DEFAULT|MALLOC_CAP_SPIRAM)
 #endif
 
+// polyCoef shifted up by CSHIFT, in RAM rather than flash, for PolyphaseMonoFast() and PolyphaseStereoFast()
+static int polyCoefFast[264];
+
 bool MP3Decoder_AllocateBuffers(void) {
     if(!m_MP3DecInfo)       {m_MP3DecInfo    = (MP3DecInfo_t*)    __malloc_heap_psram(sizeof(MP3DecInfo_t)   );}
     if(!m_FrameHeader)      {m_FrameHeader   = (FrameHeader_t*)   __malloc_heap_psram(sizeof(FrameHeader_t)  );}
@@ -1555,6 +1558,7 @@ bool MP3Decoder_AllocateBuffers(void) {
         log_e("not enough memory to allocate mp3decoder buffers");
         return false;
     }
+    for(int i = 0; i < 264; i++) {polyCoefFast[i] = (int)(polyCoef[i] << m_CSHIFT);}
     MP3Decoder_ClearBuffer();
     return true;
 }
@@ -3444,9 +3448,13 @@ int Subband( short *pcmBuf) {
                     (b & 0x01), m_IMDCTInfo->gb[0]);
             FDCT32(m_IMDCTInfo->outBuf[1][b], m_SubbandInfo->vbuf + 1 * 32, m_SubbandInfo->vindex,
                     (b & 0x01), m_IMDCTInfo->gb[1]);
+#if MP3_FAST_KERNELS
+            PolyphaseStereoFast(pcmBuf, m_SubbandInfo->vbuf + m_SubbandInfo->vindex + m_VBUF_LENGTH * (b & 0x01));
+#else
             PolyphaseStereo(pcmBuf,
                     m_SubbandInfo->vbuf + m_SubbandInfo->vindex + m_VBUF_LENGTH * (b & 0x01),
                     polyCoef);
+#endif
             m_SubbandInfo->vindex = (m_SubbandInfo->vindex - (b & 0x01)) & 7;
             pcmBuf += (2 * m_NBANDS);
         }
@@ -3455,9 +3463,13 @@ int Subband( short *pcmBuf) {
         for (b = 0; b < m_BLOCK_SIZE; b++) {
             FDCT32(m_IMDCTInfo->outBuf[0][b], m_SubbandInfo->vbuf + 0 * 32, m_SubbandInfo->vindex,
                     (b & 0x01), m_IMDCTInfo->gb[0]);
+#if MP3_FAST_KERNELS
+            PolyphaseMonoFast(pcmBuf, m_SubbandInfo->vbuf + m_SubbandInfo->vindex + m_VBUF_LENGTH * (b & 0x01));
+#else
             PolyphaseMono(pcmBuf,
                     m_SubbandInfo->vbuf + m_SubbandInfo->vindex + m_VBUF_LENGTH * (b & 0x01),
                     polyCoef);
+#endif
             m_SubbandInfo->vindex = (m_SubbandInfo->vindex - (b & 0x01)) & 7;
             pcmBuf += m_NBANDS;
         }
@@ -3802,3 +3814,139 @@ void PolyphaseStereo(short *pcm, int *vbuf, const uint32_t *coefBase){
         pcm += 2;
     }
 }
+/***********************************************************************************************************************
+ * Function:    PolyphaseMonoFast
+ *
+ * Description: PolyphaseMono() with 32-bit accumulators
+ *
+ * Inputs:      pointer to PCM output buffer
+ *              pointer to start of vbuf (preserved from last call)
+ *
+ * Outputs:     32 samples of one channel of decoded PCM data, (i.e. Q16.0)
+ *
+ * Return:      none
+ *
+ * Notes:       polyCoefFast[] is polyCoef[] << CSHIFT, so the top 32 bits of each product are already
+ *                scaled like the 64-bit sums of PolyphaseMono() after SAR64(sum, 32 - CSHIFT)
+ *              one MULSHIFT32 and one add per tap, where MADD64 is a mull, a mulsh and a carry chain
+ *                on Xtensa
+ *              each product drops its low bits (-0.5 on average in the accumulator, 1/64 LSB of output),
+ *                the rounding constant adds that back for the 16 products of a sum; output is within
+ *                1 LSB of PolyphaseMono()
+ **********************************************************************************************************************/
+void PolyphaseMonoFast(short *pcm, int *vbuf){
+    const int fracBits = m_DQ_FRACBITS_OUT - 2 - 2 - 15;
+    const int rndVal = (1 << (fracBits - 1)) + 8;
+    const int *coef;
+    int *vb1;
+    int i, vLo, vHi, c1, c2, sum1L, sum2L;
+
+    /* special case, output sample 0 */
+    coef = polyCoefFast;
+    vb1 = vbuf;
+    sum1L = rndVal;
+    for(int j=0; j<8; j++){
+        c1=*coef++; c2=*coef++; vLo=vb1[j]; vHi=vb1[23-j];
+        sum1L += MULSHIFT32(vLo, c1); sum1L += MULSHIFT32(vHi, -c2);
+    }
+    pcm[0] = ClipToShort(sum1L, fracBits);
+
+    /* special case, output sample 16, 8 products */
+    coef = polyCoefFast + 256;
+    vb1 = vbuf + 64*16;
+    sum1L = rndVal - 4;
+    for(int j=0; j<8; j++){
+        c1=*coef++; vLo=vb1[j]; sum1L += MULSHIFT32(vLo, c1);
+    }
+    pcm[16] = ClipToShort(sum1L, fracBits);
+
+    /* main convolution loop: sum1L = samples 1, 2, 3, ... 15   sum2L = samples 31, 30, ... 17 */
+    coef = polyCoefFast + 16;
+    vb1 = vbuf + 64;
+    pcm++;
+
+    for (i = 15; i > 0; i--) {
+        sum1L = sum2L = rndVal;
+        for(int j=0; j<8; j++){
+            c1=*coef++; c2=*coef++; vLo=vb1[j]; vHi=vb1[23-j];
+            sum1L += MULSHIFT32(vLo,  c1); sum2L += MULSHIFT32(vLo, c2);
+            sum1L += MULSHIFT32(vHi, -c2); sum2L += MULSHIFT32(vHi, c1);
+        }
+        vb1 += 64;
+        pcm[0]   = ClipToShort(sum1L, fracBits);
+        pcm[2*i] = ClipToShort(sum2L, fracBits);
+        pcm++;
+    }
+}
+/***********************************************************************************************************************
+ * Function:    PolyphaseStereoFast
+ *
+ * Description: PolyphaseStereo() with 32-bit accumulators, see PolyphaseMonoFast()
+ *
+ * Inputs:      pointer to PCM output buffer
+ *              pointer to start of vbuf (preserved from last call)
+ *
+ * Outputs:     32 samples of two channels of decoded PCM data, (i.e. Q16.0)
+ *
+ * Return:      none
+ *
+ * Notes:       interleaves PCM samples LRLRLR...
+ **********************************************************************************************************************/
+void PolyphaseStereoFast(short *pcm, int *vbuf){
+    const int fracBits = m_DQ_FRACBITS_OUT - 2 - 2 - 15;
+    const int rndVal = (1 << (fracBits - 1)) + 8;
+    const int *coef;
+    int *vb1;
+    int i, vLo, vHi, c1, c2, sum1L, sum2L, sum1R, sum2R;
+
+    /* special case, output sample 0 */
+    coef = polyCoefFast;
+    vb1 = vbuf;
+    sum1L = sum1R = rndVal;
+    for(int j=0; j<8; j++){
+        c1=*coef++; c2=*coef++;
+        vLo=vb1[j]; vHi=vb1[23-j];
+        sum1L += MULSHIFT32(vLo, c1); sum1L += MULSHIFT32(vHi, -c2);
+        vLo=vb1[32+j]; vHi=vb1[32+23-j];
+        sum1R += MULSHIFT32(vLo, c1); sum1R += MULSHIFT32(vHi, -c2);
+    }
+    pcm[0] = ClipToShort(sum1L, fracBits);
+    pcm[1] = ClipToShort(sum1R, fracBits);
+
+    /* special case, output sample 16, 8 products */
+    coef = polyCoefFast + 256;
+    vb1 = vbuf + 64*16;
+    sum1L = sum1R = rndVal - 4;
+    for(int j=0; j<8; j++){
+        c1=*coef++;
+        sum1L += MULSHIFT32(vb1[j], c1);
+        sum1R += MULSHIFT32(vb1[32+j], c1);
+    }
+    pcm[2*16 + 0] = ClipToShort(sum1L, fracBits);
+    pcm[2*16 + 1] = ClipToShort(sum1R, fracBits);
+
+    /* main convolution loop: sum1L = samples 1, 2, 3, ... 15   sum2L = samples 31, 30, ... 17 */
+    coef = polyCoefFast + 16;
+    vb1 = vbuf + 64;
+    pcm += 2;
+
+    for (i = 15; i > 0; i--) {
+        sum1L = sum2L = rndVal;
+        sum1R = sum2R = rndVal;
+        for(int j=0; j<8; j++){
+            c1=*coef++; c2=*coef++;
+            vLo=vb1[j]; vHi=vb1[23-j];
+            sum1L += MULSHIFT32(vLo,  c1); sum2L += MULSHIFT32(vLo, c2);
+            sum1L += MULSHIFT32(vHi, -c2); sum2L += MULSHIFT32(vHi, c1);
+            vLo=vb1[32+j]; vHi=vb1[32+23-j];
+            sum1R += MULSHIFT32(vLo,  c1); sum2R += MULSHIFT32(vLo, c2);
+            sum1R += MULSHIFT32(vHi, -c2); sum2R += MULSHIFT32(vHi, c1);
+        }
+        vb1 += 64;
+        pcm[0]         = ClipToShort(sum1L, fracBits);
+        pcm[1]         = ClipToShort(sum1R, fracBits);
+        pcm[2*2*i + 0] = ClipToShort(sum2L, fracBits);
+        pcm[2*2*i + 1] = ClipToShort(sum2R, fracBits);
+        pcm += 2;
+    }
+}
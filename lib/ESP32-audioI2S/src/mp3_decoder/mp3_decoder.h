@@ -453,6 +453,16 @@ const uint32_t csa[8][2] PROGMEM = {
  * polyCoef[256, 257, ... 263] are for special case of sample 16 (out of 0)
  *   see PolyphaseStereo() and PolyphaseMono()
  */
+extern const uint32_t polyCoef[264];
+
+/* MP3_FAST_KERNELS selects the synthesis filterbank with 32-bit accumulators (PolyphaseMonoFast(),
+ * PolyphaseStereoFast()) and, on Xtensa, makes MULSHIFT32 - the multiply of the IMDCT, the DCT and
+ * dequantization - a single mulsh instruction.
+ * Build with -DMP3_FAST_KERNELS=0 for the original Helix kernels.
+ */
+#ifndef MP3_FAST_KERNELS
+#define MP3_FAST_KERNELS 1
+#endif
 
 // prototypes
 bool MP3Decoder_AllocateBuffers(void);
@@ -471,6 +481,8 @@ int  MP3GetOutputSamps();
 void MP3Decoder_ClearBuffer(void);
 void PolyphaseMono(short *pcm, int *vbuf, const uint32_t *coefBase);
 void PolyphaseStereo(short *pcm, int *vbuf, const uint32_t *coefBase);
+void PolyphaseMonoFast(short *pcm, int *vbuf);
+void PolyphaseStereoFast(short *pcm, int *vbuf);
 void SetBitstreamPointer(BitStreamInfo_t *bsi, int nBytes, unsigned char *buf);
 unsigned int GetBits(BitStreamInfo_t *bsi, int nBits);
 int CalcBitsUsed(BitStreamInfo_t *bsi, unsigned char *startBuf, int startOffset);
@@ -506,7 +518,11 @@ void imdct12(int *x, int *out);
 int IMDCT12x3(int *xCurr, int *xPrev, int *y, int btPrev, int blockIdx, int gb);
 int HybridTransform(int *xCurr, int *xPrev, int y[m_BLOCK_SIZE][m_NBANDS], SideInfoSub_t *sis, BlockCount_t *bc);
 inline uint64_t SAR64(uint64_t x, int n) {return x >> n;}
+#if MP3_FAST_KERNELS && defined(__XTENSA__)
+inline int MULSHIFT32(int x, int y) { int z; asm ("mulsh %0, %1, %2" : "=a" (z) : "a" (x), "a" (y)); return z;}
+#else
 inline int MULSHIFT32(int x, int y) { int z; z = (uint64_t) x * (uint64_t) y >> 32; return z;}
+#endif
 inline uint64_t MADD64(uint64_t sum64, int x, int y) {sum64 += (uint64_t) x * (uint64_t) y; return sum64;}/* returns 64-bit value in [edx:eax] */
 inline uint64_t xSAR64(uint64_t x, int n){return x >> n;}
 inline int FASTABS(int x){ return __builtin_abs(x);} //xtensa has a fast abs instruction //fb
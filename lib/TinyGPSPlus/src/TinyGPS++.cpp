@@ -69,7 +69,7 @@ bool TinyGPSPlus::encode(char c)
       if (curTermOffset < sizeof(term))
       {
         term[curTermOffset] = 0;
-        isValidSentence = endOfTermHandler();
+        isValidSentence = endOfTermHandler(term, curTermOffset);
       }
       ++curTermNumber;
       curTermOffset = 0;
@@ -97,6 +97,155 @@ bool TinyGPSPlus::encode(char c)
   return false;
 }
 
+// Word-at-a-time byte tests, a word is 4 bytes on the ESP32 and 8 on a host
+typedef unsigned long gpsword_t;
+static const gpsword_t ONES = ~(gpsword_t)0 / 0xFF;
+static const gpsword_t HIGHS = ONES * 0x80;
+
+// 0x80 in every byte of w equal to b
+static inline gpsword_t matchBytes(gpsword_t w, uint8_t b)
+{
+  gpsword_t v = w ^ (ONES * b);
+  return ~(((v & ~HIGHS) + ~HIGHS) | v) & HIGHS;
+}
+
+// Nonzero if any byte of w is a control character, '*' or '$'
+static inline gpsword_t endsBodyWord(gpsword_t w)
+{
+  gpsword_t star = w ^ (ONES * '*');
+  gpsword_t dollar = w ^ (ONES * '$');
+  return ((w - ONES * 0x20) | (star - ONES) | (dollar - ONES)) & ~w & HIGHS;
+}
+
+static inline bool endsBody(char c)
+{
+  return c == '*' || c == '\r' || c == '\n' || c == '$';
+}
+
+// Scans a sentence body from just after '$' to the first '*', CR, LF or '$',
+// or to end. Returns where it stopped, with the XOR of the bytes before it
+// and the number of commas among them. Aligned words of printable bytes
+// other than '*' and '$' are handled a word at a time.
+static const char *scanBody(const char *p, const char *end, uint8_t &parity, uint32_t &commas)
+{
+  gpsword_t acc = 0;
+
+  for (;;)
+  {
+    while (end - p >= (ptrdiff_t)sizeof(gpsword_t) && !((uintptr_t)p & (sizeof(gpsword_t) - 1)))
+    {
+      gpsword_t w;
+      memcpy(&w, __builtin_assume_aligned(p, sizeof(gpsword_t)), sizeof(gpsword_t));
+      if (endsBodyWord(w))
+        break;
+      commas += (matchBytes(w, ',') >> 7) * ONES >> (8 * sizeof(gpsword_t) - 8);
+      acc ^= w;
+      p += sizeof(gpsword_t);
+    }
+
+    // Byte by byte up to the next aligned word, or through the tail
+    const char *stop = p + sizeof(gpsword_t) - ((uintptr_t)p & (sizeof(gpsword_t) - 1));
+    if (stop > end)
+      stop = end;
+    for (; p < stop; ++p)
+    {
+      if (endsBody(*p))
+        goto done;
+      commas += *p == ',';
+      parity ^= *p;
+    }
+    if (p == end)
+      break;
+  }
+
+done:
+  for (unsigned shift = 8 * sizeof(gpsword_t) / 2; shift >= 8; shift /= 2)
+    acc ^= acc >> shift;
+  parity ^= (uint8_t)acc;
+  return p;
+}
+
+// Same result as calling encode(char) for every byte. A sentence whose body
+// up to '*' is complete in the block is checksummed a word at a time, then
+// split on commas. Its fields are parsed straight from the block when they
+// fit the term buffer, the parsers stop at the delimiter. The sentence type
+// and custom fields still go through the term buffer, they rely on its
+// terminator, and the fields of sentences nobody listens to are skipped.
+// Anything else, like the checksum digits or a sentence cut by the end of
+// the block, goes through encode(char).
+size_t TinyGPSPlus::encode(const char *buf, size_t len)
+{
+  const char *p = buf;
+  const char *end = buf + len;
+  size_t validSentences = 0;
+
+  while (p < end)
+  {
+    if (*p == '$')
+    {
+      uint8_t bodyParity = 0;
+      uint32_t commas = 0;
+      const char *star = scanBody(p + 1, end, bodyParity, commas);
+      // Past 255 terms the term number wraps, leave that to encode(char)
+      if (star < end && *star == '*' && commas < 0xFF)
+      {
+        encodeBody(p + 1, star, (uint8_t)commas);
+        parity = bodyParity;
+        encodedCharCount += star - p + 1;
+        p = star + 1;
+        continue;
+      }
+    }
+    if (encode(*p++))
+      ++validSentences;
+  }
+
+  return validSentences;
+}
+
+// encode(char) for "$<body>*", without the checksum the caller computed
+void TinyGPSPlus::encodeBody(const char *body, const char *star, uint8_t commas)
+{
+  curTermNumber = curTermOffset = 0;
+  curSentenceType = GPS_SENTENCE_OTHER;
+  isChecksumTerm = false;
+  sentenceHasFix = false;
+
+  const char *t = body;
+  for (;;)
+  {
+    const char *delim = curTermNumber < commas ? (const char *)memchr(t, ',', star - t) : star;
+    size_t n = delim - t;
+
+    if (curTermNumber == 0 || customCandidates != NULL || n >= sizeof(term))
+    {
+      size_t copy = n < sizeof(term) - 1 ? n : sizeof(term) - 1;
+      memcpy(term, t, copy);
+      term[copy] = 0;
+      endOfTermHandler(term, (uint8_t)copy);
+    }
+    else if (curSentenceType != GPS_SENTENCE_OTHER)
+    {
+      endOfTermHandler(t, (uint8_t)n);
+    }
+    else
+    {
+      // Nothing to parse in the remaining terms, only count them
+      curTermNumber = commas;
+      break;
+    }
+
+    if (delim == star)
+      break;
+    ++curTermNumber;
+    t = delim + 1;
+  }
+
+  // The '*' ends the last term
+  ++curTermNumber;
+  isChecksumTerm = true;
+}
+
 //
 // internal utilities
 //
@@ -154,14 +303,21 @@ void TinyGPSPlus::parseDegrees(const char *term, RawDegrees &deg)
 
 #define COMBINE(sentence_type, term_number) (((unsigned)(sentence_type) << 5) | term_number)
 
-// Processes a just-completed term
+// Processes a just-completed term, either the NUL terminated term buffer or a
+// span of the input ending at ',' or '*' (see encode(const char *, size_t))
 // Returns true if new sentence has just passed checksum test and is validated
-bool TinyGPSPlus::endOfTermHandler()
+bool TinyGPSPlus::endOfTermHandler(const char *t, uint8_t len)
 {
   // If it's the checksum term, and the checksum checks out, commit
   if (isChecksumTerm)
   {
-    byte checksum = 16 * fromHex(term[0]) + fromHex(term[1]);
+    // Both digits are needed, anything shorter is a corrupt sentence
+    if (len < 2)
+    {
+      ++failedChecksumCount;
+      return false;
+    }
+    byte checksum = 16 * fromHex(t[0]) + fromHex(t[1]);
     if (checksum == parity)
     {
       passedChecksumCount++;
@@ -209,74 +365,74 @@ bool TinyGPSPlus::endOfTermHandler()
   // the first term determines the sentence type
   if (curTermNumber == 0)
   {
-    if (!strcmp(term, _GPRMCterm) || !strcmp(term, _GNRMCterm))
+    if (!strcmp(t, _GPRMCterm) || !strcmp(t, _GNRMCterm))
       curSentenceType = GPS_SENTENCE_GPRMC;
-    else if (!strcmp(term, _GPGGAterm) || !strcmp(term, _GNGGAterm))
+    else if (!strcmp(t, _GPGGAterm) || !strcmp(t, _GNGGAterm))
       curSentenceType = GPS_SENTENCE_GPGGA;
     else
       curSentenceType = GPS_SENTENCE_OTHER;
 
     // Any custom candidates of this sentence type?
-    for (customCandidates = customElts; customCandidates != NULL && strcmp(customCandidates->sentenceName, term) < 0; customCandidates = customCandidates->next);
-    if (customCandidates != NULL && strcmp(customCandidates->sentenceName, term) > 0)
+    for (customCandidates = customElts; customCandidates != NULL && strcmp(customCandidates->sentenceName, t) < 0; customCandidates = customCandidates->next);
+    if (customCandidates != NULL && strcmp(customCandidates->sentenceName, t) > 0)
        customCandidates = NULL;
 
     return false;
   }
 
-  if (curSentenceType != GPS_SENTENCE_OTHER && term[0])
+  if (curSentenceType != GPS_SENTENCE_OTHER && len && t[0])
     switch(COMBINE(curSentenceType, curTermNumber))
   {
     case COMBINE(GPS_SENTENCE_GPRMC, 1): // Time in both sentences
     case COMBINE(GPS_SENTENCE_GPGGA, 1):
-      time.setTime(term);
+      time.setTime(t);
       break;
     case COMBINE(GPS_SENTENCE_GPRMC, 2): // GPRMC validity
-      sentenceHasFix = term[0] == 'A';
+      sentenceHasFix = t[0] == 'A';
       break;
     case COMBINE(GPS_SENTENCE_GPRMC, 3): // Latitude
     case COMBINE(GPS_SENTENCE_GPGGA, 2):
-      location.setLatitude(term);
+      location.setLatitude(t);
       break;
     case COMBINE(GPS_SENTENCE_GPRMC, 4): // N/S
     case COMBINE(GPS_SENTENCE_GPGGA, 3):
-      location.rawNewLatData.negative = term[0] == 'S';
+      location.rawNewLatData.negative = t[0] == 'S';
       break;
     case COMBINE(GPS_SENTENCE_GPRMC, 5): // Longitude
     case COMBINE(GPS_SENTENCE_GPGGA, 4):
-      location.setLongitude(term);
+      location.setLongitude(t);
       break;
     case COMBINE(GPS_SENTENCE_GPRMC, 6): // E/W
     case COMBINE(GPS_SENTENCE_GPGGA, 5):
-      location.rawNewLngData.negative = term[0] == 'W';
+      location.rawNewLngData.negative = t[0] == 'W';
       break;
     case COMBINE(GPS_SENTENCE_GPRMC, 7): // Speed (GPRMC)
-      speed.set(term);
+      speed.set(t);
       break;
     case COMBINE(GPS_SENTENCE_GPRMC, 8): // Course (GPRMC)
-      course.set(term);
+      course.set(t);
       break;
     case COMBINE(GPS_SENTENCE_GPRMC, 9): // Date (GPRMC)
-      date.setDate(term);
+      date.setDate(t);
       break;
     case COMBINE(GPS_SENTENCE_GPGGA, 6): // Fix data (GPGGA)
-      sentenceHasFix = term[0] > '0';
+      sentenceHasFix = t[0] > '0';
       break;
     case COMBINE(GPS_SENTENCE_GPGGA, 7): // Satellites used (GPGGA)
-      satellites.set(term);
+      satellites.set(t);
       break;
     case COMBINE(GPS_SENTENCE_GPGGA, 8): // HDOP
-      hdop.set(term);
+      hdop.set(t);
       break;
     case COMBINE(GPS_SENTENCE_GPGGA, 9): // Altitude (GPGGA)
-      altitude.set(term);
+      altitude.set(t);
       break;
   }
 
   // Set custom values as needed
   for (TinyGPSCustom *p = customCandidates; p != NULL && strcmp(p->sentenceName, customCandidates->sentenceName) == 0 && p->termNumber <= curTermNumber; p = p->next)
     if (p->termNumber == curTermNumber)
-         p->set(term);
+         p->set(t);
 
   return false;
 }
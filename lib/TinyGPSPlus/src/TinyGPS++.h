@@ -221,6 +221,7 @@ class TinyGPSPlus
 public:
   TinyGPSPlus();
   bool encode(char c); // process one character received from GPS
+  size_t encode(const char *buf, size_t len); // process a block, returns sentences validated
   TinyGPSPlus &operator << (char c) {encode(c); return *this;}
 
   TinyGPSLocation location;
@@ -272,7 +273,8 @@ private:
 
   // internal utilities
   int fromHex(char a);
-  bool endOfTermHandler();
+  bool endOfTermHandler(const char *t, uint8_t len);
+  void encodeBody(const char *body, const char *star, uint8_t commas);
 };
 
 #endif // def(__TinyGPSPlus_h)
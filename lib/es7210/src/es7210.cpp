@@ -365,6 +365,12 @@ esp_err_t es7210_config_fmt(audio_hal_iface_format_t fmt)
     return ret;
 }
 
+esp_err_t es7210_adc_set_tdm(bool enable)
+{
+    /* TDM puts ADC1..4 in consecutive slots on SDOUT1, otherwise ADC3/4 go to SDOUT2 */
+    return es7210_write_reg(ES7210_SDP_INTERFACE2_REG12, enable ? 0x02 : 0x00);
+}
+
 esp_err_t es7210_set_bits(audio_hal_iface_bits_t bits)
 {
     esp_err_t ret = ESP_OK;
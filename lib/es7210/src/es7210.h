@@ -241,6 +241,19 @@ esp_err_t es7210_set_mute(bool enable);
  */
 esp_err_t es7210_mic_select(es7210_input_mics_t mic);
 
+/**
+ * @brief Output all four ADC channels as TDM slots on SDOUT1
+ *
+ * Call after es7210_adc_config_i2s(), which selects the two line layout.
+ *
+ * @param[in] enable:  TDM when true, two stereo lines when false
+ *
+ * @return
+ *     - ESP_FAIL
+ *     - ESP_OK
+ */
+esp_err_t es7210_adc_set_tdm(bool enable);
+
 /**
  * @brief Read regs of ES7210
  *
@@ -0,0 +1,453 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <math.h>
+#include "acoustic_events.h"
+
+#define ACOUSTIC_TEST_RATE      16000
+#define ACOUSTIC_TEST_FRAME     480             // The VAD's 30 ms
+#define ACOUSTIC_TEST_DIR       "/acoustic"     // Labelled recordings, <label>_<anything>.wav
+#define ACOUSTIC_TEST_SECONDS   3
+#define ACOUSTIC_TEST_FILES     12              // Synthetic files per label
+#define ACOUSTIC_TEST_LEAD      9600            // Background before the event, 0.6 s
+#define ACOUSTIC_TEST_BUDGET_US 30000           // Per second of audio, 3 % of a core
+#define ACOUSTIC_TEST_MIN_SCORE 80              // Percent precision and recall on the held-out set
+#define ACOUSTIC_TEST_SALT      0x5bd1e995u     // Seeds the held-out set away from the tuning set
+
+// "other" files hold sounds that are none of the classes
+static const char *const acoustic_test_labels[ACOUSTIC_CLASS_MAX] = { "other", "glass", "impact", "voice" };
+
+static int16_t  acoustic_test_pcm[ACOUSTIC_TEST_SECONDS * ACOUSTIC_TEST_RATE];
+static bool     acoustic_test_voiced[ACOUSTIC_TEST_SECONDS * ACOUSTIC_TEST_RATE];
+static uint32_t acoustic_test_seed;
+
+static acoustic_event_t acoustic_test_loudest;
+static uint32_t         acoustic_test_events;
+
+static float acoustic_test_random(void)
+{
+    acoustic_test_seed = acoustic_test_seed * 1664525u + 1013904223u;
+    return (acoustic_test_seed >> 8) / 16777216.0f;
+}
+
+static float acoustic_test_range(float lo, float hi)
+{
+    return lo + (hi - lo) * acoustic_test_random();
+}
+
+static float acoustic_test_noise(float amplitude)
+{
+    return amplitude * (acoustic_test_random() + acoustic_test_random() + acoustic_test_random() +
+                        acoustic_test_random() - 2.0f);
+}
+
+static void acoustic_test_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void acoustic_test_put32(uint8_t *p, uint32_t v)
+{
+    acoustic_test_put16(p, v);
+    acoustic_test_put16(p + 2, v >> 16);
+}
+
+// Damped sine starting at `at`
+static void acoustic_test_ring(float *out, uint32_t at, float hz, float amplitude, float tau)
+{
+    float phase = acoustic_test_range(0, 2 * (float)M_PI);
+    uint32_t end = at + (uint32_t)(6 * tau * ACOUSTIC_TEST_RATE);
+    for (uint32_t n = at; n < end && n < ACOUSTIC_TEST_SECONDS * ACOUSTIC_TEST_RATE; n++) {
+        float t = (float)(n - at) / ACOUSTIC_TEST_RATE;
+        out[n] += amplitude * expf(-t / tau) * sinf(2 * (float)M_PI * hz * t + phase);
+    }
+}
+
+// Noise burst, smoothed over `smooth` samples to move it down in frequency,
+// or differenced to move it up when `smooth` is 0
+static void acoustic_test_burst(float *out, uint32_t at, float amplitude, float tau, int smooth)
+{
+    float prev = 0, avg = 0;
+    uint32_t end = at + (uint32_t)(5 * tau * ACOUSTIC_TEST_RATE);
+    for (uint32_t n = at; n < end && n < ACOUSTIC_TEST_SECONDS * ACOUSTIC_TEST_RATE; n++) {
+        float t = (float)(n - at) / ACOUSTIC_TEST_RATE;
+        float v = acoustic_test_noise(amplitude);
+        float s;
+        if (smooth) {
+            avg += (v - avg) / smooth;
+            s = avg * 2;
+        } else {
+            s = (v - prev) * 0.7f;
+            prev = v;
+        }
+        out[n] += s * expf(-t / tau);
+    }
+}
+
+// Breaking pane: a bright crack, then the shards ringing high and falling
+static void acoustic_test_glass(float *out)
+{
+    float a = acoustic_test_range(6000, 16000);
+    acoustic_test_burst(out, ACOUSTIC_TEST_LEAD, a, 0.004f, 0);
+    int partials = 6 + (int)acoustic_test_range(0, 6);
+    for (int i = 0; i < partials; i++) {
+        acoustic_test_ring(out, ACOUSTIC_TEST_LEAD, acoustic_test_range(2500, 7500), a * acoustic_test_range(0.1f, 0.4f),
+                           acoustic_test_range(0.04f, 0.3f));
+    }
+    int shards = 3 + (int)acoustic_test_range(0, 5);
+    for (int s = 0; s < shards; s++) {
+        uint32_t at = ACOUSTIC_TEST_LEAD + (uint32_t)(acoustic_test_range(0.1f, 0.8f) * ACOUSTIC_TEST_RATE);
+        acoustic_test_burst(out, at, a * 0.2f, 0.002f, 0);
+        for (int i = 0; i < 4; i++) {
+            acoustic_test_ring(out, at, acoustic_test_range(3000, 7500), a * acoustic_test_range(0.05f, 0.2f),
+                               acoustic_test_range(0.02f, 0.1f));
+        }
+    }
+}
+
+// Door slam or a blow on the wall: a dull thump with a short click
+static void acoustic_test_impact(float *out)
+{
+    float a = acoustic_test_range(6000, 20000);
+    for (int i = 0; i < 3; i++) {
+        acoustic_test_ring(out, ACOUSTIC_TEST_LEAD, acoustic_test_range(50, 300), a * acoustic_test_range(0.3f, 0.7f),
+                           acoustic_test_range(0.02f, 0.08f));
+    }
+    acoustic_test_burst(out, ACOUSTIC_TEST_LEAD, a * 0.4f, acoustic_test_range(0.01f, 0.04f), 8);
+    acoustic_test_burst(out, ACOUSTIC_TEST_LEAD, a * 0.1f, 0.003f, 2);
+}
+
+// A few syllables of a voice: harmonics of a drifting pitch shaped by
+// three formants, with a fricative now and then
+static void acoustic_test_voice(float *out)
+{
+    float a = acoustic_test_range(1500, 6000);
+    float f0 = acoustic_test_range(100, 240);
+    uint32_t at = ACOUSTIC_TEST_LEAD;
+    int syllables = 3 + (int)acoustic_test_range(0, 4);
+    for (int s = 0; s < syllables; s++) {
+        uint32_t len = (uint32_t)(acoustic_test_range(0.12f, 0.3f) * ACOUSTIC_TEST_RATE);
+        float formant[3] = { acoustic_test_range(300, 800), acoustic_test_range(900, 2200), acoustic_test_range(2300, 3000) };
+        float pitch = f0 * acoustic_test_range(0.9f, 1.1f), glide = acoustic_test_range(-0.2f, 0.2f);
+        if (acoustic_test_random() < 0.3f) {
+            acoustic_test_burst(out, at, a * 0.3f, 0.02f, 0);
+        }
+        float phase = 0;
+        for (uint32_t n = 0; n < len && at + n < ACOUSTIC_TEST_SECONDS * ACOUSTIC_TEST_RATE; n++) {
+            float t = (float)n / len;
+            float hz = pitch * (1 + glide * t);
+            phase += 2 * (float)M_PI * hz / ACOUSTIC_TEST_RATE;
+            float env = sinf((float)M_PI * t);
+            float v = 0;
+            for (int k = 1; k * hz < 4000; k++) {
+                float g = 0;
+                for (int f = 0; f < 3; f++) {
+                    float d = (k * hz - formant[f]) / 150.0f;
+                    g += expf(-d * d) / (f + 1);
+                }
+                v += (g + 0.05f) * sinf(k * phase);
+            }
+            out[at + n] += a * env * v * 0.5f;
+            acoustic_test_voiced[at + n] = env > 0.3f;
+        }
+        at += len + (uint32_t)(acoustic_test_range(0.04f, 0.12f) * ACOUSTIC_TEST_RATE);
+    }
+}
+
+// Not an event for any class: a beep, a gust of hiss, mains hum, quiet
+static void acoustic_test_other(float *out, int kind)
+{
+    float a = acoustic_test_range(3000, 8000);
+    uint32_t len = (uint32_t)(acoustic_test_range(0.3f, 0.9f) * ACOUSTIC_TEST_RATE);
+    float hz = acoustic_test_range(800, 3000);
+    for (uint32_t n = 0; n < len; n++) {
+        float t = (float)n / ACOUSTIC_TEST_RATE;
+        float v = 0;
+        switch (kind % 4) {
+        case 0:
+            v = a * sinf(2 * (float)M_PI * hz * t);
+            break;
+        case 1:
+            v = acoustic_test_noise(a * 0.5f) * sinf((float)M_PI * n / len);
+            break;
+        case 2:
+            for (int k = 1; k <= 5; k++) {
+                v += a / k / 2 * sinf(2 * (float)M_PI * 50 * k * t);
+            }
+            v *= sinf((float)M_PI * n / len);
+            break;
+        default:
+            break;
+        }
+        out[ACOUSTIC_TEST_LEAD + n] += v;
+    }
+}
+
+// The prototypes were fitted on the tuning set. The held-out set draws from
+// other seeds over a louder background, and is the only one scored.
+static void acoustic_test_render(uint8_t label, int index, bool held_out, const char *path)
+{
+    static float mix[ACOUSTIC_TEST_SECONDS * ACOUSTIC_TEST_RATE];
+    const uint32_t frames = ACOUSTIC_TEST_SECONDS * ACOUSTIC_TEST_RATE;
+    acoustic_test_seed = 7919u * (label + 1) + 104729u * index;
+    if (held_out) {
+        acoustic_test_seed ^= ACOUSTIC_TEST_SALT;
+    }
+    memset(acoustic_test_voiced, 0, sizeof(acoustic_test_voiced));
+    float background = held_out ? acoustic_test_range(100, 400) : acoustic_test_range(40, 200);
+    for (uint32_t n = 0; n < frames; n++) {
+        mix[n] = acoustic_test_noise(background);
+    }
+    switch (label) {
+    case ACOUSTIC_GLASS:
+        acoustic_test_glass(mix);
+        break;
+    case ACOUSTIC_IMPACT:
+        acoustic_test_impact(mix);
+        break;
+    case ACOUSTIC_VOICE:
+        acoustic_test_voice(mix);
+        break;
+    default:
+        acoustic_test_other(mix, index);
+        break;
+    }
+    for (uint32_t n = 0; n < frames; n++) {
+        acoustic_test_pcm[n] = (int16_t)constrain(lroundf(mix[n]), -32768L, 32767L);
+    }
+
+    uint32_t data_len = frames * 2;
+    uint8_t hdr[44];
+    memcpy(hdr, "RIFF", 4);
+    acoustic_test_put32(hdr + 4, 36 + data_len);
+    memcpy(hdr + 8, "WAVEfmt ", 8);
+    acoustic_test_put32(hdr + 16, 16);
+    acoustic_test_put16(hdr + 20, 1);
+    acoustic_test_put16(hdr + 22, 1);
+    acoustic_test_put32(hdr + 24, ACOUSTIC_TEST_RATE);
+    acoustic_test_put32(hdr + 28, ACOUSTIC_TEST_RATE * 2);
+    acoustic_test_put16(hdr + 32, 2);
+    acoustic_test_put16(hdr + 34, 16);
+    memcpy(hdr + 36, "data", 4);
+    acoustic_test_put32(hdr + 40, data_len);
+
+    File file = SPIFFS.open(path, FILE_WRITE);
+    TEST_ASSERT_TRUE((bool)file);
+    TEST_ASSERT_EQUAL(sizeof(hdr), file.write(hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL(data_len, file.write((const uint8_t *)acoustic_test_pcm, data_len));
+    file.close();
+}
+
+static void acoustic_test_sink(const acoustic_event_t *event)
+{
+    acoustic_test_events++;
+    if (acoustic_test_loudest.cls == ACOUSTIC_NONE ||
+            event->features[ACOUSTIC_F_LEVEL] > acoustic_test_loudest.features[ACOUSTIC_F_LEVEL]) {
+        acoustic_test_loudest = *event;
+    }
+}
+
+// Replay a mono 16 bit WAV in VAD frames. esp_vad is not on the host: the
+// voiced samples of a synthetic voice stand in for it, with misses and
+// false alarms, and recordings are replayed without it. Returns the class
+// of the loudest event, ACOUSTIC_NONE when nothing was detected, or -1 for
+// a file that cannot be replayed.
+static int acoustic_test_replay(const char *path, bool synthetic)
+{
+    File file = SPIFFS.open(path, FILE_READ);
+    if (!file) {
+        return -1;
+    }
+    uint8_t hdr[12];
+    if (file.read(hdr, 12) != 12 || memcmp(hdr, "RIFF", 4) || memcmp(hdr + 8, "WAVE", 4)) {
+        return -1;
+    }
+    uint32_t rate = 0, data_len = 0;
+    uint16_t channels = 0, bits = 0;
+    uint8_t chunk[8];
+    while (file.read(chunk, 8) == 8) {
+        uint32_t len = chunk[4] | chunk[5] << 8 | chunk[6] << 16 | (uint32_t)chunk[7] << 24;
+        if (!memcmp(chunk, "fmt ", 4)) {
+            uint8_t fmt[16];
+            if (len < 16 || file.read(fmt, 16) != 16 || (fmt[0] | fmt[1] << 8) != 1) {
+                return -1;
+            }
+            channels = fmt[2] | fmt[3] << 8;
+            rate = fmt[4] | fmt[5] << 8 | fmt[6] << 16 | (uint32_t)fmt[7] << 24;
+            bits = fmt[14] | fmt[15] << 8;
+            file.seek(file.position() + len - 16);
+        } else if (!memcmp(chunk, "data", 4)) {
+            data_len = len;
+            break;
+        } else {
+            file.seek(file.position() + len + (len & 1));
+        }
+    }
+    if (channels != 1 || bits != 16 || !data_len || !acoustic_events_begin(rate)) {
+        return -1;
+    }
+
+    acoustic_events_set_sink(acoustic_test_sink);
+    memset(&acoustic_test_loudest, 0, sizeof(acoustic_test_loudest));
+    size_t frame_len = rate * 30 / 1000;
+    static int16_t frame[ACOUSTIC_FRAME_MAX];
+    uint32_t pos = 0;
+    while (file.read((uint8_t *)frame, frame_len * 2) == frame_len * 2) {
+        bool speech = false;
+        if (synthetic) {
+            speech = acoustic_test_voiced[pos + frame_len / 2] ? acoustic_test_random() < 0.85f
+                                                               : acoustic_test_random() < 0.03f;
+        }
+        acoustic_events_frame(frame, frame_len, speech);
+        pos += frame_len;
+    }
+    file.close();
+    return acoustic_test_loudest.cls;
+}
+
+void test_acoustic_features(void)
+{
+    static int16_t samples[ACOUSTIC_TEST_FRAME];
+    acoustic_frame_t frame;
+    TEST_ASSERT_TRUE(acoustic_events_begin(ACOUSTIC_TEST_RATE));
+
+    // Half scale 1 kHz: -9 dBFS, 60 crossings, most of it in one band
+    for (int n = 0; n < ACOUSTIC_TEST_FRAME; n++) {
+        samples[n] = (int16_t)(16384 * sinf(2 * (float)M_PI * 1000 * (n + 0.5f) / ACOUSTIC_TEST_RATE));
+    }
+    acoustic_frame_features(samples, ACOUSTIC_TEST_FRAME, &frame);
+    TEST_ASSERT_INT_WITHIN(64, -9 * 256, frame.energy_db);
+    TEST_ASSERT_INT_WITHIN(1, 60, frame.zero_crossings);
+    int loudest = 0;
+    for (int b = 1; b < ACOUSTIC_BANDS; b++) {
+        if (frame.bands[b] > frame.bands[loudest]) {
+            loudest = b;
+        }
+    }
+    TEST_ASSERT_INT_WITHIN(4 * 256, frame.energy_db, frame.bands[loudest]);
+    TEST_ASSERT_TRUE(frame.bands[0] < frame.bands[loudest] - 30 * 256);
+    TEST_ASSERT_TRUE(frame.bands[ACOUSTIC_BANDS - 1] < frame.bands[loudest] - 30 * 256);
+
+    // An octave up is further up the bands
+    for (int n = 0; n < ACOUSTIC_TEST_FRAME; n++) {
+        samples[n] = (int16_t)(16384 * sinf(2 * (float)M_PI * 2000 * (n + 0.5f) / ACOUSTIC_TEST_RATE));
+    }
+    acoustic_frame_features(samples, ACOUSTIC_TEST_FRAME, &frame);
+    int octave = 0;
+    for (int b = 1; b < ACOUSTIC_BANDS; b++) {
+        if (frame.bands[b] > frame.bands[octave]) {
+            octave = b;
+        }
+    }
+    TEST_ASSERT_TRUE(octave > loudest + 2);
+
+    // White noise crosses zero about every other sample
+    acoustic_test_seed = 1;
+    for (int n = 0; n < ACOUSTIC_TEST_FRAME; n++) {
+        samples[n] = (int16_t)acoustic_test_noise(4000);
+    }
+    acoustic_frame_features(samples, ACOUSTIC_TEST_FRAME, &frame);
+    TEST_ASSERT_INT_WITHIN(40, ACOUSTIC_TEST_FRAME / 2, frame.zero_crossings);
+
+    memset(samples, 0, sizeof(samples));
+    acoustic_frame_features(samples, ACOUSTIC_TEST_FRAME, &frame);
+    TEST_ASSERT_EQUAL(-100 * 256, frame.energy_db);
+    TEST_ASSERT_EQUAL(0, frame.zero_crossings);
+
+    // Nothing happens in steady noise, and the cost per second of audio
+    acoustic_test_seed = 2;
+    for (int i = 0; i < 1000; i++) {
+        for (int n = 0; n < ACOUSTIC_TEST_FRAME; n++) {
+            samples[n] = (int16_t)acoustic_test_noise(300);
+        }
+        acoustic_events_frame(samples, ACOUSTIC_TEST_FRAME, false);
+    }
+    acoustic_stats_t stats;
+    acoustic_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1000, stats.frames);
+    TEST_ASSERT_EQUAL(0, stats.events);
+    uint32_t us_per_s = (uint64_t)stats.frame_us * ACOUSTIC_TEST_RATE / (1000 * ACOUSTIC_TEST_FRAME);
+    TEST_ASSERT_TRUE(us_per_s < ACOUSTIC_TEST_BUDGET_US);
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "%lu us per second of audio, %lu us slowest frame",
+             (unsigned long)us_per_s, (unsigned long)stats.frame_us_max);
+    TEST_MESSAGE(msg);
+}
+
+void test_acoustic_classify(void)
+{
+    // Prototypes are recognised, something unlike any of them is not
+    int16_t f[ACOUSTIC_FEATURES] = { 600, 550, 4500, 210, 560, 620, 800, 0 };
+    uint8_t confidence;
+    TEST_ASSERT_EQUAL(ACOUSTIC_GLASS, acoustic_classify(f, &confidence));
+    TEST_ASSERT_TRUE(confidence > 50);
+    int16_t far[ACOUSTIC_FEATURES] = { 2000, 2000, 100, 255, 1000, 1500, 5000, 255 };
+    TEST_ASSERT_EQUAL(ACOUSTIC_NONE, acoustic_classify(far, &confidence));
+    TEST_ASSERT_EQUAL_STRING("Glass break", acoustic_class_name(ACOUSTIC_GLASS));
+}
+
+// Precision and recall over labelled WAV files: the held-out synthetic set,
+// written and replayed one file at a time, then any recordings in
+// ACOUSTIC_TEST_DIR
+void test_acoustic_replay(void)
+{
+    uint32_t confusion[2][ACOUSTIC_CLASS_MAX][ACOUSTIC_CLASS_MAX] = {};     // [recorded][label][detected]
+    char path[64];
+
+    SPIFFS.begin(true);
+    SPIFFS.mkdir(ACOUSTIC_TEST_DIR);
+    for (uint8_t label = 0; label < ACOUSTIC_CLASS_MAX; label++) {
+        for (int i = 0; i < ACOUSTIC_TEST_FILES; i++) {
+            snprintf(path, sizeof(path), ACOUSTIC_TEST_DIR "/%s_syn%02d.wav", acoustic_test_labels[label], i);
+            acoustic_test_render(label, i, true, path);
+            int detected = acoustic_test_replay(path, true);
+            SPIFFS.remove(path);
+            TEST_ASSERT_TRUE(detected >= 0);
+            confusion[0][label][detected]++;
+        }
+    }
+
+    File dir = SPIFFS.open(ACOUSTIC_TEST_DIR);
+    uint32_t recordings = 0;
+    for (File entry = dir ? dir.openNextFile() : File(); entry; entry = dir.openNextFile()) {
+        const char *name = strrchr(entry.name(), '/');
+        name = name ? name + 1 : entry.name();
+        snprintf(path, sizeof(path), ACOUSTIC_TEST_DIR "/%s", name);
+        entry.close();
+        for (uint8_t label = 0; label < ACOUSTIC_CLASS_MAX; label++) {
+            size_t len = strlen(acoustic_test_labels[label]);
+            if (!strncmp(name, acoustic_test_labels[label], len) && name[len] == '_') {
+                int detected = acoustic_test_replay(path, false);
+                if (detected >= 0) {
+                    confusion[1][label][detected]++;
+                    recordings++;
+                }
+            }
+        }
+    }
+
+    char msg[128];
+    uint32_t worst = 100;
+    for (int set = 0; set < (recordings ? 2 : 1); set++) {
+        for (uint8_t c = ACOUSTIC_NONE + 1; c < ACOUSTIC_CLASS_MAX; c++) {
+            uint32_t tp = confusion[set][c][c], detected = 0, labelled = 0;
+            for (uint8_t o = 0; o < ACOUSTIC_CLASS_MAX; o++) {
+                detected += confusion[set][o][c];
+                labelled += confusion[set][c][o];
+            }
+            uint32_t precision = detected ? tp * 100 / detected : 0;
+            uint32_t recall = labelled ? tp * 100 / labelled : 0;
+            snprintf(msg, sizeof(msg), "%s %-11s precision %3lu%% recall %3lu%% (%lu of %lu files)",
+                     set ? "recorded" : "held-out", acoustic_class_name(c), (unsigned long)precision,
+                     (unsigned long)recall, (unsigned long)tp, (unsigned long)labelled);
+            TEST_MESSAGE(msg);
+            if (!set) {
+                worst = min(worst, min(precision, recall));
+            }
+        }
+    }
+
+    TEST_ASSERT_TRUE(worst >= ACOUSTIC_TEST_MIN_SCORE);
+}
@@ -0,0 +1,146 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "alarm_pipeline.h"
+#include "node_registry.h"
+#include "supervision.h"
+
+static SemaphoreHandle_t sink_gate = NULL;
+static volatile bool     sink_hold = false;
+static uint8_t           sink_order[64];
+static volatile uint32_t sink_count = 0;
+
+static void recording_sink(const alarm_event_t *event)
+{
+    if (sink_count < sizeof(sink_order)) {
+        sink_order[sink_count] = event->cls;
+    }
+    sink_count++;
+    // Hold the dispatcher on the first event so the queues fill up behind it
+    if (sink_hold) {
+        sink_hold = false;
+        xSemaphoreTake(sink_gate, portMAX_DELAY);
+    }
+}
+
+static void submit(uint32_t node_id, uint16_t seq, const char *payload)
+{
+    char frame[ALARM_FRAME_MAX];
+    snprintf(frame, sizeof(frame), "@%lX,%u,80,%s", (unsigned long)node_id, seq, payload);
+    alarm_pipeline_submit_rx(frame, strlen(frame), -70.5f, 6.25f, micros());
+}
+
+// Alarm pipeline test functions
+void test_alarm_classify(void) {
+    TEST_ASSERT_EQUAL(ALARM_CLASS_PANIC, alarm_classify("PANIC"));
+    TEST_ASSERT_EQUAL(ALARM_CLASS_INTRUSION, alarm_classify("OPEN zone 2"));
+    TEST_ASSERT_EQUAL(ALARM_CLASS_INTRUSION, alarm_classify("MOTION"));
+    TEST_ASSERT_EQUAL(ALARM_CLASS_TAMPER, alarm_classify("TAMPER"));
+    TEST_ASSERT_EQUAL(ALARM_CLASS_TELEMETRY, alarm_classify("TEMP 21.5"));
+    TEST_ASSERT_EQUAL(ALARM_CLASS_TELEMETRY, alarm_classify(""));
+}
+
+void test_alarm_latency_histogram(void) {
+    TEST_ASSERT_EQUAL(0, alarm_latency_bucket(0));
+    TEST_ASSERT_EQUAL(1, alarm_latency_bucket(1));
+    TEST_ASSERT_EQUAL(10, alarm_latency_bucket(1000));
+    TEST_ASSERT_EQUAL(ALARM_HIST_BUCKETS - 1, alarm_latency_bucket(UINT32_MAX));
+
+    uint32_t hist[ALARM_HIST_BUCKETS] = {0};
+    hist[alarm_latency_bucket(100)] = 90;       // 64..127 us
+    hist[alarm_latency_bucket(5000)] = 10;      // 4096..8191 us
+    TEST_ASSERT_EQUAL_UINT32(127, alarm_latency_percentile(hist, 50));
+    TEST_ASSERT_EQUAL_UINT32(127, alarm_latency_percentile(hist, 90));
+    TEST_ASSERT_EQUAL_UINT32(8191, alarm_latency_percentile(hist, 99));
+}
+
+void test_alarm_pipeline_priority(void) {
+    node_registry_begin(nullptr);
+    supervision_begin();
+    TEST_ASSERT_TRUE(alarm_pipeline_begin());
+    if (!sink_gate) {
+        sink_gate = xSemaphoreCreateBinary();
+    }
+    alarm_pipeline_stats_t before, after;
+    alarm_pipeline_get_stats(&before);
+
+    sink_count = 0;
+    sink_hold = true;
+    alarm_pipeline_set_sink(ALARM_SINK_UPLINK, recording_sink);
+
+    // Telemetry flood while the dispatcher is busy, then one panic
+    for (uint16_t i = 0; i < 48; i++) {
+        submit(0x7000 + i, 1, "TEMP");
+        delay(1);
+    }
+    submit(0x7100, 1, "PANIC");
+    delay(20);
+    xSemaphoreGive(sink_gate);
+    delay(200);
+    alarm_pipeline_set_sink(ALARM_SINK_UPLINK, NULL);
+    alarm_pipeline_get_stats(&after);
+
+    // The panic overtakes everything except the event already in flight
+    TEST_ASSERT_TRUE(sink_count >= 2);
+    TEST_ASSERT_EQUAL(ALARM_CLASS_TELEMETRY, sink_order[0]);
+    TEST_ASSERT_EQUAL(ALARM_CLASS_PANIC, sink_order[1]);
+    TEST_ASSERT_EQUAL(before.dropped[ALARM_CLASS_PANIC], after.dropped[ALARM_CLASS_PANIC]);
+    TEST_ASSERT_TRUE(after.dropped[ALARM_CLASS_TELEMETRY] > before.dropped[ALARM_CLASS_TELEMETRY]);
+    TEST_ASSERT_EQUAL(before.dispatched[ALARM_CLASS_PANIC] + 1, after.dispatched[ALARM_CLASS_PANIC]);
+    TEST_ASSERT_TRUE(alarm_latency_percentile(after.latency[ALARM_STAGE_DISPATCH][ALARM_CLASS_PANIC], 100) > 0);
+
+    // Replayed frames are rejected
+    uint32_t replayed = after.replayed;
+    submit(0x7100, 1, "PANIC");
+    delay(20);
+    alarm_pipeline_get_stats(&after);
+    TEST_ASSERT_EQUAL(replayed + 1, after.replayed);
+    alarm_pipeline_print_stats();
+}
+
+void test_alarm_pipeline_ingress_reserve(void) {
+    TEST_ASSERT_TRUE(alarm_pipeline_begin());
+    if (!sink_gate) {
+        sink_gate = xSemaphoreCreateBinary();
+    }
+    alarm_pipeline_stats_t before, after;
+    alarm_pipeline_get_stats(&before);
+
+    sink_count = 0;
+    sink_hold = true;
+    alarm_pipeline_set_sink(ALARM_SINK_UPLINK, recording_sink);
+
+    // Stall the decode stage: one tamper held in the sink, a full tamper
+    // queue behind it and one more waiting for room, so ingress backs up
+    uint16_t seq = 1;
+    for (int i = 0; i < 1 + 16 + 1; i++) {
+        submit(0x7200, seq++, "TAMPER");
+        delay(1);
+    }
+    delay(20);
+
+    // Telemetry fills ingress up to the reserve and no further
+    for (uint16_t i = 1; i <= 2 * ALARM_INGRESS_DEPTH; i++) {
+        submit(0x7201, i, "TEMP");
+    }
+    alarm_pipeline_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.ingress_dropped + 2 * ALARM_INGRESS_DEPTH - (ALARM_INGRESS_DEPTH - ALARM_INGRESS_RESERVE),
+                      after.ingress_dropped);
+
+    // Every panic still gets in
+    uint32_t start = millis();
+    for (uint16_t i = 1; i <= ALARM_INGRESS_RESERVE; i++) {
+        submit(0x7202, i, "PANIC");
+    }
+    TEST_ASSERT_TRUE(millis() - start < ALARM_INGRESS_WAIT_MS);
+    alarm_pipeline_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.ingress_dropped + 2 * ALARM_INGRESS_DEPTH - (ALARM_INGRESS_DEPTH - ALARM_INGRESS_RESERVE),
+                      after.ingress_dropped);
+
+    xSemaphoreGive(sink_gate);
+    delay(200);
+    alarm_pipeline_set_sink(ALARM_SINK_UPLINK, NULL);
+    alarm_pipeline_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.dispatched[ALARM_CLASS_PANIC] + ALARM_INGRESS_RESERVE, after.dispatched[ALARM_CLASS_PANIC]);
+    TEST_ASSERT_EQUAL(before.dispatched[ALARM_CLASS_TAMPER] + 18, after.dispatched[ALARM_CLASS_TAMPER]);
+    TEST_ASSERT_EQUAL(before.dropped[ALARM_CLASS_PANIC], after.dropped[ALARM_CLASS_PANIC]);
+}
@@ -0,0 +1,424 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include "audio_mixer.h"
+
+#define MIXER_TEST_CONST_FRAMES 1000
+#define MIXER_TEST_SIREN_FRAMES 1024
+#define MIXER_TEST_PRODUCERS    4
+#define MIXER_TEST_COMMANDS     1000            // Per producer
+#define MIXER_TEST_TASK_FRAMES  (3 * MIXER_STREAM_FRAMES)
+
+static int16_t mixer_test_pcm[MIXER_TEST_CONST_FRAMES * 2];
+static int16_t mixer_test_out[MIXER_BLOCK_FRAMES * 2];
+
+static void mixer_test_put32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) {
+        p[i] = v >> (8 * i);
+    }
+}
+
+// A constant 16 bit PCM clip at MIXER_SAMPLE_RATE, registered unless it is already
+static int mixer_test_clip(const char *name, uint16_t channels, int16_t left, int16_t right)
+{
+    int id = clip_cache_find(name);
+    if (id >= 0) {
+        return id;
+    }
+    char path[32];
+    snprintf(path, sizeof(path), "/mixer_%s.wav", name);
+    for (int i = 0; i < MIXER_TEST_CONST_FRAMES; i++) {
+        mixer_test_pcm[i * channels] = left;
+        if (channels == 2) {
+            mixer_test_pcm[i * 2 + 1] = right;
+        }
+    }
+    uint32_t data_len = MIXER_TEST_CONST_FRAMES * channels * 2;
+    uint8_t hdr[44];
+    memcpy(hdr, "RIFF", 4);
+    mixer_test_put32(hdr + 4, 36 + data_len);
+    memcpy(hdr + 8, "WAVEfmt ", 8);
+    mixer_test_put32(hdr + 16, 16);
+    mixer_test_put32(hdr + 20, 1 | channels << 16);
+    mixer_test_put32(hdr + 24, MIXER_SAMPLE_RATE);
+    mixer_test_put32(hdr + 28, MIXER_SAMPLE_RATE * channels * 2);
+    mixer_test_put32(hdr + 32, (channels * 2) | 16 << 16);
+    memcpy(hdr + 36, "data", 4);
+    mixer_test_put32(hdr + 40, data_len);
+
+    SPIFFS.begin(true);
+    File file = SPIFFS.open(path, FILE_WRITE);
+    TEST_ASSERT_TRUE((bool)file);
+    TEST_ASSERT_EQUAL(sizeof(hdr), file.write(hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL(data_len, file.write((const uint8_t *)mixer_test_pcm, data_len));
+    file.close();
+    // Kept by name only, the file can go once it is loaded
+    static char names[4][CLIP_NAME_MAX];
+    static char paths[4][32];
+    static int count = 0;
+    TEST_ASSERT_TRUE(count < 4);
+    strlcpy(names[count], name, sizeof(names[count]));
+    strlcpy(paths[count], path, sizeof(paths[count]));
+    id = clip_cache_add(names[count], paths[count], false);
+    count++;
+    TEST_ASSERT_TRUE(id >= 0);
+    return id;
+}
+
+static int mixer_test_siren(const char *name, uint16_t lo_hz, uint16_t hi_hz, int16_t amplitude)
+{
+    int id = clip_cache_find(name);
+    if (id < 0) {
+        id = clip_cache_add_siren(name, lo_hz, hi_hz, 100, 500, amplitude);
+    }
+    TEST_ASSERT_TRUE(id >= 0);
+    return id;
+}
+
+static void mixer_test_begin(void)
+{
+    TEST_ASSERT_TRUE(clip_cache_begin(NULL, NULL, &SPIFFS, false));
+    TEST_ASSERT_TRUE(audio_mixer_begin(false));
+    audio_mixer_stop_all();
+    while (audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0)) {
+    }
+}
+
+static uint32_t mixer_test_drain(void)
+{
+    uint32_t blocks = 0;
+    while (audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0)) {
+        blocks++;
+    }
+    return blocks;
+}
+
+void test_audio_mixer_sum(void)
+{
+    mixer_test_begin();
+    int constant = mixer_test_clip("const", 2, 1000, 3000);
+    int lazy = mixer_test_clip("lazy", 1, -500, 0);
+    int siren = mixer_test_siren("siren", 650, 1300, 32000);
+
+    audio_mixer_stats_t before, after;
+    clip_cache_stats_t clips_before, clips_after;
+    audio_mixer_get_stats(&before);
+    clip_cache_get_stats(&clips_before);
+
+    // Summed at unity gain on both channels, "lazy" loaded on its first play
+    TEST_ASSERT_TRUE(audio_mixer_play(constant, MIXER_GAIN_UNITY, MIXER_PRIO_VOICE, false));
+    TEST_ASSERT_TRUE(audio_mixer_play(lazy, MIXER_GAIN_UNITY, MIXER_PRIO_VOICE, false));
+    TEST_ASSERT_TRUE(audio_mixer_active());
+    TEST_ASSERT_EQUAL(2, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    for (int k = 0; k < MIXER_BLOCK_FRAMES * 2; k++) {
+        TEST_ASSERT_EQUAL_INT16(1500, mixer_test_out[k]);
+    }
+    audio_mixer_get_stats(&after);
+    clip_cache_get_stats(&clips_after);
+    TEST_ASSERT_EQUAL(before.plays + 2, after.plays);
+    TEST_ASSERT_TRUE(clips_after.lazy_loads > clips_before.lazy_loads);
+
+    // Playing a clip again starts it over instead of taking a second voice
+    TEST_ASSERT_TRUE(audio_mixer_stop(lazy));
+    TEST_ASSERT_EQUAL(2, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    TEST_ASSERT_EQUAL(1, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    TEST_ASSERT_TRUE(audio_mixer_play(constant, MIXER_GAIN_UNITY / 2, MIXER_PRIO_VOICE, false));
+    uint32_t blocks = (MIXER_TEST_CONST_FRAMES + MIXER_BLOCK_FRAMES - 1) / MIXER_BLOCK_FRAMES;
+    TEST_ASSERT_EQUAL(1, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    // The gain halves over the first block
+    TEST_ASSERT_EQUAL_INT16(2000, mixer_test_out[0]);
+    TEST_ASSERT_INT_WITHIN(16, 1000, mixer_test_out[2 * MIXER_BLOCK_FRAMES - 1]);
+    TEST_ASSERT_EQUAL(1, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    TEST_ASSERT_EQUAL_INT16(1000, mixer_test_out[0]);
+    TEST_ASSERT_EQUAL(blocks - 2, mixer_test_drain());
+    TEST_ASSERT_FALSE(audio_mixer_active());
+
+    // Saturated once, after the sum
+    static int16_t alone[MIXER_TEST_SIREN_FRAMES];
+    TEST_ASSERT_TRUE(audio_mixer_play(siren, MIXER_GAIN_UNITY, MIXER_PRIO_SIREN, false));
+    for (int b = 0; b < MIXER_TEST_SIREN_FRAMES / MIXER_BLOCK_FRAMES; b++) {
+        TEST_ASSERT_EQUAL(1, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+        for (int k = 0; k < MIXER_BLOCK_FRAMES; k++) {
+            TEST_ASSERT_EQUAL_INT16(mixer_test_out[2 * k], mixer_test_out[2 * k + 1]);
+            alone[b * MIXER_BLOCK_FRAMES + k] = mixer_test_out[2 * k];
+        }
+    }
+    TEST_ASSERT_TRUE(audio_mixer_play(siren, MIXER_GAIN_UNITY, MIXER_PRIO_SIREN, false));
+    TEST_ASSERT_TRUE(audio_mixer_play(constant, 4 * MIXER_GAIN_UNITY, MIXER_PRIO_SIREN, false));
+    int clipped = 0;
+    for (int b = 0; b < MIXER_TEST_SIREN_FRAMES / MIXER_BLOCK_FRAMES; b++) {
+        TEST_ASSERT_EQUAL(2, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+        for (int k = 0; k < MIXER_BLOCK_FRAMES; k++) {
+            int n = b * MIXER_BLOCK_FRAMES + k;
+            int32_t sum = alone[n] + (n < MIXER_TEST_CONST_FRAMES ? 8000 : 0);
+            int16_t expect = sum > 32767 ? 32767 : sum < -32768 ? -32768 : sum;
+            TEST_ASSERT_EQUAL_INT16(expect, mixer_test_out[2 * k]);
+            TEST_ASSERT_EQUAL_INT16(expect, mixer_test_out[2 * k + 1]);
+            clipped += sum > 32767;
+        }
+    }
+    TEST_ASSERT_TRUE(clipped > 0);
+    audio_mixer_stop_all();
+    mixer_test_drain();
+
+    // Nothing to play
+    audio_mixer_get_stats(&before);
+    TEST_ASSERT_FALSE(audio_mixer_play(-1, MIXER_GAIN_UNITY, MIXER_PRIO_VOICE, false));
+    TEST_ASSERT_FALSE(audio_mixer_play(CLIP_CACHE_MAX, MIXER_GAIN_UNITY, MIXER_PRIO_VOICE, false));
+    int missing = clip_cache_find("missing");
+    if (missing >= 0) {
+        TEST_ASSERT_TRUE(audio_mixer_play(missing, MIXER_GAIN_UNITY, MIXER_PRIO_VOICE, false));
+        TEST_ASSERT_EQUAL(0, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+        audio_mixer_get_stats(&after);
+        TEST_ASSERT_EQUAL(before.dropped + 1, after.dropped);
+    }
+}
+
+void test_audio_mixer_duck(void)
+{
+    mixer_test_begin();
+    int constant = mixer_test_clip("const", 2, 1000, 3000);
+    int lazy = mixer_test_clip("lazy", 1, -500, 0);
+
+    // The click ducks to a quarter under the voice, ramping down over the
+    // first block with no step in between
+    TEST_ASSERT_TRUE(audio_mixer_play(lazy, MIXER_GAIN_UNITY, MIXER_PRIO_CLICK, false));
+    TEST_ASSERT_TRUE(audio_mixer_play(constant, MIXER_GAIN_UNITY, MIXER_PRIO_VOICE, false));
+    TEST_ASSERT_EQUAL(2, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    TEST_ASSERT_EQUAL_INT16(1500, mixer_test_out[0]);
+    for (int k = 1; k < MIXER_BLOCK_FRAMES; k++) {
+        int step = mixer_test_out[2 * k] - mixer_test_out[2 * k - 2];
+        TEST_ASSERT_TRUE(step >= 0 && step <= 4);
+    }
+    TEST_ASSERT_EQUAL(2, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    for (int k = 0; k < MIXER_BLOCK_FRAMES * 2; k++) {
+        TEST_ASSERT_EQUAL_INT16(2000 - 500 * MIXER_DUCK_GAIN / MIXER_GAIN_UNITY, mixer_test_out[k]);
+    }
+
+    // The voice stopping fades out while the click comes back up
+    TEST_ASSERT_TRUE(audio_mixer_stop(constant));
+    TEST_ASSERT_EQUAL(2, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    for (int k = 1; k < MIXER_BLOCK_FRAMES; k++) {
+        int step = mixer_test_out[2 * k] - mixer_test_out[2 * k - 2];
+        TEST_ASSERT_TRUE(step <= 0 && step >= -24);
+    }
+    TEST_ASSERT_EQUAL(1, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    for (int k = 0; k < MIXER_BLOCK_FRAMES * 2; k++) {
+        TEST_ASSERT_EQUAL_INT16(-500, mixer_test_out[k]);
+    }
+    audio_mixer_stop_all();
+    mixer_test_drain();
+}
+
+void test_audio_mixer_voices(void)
+{
+    mixer_test_begin();
+    int clips[] = {
+        mixer_test_clip("const", 2, 1000, 3000),
+        mixer_test_clip("lazy", 1, -500, 0),
+        mixer_test_siren("siren", 650, 1300, 32000),
+        mixer_test_siren("tone", 1000, 1000, 4000),
+        // The clip cache has room for one more, left by the clip cache tests
+        clip_cache_find("sine") >= 0 ? clip_cache_find("sine") : mixer_test_siren("sweep", 300, 3000, 4000),
+    };
+    static_assert(sizeof(clips) / sizeof(clips[0]) == MIXER_VOICES - 1, "one voice left for a stream");
+
+    audio_mixer_stats_t before, after;
+    audio_mixer_get_stats(&before);
+    for (int i = 0; i < MIXER_VOICES - 1; i++) {
+        TEST_ASSERT_TRUE(audio_mixer_play(clips[i], MIXER_GAIN_UNITY / 8, i < 2 ? MIXER_PRIO_SIREN : MIXER_PRIO_VOICE, true));
+    }
+    int stream = audio_mixer_stream_open(MIXER_GAIN_UNITY, MIXER_PRIO_VOICE);
+    TEST_ASSERT_TRUE(stream >= 0);
+    TEST_ASSERT_EQUAL(MIXER_VOICES - 1, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+
+    // All voices taken, none lower than a click: the stream has no voice
+    // and its writes go nowhere
+    int lost = audio_mixer_stream_open(MIXER_GAIN_UNITY, MIXER_PRIO_CLICK);
+    TEST_ASSERT_TRUE(lost >= 0 && lost != stream);
+    audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0);
+    audio_mixer_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.dropped + 1, after.dropped);
+    TEST_ASSERT_EQUAL(0, audio_mixer_stream_space(lost));
+    TEST_ASSERT_FALSE(audio_mixer_stream_attached(lost));
+    TEST_ASSERT_EQUAL(0, audio_mixer_stream_write(lost, mixer_test_pcm, 16, MIXER_SAMPLE_RATE, 0));
+    audio_mixer_stream_close(lost);
+
+    // A voice prompt takes over the oldest of the lowest priority
+    int prompt = audio_mixer_stream_open(MIXER_GAIN_UNITY, MIXER_PRIO_VOICE);
+    TEST_ASSERT_TRUE(prompt >= 0);
+    audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0);
+    audio_mixer_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.stolen + 1, after.stolen);
+    TEST_ASSERT_EQUAL(before.dropped + 1, after.dropped);
+    TEST_ASSERT_EQUAL(MIXER_STREAM_FRAMES, audio_mixer_stream_space(prompt));
+    TEST_ASSERT_TRUE(audio_mixer_stream_attached(prompt));
+
+    // Looping clips play on until stopped
+    for (int b = 0; b < 4 * CLIP_SAMPLE_RATE / 2 / MIXER_BLOCK_FRAMES; b++) {
+        TEST_ASSERT_TRUE(audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0) >= MIXER_VOICES - 2);
+    }
+    TEST_ASSERT_TRUE(audio_mixer_stop_all());
+    TEST_ASSERT_TRUE(audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0) > 0);
+    TEST_ASSERT_EQUAL(0, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    TEST_ASSERT_FALSE(audio_mixer_active());
+    TEST_ASSERT_FALSE(audio_mixer_stream_attached(prompt));
+    TEST_ASSERT_EQUAL(0, audio_mixer_stream_write(stream, mixer_test_pcm, 16, MIXER_SAMPLE_RATE, 0));
+    audio_mixer_stream_close(stream);
+    audio_mixer_stream_close(prompt);
+
+    // Both streams are free again once closed and let go by the mixer
+    stream = audio_mixer_stream_open(MIXER_GAIN_UNITY, MIXER_PRIO_VOICE);
+    prompt = audio_mixer_stream_open(MIXER_GAIN_UNITY, MIXER_PRIO_VOICE);
+    TEST_ASSERT_TRUE(stream >= 0 && prompt >= 0);
+    TEST_ASSERT_EQUAL(-1, audio_mixer_stream_open(MIXER_GAIN_UNITY, MIXER_PRIO_VOICE));
+    audio_mixer_stream_close(stream);
+    audio_mixer_stream_close(prompt);
+    mixer_test_drain();
+}
+
+static volatile uint32_t mixer_test_task_frames;
+
+static inline int16_t mixer_test_sample(uint32_t frame)
+{
+    return (int16_t)(frame & 0x7fff);
+}
+
+static void mixer_test_writer(void *params)
+{
+    int stream = *(int *)params;
+    static int16_t block[333 * 2];
+    uint32_t next = 0;
+    mixer_test_task_frames = 1;
+    while (next < MIXER_TEST_TASK_FRAMES) {
+        size_t n = MIXER_TEST_TASK_FRAMES - next < 333 ? MIXER_TEST_TASK_FRAMES - next : 333;
+        for (size_t i = 0; i < n; i++) {
+            block[2 * i] = mixer_test_sample(next + i);
+            block[2 * i + 1] = -mixer_test_sample(next + i);
+        }
+        if (audio_mixer_stream_write(stream, block, n, MIXER_SAMPLE_RATE, 1000) != n) {
+            break;
+        }
+        next += n;
+    }
+    audio_mixer_stream_close(stream);
+    mixer_test_task_frames = next;
+    vTaskDelete(NULL);
+}
+
+void test_audio_mixer_stream(void)
+{
+    mixer_test_begin();
+    audio_mixer_stats_t before, after;
+    audio_mixer_get_stats(&before);
+
+    // Half the rate, every other frame interpolated
+    static int16_t ramp[64 * 2];
+    for (int i = 0; i < 64; i++) {
+        ramp[2 * i] = i * 100;
+        ramp[2 * i + 1] = -i * 100;
+    }
+    int stream = audio_mixer_stream_open(MIXER_GAIN_UNITY, MIXER_PRIO_VOICE);
+    TEST_ASSERT_TRUE(stream >= 0);
+    TEST_ASSERT_EQUAL(64, audio_mixer_stream_write(stream, ramp, 64, MIXER_SAMPLE_RATE / 2, 0));
+    TEST_ASSERT_EQUAL(MIXER_STREAM_FRAMES - 64, audio_mixer_stream_space(stream));
+    TEST_ASSERT_EQUAL(1, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    for (int k = 0; k < 2 * 63; k++) {
+        TEST_ASSERT_INT_WITHIN(1, k * 50, mixer_test_out[2 * k]);
+        TEST_ASSERT_INT_WITHIN(1, -k * 50, mixer_test_out[2 * k + 1]);
+    }
+
+    // Late producer, counted once the stream has sounded
+    TEST_ASSERT_EQUAL(0, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    audio_mixer_get_stats(&after);
+    TEST_ASSERT_TRUE(after.underruns > before.underruns);
+    TEST_ASSERT_TRUE(audio_mixer_active());
+
+    // Closed, the last frame plays out and the voice and stream are free
+    audio_mixer_stream_close(stream);
+    TEST_ASSERT_EQUAL(1, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    TEST_ASSERT_INT_WITHIN(1, 6300, mixer_test_out[0]);
+    TEST_ASSERT_EQUAL(0, audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0));
+    TEST_ASSERT_FALSE(audio_mixer_active());
+
+    // A producer task blocked on a full ring is woken as the mixer plays,
+    // every frame comes out once and in order
+    stream = audio_mixer_stream_open(MIXER_GAIN_UNITY, MIXER_PRIO_VOICE);
+    TEST_ASSERT_TRUE(stream >= 0);
+    mixer_test_task_frames = 0;
+    TaskHandle_t handle;
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(mixer_test_writer, "mixer_test", 4096, &stream, 5, &handle));
+    while (!mixer_test_task_frames) {
+        delay(1);
+    }
+    uint32_t next = 0;
+    uint32_t start = millis();
+    while (next < MIXER_TEST_TASK_FRAMES && millis() - start < 5000) {
+        if (!audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0)) {
+            delay(1);
+            continue;
+        }
+        // A block runs short while the writer is behind, the rest is silence
+        for (int k = 0; k < MIXER_BLOCK_FRAMES && next < MIXER_TEST_TASK_FRAMES; k++) {
+            if (mixer_test_out[2 * k] == 0 && mixer_test_sample(next) != 0) {
+                break;
+            }
+            TEST_ASSERT_EQUAL_INT16(mixer_test_sample(next), mixer_test_out[2 * k]);
+            TEST_ASSERT_EQUAL_INT16(-mixer_test_sample(next), mixer_test_out[2 * k + 1]);
+            next++;
+        }
+    }
+    TEST_ASSERT_EQUAL(MIXER_TEST_TASK_FRAMES, next);
+    TEST_ASSERT_EQUAL(MIXER_TEST_TASK_FRAMES, mixer_test_task_frames);
+    mixer_test_drain();
+    TEST_ASSERT_FALSE(audio_mixer_active());
+}
+
+static volatile uint32_t mixer_test_producers_done;
+
+static void mixer_test_producer(void *params)
+{
+    int clip = *(int *)params;
+    for (int i = 0; i < MIXER_TEST_COMMANDS; i++) {
+        while (!audio_mixer_set_gain(clip, i & 0xff)) {
+            taskYIELD();
+        }
+    }
+    __atomic_fetch_add(&mixer_test_producers_done, 1, __ATOMIC_RELAXED);
+    vTaskDelete(NULL);
+}
+
+void test_audio_mixer_queue(void)
+{
+    mixer_test_begin();
+    static int clip;
+    clip = mixer_test_clip("const", 2, 1000, 3000);
+    audio_mixer_stats_t before, after;
+    audio_mixer_get_stats(&before);
+
+    // Producers on several tasks at once, no request lost or served twice
+    mixer_test_producers_done = 0;
+    for (int i = 0; i < MIXER_TEST_PRODUCERS; i++) {
+        TaskHandle_t handle;
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(mixer_test_producer, "mixer_test", 2048, &clip, 5, &handle));
+    }
+    uint32_t start = millis();
+    do {
+        audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0);
+        audio_mixer_get_stats(&after);
+    } while (after.commands - before.commands < MIXER_TEST_PRODUCERS * MIXER_TEST_COMMANDS && millis() - start < 5000);
+    while (mixer_test_producers_done < MIXER_TEST_PRODUCERS && millis() - start < 5000) {
+        delay(1);
+    }
+    audio_mixer_mix(mixer_test_out, MIXER_BLOCK_FRAMES, 0);
+    audio_mixer_get_stats(&after);
+    TEST_ASSERT_EQUAL(MIXER_TEST_PRODUCERS, mixer_test_producers_done);
+    TEST_ASSERT_EQUAL(MIXER_TEST_PRODUCERS * MIXER_TEST_COMMANDS, after.commands - before.commands);
+    TEST_ASSERT_FALSE(audio_mixer_active());
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "%lu requests refused while the queue was full",
+             (unsigned long)(after.queue_full - before.queue_full));
+    TEST_MESSAGE(msg);
+}
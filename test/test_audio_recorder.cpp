@@ -0,0 +1,272 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <math.h>
+#include "audio_recorder.h"
+#include "mic_capture.h"
+
+#define REC_TEST_RATE           16000
+#define REC_TEST_CHANNELS       4
+#define REC_TEST_CHANNEL        1
+#define REC_TEST_HZ             300
+#define REC_TEST_AMP            8000
+#define REC_TEST_BLOCKS         64
+
+// Channel REC_TEST_CHANNEL carries a sine, the others something loud that
+// must not end up in the recording
+static inline int16_t rec_test_sample(uint32_t frame, uint8_t channel)
+{
+    if (channel != REC_TEST_CHANNEL) {
+        return channel & 1 ? 30000 : -30000;
+    }
+    return (int16_t)(REC_TEST_AMP * sinf(2 * (float)M_PI * REC_TEST_HZ * (frame % REC_TEST_RATE) / REC_TEST_RATE));
+}
+
+static void rec_test_produce(uint32_t *frame, uint32_t frames, bool service)
+{
+    while (frames) {
+        size_t room;
+        int16_t *dst = mic_capture_space(&room);
+        size_t n = room < frames ? room : frames;
+        for (size_t i = 0; i < n; i++, (*frame)++) {
+            for (uint8_t ch = 0; ch < REC_TEST_CHANNELS; ch++) {
+                *dst++ = rec_test_sample(*frame, ch);
+            }
+        }
+        mic_capture_commit(n);
+        frames -= n;
+        // The recorder task's pace, about every REC_POLL_MS
+        if (service && *frame % (REC_TEST_RATE * REC_POLL_MS / 1000) < n) {
+            audio_recorder_service();
+        }
+    }
+}
+
+static uint32_t rec_test_get32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void rec_test_clear(void)
+{
+    SPIFFS.begin(true);
+    File dir = SPIFFS.open(REC_DIR);
+    if (dir && dir.isDirectory()) {
+        char path[48];
+        for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) {
+            const char *name = strrchr(entry.name(), '/');
+            snprintf(path, sizeof(path), REC_DIR "/%s", name ? name + 1 : entry.name());
+            entry.close();
+            SPIFFS.remove(path);
+        }
+    }
+}
+
+static void rec_test_begin(void)
+{
+    TEST_ASSERT_TRUE(mic_capture_begin(I2S_NUM_1, REC_TEST_CHANNELS, false));
+    TEST_ASSERT_TRUE(audio_recorder_begin(&SPIFFS, NULL, REC_TEST_RATE, REC_TEST_CHANNEL, false));
+}
+
+// Check the WAV header and compare the decoded recording with the sine from
+// capture position `first` on. Returns the samples in the file.
+static uint32_t rec_test_check_file(const char *path, uint32_t first)
+{
+    static uint8_t block[REC_ADPCM_BLOCK];
+    static int16_t pcm[REC_ADPCM_SAMPLES];
+
+    File file = SPIFFS.open(path, FILE_READ);
+    TEST_ASSERT_TRUE((bool)file);
+    uint8_t hdr[REC_HEADER_SIZE];
+    TEST_ASSERT_EQUAL(REC_HEADER_SIZE, file.read(hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL(0, memcmp(hdr, "RIFF", 4));
+    TEST_ASSERT_EQUAL(0, memcmp(hdr + 8, "WAVEfmt ", 8));
+    TEST_ASSERT_EQUAL(0x11, hdr[20] | hdr[21] << 8);
+    TEST_ASSERT_EQUAL(1, hdr[22]);
+    TEST_ASSERT_EQUAL(REC_TEST_RATE, rec_test_get32(hdr + 24));
+    TEST_ASSERT_EQUAL(REC_ADPCM_BLOCK, hdr[32] | hdr[33] << 8);
+    TEST_ASSERT_EQUAL(REC_ADPCM_SAMPLES, hdr[38] | hdr[39] << 8);
+    TEST_ASSERT_EQUAL(0, memcmp(hdr + 40, "fact", 4));
+    uint32_t samples = rec_test_get32(hdr + 48);
+    // Sector aligned audio
+    TEST_ASSERT_EQUAL(0, memcmp(hdr + REC_HEADER_SIZE - 8, "data", 4));
+    uint32_t data_bytes = rec_test_get32(hdr + REC_HEADER_SIZE - 4);
+    uint32_t blocks = (samples + REC_ADPCM_SAMPLES - 1) / REC_ADPCM_SAMPLES;
+    TEST_ASSERT_EQUAL(blocks * REC_ADPCM_BLOCK, data_bytes);
+    TEST_ASSERT_EQUAL(REC_HEADER_SIZE + data_bytes, file.size());
+    TEST_ASSERT_EQUAL(file.size() - 8, rec_test_get32(hdr + 4));
+
+    double signal = 0, noise = 0;
+    for (uint32_t n = 0; n < samples;) {
+        TEST_ASSERT_EQUAL(REC_ADPCM_BLOCK, file.read(block, sizeof(block)));
+        adpcm_decode_block(block, pcm);
+        for (int i = 0; i < REC_ADPCM_SAMPLES && n < samples; i++, n++) {
+            double expect = rec_test_sample(first + n, REC_TEST_CHANNEL);
+            signal += expect * expect;
+            noise += (pcm[i] - expect) * (pcm[i] - expect);
+        }
+    }
+    file.close();
+    TEST_ASSERT_TRUE(10 * log10(signal / noise) > 20);
+    return samples;
+}
+
+void test_audio_recorder_adpcm(void)
+{
+    static int16_t in[REC_TEST_BLOCKS * REC_ADPCM_SAMPLES];
+    static int16_t out[REC_ADPCM_SAMPLES];
+    static uint8_t block[REC_ADPCM_BLOCK];
+
+    // A sine and a full scale square, which the predictor must not wrap on
+    for (int i = 0; i < REC_TEST_BLOCKS * REC_ADPCM_SAMPLES; i++) {
+        in[i] = rec_test_sample(i, REC_TEST_CHANNEL);
+    }
+    adpcm_state_t state = { 0, 0 };
+    double signal = 0, noise = 0;
+    uint32_t start = micros();
+    for (int b = 0; b < REC_TEST_BLOCKS; b++) {
+        adpcm_encode_block(&state, in + b * REC_ADPCM_SAMPLES, block);
+    }
+    uint32_t elapsed = micros() - start;
+    state = { 0, 0 };
+    for (int b = 0; b < REC_TEST_BLOCKS; b++) {
+        const int16_t *src = in + b * REC_ADPCM_SAMPLES;
+        adpcm_encode_block(&state, src, block);
+        adpcm_decode_block(block, out);
+        TEST_ASSERT_EQUAL_INT16(src[0], out[0]);
+        // Past the first block the step size has adapted
+        for (int i = 0; i < REC_ADPCM_SAMPLES && b; i++) {
+            signal += (double)src[i] * src[i];
+            noise += (double)(out[i] - src[i]) * (out[i] - src[i]);
+        }
+    }
+    double snr = 10 * log10(signal / noise);
+    TEST_ASSERT_TRUE(snr > 25);
+
+    for (int i = 0; i < REC_ADPCM_SAMPLES; i++) {
+        in[i] = (i / 20) & 1 ? 32767 : -32768;
+    }
+    for (int b = 0; b < 4; b++) {
+        adpcm_encode_block(&state, in, block);
+    }
+    adpcm_decode_block(block, out);
+    for (int i = 0; i < REC_ADPCM_SAMPLES; i++) {
+        // Sign right once the step has caught up with each edge
+        if (i % 20 >= 8) {
+            TEST_ASSERT_TRUE((out[i] > 0) == (in[i] > 0));
+        }
+    }
+
+    // Silence stays silent
+    memset(in, 0, REC_ADPCM_SAMPLES * sizeof(int16_t));
+    state = { 0, 0 };
+    adpcm_encode_block(&state, in, block);
+    adpcm_decode_block(block, out);
+    for (int i = 0; i < REC_ADPCM_SAMPLES; i++) {
+        TEST_ASSERT_INT_WITHIN(8, 0, out[i]);
+    }
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "%.1f dB SNR, %lu samples/s encoded",
+             snr, (unsigned long)((uint64_t)REC_TEST_BLOCKS * REC_ADPCM_SAMPLES * 1000000 / (elapsed ? elapsed : 1)));
+    TEST_MESSAGE(msg);
+}
+
+void test_audio_recorder_trigger(void)
+{
+    rec_test_clear();
+    rec_test_begin();
+    const uint32_t preroll = REC_TEST_RATE * REC_PREROLL_MS / 1000;
+    const uint32_t postroll = REC_TEST_RATE * REC_POSTROLL_MS / 1000;
+
+    // Idle, nothing is written and only the pre-roll is held
+    uint32_t frame = 0;
+    rec_test_produce(&frame, 3 * REC_TEST_RATE + 1234, true);
+    audio_recorder_service();
+    TEST_ASSERT_FALSE(audio_recorder_active());
+    TEST_ASSERT_FALSE(SPIFFS.exists(REC_DIR "/rec00000.wav"));
+
+    // Two triggers a second apart, the second moves the end out
+    uint32_t first = frame;
+    audio_recorder_trigger();
+    TEST_ASSERT_TRUE(audio_recorder_service());
+    TEST_ASSERT_TRUE(audio_recorder_active());
+    rec_test_produce(&frame, REC_TEST_RATE, true);
+    uint32_t second = frame;
+    audio_recorder_trigger();
+    rec_test_produce(&frame, postroll + REC_TEST_RATE, true);
+    audio_recorder_service();
+    TEST_ASSERT_FALSE(audio_recorder_active());
+
+    char path[32];
+    audio_recorder_path(path, sizeof(path));
+    TEST_ASSERT_EQUAL_STRING(REC_DIR "/rec00000.wav", path);
+    uint32_t samples = rec_test_check_file(path, first - preroll);
+    TEST_ASSERT_EQUAL(preroll + (second - first) + postroll, samples);
+
+    audio_recorder_stats_t stats;
+    audio_recorder_get_stats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.triggers);
+    TEST_ASSERT_EQUAL(1, stats.recordings);
+    TEST_ASSERT_EQUAL(samples, stats.samples);
+    TEST_ASSERT_EQUAL(0, stats.lost_samples);
+    TEST_ASSERT_EQUAL(0, stats.errors);
+    TEST_ASSERT_EQUAL(REC_HEADER_SIZE + (samples + REC_ADPCM_SAMPLES - 1) / REC_ADPCM_SAMPLES * REC_ADPCM_BLOCK,
+                      stats.bytes);
+    // Whole sectors per write, header and tail block aside
+    TEST_ASSERT_TRUE(stats.writes <= stats.bytes / REC_WRITE_BYTES + 2);
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%lu writes, encoding %lu us per second of audio, slowest write %lu us",
+             (unsigned long)stats.writes, (unsigned long)((uint64_t)stats.encode_us * REC_TEST_RATE / samples),
+             (unsigned long)stats.write_us_max);
+    TEST_MESSAGE(msg);
+}
+
+void test_audio_recorder_finish(void)
+{
+    rec_test_clear();
+    rec_test_begin();
+    const uint32_t preroll = REC_TEST_RATE * REC_PREROLL_MS / 1000;
+
+    // Numbering continues after what is on the card
+    File file = SPIFFS.open(REC_DIR "/rec00041.wav", FILE_WRITE);
+    TEST_ASSERT_TRUE((bool)file);
+    file.close();
+    rec_test_begin();
+
+    // Stopped early with what was captured up to then
+    uint32_t frame = 0;
+    rec_test_produce(&frame, 2 * preroll, true);
+    uint32_t first = frame;
+    audio_recorder_trigger();
+    rec_test_produce(&frame, REC_TEST_RATE / 2, true);
+    audio_recorder_finish();
+    audio_recorder_service();
+    TEST_ASSERT_FALSE(audio_recorder_active());
+    char path[32];
+    audio_recorder_path(path, sizeof(path));
+    TEST_ASSERT_EQUAL_STRING(REC_DIR "/rec00042.wav", path);
+    TEST_ASSERT_EQUAL(preroll + REC_TEST_RATE / 2, rec_test_check_file(path, first - preroll));
+
+    // A recorder that falls more than the ring behind loses the oldest
+    // audio, counted, and records on from there
+    audio_recorder_stats_t before, after;
+    audio_recorder_get_stats(&before);
+    first = frame;
+    audio_recorder_trigger();
+    TEST_ASSERT_TRUE(audio_recorder_service());
+    rec_test_produce(&frame, MIC_RING_FRAMES + REC_TEST_RATE / 2, false);
+    rec_test_produce(&frame, REC_TEST_RATE * REC_POSTROLL_MS / 1000, true);
+    audio_recorder_service();
+    TEST_ASSERT_FALSE(audio_recorder_active());
+    audio_recorder_get_stats(&after);
+    TEST_ASSERT_TRUE(after.lost_samples > before.lost_samples);
+    // No pre-roll, the last recording ended where this one starts
+    TEST_ASSERT_EQUAL(REC_TEST_RATE * REC_POSTROLL_MS / 1000,
+                      after.samples - before.samples + after.lost_samples - before.lost_samples);
+    audio_recorder_path(path, sizeof(path));
+    TEST_ASSERT_EQUAL_STRING(REC_DIR "/rec00043.wav", path);
+
+    rec_test_clear();
+}
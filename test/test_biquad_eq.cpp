@@ -0,0 +1,252 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <biquad_eq/biquad_eq.h>
+
+#define EQ_TEST_FRAMES          (4 * 4410)      // 400 ms at 44.1 kHz
+#define EQ_TEST_BLOCK           512             // Audio::playBlock() block
+#define EQ_BENCH_ROUNDS         20
+
+typedef struct {
+    float a0, a1, a2, b1, b2;
+} eq_test_filter_t;
+
+// Audio::IIR_calculateCoefficients() for one sample rate and setTone() gains
+static void eq_test_coefficients(uint32_t rate, const int8_t gain[3], eq_test_filter_t f[3])
+{
+    float K, norm, V;
+    const float Q = 2.5;
+
+    K = tanf((float)PI * 500 / rate);
+    V = powf(10, fabs(gain[0]) / 20.0);
+    if (gain[0] >= 0) {
+        norm = 1 / (1 + sqrtf(2) * K + K * K);
+        f[0] = {(1 + sqrtf(2 * V) * K + V * K * K) * norm, 2 * (V * K * K - 1) * norm,
+                (1 - sqrtf(2 * V) * K + V * K * K) * norm, 2 * (K * K - 1) * norm, (1 - sqrtf(2) * K + K * K) * norm};
+    } else {
+        norm = 1 / (1 + sqrtf(2 * V) * K + V * K * K);
+        f[0] = {(1 + sqrtf(2) * K + K * K) * norm, 2 * (K * K - 1) * norm, (1 - sqrtf(2) * K + K * K) * norm,
+                2 * (V * K * K - 1) * norm, (1 - sqrtf(2 * V) * K + V * K * K) * norm};
+    }
+
+    K = tanf((float)PI * 3000 / rate);
+    V = powf(10, fabs(gain[1]) / 20.0);
+    if (gain[1] >= 0) {
+        norm = 1 / (1 + 1 / Q * K + K * K);
+        f[1] = {(1 + V / Q * K + K * K) * norm, 2 * (K * K - 1) * norm, (1 - V / Q * K + K * K) * norm,
+                2 * (K * K - 1) * norm, (1 - 1 / Q * K + K * K) * norm};
+    } else {
+        norm = 1 / (1 + V / Q * K + K * K);
+        f[1] = {(1 + 1 / Q * K + K * K) * norm, 2 * (K * K - 1) * norm, (1 - 1 / Q * K + K * K) * norm,
+                2 * (K * K - 1) * norm, (1 - V / Q * K + K * K) * norm};
+    }
+
+    K = tanf((float)PI * 6000 / rate);
+    V = powf(10, fabs(gain[2]) / 20.0);
+    if (gain[2] >= 0) {
+        norm = 1 / (1 + sqrtf(2) * K + K * K);
+        f[2] = {(V + sqrtf(2 * V) * K + K * K) * norm, 2 * (K * K - V) * norm, (V - sqrtf(2 * V) * K + K * K) * norm,
+                2 * (K * K - 1) * norm, (1 - sqrtf(2) * K + K * K) * norm};
+    } else {
+        norm = 1 / (V + sqrtf(2 * V) * K + K * K);
+        f[2] = {(1 + sqrtf(2) * K + K * K) * norm, 2 * (K * K - 1) * norm, (1 - sqrtf(2) * K + K * K) * norm,
+                2 * (K * K - V) * norm, (V - sqrtf(2 * V) * K + K * K) * norm};
+    }
+}
+
+static void eq_test_setup(BiquadEQ &eq, const eq_test_filter_t f[3], const int8_t gain[3])
+{
+    for (uint8_t i = 0; i < 3; i++) {
+        eq.setStage(i, f[i].a0, f[i].a1, f[i].a2, f[i].b1, f[i].b2, gain[i] == 0);
+    }
+}
+
+// The filter chain of Audio::playSample(), one frame at a time, in float as
+// there or in double as the exact reference. Its int16_t cast wraps past
+// full scale, here it saturates like BiquadEQ, and 0 dB stages are skipped
+// rather than run with coefficients a rounding away from 1, 0, 0, 0, 0.
+template <typename T>
+static void eq_test_reference(const eq_test_filter_t f[3], const int8_t gain[3], T mem[3][2][4], int16_t s[2])
+{
+    for (int i = 0; i < 3; i++) {
+        for (int ch = 0; ch < 2 && gain[i]; ch++) {
+            T *m = mem[i][ch];
+            T x = (T)s[ch];
+            T y = f[i].a0 * x + f[i].a1 * m[0] + f[i].a2 * m[1] - f[i].b1 * m[2] - f[i].b2 * m[3];
+            m[1] = m[0]; m[0] = x;
+            m[3] = m[2]; m[2] = y;
+            s[ch] = y > 32767 ? 32767 : y < -32768 ? -32768 : (int16_t)y;
+        }
+    }
+}
+
+// Music-like test signal: a bass line, a voice band tone, hiss and a few
+// full scale clicks, halved as playBlock() does before the filters
+static void eq_test_signal(int16_t *buff, size_t frames, uint32_t rate)
+{
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < frames; i++) {
+        seed = seed * 1664525 + 1013904223;
+        float t = (float)i / rate;
+        float v = 12000 * sinf(2 * PI * 110 * t) + 8000 * sinf(2 * PI * 2800 * t) + (int16_t)(seed >> 16) / 8;
+        if (i % 5000 == 0) {
+            v = 32767;
+        }
+        if (v > 32767) v = 32767;
+        if (v < -32768) v = -32768;
+        buff[2 * i] = (int16_t)v >> 1;
+        buff[2 * i + 1] = (int16_t)(-v / 2) >> 1;
+    }
+}
+
+void test_biquad_eq_flat(void)
+{
+    static int16_t buff[EQ_TEST_BLOCK * 2], copy[EQ_TEST_BLOCK * 2];
+    BiquadEQ eq;
+    TEST_ASSERT_TRUE(eq.isFlat());
+
+    // setTone(0, 0, 0): nothing to filter, the block is not touched
+    const int8_t flat[3] = {0, 0, 0};
+    eq_test_filter_t f[3];
+    eq_test_coefficients(44100, flat, f);
+    eq_test_setup(eq, f, flat);
+    TEST_ASSERT_TRUE(eq.isFlat());
+    eq_test_signal(buff, EQ_TEST_BLOCK, 44100);
+    memcpy(copy, buff, sizeof(buff));
+    eq.process(buff, EQ_TEST_BLOCK);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(copy, buff, EQ_TEST_BLOCK * 2);
+
+    // One stage away from 0 dB turns filtering on
+    const int8_t bass[3] = {6, 0, 0};
+    eq_test_coefficients(44100, bass, f);
+    eq_test_setup(eq, f, bass);
+    TEST_ASSERT_FALSE(eq.isFlat());
+    eq.process(buff, EQ_TEST_BLOCK);
+    TEST_ASSERT_FALSE(memcmp(copy, buff, sizeof(buff)) == 0);
+}
+
+// Largest and mean difference from the chain in T over the test signal
+template <typename T>
+static int eq_test_error(uint32_t rate, const int8_t gain[3], float *mean)
+{
+    static int16_t fixed[EQ_TEST_FRAMES * 2], ref[EQ_TEST_FRAMES * 2];
+    eq_test_filter_t f[3];
+    eq_test_coefficients(rate, gain, f);
+    BiquadEQ eq;
+    eq_test_setup(eq, f, gain);
+    eq_test_signal(fixed, EQ_TEST_FRAMES, rate);
+    memcpy(ref, fixed, sizeof(ref));
+
+    // Uneven blocks, the filter memory carries across them
+    for (size_t done = 0, n = 1; done < EQ_TEST_FRAMES; done += n, n = n * 2 + 7) {
+        if (n > EQ_TEST_BLOCK) {
+            n = EQ_TEST_BLOCK;
+        }
+        if (n > EQ_TEST_FRAMES - done) {
+            n = EQ_TEST_FRAMES - done;
+        }
+        eq.process(fixed + 2 * done, n);
+    }
+
+    T mem[3][2][4] = {};
+    int worst = 0;
+    uint32_t sum = 0;
+    for (size_t i = 0; i < EQ_TEST_FRAMES; i++) {
+        eq_test_reference(f, gain, mem, ref + 2 * i);
+        for (int ch = 0; ch < 2; ch++) {
+            int e = abs(fixed[2 * i + ch] - ref[2 * i + ch]);
+            sum += e;
+            if (e > worst) {
+                worst = e;
+            }
+        }
+    }
+    if (mean) {
+        *mean = (float)sum / (EQ_TEST_FRAMES * 2);
+    }
+    return worst;
+}
+
+void test_biquad_eq_reference(void)
+{
+    static const uint32_t rates[] = {16000, 22050, 44100, 48000};
+
+    // One stage on its own stays within an LSB of the exact filter
+    static const int8_t single[][3] = {
+        {6, 0, 0}, {0, 6, 0}, {0, 0, 6}, {-40, 0, 0}, {0, -40, 0}, {0, 0, -40}, {-3, 0, 0}, {0, 2, 0},
+    };
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        for (size_t g = 0; g < sizeof(single) / sizeof(single[0]); g++) {
+            TEST_ASSERT_TRUE(eq_test_error<double>(rates[r], single[g], NULL) <= 1);
+        }
+    }
+
+    // Chained, a truncation that goes the other way in one stage comes out
+    // of the next ones amplified, by up to 4 LSB with every stage at +6 dB.
+    // The float filters of playSample() are no closer to the exact ones.
+    static const int8_t chains[][3] = {
+        {6, 6, 6}, {-40, -40, -40}, {6, -10, 3}, {-6, 6, -40}, {-20, 4, 6},
+    };
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        for (size_t g = 0; g < sizeof(chains) / sizeof(chains[0]); g++) {
+            float mean, mean_float;
+            int err = eq_test_error<double>(rates[r], chains[g], &mean);
+            int err_float = eq_test_error<float>(rates[r], chains[g], &mean_float);
+            if (err > 4 || err_float > 4 || mean > 0.05f) {
+                Serial.printf("EQ %d/%d/%d dB at %lu Hz: off by %d (mean %.3f), %d from float (mean %.3f)\n",
+                              chains[g][0], chains[g][1], chains[g][2], (unsigned long)rates[r],
+                              err, mean, err_float, mean_float);
+            }
+            TEST_ASSERT_TRUE(err <= 4);
+            TEST_ASSERT_TRUE(err_float <= 4);
+            TEST_ASSERT_TRUE(mean <= 0.05f);
+        }
+    }
+}
+
+void test_biquad_eq_throughput(void)
+{
+    static int16_t buff[EQ_TEST_FRAMES * 2];
+    const int8_t gain[3] = {6, -10, 3};
+    const int8_t flat[3] = {0, 0, 0};
+    eq_test_filter_t f[3];
+    eq_test_coefficients(44100, gain, f);
+    eq_test_signal(buff, EQ_TEST_FRAMES, 44100);
+    const uint32_t samples = EQ_BENCH_ROUNDS * EQ_TEST_FRAMES * 2;
+
+    float mem[3][2][4] = {};
+    uint32_t start = micros();
+    for (int r = 0; r < EQ_BENCH_ROUNDS; r++) {
+        for (size_t i = 0; i < EQ_TEST_FRAMES; i++) {
+            eq_test_reference(f, gain, mem, buff + 2 * i);
+        }
+    }
+    uint32_t float_us = micros() - start;
+
+    BiquadEQ eq;
+    eq_test_setup(eq, f, gain);
+    eq_test_signal(buff, EQ_TEST_FRAMES, 44100);
+    start = micros();
+    for (int r = 0; r < EQ_BENCH_ROUNDS; r++) {
+        for (size_t i = 0; i < EQ_TEST_FRAMES; i += EQ_TEST_BLOCK) {
+            eq.process(buff + 2 * i, EQ_TEST_FRAMES - i < EQ_TEST_BLOCK ? EQ_TEST_FRAMES - i : EQ_TEST_BLOCK);
+        }
+    }
+    uint32_t fixed_us = micros() - start;
+
+    eq_test_setup(eq, f, flat);
+    start = micros();
+    for (int r = 0; r < EQ_BENCH_ROUNDS; r++) {
+        for (size_t i = 0; i < EQ_TEST_FRAMES; i += EQ_TEST_BLOCK) {
+            eq.process(buff + 2 * i, EQ_TEST_FRAMES - i < EQ_TEST_BLOCK ? EQ_TEST_FRAMES - i : EQ_TEST_BLOCK);
+        }
+    }
+    uint32_t flat_us = micros() - start;
+
+    // One core, three stages, and real time 44.1 kHz stereo streams
+    Serial.printf("EQ samples/s per core: float per sample %lu, fixed block %lu (%lu streams), flat %lu us in all\n",
+                  (unsigned long)(samples * 1000000ULL / (float_us ? float_us : 1)),
+                  (unsigned long)(samples * 1000000ULL / (fixed_us ? fixed_us : 1)),
+                  (unsigned long)(samples * 1000000ULL / (fixed_us ? fixed_us : 1) / 88200),
+                  (unsigned long)flat_us);
+    TEST_ASSERT_TRUE(flat_us < fixed_us);
+}
@@ -0,0 +1,111 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "boot_profile.h"
+#include "boot_orchestrator.h"
+
+#define BOOT_TEST_PROBE_MS      200
+#define BOOT_TEST_SLOW_MS       600
+
+void test_boot_profile_ring(void) {
+    boot_profile_reset();
+
+    uint32_t a = boot_phase_begin("a");
+    uint32_t b = boot_phase_begin("b");
+    delay(2);
+    boot_phase_end(b, false);
+    boot_phase_end(a, true);
+
+    boot_phase_t phase;
+    TEST_ASSERT_EQUAL(2, boot_profile_count());
+    TEST_ASSERT_TRUE(boot_profile_get(0, &phase));
+    TEST_ASSERT_EQUAL_STRING("a", phase.name);
+    TEST_ASSERT_TRUE(phase.ok);
+    TEST_ASSERT_TRUE(phase.end_us - phase.start_us >= 2000);
+    TEST_ASSERT_TRUE(boot_profile_get(1, &phase));
+    TEST_ASSERT_FALSE(phase.ok);
+
+    // Wrap the ring: the oldest records are overwritten
+    uint32_t running = 0;
+    for (int i = 0; i < BOOT_PROFILE_CAPACITY; i++) {
+        running = boot_phase_begin(i == BOOT_PROFILE_CAPACITY - 1 ? "last" : "fill");
+        if (i != BOOT_PROFILE_CAPACITY - 1) {
+            boot_phase_end(running, true);
+        }
+    }
+    TEST_ASSERT_EQUAL(BOOT_PROFILE_CAPACITY, boot_profile_count());
+    TEST_ASSERT_TRUE(boot_profile_get(0, &phase));
+    TEST_ASSERT_EQUAL_STRING("fill", phase.name);
+    TEST_ASSERT_TRUE(boot_profile_get(BOOT_PROFILE_CAPACITY - 1, &phase));
+    TEST_ASSERT_EQUAL_STRING("last", phase.name);
+    TEST_ASSERT_EQUAL(0, phase.end_us);
+
+    // A stale handle must not touch the slot reused by a newer phase
+    boot_phase_end(a, true);
+    TEST_ASSERT_TRUE(boot_profile_get(BOOT_PROFILE_CAPACITY - 2, &phase));
+    TEST_ASSERT_EQUAL_STRING("fill", phase.name);
+
+    char text[BOOT_PROFILE_CAPACITY * 40];
+    size_t len = boot_profile_format(text, sizeof(text));
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_NOT_NULL(strstr(text, "... last"));
+
+    // Truncated output stays terminated
+    char small[16];
+    len = boot_profile_format(small, sizeof(small));
+    TEST_ASSERT_TRUE(len < sizeof(small));
+    TEST_ASSERT_EQUAL('\0', small[len]);
+}
+
+static bool probe_fast(void)
+{
+    delay(BOOT_TEST_PROBE_MS);
+    return true;
+}
+
+static bool probe_failing(void)
+{
+    delay(BOOT_TEST_PROBE_MS);
+    return false;
+}
+
+static bool probe_slow(void)
+{
+    delay(BOOT_TEST_SLOW_MS);
+    return true;
+}
+
+static const boot_probe_t test_probes[] = {
+    {"sd",    probe_fast,    4 * 1024, true},
+    {"audio", probe_failing, 4 * 1024, true},
+    {"wifi",  probe_fast,    4 * 1024, true},
+    {"gps",   probe_slow,    4 * 1024, false},
+};
+
+void test_boot_probes_parallel(void) {
+    boot_profile_reset();
+    uint32_t start = millis();
+    boot_probes_start(test_probes, 4);
+
+    while (!boot_probes_ready() && millis() - start < 5000) {
+        delay(5);
+    }
+    uint32_t ready_ms = millis() - start;
+    Serial.printf("Boot probes: required ready in %lu ms, serial would take %d ms\n",
+                  (unsigned long)ready_ms, 3 * BOOT_TEST_PROBE_MS + BOOT_TEST_SLOW_MS);
+
+    // Required probes overlap, the slow optional one is not waited for
+    TEST_ASSERT_TRUE(boot_probes_ready());
+    TEST_ASSERT_TRUE(ready_ms < 2 * BOOT_TEST_PROBE_MS);
+    TEST_ASSERT_FALSE(boot_probe_done(3));
+    TEST_ASSERT_TRUE(boot_probe_ok(0));
+    TEST_ASSERT_TRUE(boot_probe_done(1));
+    TEST_ASSERT_FALSE(boot_probe_ok(1));
+
+    while (!boot_probe_done(3) && millis() - start < 5000) {
+        delay(5);
+    }
+    TEST_ASSERT_TRUE(boot_probe_ok(3));
+    TEST_ASSERT_EQUAL(4, boot_profile_count());
+    boot_profile_ready();
+    boot_profile_dump();
+}
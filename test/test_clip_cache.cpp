@@ -0,0 +1,187 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <math.h>
+#include "clip_cache.h"
+
+#define CLIP_TEST_SINE_RATE     16000
+#define CLIP_TEST_SINE_FRAMES   8000            // Half a second
+#define CLIP_TEST_SINE_HZ       440
+#define CLIP_TEST_SINE_AMP      10000
+#define CLIP_TEST_CONST_FRAMES  1000
+#define CLIP_TEST_HELLO_MS      6713            // data/hello.mp3, 257 frames after the Xing header
+
+static int16_t clip_test_pcm[CLIP_TEST_SINE_FRAMES * 2];
+
+static void clip_test_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void clip_test_put32(uint8_t *p, uint32_t v)
+{
+    clip_test_put16(p, v);
+    clip_test_put16(p + 2, v >> 16);
+}
+
+// 16 bit PCM from clip_test_pcm, with a LIST chunk ahead of "data" to walk over
+static void clip_test_write_wav(const char *path, uint32_t rate, uint16_t channels, uint32_t frames)
+{
+    uint32_t data_len = frames * channels * 2;
+    uint8_t hdr[56];
+    memcpy(hdr, "RIFF", 4);
+    clip_test_put32(hdr + 4, sizeof(hdr) - 8 + data_len);
+    memcpy(hdr + 8, "WAVE", 4);
+    memcpy(hdr + 12, "fmt ", 4);
+    clip_test_put32(hdr + 16, 16);
+    clip_test_put16(hdr + 20, 1);
+    clip_test_put16(hdr + 22, channels);
+    clip_test_put32(hdr + 24, rate);
+    clip_test_put32(hdr + 28, rate * channels * 2);
+    clip_test_put16(hdr + 32, channels * 2);
+    clip_test_put16(hdr + 34, 16);
+    memcpy(hdr + 36, "LIST", 4);
+    clip_test_put32(hdr + 40, 4);
+    memcpy(hdr + 44, "INFO", 4);
+    memcpy(hdr + 48, "data", 4);
+    clip_test_put32(hdr + 52, data_len);
+
+    File file = SPIFFS.open(path, FILE_WRITE);
+    TEST_ASSERT_TRUE((bool)file);
+    TEST_ASSERT_EQUAL(sizeof(hdr), file.write(hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL(data_len, file.write((const uint8_t *)clip_test_pcm, data_len));
+    file.close();
+}
+
+static void clip_test_fill(uint32_t frames, uint16_t channels, int16_t left, int16_t right)
+{
+    for (uint32_t i = 0; i < frames; i++) {
+        clip_test_pcm[i * channels] = left;
+        if (channels == 2) {
+            clip_test_pcm[i * 2 + 1] = right;
+        }
+    }
+}
+
+// Clips stay registered for the whole run, later tests reuse them
+static int clip_test_add(const char *name, const char *path, bool preload)
+{
+    int id = clip_cache_find(name);
+    return id >= 0 ? id : clip_cache_add(name, path, preload);
+}
+
+static void clip_test_begin(void)
+{
+    SPIFFS.begin(true);
+    TEST_ASSERT_TRUE(clip_cache_begin(NULL, NULL, &SPIFFS, false));
+}
+
+void test_clip_cache_wav(void)
+{
+    clip_test_begin();
+
+    for (int i = 0; i < CLIP_TEST_SINE_FRAMES; i++) {
+        clip_test_pcm[i] = (int16_t)(CLIP_TEST_SINE_AMP * sinf(2 * (float)M_PI * CLIP_TEST_SINE_HZ * i / CLIP_TEST_SINE_RATE));
+    }
+    clip_test_write_wav("/clip_sine.wav", CLIP_TEST_SINE_RATE, 1, CLIP_TEST_SINE_FRAMES);
+    clip_test_fill(CLIP_TEST_CONST_FRAMES, 2, 1000, 3000);
+    clip_test_write_wav("/clip_const.wav", CLIP_SAMPLE_RATE, 2, CLIP_TEST_CONST_FRAMES);
+    File file = SPIFFS.open("/clip_bogus.wav", FILE_WRITE);
+    TEST_ASSERT_TRUE((bool)file);
+    file.print("RIFF....WAVEnot a wav, not an mp3 either");
+    file.close();
+
+    int sine = clip_test_add("sine", "/clip_sine.wav", true);
+    int constant = clip_test_add("const", "/clip_const.wav", true);
+    int bogus = clip_test_add("bogus", "/clip_bogus.wav", true);
+    int missing = clip_test_add("missing", "/clip_missing.wav", true);
+    TEST_ASSERT_TRUE(sine >= 0 && constant >= 0 && bogus >= 0 && missing >= 0);
+    TEST_ASSERT_EQUAL(-1, clip_cache_add("sine", "/clip_sine.wav", true));
+    TEST_ASSERT_EQUAL(sine, clip_cache_find("sine"));
+
+    clip_info_t info;
+    TEST_ASSERT_TRUE(clip_cache_info(sine, &info));
+    TEST_ASSERT_FALSE(info.loaded);
+    TEST_ASSERT_EQUAL(0, info.frames);
+
+    // 16 kHz resampled to 44.1 kHz, still the same sine
+    TEST_ASSERT_TRUE(clip_cache_load(sine));
+    TEST_ASSERT_TRUE(clip_cache_info(sine, &info));
+    TEST_ASSERT_TRUE(info.loaded);
+    TEST_ASSERT_EQUAL(CLIP_TEST_SINE_RATE, info.source_rate);
+    TEST_ASSERT_UINT32_WITHIN(3, (uint64_t)CLIP_TEST_SINE_FRAMES * CLIP_SAMPLE_RATE / CLIP_TEST_SINE_RATE, info.frames);
+
+    uint32_t sine_frames = 0;
+    const int16_t *pcm = clip_cache_pcm(sine, &sine_frames);
+    TEST_ASSERT_NOT_NULL(pcm);
+    TEST_ASSERT_EQUAL(info.frames, sine_frames);
+    for (uint32_t n = 0; n < sine_frames; n++) {
+        int16_t expect = (int16_t)(CLIP_TEST_SINE_AMP * sinf(2 * (float)M_PI * CLIP_TEST_SINE_HZ * n / CLIP_SAMPLE_RATE));
+        TEST_ASSERT_INT_WITHIN(64, expect, pcm[n]);
+    }
+
+    // Stereo is averaged to mono
+    TEST_ASSERT_TRUE(clip_cache_request(constant));
+    uint32_t frames = 0;
+    pcm = clip_cache_pcm(constant, &frames);
+    TEST_ASSERT_NOT_NULL(pcm);
+    TEST_ASSERT_EQUAL(CLIP_TEST_CONST_FRAMES, frames);
+    for (uint32_t n = 0; n < frames; n++) {
+        TEST_ASSERT_EQUAL(2000, pcm[n]);
+    }
+
+    // Failures stick and are not played
+    TEST_ASSERT_FALSE(clip_cache_load(bogus));
+    TEST_ASSERT_FALSE(clip_cache_load(missing));
+    TEST_ASSERT_TRUE(clip_cache_info(missing, &info));
+    TEST_ASSERT_TRUE(info.failed);
+    TEST_ASSERT_TRUE(clip_cache_failed(missing));
+    TEST_ASSERT_FALSE(clip_cache_request(missing));
+    TEST_ASSERT_NULL(clip_cache_pcm(missing, &frames));
+    TEST_ASSERT_TRUE(clip_cache_failed(CLIP_CACHE_MAX));
+
+    clip_cache_stats_t stats;
+    clip_cache_get_stats(&stats);
+    TEST_ASSERT_TRUE(stats.loaded >= 2);
+    TEST_ASSERT_TRUE(stats.bytes >= (CLIP_TEST_CONST_FRAMES + sine_frames) * sizeof(int16_t));
+
+    SPIFFS.remove("/clip_sine.wav");
+    SPIFFS.remove("/clip_const.wav");
+    SPIFFS.remove("/clip_bogus.wav");
+}
+
+void test_clip_cache_mp3(void)
+{
+    clip_test_begin();
+    if (!SPIFFS.exists("/hello.mp3")) {
+        TEST_IGNORE_MESSAGE("hello.mp3 not in SPIFFS, upload the data folder");
+    }
+    int hello = clip_test_add("hello.mp3", "/hello.mp3", true);
+    TEST_ASSERT_TRUE(hello >= 0);
+
+    uint32_t start = millis();
+    TEST_ASSERT_TRUE(clip_cache_load(hello));
+    uint32_t elapsed = millis() - start;
+
+    clip_info_t info;
+    TEST_ASSERT_TRUE(clip_cache_info(hello, &info));
+    TEST_ASSERT_EQUAL(CLIP_SAMPLE_RATE, info.source_rate);
+    uint32_t ms = (uint64_t)info.frames * 1000 / CLIP_SAMPLE_RATE;
+    TEST_ASSERT_UINT32_WITHIN(CLIP_TEST_HELLO_MS / 50, CLIP_TEST_HELLO_MS, ms);
+
+    // Not silence
+    uint32_t frames = 0;
+    const int16_t *pcm = clip_cache_pcm(hello, &frames);
+    TEST_ASSERT_NOT_NULL(pcm);
+    double energy = 0;
+    for (uint32_t n = 0; n < frames; n++) {
+        energy += (double)pcm[n] * pcm[n];
+    }
+    TEST_ASSERT_TRUE(sqrt(energy / frames) > 100);
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "%lu ms of audio decoded in %lu ms",
+             (unsigned long)ms, (unsigned long)elapsed);
+    TEST_MESSAGE(msg);
+}
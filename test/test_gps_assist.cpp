@@ -0,0 +1,149 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include "gps_assist.h"
+
+#define ASSIST_TEST_EPOCH       1792300000      // 2026-10-18 UTC
+
+static bool assist_next_frame(ubx_parser_t *parser, const uint8_t *data, size_t len, size_t *pos)
+{
+    while (*pos < len) {
+        if (ubx_parser_feed(parser, data[(*pos)++])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static gps_fix_t assist_fix(double lat, double lng)
+{
+    gps_fix_t fix;
+    memset(&fix, 0, sizeof(fix));
+    fix.lat = lat;
+    fix.lng = lng;
+    fix.location_valid = true;
+    return fix;
+}
+
+void test_gps_assist_mga_time(void) {
+    gps_assist_begin(nullptr);
+    gps_assist_start(GPS_ASSIST_MODEL_M10, GPS_PROTOCOL_UBX);
+
+    // Nothing known: no position, clock not set
+    uint8_t frames[64];
+    TEST_ASSERT_EQUAL(0, gps_assist_mga_ini(frames, sizeof(frames), 0));
+    TEST_ASSERT_EQUAL(0, gps_assist_given());
+
+    size_t len = gps_assist_mga_ini(frames, sizeof(frames), ASSIST_TEST_EPOCH);
+    TEST_ASSERT_EQUAL(UBX_FRAME_OVERHEAD + 24, len);
+    TEST_ASSERT_EQUAL(GPS_ASSIST_TIME, gps_assist_given());
+
+    ubx_parser_t parser;
+    ubx_parser_init(&parser);
+    size_t pos = 0;
+    TEST_ASSERT_TRUE(assist_next_frame(&parser, frames, len, &pos));
+    TEST_ASSERT_EQUAL(UBX_CLASS_MGA, parser.cls);
+    TEST_ASSERT_EQUAL(UBX_MGA_INI, parser.id);
+    TEST_ASSERT_EQUAL(0x10, parser.payload[0]);                 // TIME_UTC
+    TEST_ASSERT_EQUAL(2026, parser.payload[4] | (parser.payload[5] << 8));
+    TEST_ASSERT_EQUAL(10, parser.payload[6]);
+    TEST_ASSERT_EQUAL(18, parser.payload[7]);
+    TEST_ASSERT_EQUAL(GPS_ASSIST_TIME_ACC_MS / 1000, parser.payload[16] | (parser.payload[17] << 8));
+
+    // Too small for the frame
+    TEST_ASSERT_EQUAL(0, gps_assist_mga_time(frames, 16, ASSIST_TEST_EPOCH));
+}
+
+void test_gps_assist_persist(void) {
+    TEST_ASSERT_TRUE(SPIFFS.begin(true));
+    SPIFFS.remove(GPS_ASSIST_FILE);
+    TEST_ASSERT_FALSE(gps_assist_begin(&SPIFFS));
+    gps_assist_start(GPS_ASSIST_MODEL_M10, GPS_PROTOCOL_UBX);
+
+    // Cold start: the first fix saves the position and the unassisted time
+    gps_fix_t fix = assist_fix(0, 0);
+    fix.location_valid = false;
+    gps_assist_poll(&fix, 0);
+    TEST_ASSERT_FALSE(SPIFFS.exists(GPS_ASSIST_FILE));
+    fix = assist_fix(33.9425, -118.4081);
+    gps_assist_poll(&fix, 41);
+    TEST_ASSERT_TRUE(SPIFFS.exists(GPS_ASSIST_FILE));
+
+    char text[48];
+    gps_assist_ttff_text(text, sizeof(text), 41);
+    TEST_ASSERT_EQUAL_STRING("41 s", text);
+
+    // Next boot hands the position back
+    TEST_ASSERT_TRUE(gps_assist_begin(&SPIFFS));
+    gps_assist_start(GPS_ASSIST_MODEL_M10, GPS_PROTOCOL_UBX);
+    uint8_t frames[64];
+    size_t len = gps_assist_mga_ini(frames, sizeof(frames), ASSIST_TEST_EPOCH);
+    TEST_ASSERT_EQUAL(2 * UBX_FRAME_OVERHEAD + 20 + 24, len);
+    TEST_ASSERT_EQUAL(GPS_ASSIST_POSITION | GPS_ASSIST_TIME, gps_assist_given());
+
+    ubx_parser_t parser;
+    ubx_parser_init(&parser);
+    size_t pos = 0;
+    TEST_ASSERT_TRUE(assist_next_frame(&parser, frames, len, &pos));
+    TEST_ASSERT_EQUAL(0x01, parser.payload[0]);                 // POS_LLH
+    int32_t lat, lon;
+    uint32_t acc;
+    memcpy(&lat, parser.payload + 4, 4);
+    memcpy(&lon, parser.payload + 8, 4);
+    memcpy(&acc, parser.payload + 16, 4);
+    TEST_ASSERT_EQUAL(339425000, lat);
+    TEST_ASSERT_EQUAL(-1184081000, lon);
+    TEST_ASSERT_EQUAL(GPS_ASSIST_POS_ACC_CM, acc);
+    TEST_ASSERT_TRUE(assist_next_frame(&parser, frames, len, &pos));
+    TEST_ASSERT_EQUAL(0x10, parser.payload[0]);
+
+    fix = assist_fix(33.9426, -118.4081);
+    gps_assist_poll(&fix, 12);
+    gps_assist_ttff_text(text, sizeof(text), 12);
+    TEST_ASSERT_EQUAL_STRING("12 s assisted (cold 41 s)", text);
+    gps_assist_ttff_text(text, sizeof(text), 0);
+    TEST_ASSERT_EQUAL_STRING("N.A", text);
+
+    // A damaged record is ignored
+    File file = SPIFFS.open(GPS_ASSIST_FILE, FILE_WRITE);
+    const uint8_t junk[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    file.write(junk, sizeof(junk));
+    file.close();
+    TEST_ASSERT_FALSE(gps_assist_begin(&SPIFFS));
+    SPIFFS.remove(GPS_ASSIST_FILE);
+}
+
+void test_gps_assist_db_load(void) {
+    TEST_ASSERT_TRUE(SPIFFS.begin(true));
+    uint8_t payload[60];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = i;
+    }
+
+    // Two whole MGA-DBD frames, then one cut short by a reset
+    uint8_t data[3 * (UBX_FRAME_OVERHEAD + sizeof(payload))];
+    size_t len = 0;
+    for (int i = 0; i < 3; i++) {
+        len += ubx_frame(data + len, sizeof(data) - len, UBX_CLASS_MGA, UBX_MGA_DBD, payload, sizeof(payload));
+    }
+    size_t whole = 2 * (UBX_FRAME_OVERHEAD + sizeof(payload));
+    File file = SPIFFS.open(GPS_ASSIST_DB_FILE, FILE_WRITE);
+    file.write(data, whole + 20);
+    file.close();
+
+    gps_assist_begin(&SPIFFS);
+    gps_assist_start(GPS_ASSIST_MODEL_M10, GPS_PROTOCOL_UBX);
+    uint8_t buf[sizeof(data)];
+    TEST_ASSERT_EQUAL(whole, gps_assist_db_load(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_MEMORY(data, buf, whole);
+    TEST_ASSERT_TRUE(gps_assist_given() & GPS_ASSIST_DATABASE);
+
+    // Anything but MGA-DBD stops the replay
+    file = SPIFFS.open(GPS_ASSIST_DB_FILE, FILE_WRITE);
+    file.write(data, 4);
+    file.close();
+    gps_assist_start(GPS_ASSIST_MODEL_M10, GPS_PROTOCOL_UBX);
+    TEST_ASSERT_EQUAL(0, gps_assist_db_load(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(0, gps_assist_given());
+    SPIFFS.remove(GPS_ASSIST_DB_FILE);
+}
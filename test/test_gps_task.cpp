@@ -0,0 +1,117 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "gps_task.h"
+
+static const char *const GPS_TEST_RMC = "$GPRMC,083559.00,A,4717.11437,N,00833.91522,E,0.004,77.52,091202,,,A*57\r\n";
+static const char *const GPS_TEST_GGA = "$GPGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,*5B\r\n";
+
+#define GPS_BENCH_BYTES         (64 * 1024)
+
+static uint32_t framed;
+static size_t framed_len;
+
+static void count_sentence(const char *sentence, size_t len, void *ctx)
+{
+    framed++;
+    framed_len += len;
+    TEST_ASSERT_EQUAL('$', sentence[0]);
+    TEST_ASSERT_EQUAL('\n', sentence[len - 1]);
+}
+
+static void framer_feed(gps_framer_t *framer, const char *data, size_t chunk)
+{
+    size_t len = strlen(data);
+    while (len) {
+        size_t space;
+        char *dst = gps_framer_space(framer, &space);
+        size_t n = len < chunk ? len : chunk;
+        n = n < space ? n : space;
+        memcpy(dst, data, n);
+        gps_framer_commit(framer, n, count_sentence, NULL);
+        data += n;
+        len -= n;
+    }
+}
+
+void test_gps_nmea_checksum(void) {
+    TEST_ASSERT_TRUE(gps_nmea_checksum_ok(GPS_TEST_RMC, strlen(GPS_TEST_RMC)));
+    TEST_ASSERT_TRUE(gps_nmea_checksum_ok(GPS_TEST_GGA, strlen(GPS_TEST_GGA)));
+
+    char corrupt[96];
+    strcpy(corrupt, GPS_TEST_RMC);
+    corrupt[10] = '9';
+    TEST_ASSERT_FALSE(gps_nmea_checksum_ok(corrupt, strlen(corrupt)));
+    TEST_ASSERT_FALSE(gps_nmea_checksum_ok("$GPTXT,01\r\n", 11));
+    TEST_ASSERT_FALSE(gps_nmea_checksum_ok("$GPTXT*4", 8));
+}
+
+void test_gps_framer_split_and_noise(void) {
+    static gps_framer_t framer;
+    char stream[512];
+    snprintf(stream, sizeof(stream), "noise%s%s$GPGGA,cut\r\n%s", GPS_TEST_RMC, GPS_TEST_GGA, GPS_TEST_RMC);
+
+    // Sentences split across every possible read size frame the same way
+    for (size_t chunk = 1; chunk <= 40; chunk++) {
+        gps_framer_init(&framer);
+        framed = 0;
+        framed_len = 0;
+        framer_feed(&framer, stream, chunk);
+        TEST_ASSERT_EQUAL(3, framed);
+        TEST_ASSERT_EQUAL(2 * strlen(GPS_TEST_RMC) + strlen(GPS_TEST_GGA), framed_len);
+        TEST_ASSERT_EQUAL(1, framer.bad_checksum);
+        TEST_ASSERT_EQUAL(0, framer.len);
+    }
+
+    // A line longer than the buffer is dropped, framing resumes after it
+    gps_framer_init(&framer);
+    framed = 0;
+    char junk[GPS_FRAME_BUFFER_SIZE + 100];
+    memset(junk, 'x', sizeof(junk) - 1);
+    junk[sizeof(junk) - 1] = '\0';
+    framer_feed(&framer, junk, 64);
+    framer_feed(&framer, "\r\n", 64);
+    framer_feed(&framer, GPS_TEST_GGA, 64);
+    TEST_ASSERT_EQUAL(1, framer.overflows);
+    TEST_ASSERT_EQUAL(1, framed);
+}
+
+void test_gps_task_fix_snapshot(void) {
+    static TinyGPSPlus parser;
+    static HardwareSerial serial;
+    gps_fix_t fix;
+
+    TEST_ASSERT_TRUE(gps_task_begin(&serial, &parser, GPS_PROTOCOL_NMEA));
+    TEST_ASSERT_FALSE(gps_fix_read(&fix));
+
+    gps_task_ingest((const uint8_t *)GPS_TEST_RMC, strlen(GPS_TEST_RMC));
+    TEST_ASSERT_TRUE(gps_fix_read(&fix));
+    TEST_ASSERT_TRUE(fix.location_valid);
+    TEST_ASSERT_TRUE(fabs(fix.lat - 47.285239) < 0.00001);
+    TEST_ASSERT_TRUE(fabs(fix.lng - 8.565254) < 0.00001);
+    TEST_ASSERT_EQUAL(2002, fix.year);
+    TEST_ASSERT_EQUAL(12, fix.month);
+    TEST_ASSERT_EQUAL(9, fix.day);
+    TEST_ASSERT_EQUAL(8, fix.hour);
+    TEST_ASSERT_EQUAL(35, fix.minute);
+    TEST_ASSERT_EQUAL(59, fix.second);
+    TEST_ASSERT_EQUAL(1, fix.sentences);
+    TEST_ASSERT_EQUAL(strlen(GPS_TEST_RMC), fix.chars);
+
+    // Throughput of framing plus parsing, a 10 Hz RMC+GGA stream is ~1.7 KB/s
+    static char stream[GPS_BENCH_BYTES];
+    size_t len = 0;
+    uint32_t sentences = 0;
+    while (len + 2 * 100 < sizeof(stream)) {
+        len += snprintf(stream + len, sizeof(stream) - len, "%s%s", GPS_TEST_RMC, GPS_TEST_GGA);
+        sentences += 2;
+    }
+    uint32_t start = micros();
+    gps_task_ingest((const uint8_t *)stream, len);
+    uint32_t elapsed = micros() - start;
+
+    TEST_ASSERT_TRUE(gps_fix_read(&fix));
+    TEST_ASSERT_EQUAL(1 + sentences, fix.sentences);
+    TEST_ASSERT_EQUAL(0, fix.bad_sentences);
+    Serial.printf("GPS task: %u bytes, %lu sentences in %lu us\n", (unsigned)len,
+                  (unsigned long)sentences, (unsigned long)elapsed);
+}
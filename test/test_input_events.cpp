@@ -0,0 +1,73 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "input_events.h"
+
+static void input_test_drain(uint8_t queue)
+{
+    input_event_t event;
+    while (input_events_next(queue, &event)) {
+    }
+}
+
+// Events come out per source, in order, with the time of their edge
+void test_input_events_queue(void)
+{
+    input_test_drain(INPUT_QUEUE_TRACKBALL);
+    input_test_drain(INPUT_QUEUE_TOUCH);
+
+    input_events_push(INPUT_QUEUE_TRACKBALL, INPUT_EV_RIGHT, 1000);
+    input_events_push(INPUT_QUEUE_TOUCH, INPUT_EV_TOUCH, 1500);
+    input_events_push(INPUT_QUEUE_TRACKBALL, INPUT_EV_BUTTON_DOWN, 2000);
+    input_events_push(INPUT_QUEUE_TRACKBALL, INPUT_EV_UP, 3000);
+    TEST_ASSERT_EQUAL(3, input_events_pending(INPUT_QUEUE_TRACKBALL));
+    TEST_ASSERT_EQUAL(1, input_events_pending(INPUT_QUEUE_TOUCH));
+
+    input_event_t event;
+    TEST_ASSERT_TRUE(input_events_next(INPUT_QUEUE_TRACKBALL, &event));
+    TEST_ASSERT_EQUAL(INPUT_EV_RIGHT, event.type);
+    TEST_ASSERT_EQUAL(1000, event.at_us);
+    TEST_ASSERT_TRUE(input_events_next(INPUT_QUEUE_TRACKBALL, &event));
+    TEST_ASSERT_EQUAL(INPUT_EV_BUTTON_DOWN, event.type);
+    TEST_ASSERT_TRUE(input_events_next(INPUT_QUEUE_TRACKBALL, &event));
+    TEST_ASSERT_EQUAL(INPUT_EV_UP, event.type);
+    TEST_ASSERT_EQUAL(3000, event.at_us);
+    TEST_ASSERT_FALSE(input_events_next(INPUT_QUEUE_TRACKBALL, &event));
+
+    TEST_ASSERT_TRUE(input_events_next(INPUT_QUEUE_TOUCH, &event));
+    TEST_ASSERT_EQUAL(INPUT_EV_TOUCH, event.type);
+    TEST_ASSERT_EQUAL(1500, event.at_us);
+    TEST_ASSERT_FALSE(input_events_next(INPUT_QUEUE_TOUCH, &event));
+}
+
+// The base step from INPUT_TRACKBALL_ACCEL_US up, the limit from the
+// interval that reaches it down, with no jump at either edge
+void test_input_trackball_limits(void)
+{
+    const uint32_t max_us = (uint32_t)INPUT_TRACKBALL_PX * INPUT_TRACKBALL_ACCEL_US / INPUT_TRACKBALL_PX_MAX;
+
+    TEST_ASSERT_EQUAL(INPUT_TRACKBALL_PX, input_trackball_step(UINT32_MAX));
+    TEST_ASSERT_EQUAL(INPUT_TRACKBALL_PX, input_trackball_step(INPUT_TRACKBALL_ACCEL_US + 1));
+    TEST_ASSERT_EQUAL(INPUT_TRACKBALL_PX, input_trackball_step(INPUT_TRACKBALL_ACCEL_US));
+    TEST_ASSERT_EQUAL(INPUT_TRACKBALL_PX, input_trackball_step(INPUT_TRACKBALL_ACCEL_US - 1));
+    TEST_ASSERT_EQUAL(INPUT_TRACKBALL_PX + 1, input_trackball_step(INPUT_TRACKBALL_ACCEL_US * INPUT_TRACKBALL_PX / (INPUT_TRACKBALL_PX + 1)));
+
+    TEST_ASSERT_EQUAL(INPUT_TRACKBALL_PX_MAX - 1, input_trackball_step(max_us + 1));
+    TEST_ASSERT_EQUAL(INPUT_TRACKBALL_PX_MAX, input_trackball_step(max_us));
+    TEST_ASSERT_EQUAL(INPUT_TRACKBALL_PX_MAX, input_trackball_step(INPUT_TRACKBALL_GLITCH_US));
+    TEST_ASSERT_EQUAL(INPUT_TRACKBALL_PX_MAX, input_trackball_step(1));
+    TEST_ASSERT_EQUAL(INPUT_TRACKBALL_PX_MAX, input_trackball_step(0));
+}
+
+// Faster rolls move further in between
+void test_input_trackball_accel(void)
+{
+    TEST_ASSERT_EQUAL(INPUT_TRACKBALL_PX * 2, input_trackball_step(INPUT_TRACKBALL_ACCEL_US / 2));
+
+    int16_t last = INPUT_TRACKBALL_PX_MAX;
+    for (uint32_t us = INPUT_TRACKBALL_GLITCH_US; us <= INPUT_TRACKBALL_ACCEL_US; us += 500) {
+        int16_t step = input_trackball_step(us);
+        TEST_ASSERT_TRUE(step <= last);
+        TEST_ASSERT_TRUE(step >= INPUT_TRACKBALL_PX);
+        last = step;
+    }
+}
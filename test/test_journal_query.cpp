@@ -0,0 +1,87 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "journal_query.h"
+
+static journal_record_t make_record(uint8_t type, uint32_t node_id, uint8_t zone, uint32_t ts)
+{
+    journal_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = type;
+    rec.node_id = node_id;
+    rec.zone = zone;
+    rec.timestamp = ts;
+    journal_record_seal(&rec);
+    return rec;
+}
+
+// Journal query test functions
+void test_journal_index_entry_layout(void) {
+    // Index entries must tile SD sectors like the records they summarise
+    TEST_ASSERT_EQUAL(32, sizeof(journal_block_index_t));
+    TEST_ASSERT_EQUAL(0, JOURNAL_SEGMENT_RECORDS % JOURNAL_BLOCK_RECORDS);
+    TEST_ASSERT_TRUE(JOURNAL_BLOCK_RECORDS <= 255);
+}
+
+void test_journal_filter_match(void) {
+    journal_filter_t filter;
+    journal_filter_init(&filter);
+    journal_record_t rec = make_record(JOURNAL_EVT_ALARM, 0x1001, 3, 1000);
+    TEST_ASSERT_TRUE(journal_filter_match(&filter, &rec));
+
+    filter.from_ts = 1001;
+    TEST_ASSERT_FALSE(journal_filter_match(&filter, &rec));
+    filter.from_ts = 1000;
+    filter.to_ts = 1000;
+    TEST_ASSERT_TRUE(journal_filter_match(&filter, &rec));
+
+    filter.zone = 4;
+    TEST_ASSERT_FALSE(journal_filter_match(&filter, &rec));
+    filter.zone = 3;
+    filter.node_id = 0x1002;
+    TEST_ASSERT_FALSE(journal_filter_match(&filter, &rec));
+    filter.node_id = 0x1001;
+    filter.type_mask = JOURNAL_TYPE_BIT(JOURNAL_EVT_ARM) | JOURNAL_TYPE_BIT(JOURNAL_EVT_DISARM);
+    TEST_ASSERT_FALSE(journal_filter_match(&filter, &rec));
+    filter.type_mask |= JOURNAL_TYPE_BIT(JOURNAL_EVT_ALARM);
+    TEST_ASSERT_TRUE(journal_filter_match(&filter, &rec));
+}
+
+void test_journal_block_index_summary(void) {
+    journal_block_index_t entry;
+    journal_block_index_reset(&entry);
+    for (uint32_t i = 0; i < JOURNAL_BLOCK_RECORDS; i++) {
+        journal_record_t rec = make_record(i % 2 ? JOURNAL_EVT_RADIO_RX : JOURNAL_EVT_HEARTBEAT,
+                                           0x2000 + i * 7, i % 8, 5000 + i);
+        journal_block_index_add(&entry, &rec);
+    }
+    TEST_ASSERT_EQUAL(JOURNAL_BLOCK_RECORDS, entry.count);
+    TEST_ASSERT_EQUAL_UINT32(5000, entry.min_ts);
+    TEST_ASSERT_EQUAL_UINT32(5000 + JOURNAL_BLOCK_RECORDS - 1, entry.max_ts);
+    TEST_ASSERT_EQUAL_HEX32(0xFF, entry.zone_mask);
+    TEST_ASSERT_EQUAL_HEX16(JOURNAL_TYPE_BIT(JOURNAL_EVT_RADIO_RX) | JOURNAL_TYPE_BIT(JOURNAL_EVT_HEARTBEAT),
+                            entry.type_mask);
+}
+
+void test_journal_bloom_no_false_negatives(void) {
+    journal_block_index_t entry;
+    journal_block_index_reset(&entry);
+    TEST_ASSERT_FALSE(journal_block_index_may_contain_node(&entry, 0x12345678));
+
+    for (uint32_t i = 0; i < 16; i++) {
+        journal_record_t rec = make_record(JOURNAL_EVT_RADIO_RX, 0xA0000000 + i * 977, 1, 100);
+        journal_block_index_add(&entry, &rec);
+    }
+    // Every inserted node must be reported, a missed node would hide its events
+    for (uint32_t i = 0; i < 16; i++) {
+        TEST_ASSERT_TRUE(journal_block_index_may_contain_node(&entry, 0xA0000000 + i * 977));
+    }
+
+    // With few nodes per block most foreign nodes are rejected
+    uint32_t false_positives = 0;
+    for (uint32_t i = 0; i < 1000; i++) {
+        if (journal_block_index_may_contain_node(&entry, 0x50000000 + i * 131)) {
+            false_positives++;
+        }
+    }
+    TEST_ASSERT_LESS_THAN_UINT32(150, false_positives);
+}
@@ -0,0 +1,100 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "keyboard.h"
+
+static void kb_test_drain(void)
+{
+    kb_event_t event;
+    while (keyboard_next(&event)) {
+    }
+}
+
+// Events come out in order with their flags, position and character
+void test_keyboard_burst(void)
+{
+    kb_test_drain();
+    kb_stats_t before, after;
+    keyboard_get_stats(&before);
+
+    // Shift down, 'A' down, 'A' up, shift up
+    const uint8_t burst[] = {
+        KB_BURST_MAGIC, 4 | KB_BURST_MORE,
+        KB_EVT_PRESSED | KB_MOD_SHIFT, 1 * KB_MATRIX_ROWS + 6, 0,
+        KB_EVT_PRESSED | KB_MOD_SHIFT, 0 * KB_MATRIX_ROWS + 3, 'A',
+        KB_MOD_SHIFT, 0 * KB_MATRIX_ROWS + 3, 'A',
+        0, 1 * KB_MATRIX_ROWS + 6, 0,
+    };
+    bool more;
+    TEST_ASSERT_EQUAL(4, keyboard_feed_burst(burst, sizeof(burst), 1234, &more));
+    TEST_ASSERT_TRUE(more);
+    TEST_ASSERT_EQUAL(4, keyboard_pending());
+
+    kb_event_t event;
+    TEST_ASSERT_TRUE(keyboard_next(&event));
+    TEST_ASSERT_EQUAL_HEX8(KB_EVT_PRESSED | KB_MOD_SHIFT, event.flags);
+    TEST_ASSERT_EQUAL(0, event.ch);
+    TEST_ASSERT_TRUE(keyboard_next(&event));
+    TEST_ASSERT_EQUAL('A', event.ch);
+    TEST_ASSERT_EQUAL(3, event.key);
+    TEST_ASSERT_TRUE(event.flags & KB_EVT_PRESSED);
+    TEST_ASSERT_EQUAL(1234, event.at_ms);
+    TEST_ASSERT_TRUE(keyboard_next(&event));
+    TEST_ASSERT_EQUAL('A', event.ch);
+    TEST_ASSERT_FALSE(event.flags & KB_EVT_PRESSED);
+    TEST_ASSERT_TRUE(keyboard_next(&event));
+    TEST_ASSERT_FALSE(keyboard_next(&event));
+
+    // An empty burst with the overflow bit only counts the overflow
+    const uint8_t overflow[] = {KB_BURST_MAGIC, KB_BURST_OVERFLOW};
+    TEST_ASSERT_EQUAL(0, keyboard_feed_burst(overflow, sizeof(overflow), 1240, &more));
+    TEST_ASSERT_FALSE(more);
+
+    keyboard_get_stats(&after);
+    TEST_ASSERT_EQUAL(2, after.bursts - before.bursts);
+    TEST_ASSERT_EQUAL(4, after.events - before.events);
+    TEST_ASSERT_EQUAL(1, after.overflows - before.overflows);
+}
+
+// Old firmware answers without the magic; a count past the bytes read is cut
+void test_keyboard_bad_burst(void)
+{
+    kb_test_drain();
+    bool more;
+    const uint8_t legacy[] = {'q', 0, 0};
+    TEST_ASSERT_EQUAL(-1, keyboard_feed_burst(legacy, sizeof(legacy), 0, &more));
+    TEST_ASSERT_EQUAL(0, keyboard_pending());
+
+    const uint8_t short_read[] = {KB_BURST_MAGIC, 5, KB_EVT_PRESSED, 0, 'q', 0, 0};
+    TEST_ASSERT_EQUAL(1, keyboard_feed_burst(short_read, sizeof(short_read), 0, &more));
+    TEST_ASSERT_EQUAL(1, keyboard_pending());
+    kb_test_drain();
+}
+
+// A full queue drops the newest events and counts them
+void test_keyboard_queue_full(void)
+{
+    kb_test_drain();
+    kb_stats_t before, after;
+    keyboard_get_stats(&before);
+
+    uint8_t burst[KB_BURST_BYTES] = {KB_BURST_MAGIC, KB_BURST_EVENTS};
+    for (int i = 0; i < KB_BURST_EVENTS; i++) {
+        burst[2 + i * KB_EVENT_BYTES] = KB_EVT_PRESSED;
+        burst[2 + i * KB_EVENT_BYTES + 1] = i;
+        burst[2 + i * KB_EVENT_BYTES + 2] = 'a' + i;
+    }
+    bool more;
+    int bursts = KB_QUEUE_DEPTH / KB_BURST_EVENTS + 1;
+    for (int i = 0; i < bursts; i++) {
+        TEST_ASSERT_EQUAL(KB_BURST_EVENTS, keyboard_feed_burst(burst, sizeof(burst), i, &more));
+    }
+    TEST_ASSERT_EQUAL(KB_QUEUE_DEPTH, keyboard_pending());
+    keyboard_get_stats(&after);
+    TEST_ASSERT_EQUAL(KB_BURST_EVENTS, after.dropped - before.dropped);
+
+    kb_event_t event;
+    TEST_ASSERT_TRUE(keyboard_next(&event));
+    TEST_ASSERT_EQUAL('a', event.ch);
+    TEST_ASSERT_EQUAL(0, event.at_ms);
+    kb_test_drain();
+}
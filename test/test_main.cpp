@@ -7,6 +7,128 @@ void test_gps_functions(void);
 void test_radio_functions(void);
 void test_ui_functions(void);
 
+// Event journal tests (test_journal.cpp)
+void test_journal_crc32_reference(void);
+void test_journal_record_layout(void);
+void test_journal_record_seal_and_validate(void);
+void test_journal_segment_path(void);
+void test_journal_append_throughput(void);
+
+// Journal query tests (test_journal_query.cpp)
+void test_journal_index_entry_layout(void);
+void test_journal_filter_match(void);
+void test_journal_block_index_summary(void);
+void test_journal_bloom_no_false_negatives(void);
+
+// Node registry tests (test_node_registry.cpp)
+void test_node_registry_insert_and_lookup(void);
+void test_node_registry_capacity(void);
+void test_node_registry_ewma_and_loss(void);
+void test_node_registry_seq_window(void);
+void test_node_registry_lookup_speed(void);
+void test_node_registry_persistence(void);
+void test_node_frame_parse(void);
+
+// Timer wheel tests (test_timer_wheel.cpp)
+void test_timer_wheel_fires_on_time(void);
+void test_timer_wheel_cancel_and_reschedule(void);
+void test_timer_wheel_supervision_benchmark(void);
+
+// Alarm pipeline tests (test_alarm_pipeline.cpp)
+void test_alarm_classify(void);
+void test_alarm_latency_histogram(void);
+void test_alarm_pipeline_priority(void);
+void test_alarm_pipeline_ingress_reserve(void);
+
+// UI theme tests (test_performance.cpp)
+void test_ui_style_cache_initialization(void);
+void test_ui_theme_heap_and_draw(void);
+
+// UI page registry tests (test_ui_pages.cpp)
+void test_ui_pages_lazy_build(void);
+void test_ui_pages_idle_teardown(void);
+
+// Boot profiler tests (test_boot_profile.cpp)
+void test_boot_profile_ring(void);
+void test_boot_probes_parallel(void);
+
+// GPS task tests (test_gps_task.cpp)
+void test_gps_nmea_checksum(void);
+void test_gps_framer_split_and_noise(void);
+void test_gps_task_fix_snapshot(void);
+
+// Bulk NMEA parser tests (test_nmea_bulk.cpp)
+void test_nmea_bulk_matches_per_char(void);
+void test_nmea_bulk_throughput(void);
+
+// UBX protocol tests (test_ubx.cpp)
+void test_ubx_parser_frames(void);
+void test_ubx_nav_pvt_fix(void);
+void test_ubx_cfg_pvt_only(void);
+
+// GPS assisted start tests (test_gps_assist.cpp)
+void test_gps_assist_mga_time(void);
+void test_gps_assist_persist(void);
+void test_gps_assist_db_load(void);
+
+// Node map tests (test_map_tiles.cpp)
+void test_map_project(void);
+void test_map_tiles_cache(void);
+void test_map_nodes_load(void);
+void test_map_view_frame_rate(void);
+
+// Microphone capture tests (test_mic_capture.cpp)
+void test_mic_capture_fanout(void);
+void test_mic_capture_overrun(void);
+void test_mic_capture_peek(void);
+void test_mic_capture_task_wakeup(void);
+
+// Noise direction tests (test_mic_array.cpp)
+void test_mic_array_deinterleave(void);
+void test_mic_array_doa_square(void);
+void test_mic_array_doa_pair(void);
+void test_mic_array_beamform(void);
+
+// Tone equalizer tests (test_biquad_eq.cpp)
+void test_biquad_eq_flat(void);
+void test_biquad_eq_reference(void);
+void test_biquad_eq_throughput(void);
+
+// Clip cache tests (test_clip_cache.cpp)
+void test_clip_cache_wav(void);
+void test_clip_cache_mp3(void);
+
+// Mixer tests (test_audio_mixer.cpp)
+void test_audio_mixer_sum(void);
+void test_audio_mixer_duck(void);
+void test_audio_mixer_voices(void);
+void test_audio_mixer_stream(void);
+void test_audio_mixer_queue(void);
+
+// Recorder tests (test_audio_recorder.cpp)
+void test_audio_recorder_adpcm(void);
+void test_audio_recorder_trigger(void);
+void test_audio_recorder_finish(void);
+
+// Acoustic event tests (test_acoustic_events.cpp)
+void test_acoustic_features(void);
+void test_acoustic_classify(void);
+void test_acoustic_replay(void);
+
+// MP3 decoder tests (test_mp3_decoder.cpp)
+void test_mp3_polyphase(void);
+void test_mp3_decode_rtf(void);
+
+// Keyboard tests (test_keyboard.cpp)
+void test_keyboard_burst(void);
+void test_keyboard_bad_burst(void);
+void test_keyboard_queue_full(void);
+
+// Input event tests (test_input_events.cpp)
+void test_input_events_queue(void);
+void test_input_trackball_limits(void);
+void test_input_trackball_accel(void);
+
 void setUp(void) {
     // Set up code here, called before each test
 }
@@ -88,6 +210,82 @@ void setup() {
     RUN_TEST(test_gps_functions);
     RUN_TEST(test_radio_functions);
     RUN_TEST(test_ui_functions);
+    RUN_TEST(test_journal_crc32_reference);
+    RUN_TEST(test_journal_record_layout);
+    RUN_TEST(test_journal_record_seal_and_validate);
+    RUN_TEST(test_journal_segment_path);
+    RUN_TEST(test_journal_append_throughput);
+    RUN_TEST(test_journal_index_entry_layout);
+    RUN_TEST(test_journal_filter_match);
+    RUN_TEST(test_journal_block_index_summary);
+    RUN_TEST(test_journal_bloom_no_false_negatives);
+    RUN_TEST(test_node_registry_insert_and_lookup);
+    RUN_TEST(test_node_registry_capacity);
+    RUN_TEST(test_node_registry_ewma_and_loss);
+    RUN_TEST(test_node_registry_seq_window);
+    RUN_TEST(test_node_registry_lookup_speed);
+    RUN_TEST(test_node_registry_persistence);
+    RUN_TEST(test_node_frame_parse);
+    RUN_TEST(test_timer_wheel_fires_on_time);
+    RUN_TEST(test_timer_wheel_cancel_and_reschedule);
+    RUN_TEST(test_timer_wheel_supervision_benchmark);
+    RUN_TEST(test_alarm_classify);
+    RUN_TEST(test_alarm_latency_histogram);
+    RUN_TEST(test_alarm_pipeline_priority);
+    RUN_TEST(test_alarm_pipeline_ingress_reserve);
+    RUN_TEST(test_ui_style_cache_initialization);
+    RUN_TEST(test_ui_theme_heap_and_draw);
+    RUN_TEST(test_ui_pages_lazy_build);
+    RUN_TEST(test_ui_pages_idle_teardown);
+    RUN_TEST(test_boot_profile_ring);
+    RUN_TEST(test_boot_probes_parallel);
+    RUN_TEST(test_gps_nmea_checksum);
+    RUN_TEST(test_gps_framer_split_and_noise);
+    RUN_TEST(test_gps_task_fix_snapshot);
+    RUN_TEST(test_nmea_bulk_matches_per_char);
+    RUN_TEST(test_nmea_bulk_throughput);
+    RUN_TEST(test_ubx_parser_frames);
+    RUN_TEST(test_ubx_nav_pvt_fix);
+    RUN_TEST(test_ubx_cfg_pvt_only);
+    RUN_TEST(test_gps_assist_mga_time);
+    RUN_TEST(test_gps_assist_persist);
+    RUN_TEST(test_gps_assist_db_load);
+    RUN_TEST(test_map_project);
+    RUN_TEST(test_map_tiles_cache);
+    RUN_TEST(test_map_nodes_load);
+    RUN_TEST(test_map_view_frame_rate);
+    RUN_TEST(test_mic_capture_fanout);
+    RUN_TEST(test_mic_capture_overrun);
+    RUN_TEST(test_mic_capture_peek);
+    RUN_TEST(test_mic_capture_task_wakeup);
+    RUN_TEST(test_mic_array_deinterleave);
+    RUN_TEST(test_mic_array_doa_square);
+    RUN_TEST(test_mic_array_doa_pair);
+    RUN_TEST(test_mic_array_beamform);
+    RUN_TEST(test_biquad_eq_flat);
+    RUN_TEST(test_biquad_eq_reference);
+    RUN_TEST(test_biquad_eq_throughput);
+    RUN_TEST(test_clip_cache_wav);
+    RUN_TEST(test_clip_cache_mp3);
+    RUN_TEST(test_audio_mixer_sum);
+    RUN_TEST(test_audio_mixer_duck);
+    RUN_TEST(test_audio_mixer_voices);
+    RUN_TEST(test_audio_mixer_stream);
+    RUN_TEST(test_audio_mixer_queue);
+    RUN_TEST(test_audio_recorder_adpcm);
+    RUN_TEST(test_audio_recorder_trigger);
+    RUN_TEST(test_audio_recorder_finish);
+    RUN_TEST(test_acoustic_features);
+    RUN_TEST(test_acoustic_classify);
+    RUN_TEST(test_acoustic_replay);
+    RUN_TEST(test_mp3_polyphase);
+    RUN_TEST(test_mp3_decode_rtf);
+    RUN_TEST(test_keyboard_burst);
+    RUN_TEST(test_keyboard_bad_burst);
+    RUN_TEST(test_keyboard_queue_full);
+    RUN_TEST(test_input_events_queue);
+    RUN_TEST(test_input_trackball_limits);
+    RUN_TEST(test_input_trackball_accel);
     
     UNITY_END(); // End Unity test framework
 }
@@ -0,0 +1,241 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include "map_tiles.h"
+#include "ui_map.h"
+#include "ui_pages.h"
+#include "ui_theme.h"
+
+#define MAP_TEST_ZOOM           16
+#define MAP_TEST_FRAMES         120
+#define MAP_TEST_FPS_MIN        30
+
+static uint16_t map_test_tile[MAP_TILE_SIZE * MAP_TILE_SIZE];
+
+static void map_test_path(char *path, size_t len, uint8_t zoom, uint32_t x, uint32_t y, bool dir)
+{
+    if (dir) {
+        snprintf(path, len, MAP_TILE_DIR "/%u/%lu", zoom, (unsigned long)x);
+    } else {
+        snprintf(path, len, MAP_TILE_DIR "/%u/%lu/%lu.565", zoom, (unsigned long)x, (unsigned long)y);
+    }
+}
+
+static void map_test_write_tile(uint8_t zoom, uint32_t x, uint32_t y)
+{
+    char path[48];
+    snprintf(path, sizeof(path), MAP_TILE_DIR "/%u", zoom);
+    SPIFFS.mkdir(MAP_TILE_DIR);
+    SPIFFS.mkdir(path);
+    map_test_path(path, sizeof(path), zoom, x, y, true);
+    SPIFFS.mkdir(path);
+
+    for (size_t i = 0; i < sizeof(map_test_tile) / sizeof(map_test_tile[0]); i++) {
+        map_test_tile[i] = (uint16_t)(x * 31 + y * 17 + i);
+    }
+    map_test_path(path, sizeof(path), zoom, x, y, false);
+    File file = SPIFFS.open(path, FILE_WRITE);
+    TEST_ASSERT_TRUE((bool)file);
+    TEST_ASSERT_EQUAL(MAP_TILE_BYTES, file.write((const uint8_t *)map_test_tile, MAP_TILE_BYTES));
+    file.close();
+}
+
+static void map_test_remove_tile(uint8_t zoom, uint32_t x, uint32_t y)
+{
+    char path[48];
+    map_test_path(path, sizeof(path), zoom, x, y, false);
+    SPIFFS.remove(path);
+}
+
+static void map_test_drain(void)
+{
+    while (map_tiles_service(0)) {
+    }
+}
+
+void test_map_project(void) {
+    uint32_t mx, my;
+    map_project(0, 0, &mx, &my);
+    TEST_ASSERT_EQUAL_HEX32(0x80000000UL, mx);
+    TEST_ASSERT_EQUAL_HEX32(0x80000000UL, my);
+
+    // Beyond the Mercator square is clamped to its edges
+    map_project(89.9, -180.0, &mx, &my);
+    TEST_ASSERT_EQUAL_HEX32(0, mx);
+    TEST_ASSERT_TRUE(my < 0x100);
+
+    // Zoom 14 here has the pixels of a 256 pixel slippy map at zoom 13
+    map_project(33.9425, -118.4081, &mx, &my);
+    TEST_ASSERT_EQUAL(1401, map_world_px(mx, 14) >> 8);
+    TEST_ASSERT_EQUAL(3274, map_world_px(my, 14) >> 8);
+    TEST_ASSERT_EQUAL(map_world_px(mx, 15), 2 * map_world_px(mx, 14) + ((mx >> 10) & 1));
+    TEST_ASSERT_EQUAL(MAP_TILE_SIZE << 18, map_world_size(18));
+}
+
+void test_map_tiles_cache(void) {
+    TEST_ASSERT_TRUE(SPIFFS.begin(true));
+    map_test_write_tile(3, 1, 2);
+    TEST_ASSERT_TRUE(map_tiles_begin(&SPIFFS, NULL, false));
+
+    // A miss queues the load, the tile shows once the loader ran
+    TEST_ASSERT_NULL(map_tiles_get(3, 1, 2, 1));
+    TEST_ASSERT_EQUAL(MAP_TILE_LOADING, map_tiles_state(3, 1, 2));
+    TEST_ASSERT_NULL(map_tiles_get(3, 1, 2, 1));
+    uint32_t gen = map_tiles_generation();
+    TEST_ASSERT_TRUE(map_tiles_service(0));
+    TEST_ASSERT_FALSE(map_tiles_service(0));
+    TEST_ASSERT_NOT_EQUAL(gen, map_tiles_generation());
+    const uint16_t *pixels = map_tiles_get(3, 1, 2, 2);
+    TEST_ASSERT_NOT_NULL(pixels);
+    TEST_ASSERT_EQUAL_MEMORY(map_test_tile, pixels, MAP_TILE_BYTES);
+
+    // No file: remembered as missing, not read again
+    TEST_ASSERT_NULL(map_tiles_get(3, 0, 0, 2));
+    map_test_drain();
+    TEST_ASSERT_EQUAL(MAP_TILE_MISSING, map_tiles_state(3, 0, 0));
+    TEST_ASSERT_NULL(map_tiles_get(3, 0, 0, 3));
+    TEST_ASSERT_FALSE(map_tiles_service(0));
+
+    // Panned away before the loader got to it
+    map_tiles_get(3, 5, 5, 3);
+    map_tiles_get(3, 1, 2, 3 + MAP_STALE_FRAMES + 1);
+    map_test_drain();
+    TEST_ASSERT_EQUAL(MAP_TILE_EMPTY, map_tiles_state(3, 5, 5));
+
+    // Filling the cache evicts the least recently used tile, not the one in use
+    for (uint32_t i = 0; i < MAP_CACHE_SLOTS; i++) {
+        uint32_t frame = 10 + i;
+        TEST_ASSERT_NOT_NULL(map_tiles_get(3, 1, 2, frame));
+        map_tiles_get(4, i, 0, frame);
+        map_test_drain();
+    }
+    TEST_ASSERT_EQUAL(MAP_TILE_READY, map_tiles_state(3, 1, 2));
+    TEST_ASSERT_EQUAL(MAP_TILE_EMPTY, map_tiles_state(3, 0, 0));
+    TEST_ASSERT_EQUAL(MAP_TILE_MISSING, map_tiles_state(4, MAP_CACHE_SLOTS - 1, 0));
+
+    map_tiles_stats_t stats;
+    map_tiles_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.loads);
+    TEST_ASSERT_EQUAL(1, stats.skipped);
+    TEST_ASSERT_TRUE(stats.hits >= MAP_CACHE_SLOTS);
+
+    map_tiles_flush();
+    TEST_ASSERT_EQUAL(MAP_TILE_EMPTY, map_tiles_state(3, 1, 2));
+    map_test_remove_tile(3, 1, 2);
+}
+
+void test_map_nodes_load(void) {
+    TEST_ASSERT_TRUE(SPIFFS.begin(true));
+    SPIFFS.mkdir(MAP_TILE_DIR);
+    File file = SPIFFS.open(MAP_NODES_FILE, FILE_WRITE);
+    const char *text = "A1B2C3D4,33.9425,-118.4081\r\n"
+                       "# comment\n"
+                       "0,1.0,2.0\n"
+                       "5,1.0\n"
+                       "00000010,-33.8688,151.2093\n";
+    file.write((const uint8_t *)text, strlen(text));
+    file.close();
+
+    TEST_ASSERT_EQUAL(2, map_nodes_load(&SPIFFS));
+    TEST_ASSERT_EQUAL(2, map_nodes_count());
+    TEST_ASSERT_EQUAL_HEX32(0xA1B2C3D4, map_nodes_get(0)->node_id);
+    TEST_ASSERT_EQUAL_HEX32(0x10, map_nodes_get(1)->node_id);
+    uint32_t mx, my;
+    map_project(-33.8688, 151.2093, &mx, &my);
+    TEST_ASSERT_EQUAL(mx, map_nodes_get(1)->mx);
+    TEST_ASSERT_EQUAL(my, map_nodes_get(1)->my);
+    TEST_ASSERT_NULL(map_nodes_get(2));
+    SPIFFS.remove(MAP_NODES_FILE);
+}
+
+static void map_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    lv_disp_flush_ready(drv);
+}
+
+static lv_obj_t *map_test_page(void)
+{
+    lv_obj_t *page = lv_obj_create(lv_scr_act());
+    lv_obj_add_style(page, &ui_theme.page, LV_PART_MAIN);
+    lv_obj_add_flag(page, LV_OBJ_FLAG_HIDDEN);
+    return page;
+}
+
+static ui_page_t map_test_pages[1] = {
+    {"Map", ui_map_build, ui_map_teardown, false},
+};
+
+void test_map_view_frame_rate(void) {
+    if (!lv_is_initialized()) {
+        lv_init();
+    }
+    if (!lv_disp_get_default()) {
+        static lv_color_t buf[320 * 24];
+        static lv_disp_draw_buf_t draw_buf;
+        static lv_disp_drv_t drv;
+        lv_disp_draw_buf_init(&draw_buf, buf, NULL, sizeof(buf) / sizeof(buf[0]));
+        lv_disp_drv_init(&drv);
+        drv.hor_res = 320;
+        drv.ver_res = 240;
+        drv.flush_cb = map_flush;
+        drv.draw_buf = &draw_buf;
+        lv_disp_drv_register(&drv);
+    }
+    ui_theme_init();
+    TEST_ASSERT_TRUE(SPIFFS.begin(true));
+
+    // Centre the view on a tile and keep the 3 x 3 block around it on "SD"
+    const double lat = 33.9425, lng = -118.4081;
+    uint32_t mx, my;
+    map_project(lat, lng, &mx, &my);
+    uint32_t tx = map_world_px(mx, MAP_TEST_ZOOM) >> MAP_TILE_SHIFT;
+    uint32_t ty = map_world_px(my, MAP_TEST_ZOOM) >> MAP_TILE_SHIFT;
+    for (uint32_t y = ty - 1; y <= ty + 1; y++) {
+        for (uint32_t x = tx - 1; x <= tx + 1; x++) {
+            map_test_write_tile(MAP_TEST_ZOOM, x, y);
+        }
+    }
+    TEST_ASSERT_TRUE(map_tiles_begin(&SPIFFS, NULL, false));
+
+    ui_map_set_self(lat, lng);
+    ui_pages_begin(map_test_pages, 1, map_test_page, 0);
+    TEST_ASSERT_NOT_NULL(ui_pages_open(0));
+    ui_map_zoom(MAP_TEST_ZOOM - UI_MAP_ZOOM_DEFAULT);
+    lv_refr_now(NULL);
+    int32_t dx = (int32_t)(tx << MAP_TILE_SHIFT) + MAP_TILE_SIZE / 2 - map_world_px(mx, MAP_TEST_ZOOM);
+    int32_t dy = (int32_t)(ty << MAP_TILE_SHIFT) + MAP_TILE_SIZE / 2 - map_world_px(my, MAP_TEST_ZOOM);
+    TEST_ASSERT_TRUE(ui_map_pan(dx, dy));
+    lv_refr_now(NULL);
+    map_test_drain();
+    lv_refr_now(NULL);
+    TEST_ASSERT_EQUAL(MAP_TILE_READY, map_tiles_state(MAP_TEST_ZOOM, tx, ty));
+
+    // Pan back and forth inside the resident block, one full redraw per step
+    map_tiles_stats_t before, after;
+    map_tiles_get_stats(&before);
+    uint32_t start = micros();
+    for (int i = 0; i < MAP_TEST_FRAMES; i++) {
+        ui_map_pan((i / 8) % 2 ? -4 : 4, (i / 16) % 2 ? -2 : 2);
+        lv_refr_now(NULL);
+        map_test_drain();
+    }
+    uint32_t elapsed = micros() - start;
+    map_tiles_get_stats(&after);
+    uint32_t fps = MAP_TEST_FRAMES * 1000000ULL / (elapsed ? elapsed : 1);
+    Serial.printf("Map: %d frames in %lu us, %lu fps, %lu tile hits, %lu loads\n",
+                  MAP_TEST_FRAMES, (unsigned long)elapsed, (unsigned long)fps,
+                  (unsigned long)(after.hits - before.hits), (unsigned long)(after.loads - before.loads));
+
+    // Every frame drew at least a 3 x 2 block from the cache, none waited for SD
+    TEST_ASSERT_TRUE(after.hits - before.hits >= MAP_TEST_FRAMES * 6);
+    TEST_ASSERT_EQUAL(before.loads, after.loads);
+    TEST_ASSERT_TRUE(fps >= MAP_TEST_FPS_MIN);
+
+    ui_pages_destroy(0);
+    TEST_ASSERT_FALSE(ui_map_pan(1, 1));
+    for (uint32_t y = ty - 1; y <= ty + 1; y++) {
+        for (uint32_t x = tx - 1; x <= tx + 1; x++) {
+            map_test_remove_tile(MAP_TEST_ZOOM, x, y);
+        }
+    }
+}
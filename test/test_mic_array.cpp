@@ -0,0 +1,307 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <math.h>
+#include "mic_array.h"
+#include "mic_capture.h"
+
+#define DOA_TEST_RATE           16000
+#define DOA_TEST_CHANNELS       4
+#define DOA_TEST_FRAMES         16000           // One second per file
+#define DOA_TEST_BURST_START    9000            // Quiet first, so the floor settles
+#define DOA_TEST_BURST_FRAMES   4000
+#define DOA_TEST_TONES          40
+#define DOA_TEST_TOLERANCE      10              // Degrees
+
+static int16_t doa_test_pcm[DOA_TEST_FRAMES * DOA_TEST_CHANNELS];
+static float   doa_test_freq[DOA_TEST_TONES];
+static float   doa_test_phase[DOA_TEST_TONES];
+static uint32_t doa_test_seed;
+
+static float doa_test_random(void)
+{
+    doa_test_seed = doa_test_seed * 1664525u + 1013904223u;
+    return (doa_test_seed >> 8) / 16777216.0f;
+}
+
+static float doa_test_noise(float amplitude)
+{
+    // Sum of four uniforms, roughly Gaussian
+    return amplitude * (doa_test_random() + doa_test_random() + doa_test_random() + doa_test_random() - 2.0f);
+}
+
+// Broadband source made of tones, so any fractional delay is exact
+static void doa_test_source(uint32_t seed)
+{
+    doa_test_seed = seed;
+    for (int i = 0; i < DOA_TEST_TONES; i++) {
+        doa_test_freq[i] = 300.0f + doa_test_random() * 3200.0f;
+        doa_test_phase[i] = doa_test_random() * 2.0f * (float)M_PI;
+    }
+}
+
+static float doa_test_signal(double t)
+{
+    float s = 0;
+    for (int i = 0; i < DOA_TEST_TONES; i++) {
+        s += sinf((float)fmod(2.0 * M_PI * doa_test_freq[i] * t + doa_test_phase[i], 2.0 * M_PI));
+    }
+    return s * 300.0f / DOA_TEST_TONES * 2.0f;
+}
+
+// Four channel recording of a burst from `azimuth` at `rate`, microphones
+// not in `mics` get noise only
+static void doa_test_render(const mic_position_t *mics, uint8_t count, int16_t azimuth, uint32_t rate, float noise)
+{
+    float rad = azimuth * (float)M_PI / 180.0f;
+    float ux = sinf(rad), uy = cosf(rad);
+    for (int i = 0; i < DOA_TEST_FRAMES; i++) {
+        bool burst = i >= DOA_TEST_BURST_START && i < DOA_TEST_BURST_START + DOA_TEST_BURST_FRAMES;
+        for (int ch = 0; ch < DOA_TEST_CHANNELS; ch++) {
+            float v = doa_test_noise(noise);
+            for (uint8_t m = 0; burst && m < count; m++) {
+                if (mics[m].channel == ch) {
+                    double lead = (mics[m].x_mm * ux + mics[m].y_mm * uy) / (double)MIC_ARRAY_SOUND_MM_S;
+                    v += doa_test_signal((double)i / rate + lead);
+                }
+            }
+            doa_test_pcm[i * DOA_TEST_CHANNELS + ch] = (int16_t)constrain(lroundf(v), -32768L, 32767L);
+        }
+    }
+}
+
+static void doa_test_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void doa_test_put32(uint8_t *p, uint32_t v)
+{
+    doa_test_put16(p, v);
+    doa_test_put16(p + 2, v >> 16);
+}
+
+static void doa_test_write_wav(const char *path, uint32_t rate)
+{
+    const uint32_t data_len = sizeof(doa_test_pcm);
+    uint8_t hdr[44];
+    memcpy(hdr, "RIFF", 4);
+    doa_test_put32(hdr + 4, 36 + data_len);
+    memcpy(hdr + 8, "WAVEfmt ", 8);
+    doa_test_put32(hdr + 16, 16);
+    doa_test_put16(hdr + 20, 1);                                // PCM
+    doa_test_put16(hdr + 22, DOA_TEST_CHANNELS);
+    doa_test_put32(hdr + 24, rate);
+    doa_test_put32(hdr + 28, rate * DOA_TEST_CHANNELS * 2);
+    doa_test_put16(hdr + 32, DOA_TEST_CHANNELS * 2);
+    doa_test_put16(hdr + 34, 16);
+    memcpy(hdr + 36, "data", 4);
+    doa_test_put32(hdr + 40, data_len);
+
+    File file = SPIFFS.open(path, FILE_WRITE);
+    TEST_ASSERT_TRUE((bool)file);
+    TEST_ASSERT_EQUAL(sizeof(hdr), file.write(hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL(data_len, file.write((const uint8_t *)doa_test_pcm, data_len));
+    file.close();
+}
+
+// Chunks are walked up to "data", the samples land in doa_test_pcm
+static uint32_t doa_test_read_wav(const char *path, uint16_t *channels)
+{
+    File file = SPIFFS.open(path, FILE_READ);
+    TEST_ASSERT_TRUE((bool)file);
+    uint8_t hdr[12];
+    TEST_ASSERT_EQUAL(12, file.read(hdr, 12));
+    TEST_ASSERT_EQUAL_MEMORY("RIFF", hdr, 4);
+    TEST_ASSERT_EQUAL_MEMORY("WAVE", hdr + 8, 4);
+
+    uint32_t frames = 0;
+    *channels = 0;
+    uint8_t chunk[8];
+    while (file.read(chunk, 8) == 8) {
+        uint32_t len = chunk[4] | chunk[5] << 8 | chunk[6] << 16 | (uint32_t)chunk[7] << 24;
+        if (!memcmp(chunk, "fmt ", 4)) {
+            uint8_t fmt[16];
+            TEST_ASSERT_EQUAL(16, file.read(fmt, 16));
+            TEST_ASSERT_EQUAL(1, fmt[0] | fmt[1] << 8);
+            TEST_ASSERT_EQUAL(16, fmt[14] | fmt[15] << 8);
+            *channels = fmt[2] | fmt[3] << 8;
+            file.seek(file.position() + len - 16);
+        } else if (!memcmp(chunk, "data", 4)) {
+            TEST_ASSERT_TRUE(len <= sizeof(doa_test_pcm));
+            TEST_ASSERT_EQUAL(len, file.read((uint8_t *)doa_test_pcm, len));
+            frames = len / (*channels * 2);
+            break;
+        } else {
+            file.seek(file.position() + len);
+        }
+    }
+    file.close();
+    return frames;
+}
+
+// Play a file through the capture ring to the direction consumer
+static void doa_test_play(const char *path, const mic_position_t *mics, uint8_t count, mic_doa_t *doa)
+{
+    uint16_t channels;
+    uint32_t frames = doa_test_read_wav(path, &channels);
+    TEST_ASSERT_EQUAL(DOA_TEST_CHANNELS, channels);
+    TEST_ASSERT_EQUAL(DOA_TEST_FRAMES, frames);
+
+    TEST_ASSERT_TRUE(mic_capture_begin(I2S_NUM_1, channels, false));
+    TEST_ASSERT_TRUE(mic_array_begin(mics, count, DOA_TEST_RATE, false));
+    for (uint32_t pos = 0; pos < frames;) {
+        size_t room;
+        int16_t *dst = mic_capture_space(&room);
+        size_t n = min((size_t)(frames - pos), room);
+        memcpy(dst, &doa_test_pcm[pos * channels], n * channels * sizeof(int16_t));
+        mic_capture_commit(n);
+        pos += n;
+        while (mic_array_service(0)) {
+        }
+    }
+    mic_array_latest(doa);
+}
+
+static int doa_test_error(int16_t got, int16_t want)
+{
+    int d = ((got - want) % 360 + 540) % 360 - 180;
+    return abs(d);
+}
+
+void test_mic_array_deinterleave(void)
+{
+    int16_t in[5 * 4];
+    for (int i = 0; i < 20; i++) {
+        in[i] = i;
+    }
+    int16_t c[4][5];
+    int16_t *out[4] = { c[0], c[1], c[2], c[3] };
+    mic_deinterleave(in, 5, 4, out);
+    for (int f = 0; f < 5; f++) {
+        for (int ch = 0; ch < 4; ch++) {
+            TEST_ASSERT_EQUAL_INT16(f * 4 + ch, c[ch][f]);
+        }
+    }
+    mic_deinterleave(in, 6, 3, out);
+    TEST_ASSERT_EQUAL_INT16(17, c[2][5]);
+    TEST_ASSERT_EQUAL_INT16(3, c[0][1]);
+
+    TEST_ASSERT_EQUAL_STRING("Front", mic_array_sector(0));
+    TEST_ASSERT_EQUAL_STRING("Front", mic_array_sector(-20));
+    TEST_ASSERT_EQUAL_STRING("Right", mic_array_sector(80));
+    TEST_ASSERT_EQUAL_STRING("Back left", mic_array_sector(225));
+    TEST_ASSERT_EQUAL_STRING("Left", mic_array_sector(-90));
+}
+
+void test_mic_array_doa_square(void)
+{
+    // Four microphones at the corners of a 60 mm square, all round
+    static const mic_position_t square[] = {
+        { -30, 30, 0 }, { 30, 30, 1 }, { 30, -30, 2 }, { -30, -30, 3 },
+    };
+    static const int16_t sources[] = { 0, 30, 135, 250, 315 };
+    SPIFFS.begin(true);
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++) {
+        char path[32];
+        snprintf(path, sizeof(path), "/doa_sq_%d.wav", sources[i]);
+        doa_test_source(1000 + i);
+        doa_test_render(square, 4, sources[i], DOA_TEST_RATE, 20.0f);
+        doa_test_write_wav(path, DOA_TEST_RATE);
+
+        mic_doa_t doa;
+        doa_test_play(path, square, 4, &doa);
+        mic_array_stats_t st;
+        mic_array_get_stats(&st);
+        TEST_ASSERT_TRUE(st.onsets > 0);
+        TEST_ASSERT_TRUE(st.estimates > 0);
+        TEST_ASSERT_TRUE(st.onsets <= DOA_TEST_BURST_FRAMES / MIC_ARRAY_FFT_SIZE + 2);
+        TEST_ASSERT_TRUE(doa.count > 0);
+        TEST_ASSERT_TRUE(doa.coherence >= MIC_ARRAY_MIN_COHERENCE);
+        TEST_ASSERT_TRUE(doa_test_error(doa.azimuth, sources[i]) <= DOA_TEST_TOLERANCE);
+        SPIFFS.remove(path);
+        Serial.printf("DOA: source %d found at %d, coherence %u%%, %lu us\n", sources[i], doa.azimuth,
+                      doa.coherence, (unsigned long)st.doa_us_max);
+    }
+}
+
+void test_mic_array_doa_pair(void)
+{
+    // The board pair: only the angle to its axis, front and back alike
+    static const mic_position_t pair[] = {
+        { -25, 0, 0 }, { 25, 0, 1 },
+    };
+    static const int16_t sources[] = { -60, 0, 40, 70 };
+    SPIFFS.begin(true);
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++) {
+        // From behind the keypad reads as the mirror image in front
+        int16_t from = i & 1 ? 180 - sources[i] : sources[i];
+        doa_test_source(2000 + i);
+        doa_test_render(pair, 2, from, DOA_TEST_RATE, 20.0f);
+        doa_test_write_wav("/doa_pair.wav", DOA_TEST_RATE);
+
+        mic_doa_t doa;
+        doa_test_play("/doa_pair.wav", pair, 2, &doa);
+        TEST_ASSERT_TRUE(doa.count > 0);
+        TEST_ASSERT_TRUE(doa.azimuth >= -90 && doa.azimuth <= 90);
+        TEST_ASSERT_TRUE(doa_test_error(doa.azimuth, sources[i]) <= DOA_TEST_TOLERANCE);
+    }
+    SPIFFS.remove("/doa_pair.wav");
+
+    // Steady noise alone never reports a direction
+    doa_test_source(3000);
+    doa_test_render(pair, 0, 0, DOA_TEST_RATE, 200.0f);
+    doa_test_write_wav("/doa_quiet.wav", DOA_TEST_RATE);
+    mic_doa_t doa;
+    doa_test_play("/doa_quiet.wav", pair, 2, &doa);
+    TEST_ASSERT_EQUAL(0, doa.count);
+    SPIFFS.remove("/doa_quiet.wav");
+}
+
+void test_mic_array_beamform(void)
+{
+    // A line along x with whole sample spacing at this rate, steered end on
+    const uint32_t rate = MIC_ARRAY_SOUND_MM_S / 20;
+    static const mic_position_t line[] = {
+        { -30, 0, 0 }, { -10, 0, 1 }, { 10, 0, 2 }, { 30, 0, 3 },
+    };
+    static int16_t c[DOA_TEST_CHANNELS][DOA_TEST_FRAMES];
+    static int16_t beam[DOA_TEST_FRAMES];
+    int16_t *planar[DOA_TEST_CHANNELS] = { c[0], c[1], c[2], c[3] };
+
+    doa_test_source(4000);
+    doa_test_render(line, 4, 90, rate, 0.0f);
+    mic_deinterleave(doa_test_pcm, DOA_TEST_FRAMES, DOA_TEST_CHANNELS, planar);
+    for (int i = 0; i < DOA_TEST_FRAMES; i++) {
+        for (int ch = 0; ch < DOA_TEST_CHANNELS; ch++) {
+            c[ch][i] += (int16_t)doa_test_noise(150.0f);
+        }
+    }
+    TEST_ASSERT_TRUE(mic_array_begin(line, 4, rate, false));
+    const int16_t *in[DOA_TEST_CHANNELS] = { c[0], c[1], c[2], c[3] };
+    size_t n = mic_array_beamform(in, DOA_TEST_FRAMES, 90, beam);
+    TEST_ASSERT_EQUAL(DOA_TEST_FRAMES - 3, n);
+
+    // Against the clean source at the leading microphone: the noise of four
+    // microphones averages down by about 6 dB
+    double mic_err = 0, beam_err = 0;
+    for (int i = DOA_TEST_BURST_START; i < DOA_TEST_BURST_START + DOA_TEST_BURST_FRAMES - 3; i++) {
+        double clean = doa_test_signal((double)i / rate + 30.0 / MIC_ARRAY_SOUND_MM_S);
+        mic_err += (c[3][i] - clean) * (c[3][i] - clean);
+        beam_err += (beam[i] - clean) * (beam[i] - clean);
+    }
+    TEST_ASSERT_TRUE(beam_err * 3 < mic_err);
+
+    // Steered the other way the burst no longer adds up
+    double on = 0, off = 0;
+    mic_array_beamform(in, DOA_TEST_FRAMES, 90, beam);
+    for (int i = DOA_TEST_BURST_START; i < DOA_TEST_BURST_START + DOA_TEST_BURST_FRAMES - 3; i++) {
+        on += (double)beam[i] * beam[i];
+    }
+    mic_array_beamform(in, DOA_TEST_FRAMES, 270, beam);
+    for (int i = DOA_TEST_BURST_START; i < DOA_TEST_BURST_START + DOA_TEST_BURST_FRAMES - 3; i++) {
+        off += (double)beam[i] * beam[i];
+    }
+    TEST_ASSERT_TRUE(off < on * 0.8);
+}
@@ -0,0 +1,195 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "mic_capture.h"
+
+#define MIC_TEST_CHANNELS       4
+#define MIC_TEST_VAD_FRAMES     480             // 30 ms at 16 kHz
+#define MIC_TEST_TASK_FRAMES    (3 * MIC_RING_FRAMES)
+
+// Every sample tells its frame number and channel
+static inline int16_t mic_test_sample(uint32_t frame, uint8_t channel)
+{
+    return (int16_t)((frame << 2) | channel);
+}
+
+static void mic_test_produce(uint32_t *frame, size_t frames)
+{
+    while (frames) {
+        size_t room;
+        int16_t *dst = mic_capture_space(&room);
+        // Uneven commits, as a short i2s_read would give
+        size_t n = room > 100 ? 100 : room;
+        if (n > frames) {
+            n = frames;
+        }
+        for (size_t i = 0; i < n; i++, (*frame)++) {
+            for (uint8_t ch = 0; ch < MIC_TEST_CHANNELS; ch++) {
+                *dst++ = mic_test_sample(*frame, ch);
+            }
+        }
+        mic_capture_commit(n);
+        frames -= n;
+    }
+}
+
+void test_mic_capture_fanout(void)
+{
+    static int16_t vad[MIC_TEST_VAD_FRAMES];
+    static int16_t rec[333 * MIC_TEST_CHANNELS];
+
+    TEST_ASSERT_TRUE(mic_capture_begin(I2S_NUM_1, MIC_TEST_CHANNELS, false));
+    int a = mic_capture_subscribe("vad");
+    int b = mic_capture_subscribe("rec");
+    TEST_ASSERT_TRUE(a >= 0 && b >= 0 && a != b);
+
+    // Two readers at different paces over several ring wraps, each sees
+    // every frame once and in order
+    uint32_t produced = 0, next_a = 0, next_b = 0;
+    while (produced < 3 * MIC_RING_FRAMES) {
+        mic_test_produce(&produced, 1000);
+        while (mic_capture_read_channel(a, 1, vad, MIC_TEST_VAD_FRAMES, 0) == MIC_TEST_VAD_FRAMES) {
+            for (int i = 0; i < MIC_TEST_VAD_FRAMES; i++, next_a++) {
+                TEST_ASSERT_EQUAL_INT16(mic_test_sample(next_a, 1), vad[i]);
+            }
+        }
+        // The recorder stays about half a ring behind
+        while (produced - next_b > MIC_RING_FRAMES / 2 && mic_capture_read(b, rec, 333, 0) == 333) {
+            for (int i = 0; i < 333 * MIC_TEST_CHANNELS; i++) {
+                TEST_ASSERT_EQUAL_INT16(mic_test_sample(next_b + i / MIC_TEST_CHANNELS, i % MIC_TEST_CHANNELS), rec[i]);
+            }
+            next_b += 333;
+        }
+    }
+    TEST_ASSERT_EQUAL(produced - next_a, mic_capture_available(a));
+    TEST_ASSERT_EQUAL(produced - next_b, mic_capture_available(b));
+
+    mic_consumer_stats_t st;
+    TEST_ASSERT_TRUE(mic_capture_consumer_stats(b, &st));
+    TEST_ASSERT_EQUAL_STRING("rec", st.name);
+    TEST_ASSERT_EQUAL(0, st.overruns);
+    TEST_ASSERT_EQUAL(next_b, st.frames);
+    TEST_ASSERT_TRUE(st.lag_max > MIC_RING_FRAMES / 2);
+
+    // Nothing waiting: no frames and the cursor stays put
+    mic_capture_read_channel(a, 0, vad, (produced - next_a) / MIC_TEST_VAD_FRAMES * MIC_TEST_VAD_FRAMES, 0);
+    TEST_ASSERT_EQUAL(0, mic_capture_read_channel(a, 0, vad, MIC_TEST_VAD_FRAMES, 0));
+    TEST_ASSERT_EQUAL(0, mic_capture_read_channel(a, MIC_TEST_CHANNELS, vad, 1, 0));
+
+    mic_capture_unsubscribe(a);
+    mic_capture_unsubscribe(b);
+}
+
+void test_mic_capture_overrun(void)
+{
+    static int16_t buf[64 * MIC_TEST_CHANNELS];
+
+    TEST_ASSERT_TRUE(mic_capture_begin(I2S_NUM_1, MIC_TEST_CHANNELS, false));
+    int id = mic_capture_subscribe("slow");
+    TEST_ASSERT_TRUE(id >= 0);
+
+    // Up to a ring less the writer's chunk behind, nothing is lost
+    uint32_t produced = 0;
+    mic_test_produce(&produced, MIC_RING_FRAMES - MIC_CAPTURE_CHUNK);
+    TEST_ASSERT_EQUAL(MIC_RING_FRAMES - MIC_CAPTURE_CHUNK, mic_capture_available(id));
+    TEST_ASSERT_EQUAL(64, mic_capture_read(id, buf, 64, 0));
+    TEST_ASSERT_EQUAL_INT16(mic_test_sample(0, 0), buf[0]);
+
+    // Lapped: the cursor jumps to the oldest frame held and the gap is counted
+    mic_test_produce(&produced, 5000);
+    TEST_ASSERT_EQUAL(64, mic_capture_read(id, buf, 64, 0));
+    uint32_t oldest = produced + MIC_CAPTURE_CHUNK - MIC_RING_FRAMES;
+    TEST_ASSERT_EQUAL_INT16(mic_test_sample(oldest, 0), buf[0]);
+    TEST_ASSERT_EQUAL_INT16(mic_test_sample(oldest + 63, 3), buf[63 * MIC_TEST_CHANNELS + 3]);
+
+    mic_consumer_stats_t st;
+    TEST_ASSERT_TRUE(mic_capture_consumer_stats(id, &st));
+    TEST_ASSERT_EQUAL(1, st.overruns);
+    TEST_ASSERT_EQUAL(oldest - 64, st.lost_frames);
+    TEST_ASSERT_EQUAL(128, st.frames);
+
+    mic_capture_unsubscribe(id);
+    TEST_ASSERT_FALSE(mic_capture_consumer_stats(id, &st));
+}
+
+void test_mic_capture_peek(void)
+{
+    TEST_ASSERT_TRUE(mic_capture_begin(I2S_NUM_1, MIC_TEST_CHANNELS, false));
+    int id = mic_capture_subscribe("sd");
+
+    // Consume in place across the ring end, runs stop at the wrap
+    uint32_t produced = 0, next = 0;
+    mic_test_produce(&produced, MIC_RING_FRAMES - 1000);
+    size_t frames;
+    mic_capture_peek(id, &frames);
+    TEST_ASSERT_TRUE(mic_capture_advance(id, frames));
+    next += frames;
+    mic_test_produce(&produced, 3000);
+
+    const int16_t *run = mic_capture_peek(id, &frames);
+    TEST_ASSERT_EQUAL(1000, frames);
+    TEST_ASSERT_EQUAL_INT16(mic_test_sample(next, 2), run[2]);
+    TEST_ASSERT_TRUE(mic_capture_advance(id, frames));
+    next += frames;
+
+    run = mic_capture_peek(id, &frames);
+    TEST_ASSERT_EQUAL(2000, frames);
+    TEST_ASSERT_EQUAL_INT16(mic_test_sample(next, 0), run[0]);
+
+    // The writer laps the frames while they are being written out
+    mic_test_produce(&produced, MIC_RING_FRAMES);
+    TEST_ASSERT_FALSE(mic_capture_advance(id, frames));
+    run = mic_capture_peek(id, &frames);
+    TEST_ASSERT_EQUAL_INT16(mic_test_sample(produced + MIC_CAPTURE_CHUNK - MIC_RING_FRAMES, 0), run[0]);
+
+    mic_capture_unsubscribe(id);
+}
+
+static volatile uint32_t mic_test_task_frames;
+static volatile bool     mic_test_task_ok;
+
+static void mic_test_consumer(void *params)
+{
+    static int16_t vad[MIC_TEST_VAD_FRAMES];
+    int id = mic_capture_subscribe("task");
+    bool ok = id >= 0;
+    uint32_t next = 0;
+    mic_test_task_frames = 1;
+    while (ok && next + MIC_TEST_VAD_FRAMES <= MIC_TEST_TASK_FRAMES) {
+        ok = mic_capture_read_channel(id, 3, vad, MIC_TEST_VAD_FRAMES, 1000) == MIC_TEST_VAD_FRAMES;
+        for (int i = 0; ok && i < MIC_TEST_VAD_FRAMES; i++, next++) {
+            ok = vad[i] == mic_test_sample(next, 3);
+        }
+    }
+    mic_test_task_ok = ok;
+    mic_test_task_frames = next;
+    mic_capture_unsubscribe(id);
+    vTaskDelete(NULL);
+}
+
+void test_mic_capture_task_wakeup(void)
+{
+    TEST_ASSERT_TRUE(mic_capture_begin(I2S_NUM_1, MIC_TEST_CHANNELS, false));
+    mic_test_task_frames = 0;
+    mic_test_task_ok = false;
+    TaskHandle_t handle;
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(mic_test_consumer, "mic_test", 4096, NULL, 5, &handle));
+    while (!mic_test_task_frames) {
+        delay(1);
+    }
+
+    // A consumer blocked in a read wakes on each commit and keeps up with
+    // the writer paced at its chunk size
+    uint32_t produced = 0;
+    while (produced < MIC_TEST_TASK_FRAMES) {
+        mic_test_produce(&produced, MIC_CAPTURE_CHUNK);
+        if (produced % (16 * MIC_CAPTURE_CHUNK) == 0) {
+            delay(1);
+        }
+    }
+    uint32_t start = millis();
+    while (mic_test_task_frames == 1 && millis() - start < 5000) {
+        delay(1);
+    }
+    TEST_ASSERT_TRUE(mic_test_task_ok);
+    TEST_ASSERT_EQUAL(MIC_TEST_TASK_FRAMES / MIC_TEST_VAD_FRAMES * MIC_TEST_VAD_FRAMES, mic_test_task_frames);
+}
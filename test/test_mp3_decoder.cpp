@@ -0,0 +1,141 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <mp3_decoder/mp3_decoder.h>
+
+#define MP3_TEST_VBUF_RANGE     (1 << 24)       // Output near full scale
+#define MP3_TEST_BLOCKS         200
+#define MP3_TEST_FILE_MAX       (2 * 1024 * 1024)
+#define MP3_TEST_FRAME_SAMPLES  (1152 * 2)
+#define MP3_TEST_RTF_MAX        0.25f           // A quarter of a core for real time playback
+
+static uint32_t mp3_test_seed;
+
+static int mp3_test_random(void)
+{
+    mp3_test_seed = mp3_test_seed * 1664525u + 1013904223u;
+    return (int)(mp3_test_seed >> 7) % MP3_TEST_VBUF_RANGE;
+}
+
+// The 32-bit accumulator filterbank against the Helix one, on random filter state
+void test_mp3_polyphase(void)
+{
+    static int vbuf[2 * m_VBUF_LENGTH];
+    static short ref[2 * m_NBANDS], fast[2 * m_NBANDS];
+    TEST_ASSERT_TRUE(MP3Decoder_AllocateBuffers());
+
+    mp3_test_seed = 1;
+    int max_diff = 0;
+    uint32_t differ = 0, ref_us = 0, fast_us = 0;
+    for (int block = 0; block < MP3_TEST_BLOCKS; block++) {
+        for (int i = 0; i < 2 * m_VBUF_LENGTH; i++) {
+            vbuf[i] = mp3_test_random();
+        }
+        bool stereo = block & 1;
+        uint32_t start = micros();
+        if (stereo) {
+            PolyphaseStereo(ref, vbuf, polyCoef);
+        } else {
+            PolyphaseMono(ref, vbuf, polyCoef);
+        }
+        ref_us += micros() - start;
+        start = micros();
+        if (stereo) {
+            PolyphaseStereoFast(fast, vbuf);
+        } else {
+            PolyphaseMonoFast(fast, vbuf);
+        }
+        fast_us += micros() - start;
+
+        for (int i = 0; i < (stereo ? 2 : 1) * m_NBANDS; i++) {
+            int diff = abs(ref[i] - fast[i]);
+            max_diff = max(max_diff, diff);
+            differ += diff != 0;
+        }
+    }
+    MP3Decoder_FreeBuffers();
+    TEST_ASSERT_TRUE(max_diff <= 1);
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%lu of %lu samples 1 LSB off, %lu us Helix, %lu us 32 bit",
+             (unsigned long)differ, (unsigned long)(MP3_TEST_BLOCKS * 3 / 2 * m_NBANDS),
+             (unsigned long)ref_us, (unsigned long)fast_us);
+    TEST_MESSAGE(msg);
+}
+
+// Decode one file, returning decode time and audio length
+static bool mp3_test_decode(uint8_t *data, size_t len, uint32_t *us, uint32_t *audio_ms, int *rate, int *channels)
+{
+    static short frame[MP3_TEST_FRAME_SAMPLES];
+    size_t pos = 0;
+    uint64_t samples = 0;
+    if (len > 10 && memcmp(data, "ID3", 3) == 0) {
+        pos = 10 + ((data[6] & 0x7f) << 21 | (data[7] & 0x7f) << 14 | (data[8] & 0x7f) << 7 | (data[9] & 0x7f));
+    }
+    if (!MP3Decoder_AllocateBuffers()) {
+        return false;
+    }
+    *us = 0;
+    *rate = 0;
+    while (pos < len) {
+        int sync = MP3FindSyncWord(data + pos, len - pos);
+        if (sync < 0) {
+            break;
+        }
+        pos += sync;
+        int left = len - pos;
+        uint32_t start = micros();
+        int err = MP3Decode(data + pos, &left, frame, 0);
+        *us += micros() - start;
+        size_t used = len - pos - left;
+        if (err == ERR_MP3_NONE) {
+            *rate = MP3GetSampRate();
+            *channels = MP3GetChannels();
+            samples += MP3GetOutputSamps() / *channels;
+        } else if (err == ERR_MP3_INDATA_UNDERFLOW) {
+            break;
+        }
+        pos += used ? used : 2;
+    }
+    MP3Decoder_FreeBuffers();
+    *audio_ms = *rate ? samples * 1000 / *rate : 0;
+    return *audio_ms > 0;
+}
+
+// Real time factor per MP3 file in SPIFFS: decode time over audio length
+void test_mp3_decode_rtf(void)
+{
+    SPIFFS.begin(true);
+    File dir = SPIFFS.open("/");
+    uint32_t files = 0;
+    for (File entry = dir ? dir.openNextFile() : File(); entry; entry = dir.openNextFile()) {
+        const char *name = entry.name();
+        size_t name_len = strlen(name);
+        if (entry.isDirectory() || name_len < 4 || strcasecmp(name + name_len - 4, ".mp3") ||
+                entry.size() > MP3_TEST_FILE_MAX) {
+            continue;
+        }
+        size_t len = entry.size();
+        uint8_t *data = (uint8_t *)ps_malloc(len);
+        TEST_ASSERT_NOT_NULL(data);
+        TEST_ASSERT_EQUAL(len, entry.read(data, len));
+        entry.close();
+
+        uint32_t us, audio_ms;
+        int rate, channels;
+        bool ok = mp3_test_decode(data, len, &us, &audio_ms, &rate, &channels);
+        free(data);
+        TEST_ASSERT_TRUE(ok);
+        float rtf = us / 1000.0f / audio_ms;
+
+        char msg[128];
+        snprintf(msg, sizeof(msg), "%s: %d Hz %d ch, %lu ms of audio in %lu ms, RTF %.4f (%s kernels)", name, rate,
+                 channels, (unsigned long)audio_ms, (unsigned long)(us / 1000), rtf, MP3_FAST_KERNELS ? "fast" : "Helix");
+        TEST_MESSAGE(msg);
+        TEST_ASSERT_TRUE(rtf < MP3_TEST_RTF_MAX);
+        files++;
+    }
+    if (!files) {
+        TEST_IGNORE_MESSAGE("no MP3 files in SPIFFS, upload the data folder");
+    }
+}
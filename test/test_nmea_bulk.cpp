@@ -0,0 +1,160 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <TinyGPS++.h>
+
+// Recorded from a u-blox M10 and the TinyGPSPlus examples, with a bad checksum,
+// line noise, control bytes, a truncated sentence and fields longer than the
+// term buffer
+static const char NMEA_TEST_LOG[] =
+    "$GPRMC,045103.000,A,3014.1984,N,09749.2872,W,0.67,161.46,030913,,,A*7C\r\n"
+    "$GPGGA,045104.000,3014.1985,N,09749.2873,W,1,09,1.2,211.6,M,-22.5,M,,0000*62\r\n"
+    "$GNTXT,01,01,02,u-blox AG - www.u-blox.com*4E\r\n"
+    "$GNTXT,01,01,02,ANTSTATUS=OK\t\xb0*9C\r\n"
+    "$GNRMC,101512.00,V,,,,,,,180926,,,N,V*1B\r\n"
+    "$GNGGA,101512.00,,,,,0,00,99.99,,,,,,*7E\r\n"
+    "$GNRMC,101513.00,A,3351.52841,S,15112.45210,E,0.021,,180926,,,A,V*03\r\n"
+    "$GNVTG,,T,,M,0.021,N,0.039,K,A*34\r\n"
+    "$GNGGA,101513.00,3351.52841,S,15112.45210,E,1,12,0.71,38.4,M,22.1,M,,*69\r\n"
+    "$GNGSA,A,3,05,13,15,18,20,23,24,29,,,,,1.25,0.71,1.03,1*07\r\n"
+    "$GPGSV,3,1,11,05,44,292,42,13,20,243,36,15,25,185,40,18,69,111,44,1*60\r\n"
+    "$GPGSV,3,2,11,20,11,023,31,23,32,351,39,24,52,214,45,29,14,111,33,1*61\r\n"
+    "$GLGSV,2,1,07,65,31,145,38,66,73,231,40,67,33,320,35,75,12,040,,1*75\r\n"
+    "$GNGLL,3351.52841,S,15112.45210,E,101513.00,A,A*67\r\n"
+    "$GNRMC,101514.00,A,3351.52855,S,15112.45198,E,12.3456789012345678,274.1234567890123,180926,,,A,V*26\r\n"
+    "$GNGGA,101514.00,3351.52855,S,15112.45198,E,1,12,0.71,38.6,M,22.1,M,,*7B\r\n"
+    "@@noise\x01\xff,,*\r\n"
+    "$GNGGA,101514.00,3351.52855,S,15112.45198,E,1,12,0.71,38.6,M,22.1,M,,*6a\r\n"
+    "$GNRMC,101515.00,A,3351.5286"
+    "$GNRMC,101516.00,A,3351.52870,S,15112.45180,E,0.5,90.0,180926,,,A,V*1F\r\n"
+    "$GPGGA,1,2*\r\n"
+    "$GPGGA,1,2*5\r\n";
+
+#define NMEA_BENCH_BYTES        (128 * 1024)
+
+typedef struct {
+    RawDegrees lat, lng;
+    bool       location_valid, location_updated;
+    uint32_t   date, time;
+    int32_t    speed, course, altitude, hdop;
+    uint32_t   satellites;
+    uint32_t   chars, with_fix, failed, passed;
+} nmea_state_t;
+
+static void nmea_snapshot(TinyGPSPlus &gps, nmea_state_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->location_valid = gps.location.isValid();
+    s->location_updated = gps.location.isUpdated();
+    s->lat = gps.location.rawLat();
+    s->lng = gps.location.rawLng();
+    s->date = gps.date.value();
+    s->time = gps.time.value();
+    s->speed = gps.speed.value();
+    s->course = gps.course.value();
+    s->altitude = gps.altitude.value();
+    s->hdop = gps.hdop.value();
+    s->satellites = gps.satellites.value();
+    s->chars = gps.charsProcessed();
+    s->with_fix = gps.sentencesWithFix();
+    s->failed = gps.failedChecksum();
+    s->passed = gps.passedChecksum();
+}
+
+static void nmea_assert_same(const nmea_state_t *a, const nmea_state_t *b)
+{
+    TEST_ASSERT_EQUAL(a->location_valid, b->location_valid);
+    TEST_ASSERT_EQUAL(a->location_updated, b->location_updated);
+    TEST_ASSERT_EQUAL(a->lat.deg, b->lat.deg);
+    TEST_ASSERT_EQUAL(a->lat.billionths, b->lat.billionths);
+    TEST_ASSERT_EQUAL(a->lat.negative, b->lat.negative);
+    TEST_ASSERT_EQUAL(a->lng.deg, b->lng.deg);
+    TEST_ASSERT_EQUAL(a->lng.billionths, b->lng.billionths);
+    TEST_ASSERT_EQUAL(a->lng.negative, b->lng.negative);
+    TEST_ASSERT_EQUAL(a->date, b->date);
+    TEST_ASSERT_EQUAL(a->time, b->time);
+    TEST_ASSERT_EQUAL(a->speed, b->speed);
+    TEST_ASSERT_EQUAL(a->course, b->course);
+    TEST_ASSERT_EQUAL(a->altitude, b->altitude);
+    TEST_ASSERT_EQUAL(a->hdop, b->hdop);
+    TEST_ASSERT_EQUAL(a->satellites, b->satellites);
+    TEST_ASSERT_EQUAL(a->chars, b->chars);
+    TEST_ASSERT_EQUAL(a->with_fix, b->with_fix);
+    TEST_ASSERT_EQUAL(a->failed, b->failed);
+    TEST_ASSERT_EQUAL(a->passed, b->passed);
+}
+
+void test_nmea_bulk_matches_per_char(void) {
+    const size_t len = sizeof(NMEA_TEST_LOG) - 1;
+    static char shifted[sizeof(NMEA_TEST_LOG) + 4];
+
+    TinyGPSPlus reference;
+    size_t reference_valid = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (reference.encode(NMEA_TEST_LOG[i])) {
+            reference_valid++;
+        }
+    }
+    nmea_state_t expected;
+    nmea_snapshot(reference, &expected);
+    TEST_ASSERT_EQUAL(4, expected.failed);
+    TEST_ASSERT_TRUE(expected.lat.negative);
+    TEST_ASSERT_EQUAL(33, expected.lat.deg);
+
+    // Every block size and buffer alignment, terms split anywhere
+    for (size_t offset = 0; offset < 4; offset++) {
+        memcpy(shifted + offset, NMEA_TEST_LOG, len);
+        for (size_t chunk = 1; chunk <= len; chunk += (chunk < 100 ? 1 : 97)) {
+            TinyGPSPlus gps;
+            size_t valid = 0;
+            for (size_t pos = 0; pos < len; pos += chunk) {
+                valid += gps.encode(shifted + offset + pos, len - pos < chunk ? len - pos : chunk);
+            }
+            nmea_state_t actual;
+            nmea_snapshot(gps, &actual);
+            nmea_assert_same(&expected, &actual);
+            TEST_ASSERT_EQUAL(reference_valid, valid);
+        }
+    }
+
+    // Custom fields take the term buffer path
+    TinyGPSPlus a, b;
+    TinyGPSCustom a_sats(a, "GPGSV", 3), b_sats(b, "GPGSV", 3);
+    TinyGPSCustom a_mode(a, "GNGSA", 2), b_mode(b, "GNGSA", 2);
+    for (size_t i = 0; i < len; i++) {
+        a.encode(NMEA_TEST_LOG[i]);
+    }
+    b.encode(NMEA_TEST_LOG, len);
+    TEST_ASSERT_EQUAL_STRING("11", b_sats.value());
+    TEST_ASSERT_EQUAL_STRING(a_sats.value(), b_sats.value());
+    TEST_ASSERT_EQUAL_STRING(a_mode.value(), b_mode.value());
+    TEST_ASSERT_EQUAL(a.passedChecksum(), b.passedChecksum());
+}
+
+void test_nmea_bulk_throughput(void) {
+    static char log[NMEA_BENCH_BYTES];
+    const size_t sample = sizeof(NMEA_TEST_LOG) - 1;
+    size_t len = 0;
+    while (len + sample <= sizeof(log)) {
+        memcpy(log + len, NMEA_TEST_LOG, sample);
+        len += sample;
+    }
+
+    TinyGPSPlus per_char;
+    uint32_t start = micros();
+    for (size_t i = 0; i < len; i++) {
+        per_char.encode(log[i]);
+    }
+    uint32_t per_char_us = micros() - start;
+
+    TinyGPSPlus bulk;
+    start = micros();
+    bulk.encode(log, len);
+    uint32_t bulk_us = micros() - start;
+
+    TEST_ASSERT_EQUAL(per_char.passedChecksum(), bulk.passedChecksum());
+    TEST_ASSERT_EQUAL(per_char.charsProcessed(), bulk.charsProcessed());
+    Serial.printf("NMEA parse: per char %lu chars/s, bulk %lu chars/s\n",
+                  (unsigned long)(len * 1000000ULL / (per_char_us ? per_char_us : 1)),
+                  (unsigned long)(len * 1000000ULL / (bulk_us ? bulk_us : 1)));
+    TEST_ASSERT_TRUE(bulk_us <= per_char_us);
+}
@@ -0,0 +1,163 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include "node_registry.h"
+
+#define TEST_NODE_BASE      0x4E000000UL
+
+// Node registry test functions
+void test_node_registry_insert_and_lookup(void) {
+    node_registry_begin(nullptr);
+    for (uint32_t i = 0; i < 300; i++) {
+        TEST_ASSERT_EQUAL(i, node_registry_update_rx(TEST_NODE_BASE + i * 17, -80, 5, 1, 90));
+    }
+    TEST_ASSERT_EQUAL(300, node_registry_count());
+    for (uint32_t i = 0; i < 300; i++) {
+        TEST_ASSERT_EQUAL(i, node_registry_find(TEST_NODE_BASE + i * 17));
+    }
+    TEST_ASSERT_EQUAL(-1, node_registry_find(TEST_NODE_BASE + 1));
+    TEST_ASSERT_EQUAL(-1, node_registry_find(0));
+
+    node_snapshot_t snap;
+    TEST_ASSERT_TRUE(node_registry_lookup(TEST_NODE_BASE + 17, &snap));
+    TEST_ASSERT_EQUAL_HEX32(TEST_NODE_BASE + 17, snap.node_id);
+    TEST_ASSERT_EQUAL(1, snap.rx_count);
+    TEST_ASSERT_EQUAL(90, snap.battery);
+    TEST_ASSERT_TRUE(snap.flags & NODE_FLAG_SEEN);
+}
+
+void test_node_registry_capacity(void) {
+    node_registry_begin(nullptr);
+    for (uint32_t i = 0; i < NODE_REGISTRY_CAPACITY; i++) {
+        TEST_ASSERT_TRUE(node_registry_update_rx(i + 1, -90, 0, 0, 0xFF) >= 0);
+    }
+    TEST_ASSERT_EQUAL(-1, node_registry_update_rx(NODE_REGISTRY_CAPACITY + 1, -90, 0, 0, 0xFF));
+    // Known nodes are still updated when full
+    TEST_ASSERT_EQUAL(0, node_registry_update_rx(1, -90, 0, 1, 0xFF));
+}
+
+void test_node_registry_ewma_and_loss(void) {
+    node_registry_begin(nullptr);
+    uint32_t id = TEST_NODE_BASE + 5;
+    node_registry_update_rx(id, -100, -10, 10, 50);
+    for (int i = 0; i < 64; i++) {
+        node_registry_update_rx(id, -60, 8, 11 + i, 50);
+    }
+    node_snapshot_t snap;
+    TEST_ASSERT_TRUE(node_registry_lookup(id, &snap));
+    TEST_ASSERT_INT_WITHIN(NODE_EWMA_SCALE, -60 * NODE_EWMA_SCALE, snap.rssi_x16);
+    TEST_ASSERT_INT_WITHIN(NODE_EWMA_SCALE, 8 * NODE_EWMA_SCALE, snap.snr_x16);
+    TEST_ASSERT_EQUAL(0, snap.seq_lost);
+
+    // Three packets missed, then a duplicate and a node reboot
+    node_registry_update_rx(id, -60, 8, 78, 50);
+    node_registry_update_rx(id, -60, 8, 78, 50);
+    node_registry_update_rx(id, -60, 8, 0, 50);
+    TEST_ASSERT_TRUE(node_registry_lookup(id, &snap));
+    TEST_ASSERT_EQUAL(3, snap.seq_lost);
+    TEST_ASSERT_EQUAL(68, snap.rx_count);
+}
+
+void test_node_registry_seq_window(void) {
+    node_registry_begin(nullptr);
+    uint32_t id = TEST_NODE_BASE + 6;
+    TEST_ASSERT_TRUE(node_registry_seq_fresh(id, 65530));
+    for (uint16_t seq = 65530; seq != 4; seq++) {
+        if (seq != 65534 && seq != 1) {
+            node_registry_update_rx(id, -70, 5, seq, 50);
+        }
+    }
+    // Across the wrap: 3 is the newest, 65534 and 1 were missed
+    node_snapshot_t snap;
+    TEST_ASSERT_TRUE(node_registry_lookup(id, &snap));
+    TEST_ASSERT_EQUAL(3, snap.last_seq);
+    TEST_ASSERT_EQUAL(2, snap.seq_lost);
+    TEST_ASSERT_TRUE(node_registry_seq_fresh(id, 4));
+    TEST_ASSERT_FALSE(node_registry_seq_fresh(id, 3));
+    TEST_ASSERT_FALSE(node_registry_seq_fresh(id, 65535));
+    TEST_ASSERT_FALSE(node_registry_seq_fresh(id, 65530));
+
+    // A late frame within the window is accepted once and is no longer lost
+    TEST_ASSERT_TRUE(node_registry_seq_fresh(id, 65534));
+    node_registry_update_rx(id, -70, 5, 65534, 50);
+    TEST_ASSERT_FALSE(node_registry_seq_fresh(id, 65534));
+    TEST_ASSERT_TRUE(node_registry_lookup(id, &snap));
+    TEST_ASSERT_EQUAL(3, snap.last_seq);
+    TEST_ASSERT_EQUAL(1, snap.seq_lost);
+
+    // Anything older than the window is a replay, unless the node rebooted
+    node_registry_update_rx(id, -70, 5, 3 + NODE_SEQ_WINDOW + 100, 50);
+    TEST_ASSERT_FALSE(node_registry_seq_fresh(id, 40));
+    TEST_ASSERT_FALSE(node_registry_seq_fresh(id, 100));
+    TEST_ASSERT_TRUE(node_registry_seq_fresh(id, 103 + NODE_SEQ_WINDOW - 2));
+    TEST_ASSERT_TRUE(node_registry_seq_fresh(id, 0));
+    node_registry_update_rx(id, -70, 5, 0, 50);
+    TEST_ASSERT_FALSE(node_registry_seq_fresh(id, 0));
+    TEST_ASSERT_TRUE(node_registry_seq_fresh(id, 1));
+}
+
+void test_node_registry_lookup_speed(void) {
+    node_registry_begin(nullptr);
+    for (uint32_t i = 0; i < 400; i++) {
+        node_registry_update_rx(TEST_NODE_BASE + i * 3, -80, 5, 0, 0xFF);
+    }
+    const uint32_t lookups = 100000;
+    volatile int sink = 0;
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < lookups; i++) {
+        sink += node_registry_find(TEST_NODE_BASE + (i % 400) * 3);
+    }
+    uint32_t elapsed = micros() - start;
+    Serial.printf("Node registry: %lu lookups in %lu us\n", (unsigned long)lookups, (unsigned long)elapsed);
+    // Sub-microsecond per lookup
+    TEST_ASSERT_LESS_THAN_UINT32(lookups, elapsed);
+}
+
+void test_node_registry_persistence(void) {
+    TEST_ASSERT_TRUE(SPIFFS.begin(true));
+    SPIFFS.remove(NODE_REGISTRY_FILE);
+    TEST_ASSERT_TRUE(node_registry_begin(&SPIFFS));
+    for (uint32_t i = 0; i < 20; i++) {
+        node_registry_update_rx(TEST_NODE_BASE + i, -70, 3, i, 40 + i);
+    }
+    node_registry_set_zone(TEST_NODE_BASE + 9, 4);
+    // 20 nodes span three pages
+    TEST_ASSERT_EQUAL(3, node_registry_dirty_pages());
+    TEST_ASSERT_EQUAL(3, node_registry_save());
+    TEST_ASSERT_EQUAL(0, node_registry_save());
+
+    // A single change rewrites a single page
+    node_registry_set_flags(TEST_NODE_BASE + 17, NODE_FLAG_ARMED, 0);
+    TEST_ASSERT_EQUAL(1, node_registry_save());
+
+    TEST_ASSERT_TRUE(node_registry_begin(&SPIFFS));
+    TEST_ASSERT_EQUAL(20, node_registry_count());
+    node_snapshot_t snap;
+    TEST_ASSERT_TRUE(node_registry_lookup(TEST_NODE_BASE + 9, &snap));
+    TEST_ASSERT_EQUAL(4, snap.zone);
+    TEST_ASSERT_EQUAL(49, snap.battery);
+    TEST_ASSERT_FALSE(snap.flags & NODE_FLAG_SEEN);
+    TEST_ASSERT_TRUE(node_registry_lookup(TEST_NODE_BASE + 17, &snap));
+    TEST_ASSERT_TRUE(snap.flags & NODE_FLAG_ARMED);
+
+    SPIFFS.remove(NODE_REGISTRY_FILE);
+    node_registry_begin(nullptr);
+}
+
+void test_node_frame_parse(void) {
+    node_frame_t frame;
+    TEST_ASSERT_TRUE(node_frame_parse("@4E0000A1,513,87,DOOR", &frame));
+    TEST_ASSERT_EQUAL_HEX32(0x4E0000A1, frame.node_id);
+    TEST_ASSERT_EQUAL(513, frame.seq);
+    TEST_ASSERT_EQUAL(87, frame.battery);
+    TEST_ASSERT_EQUAL_STRING("DOOR", frame.payload);
+
+    TEST_ASSERT_TRUE(node_frame_parse("@1,0,255", &frame));
+    TEST_ASSERT_EQUAL_STRING("", frame.payload);
+
+    TEST_ASSERT_FALSE(node_frame_parse("42", &frame));          // Legacy counter packets
+    TEST_ASSERT_FALSE(node_frame_parse("@0,1,50", &frame));     // Node 0 is reserved
+    TEST_ASSERT_FALSE(node_frame_parse("@12,70000,50", &frame));
+    TEST_ASSERT_FALSE(node_frame_parse("@12,1,150", &frame));
+    TEST_ASSERT_FALSE(node_frame_parse("@12,1", &frame));
+}
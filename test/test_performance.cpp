@@ -93,15 +93,27 @@ void test_ui_update_rate_constants(void) {
 }
 
 void test_ui_style_cache_initialization(void) {
-    // Test that style cache initializes properly
+    // The shared theme needs the LVGL style properties registered by lv_init()
+    if (!lv_is_initialized()) {
+        lv_init();
+    }
     ui_performance_init();
     
-    TEST_ASSERT_TRUE(g_style_cache.initialized);
+    TEST_ASSERT_TRUE(ui_theme.initialized);
+    
+    // Initialization is idempotent, styles keep their properties
+    lv_style_value_t width;
+    TEST_ASSERT_EQUAL(LV_RES_OK, lv_style_get_prop(&ui_theme.icon, LV_STYLE_WIDTH, &width));
+    ui_theme_init();
+    TEST_ASSERT_EQUAL(80, width.num);
+    TEST_ASSERT_EQUAL(LV_RES_OK, lv_style_get_prop(&ui_theme.icon, LV_STYLE_WIDTH, &width));
+    TEST_ASSERT_EQUAL(80, width.num);
     
-    // Test that cached styles are valid
-    TEST_ASSERT_NOT_NULL(&g_style_cache.section_style);
-    TEST_ASSERT_NOT_NULL(&g_style_cache.button_style);
-    TEST_ASSERT_NOT_NULL(&g_style_cache.label_style);
+    // Runtime opacity changes go to the shared styles
+    lv_style_value_t opa;
+    ui_theme_set_icon_opa(LV_OPA_50);
+    TEST_ASSERT_EQUAL(LV_RES_OK, lv_style_get_prop(&ui_theme.icon, LV_STYLE_BG_OPA, &opa));
+    TEST_ASSERT_EQUAL(LV_OPA_50, opa.num);
 }
 
 void test_ui_memory_pool_functionality(void) {
@@ -151,3 +163,145 @@ void test_performance_benchmark_suite(void) {
     // Benchmark should show improvement or at least equal performance
     TEST_ASSERT_TRUE(fast_alloc_time <= std_alloc_time + 50); // Allow 50μs tolerance
 }
+
+// Theme benchmark: the same page content built with per-object local styles,
+// as the ui.cpp factories did before the theme, and with the shared styles
+#define THEME_BENCH_ROWS    12
+#define THEME_BENCH_FRAMES  10
+
+static void bench_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    lv_disp_flush_ready(drv);
+}
+
+static void bench_display_init(void)
+{
+    if (lv_disp_get_default()) {
+        return;
+    }
+    static lv_color_t buf[320 * 24];
+    static lv_disp_draw_buf_t draw_buf;
+    static lv_disp_drv_t drv;
+    lv_disp_draw_buf_init(&draw_buf, buf, NULL, sizeof(buf) / sizeof(buf[0]));
+    lv_disp_drv_init(&drv);
+    drv.hor_res = 320;
+    drv.ver_res = 240;
+    drv.flush_cb = bench_flush;
+    drv.draw_buf = &draw_buf;
+    lv_disp_drv_register(&drv);
+}
+
+static void bench_row_local(lv_obj_t *page)
+{
+    lv_obj_t *group = lv_obj_create(page);
+    lv_obj_set_size(group, LV_PCT(90), LV_SIZE_CONTENT);
+    lv_obj_set_style_bg_color(group, lv_color_hex(0x2D2D30), LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(group, LV_OPA_COVER, LV_PART_MAIN);
+    lv_obj_set_style_radius(group, 6, LV_PART_MAIN);
+    lv_obj_set_style_border_width(group, 1, LV_PART_MAIN);
+    lv_obj_set_style_border_color(group, lv_color_hex(0x3E3E42), LV_PART_MAIN);
+    lv_obj_set_style_pad_all(group, 8, LV_PART_MAIN);
+    lv_obj_set_style_pad_top(group, 10, LV_PART_MAIN);
+    lv_obj_set_style_pad_bottom(group, 10, LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(group, 100, LV_PART_MAIN);
+
+    lv_obj_t *obj = lv_obj_create(group);
+    lv_obj_set_style_bg_color(obj, lv_color_hex(0x2D2D30), LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(obj, LV_OPA_COVER, LV_PART_MAIN);
+    lv_obj_set_style_border_width(obj, 1, LV_PART_MAIN);
+    lv_obj_set_style_border_color(obj, lv_color_hex(0x3E3E42), LV_PART_MAIN);
+    lv_obj_set_style_pad_all(obj, 12, LV_PART_MAIN);
+    lv_obj_set_style_min_height(obj, 60, LV_PART_MAIN);
+    lv_obj_set_width(obj, LV_PCT(100));
+    lv_obj_set_height(obj, LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(obj, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(obj, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+    lv_obj_t *header_row = lv_obj_create(obj);
+    lv_obj_set_width(header_row, LV_PCT(100));
+    lv_obj_set_height(header_row, LV_SIZE_CONTENT);
+    lv_obj_set_style_bg_opa(header_row, LV_OPA_TRANSP, LV_PART_MAIN);
+    lv_obj_set_style_border_width(header_row, 0, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(header_row, 0, LV_PART_MAIN);
+    lv_obj_set_flex_flow(header_row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(header_row, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+    lv_obj_t *label = lv_label_create(header_row);
+    lv_label_set_text(label, "Title");
+    lv_obj_set_style_text_color(label, lv_color_hex(0xCCCCCC), LV_PART_MAIN);
+    lv_obj_set_style_text_font(label, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_LEFT, LV_PART_MAIN);
+    lv_obj_set_flex_grow(label, 1);
+
+    lv_obj_t *value = lv_label_create(obj);
+    lv_label_set_text(value, "N.A");
+    lv_obj_set_style_text_color(value, lv_color_hex(0x9CDCFE), LV_PART_MAIN);
+    lv_obj_set_style_text_font(value, &lv_font_montserrat_12, LV_PART_MAIN);
+    lv_obj_set_style_text_align(value, LV_TEXT_ALIGN_RIGHT, LV_PART_MAIN);
+}
+
+static void bench_row_themed(lv_obj_t *page)
+{
+    lv_obj_t *group = lv_obj_create(page);
+    lv_obj_add_style(group, &ui_theme.section, LV_PART_MAIN);
+    lv_obj_add_style(group, &ui_theme.section_opa, LV_PART_MAIN);
+
+    lv_obj_t *obj = lv_obj_create(group);
+    lv_obj_add_style(obj, &ui_theme.row, LV_PART_MAIN);
+
+    lv_obj_t *header_row = lv_obj_create(obj);
+    lv_obj_add_style(header_row, &ui_theme.bare, LV_PART_MAIN);
+    lv_obj_add_style(header_row, &ui_theme.row_header, LV_PART_MAIN);
+
+    lv_obj_t *label = lv_label_create(header_row);
+    lv_label_set_text(label, "Title");
+    lv_obj_add_style(label, &ui_theme.title, LV_PART_MAIN);
+
+    lv_obj_t *value = lv_label_create(obj);
+    lv_label_set_text(value, "N.A");
+    lv_obj_add_style(value, &ui_theme.value, LV_PART_MAIN);
+}
+
+static void bench_page(bool themed, long *heap, uint32_t *draw_us)
+{
+    lv_obj_t *prev = lv_scr_act();
+    lv_obj_t *page = lv_obj_create(NULL);
+    lv_obj_set_flex_flow(page, LV_FLEX_FLOW_COLUMN);
+    lv_scr_load(page);
+
+    size_t mark = ui_heap_mark();
+    for (int i = 0; i < THEME_BENCH_ROWS; i++) {
+        themed ? bench_row_themed(page) : bench_row_local(page);
+    }
+    *heap = (long)mark - (long)ui_heap_mark();
+
+    lv_refr_now(NULL);
+    uint32_t start = micros();
+    for (int i = 0; i < THEME_BENCH_FRAMES; i++) {
+        lv_obj_scroll_by(page, 0, i & 1 ? 20 : -20, LV_ANIM_OFF);
+        lv_refr_now(NULL);
+    }
+    *draw_us = (micros() - start) / THEME_BENCH_FRAMES;
+
+    lv_scr_load(prev);
+    lv_obj_del(page);
+}
+
+void test_ui_theme_heap_and_draw(void) {
+    if (!lv_is_initialized()) {
+        lv_init();
+    }
+    bench_display_init();
+    ui_theme_init();
+
+    long local_heap, themed_heap;
+    uint32_t local_us, themed_us;
+    bench_page(false, &local_heap, &local_us);
+    bench_page(true, &themed_heap, &themed_us);
+
+    Serial.printf("UI theme: %d rows, local styles %ld bytes %lu us/frame, shared styles %ld bytes %lu us/frame\n",
+                  THEME_BENCH_ROWS, local_heap, (unsigned long)local_us, themed_heap, (unsigned long)themed_us);
+
+    // Shared styles only add a reference per object
+    TEST_ASSERT_TRUE(themed_heap < local_heap);
+}
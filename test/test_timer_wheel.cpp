@@ -0,0 +1,127 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "timer_wheel.h"
+
+#define BENCH_NODES         1000
+#define BENCH_TICKS         (2 * 3600 * 4)          // Two hours of 250 ms ticks
+#define BENCH_SILENT_TICK   (30 * 60 * 4)           // Every 10th node stops after 30 min
+#define BENCH_LOST_MISSES   3
+
+static timer_wheel_t        test_wheel;
+static timer_wheel_entry_t  test_entries[BENCH_NODES];
+static uint32_t             fired_at[BENCH_NODES];
+
+static void record_fire(uint16_t id, void *ctx)
+{
+    fired_at[id] = ((timer_wheel_t *)ctx)->now;
+}
+
+// Timer wheel test functions
+void test_timer_wheel_fires_on_time(void) {
+    // Deltas on both sides of every level boundary, plus one parked beyond the range
+    const uint32_t deltas[] = {1, 2, 255, 256, 257, 300, 16383, 16384, 16385, 70000,
+                               TIMER_WHEEL_MAX_DELTA, TIMER_WHEEL_MAX_DELTA + 5000};
+    const uint16_t count = sizeof(deltas) / sizeof(deltas[0]);
+    const uint32_t start = 0xFFFFF000;                  // Also cross the 32 bit wrap
+
+    timer_wheel_init(&test_wheel, test_entries, count, start);
+    for (uint16_t i = 0; i < count; i++) {
+        fired_at[i] = 0;
+        timer_wheel_schedule(&test_wheel, i, start + deltas[i]);
+        TEST_ASSERT_TRUE(timer_wheel_pending(&test_wheel, i));
+    }
+    uint32_t fired = timer_wheel_advance(&test_wheel, start + TIMER_WHEEL_MAX_DELTA + 6000, record_fire, &test_wheel);
+    TEST_ASSERT_EQUAL(count, fired);
+    for (uint16_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(start + deltas[i], fired_at[i]);
+        TEST_ASSERT_FALSE(timer_wheel_pending(&test_wheel, i));
+    }
+}
+
+void test_timer_wheel_cancel_and_reschedule(void) {
+    timer_wheel_init(&test_wheel, test_entries, 4, 100);
+    fired_at[0] = fired_at[1] = fired_at[2] = 0;
+    timer_wheel_schedule(&test_wheel, 0, 150);
+    timer_wheel_schedule(&test_wheel, 1, 150);
+    timer_wheel_schedule(&test_wheel, 2, 5000);
+    timer_wheel_cancel(&test_wheel, 1);
+    timer_wheel_schedule(&test_wheel, 2, 120);          // Moved from level 1 to level 0
+    timer_wheel_schedule(&test_wheel, 3, 90);           // Already due, fires on the next tick
+
+    TEST_ASSERT_EQUAL(1, timer_wheel_advance(&test_wheel, 101, record_fire, &test_wheel));
+    TEST_ASSERT_EQUAL(2, timer_wheel_advance(&test_wheel, 6000, record_fire, &test_wheel));
+    TEST_ASSERT_EQUAL_UINT32(150, fired_at[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, fired_at[1]);
+    TEST_ASSERT_EQUAL_UINT32(120, fired_at[2]);
+}
+
+// Heartbeat supervision of 1,000 simulated nodes: one wheel emits the node
+// heartbeats, the other holds the supervision deadlines as supervision.cpp does
+static timer_wheel_t        sim_wheel;
+static timer_wheel_entry_t  sim_entries[BENCH_NODES];
+static uint16_t             bench_interval[BENCH_NODES];
+static uint32_t             bench_heard[BENCH_NODES];
+static uint8_t              bench_stage[BENCH_NODES];      // 0 await, 1 late, 2 lost
+static uint32_t             bench_lost = 0;
+static uint32_t             bench_wrong = 0;
+
+static void bench_deadline(uint16_t id, void *ctx)
+{
+    if (bench_stage[id] == 0) {
+        bench_stage[id] = 1;
+        timer_wheel_schedule(&test_wheel, id, bench_heard[id] + bench_interval[id] * BENCH_LOST_MISSES);
+    } else if (bench_stage[id] == 1) {
+        bench_stage[id] = 2;
+        bench_lost++;
+        if (id % 10 != 0 || test_wheel.now != bench_heard[id] + bench_interval[id] * BENCH_LOST_MISSES) {
+            bench_wrong++;
+        }
+    }
+}
+
+static void bench_heartbeat(uint16_t id, void *ctx)
+{
+    uint32_t now = sim_wheel.now;
+    if (id % 10 == 0 && now >= BENCH_SILENT_TICK) {
+        return;
+    }
+    timer_wheel_schedule(&sim_wheel, id, now + bench_interval[id]);
+    // What supervision_node_heard() does
+    bench_stage[id] = 0;
+    bench_heard[id] = now;
+    timer_wheel_schedule(&test_wheel, id, now + bench_interval[id] + bench_interval[id] / 4);
+}
+
+void test_timer_wheel_supervision_benchmark(void) {
+    timer_wheel_init(&test_wheel, test_entries, BENCH_NODES, 0);
+    timer_wheel_init(&sim_wheel, sim_entries, BENCH_NODES, 0);
+    bench_lost = bench_wrong = 0;
+    uint32_t seed = 12345;
+    for (uint16_t i = 0; i < BENCH_NODES; i++) {
+        // Heartbeat intervals between 30 s and 5 min
+        seed = seed * 1103515245 + 12345;
+        bench_interval[i] = 120 + (seed >> 16) % 1080;
+        timer_wheel_schedule(&sim_wheel, i, 1 + i % bench_interval[i]);
+        bench_stage[i] = 0;
+        bench_heard[i] = 0;
+        timer_wheel_schedule(&test_wheel, i, bench_interval[i] * BENCH_LOST_MISSES);
+    }
+
+    uint32_t supervision_us = 0, max_tick_us = 0;
+    for (uint32_t tick = 1; tick <= BENCH_TICKS; tick++) {
+        uint32_t start = micros();
+        timer_wheel_advance(&sim_wheel, tick, bench_heartbeat, NULL);
+        timer_wheel_advance(&test_wheel, tick, bench_deadline, NULL);
+        uint32_t elapsed = micros() - start;
+        supervision_us += elapsed;
+        max_tick_us = max(max_tick_us, elapsed);
+    }
+    Serial.printf("Timer wheel: %d nodes, %d ticks in %lu us (%lu ns/tick avg, %lu us max)\n",
+                  BENCH_NODES, BENCH_TICKS, (unsigned long)supervision_us,
+                  (unsigned long)(supervision_us * 1000ULL / BENCH_TICKS), (unsigned long)max_tick_us);
+
+    TEST_ASSERT_EQUAL(BENCH_NODES / 10, bench_lost);
+    TEST_ASSERT_EQUAL(0, bench_wrong);
+    // Average tick well below the 250 ms tick period
+    TEST_ASSERT_LESS_THAN_UINT32(50, supervision_us / BENCH_TICKS);
+}
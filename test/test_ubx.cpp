@@ -0,0 +1,146 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "ubx.h"
+#include "gps_task.h"
+
+static int ubx_feed_all(ubx_parser_t *parser, const uint8_t *data, size_t len)
+{
+    int frames = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (ubx_parser_feed(parser, data[i])) {
+            frames++;
+        }
+    }
+    return frames;
+}
+
+static void ubx_test_pvt_payload(uint8_t *p, bool fix, int32_t lat, int32_t lon)
+{
+    memset(p, 0, UBX_NAV_PVT_LEN);
+    uint32_t itow = 123456000;
+    memcpy(p + 0, &itow, 4);
+    uint16_t year = 2026;
+    memcpy(p + 4, &year, 2);
+    p[6] = 10;
+    p[7] = 18;
+    p[8] = 9;
+    p[9] = 41;
+    p[10] = 7;
+    p[11] = 0x07;                       // Date, time, fully resolved
+    p[20] = fix ? 3 : 0;
+    p[21] = fix ? 0x01 : 0x00;
+    p[23] = 14;
+    memcpy(p + 24, &lon, 4);
+    memcpy(p + 28, &lat, 4);
+    int32_t speed = 5144;               // 10 knots
+    memcpy(p + 60, &speed, 4);
+    uint16_t pdop = 123;
+    memcpy(p + 76, &pdop, 2);
+}
+
+void test_ubx_parser_frames(void) {
+    // Frames already sent by GPS_Recovery(), the builder must match them
+    const uint8_t cfg_rate[] = {0xB5, 0x62, 0x06, 0x08, 0x00, 0x00, 0x0E, 0x30};
+    const uint8_t cfg_clear1[] = {0xB5, 0x62, 0x06, 0x09, 0x0D, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x1C, 0xA2};
+    uint8_t frame[64];
+    TEST_ASSERT_EQUAL(sizeof(cfg_rate), ubx_frame(frame, sizeof(frame), 0x06, 0x08, NULL, 0));
+    TEST_ASSERT_EQUAL_MEMORY(cfg_rate, frame, sizeof(cfg_rate));
+    TEST_ASSERT_EQUAL(sizeof(cfg_clear1), ubx_frame(frame, sizeof(frame), 0x06, 0x09, cfg_clear1 + 6, 13));
+    TEST_ASSERT_EQUAL_MEMORY(cfg_clear1, frame, sizeof(cfg_clear1));
+    TEST_ASSERT_EQUAL(0, ubx_frame(frame, 20, 0x06, 0x09, cfg_clear1 + 6, 13));
+
+    // ACK-ACK behind NMEA text and a false sync, one byte at a time
+    static ubx_parser_t parser;
+    ubx_parser_init(&parser);
+    const uint8_t ack_payload[] = {UBX_CLASS_CFG, UBX_CFG_VALSET};
+    uint8_t stream[64];
+    const char *noise = "$GNTXT,01*4E\r\n\xB5\xB5";
+    size_t len = strlen(noise);
+    memcpy(stream, noise, len);
+    len += ubx_frame(stream + len, sizeof(stream) - len, UBX_CLASS_ACK, UBX_ACK_ACK, ack_payload, 2);
+    for (size_t i = 0; i < len; i++) {
+        bool done = ubx_parser_feed(&parser, stream[i]);
+        TEST_ASSERT_EQUAL(i == len - 1, done);
+    }
+    TEST_ASSERT_EQUAL(UBX_CLASS_ACK, parser.cls);
+    TEST_ASSERT_EQUAL(UBX_ACK_ACK, parser.id);
+    TEST_ASSERT_EQUAL(2, parser.len);
+    TEST_ASSERT_EQUAL_MEMORY(ack_payload, parser.payload, 2);
+
+    // Corrupt checksum, then an oversize length, then a good frame
+    stream[len - 1] ^= 0xFF;
+    TEST_ASSERT_EQUAL(0, ubx_feed_all(&parser, stream, len));
+    TEST_ASSERT_EQUAL(1, parser.bad_checksum);
+    const uint8_t oversize[] = {0xB5, 0x62, 0x01, 0x07, 0xFF, 0x7F};
+    TEST_ASSERT_EQUAL(0, ubx_feed_all(&parser, oversize, sizeof(oversize)));
+    TEST_ASSERT_EQUAL(1, parser.oversize);
+    stream[len - 1] ^= 0xFF;
+    TEST_ASSERT_EQUAL(1, ubx_feed_all(&parser, stream, len));
+    TEST_ASSERT_EQUAL(2, parser.frames);
+}
+
+void test_ubx_nav_pvt_fix(void) {
+    uint8_t payload[UBX_NAV_PVT_LEN];
+    uint8_t frame[UBX_NAV_PVT_LEN + UBX_FRAME_OVERHEAD];
+    ubx_nav_pvt_t pvt;
+
+    ubx_test_pvt_payload(payload, true, -338588068, 1512075350);
+    TEST_ASSERT_TRUE(ubx_decode_nav_pvt(payload, sizeof(payload), &pvt));
+    TEST_ASSERT_FALSE(ubx_decode_nav_pvt(payload, sizeof(payload) - 1, &pvt));
+    TEST_ASSERT_EQUAL(123456000, pvt.itow_ms);
+    TEST_ASSERT_EQUAL(2026, pvt.year);
+    TEST_ASSERT_TRUE(pvt.date_valid);
+    TEST_ASSERT_TRUE(pvt.time_valid);
+    TEST_ASSERT_EQUAL(3, pvt.fix_type);
+    TEST_ASSERT_TRUE(pvt.fix_ok);
+    TEST_ASSERT_EQUAL(14, pvt.num_sv);
+    TEST_ASSERT_EQUAL(-338588068, pvt.lat);
+    TEST_ASSERT_EQUAL(1512075350, pvt.lon);
+    TEST_ASSERT_EQUAL(123, pvt.pdop);
+
+    // A whole epoch in one 100 byte frame
+    size_t len = ubx_frame(frame, sizeof(frame), UBX_CLASS_NAV, UBX_NAV_PVT, payload, sizeof(payload));
+    TEST_ASSERT_EQUAL(100, len);
+
+    gps_fix_t fix;
+    gps_task_ingest_ubx(frame, len);
+    TEST_ASSERT_TRUE(gps_fix_read(&fix));
+    TEST_ASSERT_TRUE(fix.location_valid);
+    TEST_ASSERT_TRUE(fabs(fix.lat - -33.8588068) < 1e-7);
+    TEST_ASSERT_TRUE(fabs(fix.lng - 151.2075350) < 1e-7);
+    TEST_ASSERT_TRUE(fabs(fix.speed - 1000.0) < 1.0);
+    TEST_ASSERT_EQUAL(2026, fix.year);
+    TEST_ASSERT_EQUAL(9, fix.hour);
+    TEST_ASSERT_EQUAL(41, fix.minute);
+    TEST_ASSERT_EQUAL(7, fix.second);
+
+    // Losing the fix keeps the last position, like the NMEA path
+    uint32_t sentences = fix.sentences;
+    ubx_test_pvt_payload(payload, false, 0, 0);
+    len = ubx_frame(frame, sizeof(frame), UBX_CLASS_NAV, UBX_NAV_PVT, payload, sizeof(payload));
+    gps_task_ingest_ubx(frame, len);
+    TEST_ASSERT_TRUE(gps_fix_read(&fix));
+    TEST_ASSERT_EQUAL(sentences + 1, fix.sentences);
+    TEST_ASSERT_TRUE(fabs(fix.lat - -33.8588068) < 1e-7);
+}
+
+void test_ubx_cfg_pvt_only(void) {
+    uint8_t frame[64];
+    size_t len = ubx_cfg_pvt_only(frame, sizeof(frame), UBX_PVT_FAST_MS);
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_EQUAL(0, ubx_cfg_pvt_only(frame, 16, UBX_PVT_FAST_MS));
+
+    static ubx_parser_t parser;
+    ubx_parser_init(&parser);
+    TEST_ASSERT_EQUAL(1, ubx_feed_all(&parser, frame, len));
+    TEST_ASSERT_EQUAL(UBX_CLASS_CFG, parser.cls);
+    TEST_ASSERT_EQUAL(UBX_CFG_VALSET, parser.id);
+    TEST_ASSERT_EQUAL(31, parser.len);
+
+    // RAM layer, NMEA output off, then CFG-RATE-MEAS in milliseconds
+    TEST_ASSERT_EQUAL(0x01, parser.payload[1]);
+    const uint8_t nmea_off[] = {0x02, 0x00, 0x74, 0x10, 0x00};
+    TEST_ASSERT_EQUAL_MEMORY(nmea_off, parser.payload + 4, sizeof(nmea_off));
+    const uint8_t rate_meas[] = {0x01, 0x00, 0x21, 0x30, UBX_PVT_FAST_MS, 0x00};
+    TEST_ASSERT_EQUAL_MEMORY(rate_meas, parser.payload + 19, sizeof(rate_meas));
+}
@@ -0,0 +1,166 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "ui_pages.h"
+#include "ui_performance.h"
+
+#define PAGES_TEST_IDLE_MS      1000
+#define PAGES_TEST_ROWS         20
+
+static uint32_t build_count[3];
+static uint32_t teardown_count[3];
+static lv_timer_t *page_timer[3];
+static uint32_t refused_timers;
+
+static void pages_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    lv_disp_flush_ready(drv);
+}
+
+static void pages_display_init(void)
+{
+    if (!lv_is_initialized()) {
+        lv_init();
+    }
+    if (lv_disp_get_default()) {
+        return;
+    }
+    static lv_color_t buf[320 * 24];
+    static lv_disp_draw_buf_t draw_buf;
+    static lv_disp_drv_t drv;
+    lv_disp_draw_buf_init(&draw_buf, buf, NULL, sizeof(buf) / sizeof(buf[0]));
+    lv_disp_drv_init(&drv);
+    drv.hor_res = 320;
+    drv.ver_res = 240;
+    drv.flush_cb = pages_flush;
+    drv.draw_buf = &draw_buf;
+    lv_disp_drv_register(&drv);
+}
+
+static lv_obj_t *pages_create(void)
+{
+    lv_obj_t *page = lv_obj_create(lv_scr_act());
+    lv_obj_set_flex_flow(page, LV_FLEX_FLOW_COLUMN);
+    lv_obj_add_flag(page, LV_OBJ_FLAG_HIDDEN);
+    return page;
+}
+
+static void pages_timer_cb(lv_timer_t *t)
+{
+}
+
+static void pages_build(uint8_t id, lv_obj_t *page)
+{
+    build_count[id]++;
+    for (int i = 0; i < PAGES_TEST_ROWS; i++) {
+        lv_obj_t *label = lv_label_create(page);
+        lv_label_set_text_fmt(label, "Row %d", i);
+    }
+    page_timer[id] = ui_page_timer_create(pages_timer_cb, 1000, NULL);
+    if (id == 2) {
+        // One more than the page can own
+        for (int i = 0; i < UI_PAGE_MAX_TIMERS; i++) {
+            if (!ui_page_timer_create(pages_timer_cb, 1000, NULL)) {
+                refused_timers++;
+            }
+        }
+    }
+}
+
+static void pages_build_0(lv_obj_t *page) { pages_build(0, page); }
+static void pages_build_1(lv_obj_t *page) { pages_build(1, page); }
+static void pages_build_2(lv_obj_t *page) { pages_build(2, page); }
+static void pages_teardown_0(void) { teardown_count[0]++; }
+static void pages_teardown_1(void) { teardown_count[1]++; }
+static void pages_teardown_2(void) { teardown_count[2]++; }
+
+static ui_page_t test_pages[3] = {
+    {"Test 0", pages_build_0, pages_teardown_0, false},
+    {"Test 1", pages_build_1, pages_teardown_1, false},
+    {"Test 2", pages_build_2, pages_teardown_2, true},
+};
+
+static void pages_reset(void)
+{
+    pages_display_init();
+    memset(build_count, 0, sizeof(build_count));
+    memset(teardown_count, 0, sizeof(teardown_count));
+    refused_timers = 0;
+    ui_pages_begin(test_pages, 3, pages_create, PAGES_TEST_IDLE_MS);
+}
+
+void test_ui_pages_lazy_build(void) {
+    pages_reset();
+
+    // Nothing is built before the first navigation
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_FALSE(ui_pages_built(i));
+    }
+    TEST_ASSERT_EQUAL(UI_PAGE_NONE, ui_pages_current());
+
+    lv_obj_t *page0 = ui_pages_open(0);
+    TEST_ASSERT_NOT_NULL(page0);
+    TEST_ASSERT_EQUAL(1, build_count[0]);
+    TEST_ASSERT_EQUAL(0, build_count[1]);
+    TEST_ASSERT_FALSE(lv_obj_has_flag(page0, LV_OBJ_FLAG_HIDDEN));
+    TEST_ASSERT_FALSE(page_timer[0]->paused);
+
+    // Switching hides the previous page and pauses its timers
+    lv_obj_t *page1 = ui_pages_open(1);
+    TEST_ASSERT_TRUE(lv_obj_has_flag(page0, LV_OBJ_FLAG_HIDDEN));
+    TEST_ASSERT_TRUE(page_timer[0]->paused);
+    TEST_ASSERT_FALSE(page_timer[1]->paused);
+
+    // Reopening reuses the page and resumes its timers
+    TEST_ASSERT_EQUAL_PTR(page0, ui_pages_open(0));
+    TEST_ASSERT_EQUAL(1, build_count[0]);
+    TEST_ASSERT_FALSE(page_timer[0]->paused);
+
+    ui_pages_close();
+    TEST_ASSERT_EQUAL(UI_PAGE_NONE, ui_pages_current());
+    TEST_ASSERT_TRUE(lv_obj_has_flag(page0, LV_OBJ_FLAG_HIDDEN));
+    TEST_ASSERT_TRUE(lv_obj_has_flag(page1, LV_OBJ_FLAG_HIDDEN));
+    TEST_ASSERT_TRUE(page_timer[0]->paused);
+
+    ui_pages_destroy(0);
+    ui_pages_destroy(1);
+}
+
+void test_ui_pages_idle_teardown(void) {
+    pages_reset();
+    size_t mark = ui_heap_mark();
+
+    ui_pages_open(0);
+    ui_pages_open(2);
+    ui_pages_open(1);
+    TEST_ASSERT_EQUAL(UI_PAGE_MAX_TIMERS, test_pages[2].timer_count);
+    TEST_ASSERT_EQUAL(1, refused_timers);
+    long built_heap = (long)mark - (long)ui_heap_mark();
+
+    ui_pages_close();
+    uint32_t closed_ms = millis();
+
+    // Hidden pages survive until the idle timeout
+    TEST_ASSERT_EQUAL(0, ui_pages_reap(closed_ms + PAGES_TEST_IDLE_MS / 2));
+    TEST_ASSERT_TRUE(ui_pages_built(0));
+
+    // Then only pages without `keep` are released
+    TEST_ASSERT_EQUAL(2, ui_pages_reap(closed_ms + PAGES_TEST_IDLE_MS));
+    TEST_ASSERT_FALSE(ui_pages_built(0));
+    TEST_ASSERT_FALSE(ui_pages_built(1));
+    TEST_ASSERT_TRUE(ui_pages_built(2));
+    TEST_ASSERT_EQUAL(1, teardown_count[0]);
+    TEST_ASSERT_EQUAL(1, teardown_count[1]);
+    TEST_ASSERT_EQUAL(0, teardown_count[2]);
+
+    long resident_heap = (long)mark - (long)ui_heap_mark();
+    Serial.printf("UI pages: 3 pages %ld bytes, after idle teardown %ld bytes\n", built_heap, resident_heap);
+    TEST_ASSERT_TRUE(resident_heap < built_heap);
+
+    // The next visit rebuilds the page
+    ui_pages_open(0);
+    TEST_ASSERT_EQUAL(2, build_count[0]);
+    ui_pages_close();
+
+    ui_pages_destroy(0);
+    ui_pages_destroy(2);
+}